@@ -0,0 +1,39 @@
+#-------------------------------------------------
+#
+# Headless benchmarks of Lib_Teste. Run with --help for the options.
+# The results are written as JSON, so they can be compared between releases.
+#
+#-------------------------------------------------
+
+QT       += core gui widgets
+
+TARGET = Benchmark
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        SceneBenchmark.cpp \
+        main.cpp
+
+HEADERS += \
+        SceneBenchmark.h
+
+# Links with the library the same way as Teste_da_Lib.
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/./ -lLib_Teste
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/./ -lLib_Tested
+else:unix: LIBS += -L$$PWD/./ -lLib_Teste
+
+win32: LIBS += -lpsapi
+
+INCLUDEPATH += $$PWD/../Lib_Teste
+DEPENDPATH += $$PWD/../Lib_Teste
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/./libLib_Teste.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/./libLib_Tested.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/./Lib_Teste.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/./Lib_Tested.lib
+else:unix: PRE_TARGETDEPS += $$PWD/./libLib_Teste.a
@@ -0,0 +1,1021 @@
+#include "SceneBenchmark.h"
+#include "Core/GraphicsScene.h"
+#include "Core/GraphicsSceneEventRecorder.h"
+#include "Core/GraphicsSceneEventReplayer.h"
+#include "Core/Graphics2DView.h"
+#include "Core/Graphics3DItem.h"
+#include "Core/Graphics3DView.h"
+#include "Core/RenderProfiler.h"
+#include "Items/PointSet2DItem.h"
+#include "Items/Polyline2DItem.h"
+#include "Items/Rectangle2DItem.h"
+#include "Items/TriangleMesh2DItem.h"
+#include "Items/TriangleMesh3DItem.h"
+#include "Shading/ShaderProgramRegistry.h"
+#include "Tools/EditPolyline2DItemTool.h"
+#include "Tools/Select2DItemTool.h"
+#include "Tools/ViewControllerTool.h"
+#include "Utility/MeshCache.h"
+#include "Utility/ReaderOFF.h"
+#include "Utility/Tri3ToTri6Conversor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QTemporaryFile>
+#include <QTransform>
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <QFile>
+#endif
+
+namespace
+{
+/**
+ * @brief getElapsedTime - Gets the time elapsed on a timer.
+ * @param timer - Started timer.
+ * @return - Returns the time in milliseconds.
+ */
+double getElapsedTime(const QElapsedTimer& timer)
+{
+    return timer.nsecsElapsed() * 1e-6;
+}
+
+
+
+/**
+ * @brief summarize - Computes the statistics of a set of samples.
+ * @param samples - Samples. They are sorted.
+ * @return - Returns the number of samples, their mean, minimum, median, 95th percentile and maximum.
+ */
+QJsonObject summarize(std::vector<double>& samples)
+{
+    QJsonObject summary;
+    summary["count"] = static_cast<int>(samples.size());
+    if (samples.empty())
+    {
+        return summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double sample : samples)
+    {
+        sum += sample;
+    }
+
+    summary["mean"] = sum / samples.size();
+    summary["min"] = samples.front();
+    summary["median"] = samples[samples.size() / 2];
+    summary["p95"] = samples[std::min(samples.size() - 1, static_cast<size_t>(0.95 * samples.size()))];
+    summary["max"] = samples.back();
+    return summary;
+}
+
+
+
+/**
+ * @brief getMemoryUsage - Gets the memory used by the process.
+ * @param peak - True to get the peak usage instead of the current one.
+ * @return - Returns the resident memory in bytes, or -1 if it is not known on this platform.
+ */
+double getMemoryUsage(bool peak)
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return static_cast<double>(peak ? counters.PeakWorkingSetSize : counters.WorkingSetSize);
+    }
+#elif defined(Q_OS_LINUX)
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QByteArray key = peak ? "VmHWM:" : "VmRSS:";
+        for (QByteArray line = file.readLine(); !line.isEmpty(); line = file.readLine())
+        {
+            if (line.startsWith(key))
+            {
+                //The value is in kB.
+                return line.mid(key.size()).trimmed().split(' ').first().toDouble() * 1024;
+            }
+        }
+    }
+#else
+    Q_UNUSED(peak);
+#endif
+    return -1;
+}
+
+
+
+/**
+ * @brief createGrid - Creates a regular triangle mesh on a rectangle.
+ * @param cells - Number of grid cells on each axis. Each cell has two triangles.
+ * @param origin - Minimal corner of the rectangle.
+ * @param size - Rectangle size.
+ * @param mesh - Receives the triangles.
+ * @param points - Receives the points.
+ */
+void createGrid(unsigned int cells, const rm::Point2Df& origin, float size, std::vector<unsigned int>& mesh,
+                std::vector<rm::Point2Df>& points)
+{
+    mesh.clear();
+    points.clear();
+    for (unsigned int j = 0; j <= cells; j++)
+    {
+        for (unsigned int i = 0; i <= cells; i++)
+        {
+            points.emplace_back(origin.x() + size * i / cells, origin.y() + size * j / cells);
+        }
+    }
+
+    for (unsigned int j = 0; j < cells; j++)
+    {
+        for (unsigned int i = 0; i < cells; i++)
+        {
+            unsigned int v = j * (cells + 1) + i;
+            mesh.insert(mesh.end(), {v, v + 1, v + cells + 2, v, v + cells + 2, v + cells + 1});
+        }
+    }
+}
+
+
+
+/**
+ * @brief getGridCells - Gets the number of cells per axis of a grid with about the given number of triangles.
+ * @param triangles - Number of triangles.
+ * @return - Returns the number of cells on each axis.
+ */
+unsigned int getGridCells(unsigned int triangles)
+{
+    return std::max(1u, static_cast<unsigned int>(std::sqrt(triangles / 2.0)));
+}
+
+
+
+/**
+ * @brief writeGridFileOFF - Writes a height field over a regular grid as an OFF triangle mesh.
+ * @param filename - File name.
+ * @param triangles - Approximate number of triangles.
+ * @return - Returns true if the whole file was written.
+ */
+bool writeGridFileOFF(const std::string& filename, unsigned int triangles)
+{
+    std::vector<unsigned int> mesh;
+    std::vector<rm::Point2Df> points;
+    createGrid(getGridCells(triangles), rm::Point2Df(0, 0), 1.0f, mesh, points);
+
+    std::ofstream out(filename);
+    out << "OFF\n" << points.size() << ' ' << mesh.size() / 3 << " 0\n";
+    for (const rm::Point2Df& p : points)
+    {
+        out << p.x() << ' ' << p.y() << ' ' << 0.05f * std::sin(20 * p.x()) * std::cos(20 * p.y()) << '\n';
+    }
+    for (size_t i = 0; i < mesh.size(); i += 3)
+    {
+        out << "3 " << mesh[i] << ' ' << mesh[i + 1] << ' ' << mesh[i + 2] << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+
+
+/**
+ * @brief readTriangle3DFileOFFStream - Reads a triangle mesh with formatted std::ifstream reads. It is the reference
+ * for the library reader. Comments are not supported.
+ * @param filename - File name.
+ * @param points - Receives the points.
+ * @param triangles - Receives the triangles. Faces that are not triangles are skipped.
+ * @return - Returns true if the header was read.
+ */
+bool readTriangle3DFileOFFStream(const std::string& filename, std::vector<QVector3D>& points,
+                                 std::vector<unsigned int>& triangles)
+{
+    std::ifstream in(filename);
+    std::string header;
+    size_t numPoints = 0, numFaces = 0, numEdges = 0;
+    if (!(in >> header >> numPoints >> numFaces >> numEdges) || header != "OFF")
+    {
+        return false;
+    }
+
+    points.resize(numPoints);
+    for (QVector3D& p : points)
+    {
+        float x, y, z;
+        in >> x >> y >> z;
+        p = QVector3D(x, y, z);
+    }
+
+    triangles.clear();
+    triangles.reserve(3 * numFaces);
+    for (size_t f = 0; f < numFaces; f++)
+    {
+        unsigned int n = 0, index = 0;
+        in >> n;
+        for (unsigned int i = 0; i < n; i++)
+        {
+            in >> index;
+            if (n == 3)
+            {
+                triangles.push_back(index);
+            }
+        }
+    }
+    return true;
+}
+}
+
+
+
+SceneBenchmark::SceneBenchmark(const Parameters& parameters)
+    : _parameters(parameters)
+{
+}
+
+
+
+SceneBenchmark::~SceneBenchmark()
+{
+    if (_scene != nullptr)
+    {
+        //The views have their profiler queries on the scene context, since they are rendered on it.
+        _scene->makeCurrent();
+        _scene->deleteView(_view2D);
+        _scene->makeCurrent();
+        _scene->deleteView(_view3D);
+        _scene->doneCurrent();
+        delete _scene;
+    }
+}
+
+
+
+QJsonObject SceneBenchmark::run()
+{
+    QJsonObject results;
+    results["parameters"] = getParameters();
+
+    results["programs"] = measurePrograms();
+
+    QJsonObject memory;
+    memory["beforeLoad"] = getMemoryUsage(false);
+
+    _scene = new rm::GraphicsScene();
+    _view2D = _scene->create2DView();
+    _view2D->resize(_parameters.width, _parameters.height);
+    _view2D->setBatchRendering(_parameters.batchRendering);
+    _view3D = _scene->create3DView();
+    _view3D->resize(_parameters.width, _parameters.height);
+
+    results["load"] = load();
+    memory["afterLoad"] = getMemoryUsage(false);
+
+    _scene->makeCurrent();
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+
+    QJsonObject environment;
+    environment["qt"] = qVersion();
+    environment["vendor"] = reinterpret_cast<const char*>(f->glGetString(GL_VENDOR));
+    environment["renderer"] = reinterpret_cast<const char*>(f->glGetString(GL_RENDERER));
+    environment["version"] = reinterpret_cast<const char*>(f->glGetString(GL_VERSION));
+    results["environment"] = environment;
+
+    {
+        //The framebuffer takes the place of the widget one, and the view setup is done as if it was shown.
+        QOpenGLFramebufferObject framebuffer(_parameters.width, _parameters.height,
+                                             QOpenGLFramebufferObject::CombinedDepthStencil);
+        framebuffer.bind();
+
+        _view2D->initializeGL();
+        _view2D->resizeGL(_parameters.width, _parameters.height);
+        _view2D->fit();
+        results["frames2D"] = measureFrames(_view2D);
+
+        //The 3D meshes are laid on a grid of unit squares on the plane z = 0.
+        float extent = std::ceil(std::sqrt(static_cast<float>(std::max(1u, _parameters.meshes3D))));
+        QVector3D center(extent / 2, extent / 2, 0);
+        _view3D->initializeGL();
+        _view3D->resizeGL(_parameters.width, _parameters.height);
+        _view3D->lookAt(center + QVector3D(0, 0, 1.2f * extent), center, QVector3D(0, 1, 0));
+        results["frames3D"] = measureFrames(_view3D);
+
+        framebuffer.release();
+    }
+    _scene->doneCurrent();
+
+    results["picks2D"] = measurePicks2D();
+    results["picks3D"] = measurePicks3D();
+
+    //Without a given file, the readers are compared on a synthetic one. It is removed at the end of the run.
+    QTemporaryFile syntheticFile(QDir::tempPath() + "/SceneBenchmark-XXXXXX.off");
+    std::string offFile = _parameters.offFile;
+    if (offFile.empty() && _parameters.offFaces > 0 && syntheticFile.open())
+    {
+        syntheticFile.close();
+        offFile = syntheticFile.fileName().toStdString();
+        if (!writeGridFileOFF(offFile, _parameters.offFaces))
+        {
+            offFile.clear();
+        }
+    }
+
+    if (!offFile.empty())
+    {
+        results["readerOFF"] = measureReaderOFF(offFile);
+        results["meshCache"] = measureMeshCache(offFile);
+    }
+
+    if (_parameters.tri6Triangles > 0)
+    {
+        results["tri3ToTri6"] = measureTri3ToTri6();
+    }
+
+    if (!_parameters.replayFile.empty())
+    {
+        results["replay"] = measureReplay();
+    }
+
+    if (_parameters.submissionItems > 0)
+    {
+        results["submission"] = measureSubmission();
+    }
+
+    memory["peak"] = getMemoryUsage(true);
+    results["memory"] = memory;
+    return results;
+}
+
+
+
+QJsonObject SceneBenchmark::measurePrograms()
+{
+    auto build = [](bool isDiskCacheEnabled, unsigned int& numPrograms)
+    {
+        QCoreApplication::setAttribute(Qt::AA_DisableShaderDiskCache, !isDiskCacheEnabled);
+
+        QOffscreenSurface surface;
+        surface.create();
+        QOpenGLContext context;
+        if (!context.create() || !context.makeCurrent(&surface))
+        {
+            return -1.0;
+        }
+
+        //The group of the new context has its own registry, which starts empty.
+        rm::ShaderProgramRegistry* registry = rm::ShaderProgramRegistry::current();
+        QElapsedTimer timer;
+        timer.start();
+        numPrograms = registry->warmUp(rm::ShaderProgramRegistry::getLibraryPrograms());
+        context.functions()->glFinish();
+        double buildTime = getElapsedTime(timer);
+
+        //The programs are deleted while their context is current.
+        delete registry;
+        context.doneCurrent();
+        return buildTime;
+    };
+
+    unsigned int numPrograms = 0;
+    QJsonObject programs;
+    programs["coldTime"] = build(false, numPrograms);
+    programs["cacheStoreTime"] = build(true, numPrograms);
+    programs["warmTime"] = build(true, numPrograms);
+    programs["programs"] = static_cast<double>(numPrograms);
+    QCoreApplication::setAttribute(Qt::AA_DisableShaderDiskCache, false);
+    return programs;
+}
+
+
+
+QJsonObject SceneBenchmark::load()
+{
+    std::mt19937 random(_parameters.seed);
+    std::uniform_real_distribution<float> unit(0.1f, 0.9f);
+
+    //The 2D items are laid on a grid of unit squares, one item per square.
+    unsigned int numItems2D = _parameters.pointSets + _parameters.polylines + _parameters.rectangles +
+            _parameters.meshes2D;
+    unsigned int columns2D = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(numItems2D))));
+    unsigned int item2D = 0;
+    auto nextOrigin = [&]()
+    {
+        rm::Point2Df origin(static_cast<float>(item2D % columns2D), static_cast<float>(item2D / columns2D));
+        item2D++;
+        return origin;
+    };
+
+    QJsonObject load;
+    QElapsedTimer timer;
+    std::vector<rm::Point2Df> points;
+
+    //Point sets. Just the item creation is timed, not the generation of its data.
+    double loadTime = 0;
+    for (unsigned int i = 0; i < _parameters.pointSets; i++)
+    {
+        rm::Point2Df origin = nextOrigin();
+        points.clear();
+        for (unsigned int p = 0; p < _parameters.pointsPerItem; p++)
+        {
+            points.emplace_back(origin.x() + unit(random), origin.y() + unit(random));
+        }
+
+        timer.start();
+        _scene->addItem(new rm::PointSet2DItem(points));
+        loadTime += getElapsedTime(timer);
+    }
+    load["pointSets"] = loadTime;
+
+    //Polylines.
+    loadTime = 0;
+    for (unsigned int i = 0; i < _parameters.polylines; i++)
+    {
+        rm::Point2Df origin = nextOrigin();
+        points.clear();
+        for (unsigned int p = 0; p < _parameters.pointsPerItem; p++)
+        {
+            points.emplace_back(origin.x() + unit(random), origin.y() + unit(random));
+        }
+
+        timer.start();
+        _scene->addItem(new rm::Polyline2DItem(points, i % 2 == 1));
+        loadTime += getElapsedTime(timer);
+    }
+    load["polylines"] = loadTime;
+
+    //Rectangles.
+    loadTime = 0;
+    for (unsigned int i = 0; i < _parameters.rectangles; i++)
+    {
+        rm::Point2Df origin = nextOrigin();
+        rm::Point2Df center(origin.x() + 0.5f, origin.y() + 0.5f);
+
+        timer.start();
+        _scene->addItem(new rm::Rectangle2DItem(center, unit(random), unit(random)));
+        loadTime += getElapsedTime(timer);
+    }
+    load["rectangles"] = loadTime;
+
+    //2D meshes.
+    std::vector<unsigned int> mesh;
+    unsigned int cells = getGridCells(_parameters.trianglesPerMesh);
+    loadTime = 0;
+    for (unsigned int i = 0; i < _parameters.meshes2D; i++)
+    {
+        rm::Point2Df origin = nextOrigin();
+        createGrid(cells, rm::Point2Df(origin.x() + 0.1f, origin.y() + 0.1f), 0.8f, mesh, points);
+
+        timer.start();
+        _scene->addItem(new rm::TriangleMesh2DItem(mesh, points));
+        loadTime += getElapsedTime(timer);
+    }
+    load["meshes2D"] = loadTime;
+
+    //3D meshes: height fields over a grid of unit squares.
+    unsigned int columns3D = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(_parameters.meshes3D))));
+    std::vector<QVector3D> points3D;
+    double levelsOfDetailTime = 0;
+    loadTime = 0;
+    for (unsigned int i = 0; i < _parameters.meshes3D; i++)
+    {
+        rm::Point2Df origin(static_cast<float>(i % columns3D), static_cast<float>(i / columns3D));
+        createGrid(cells, rm::Point2Df(origin.x() + 0.1f, origin.y() + 0.1f), 0.8f, mesh, points);
+        points3D.clear();
+        for (const rm::Point2Df& p : points)
+        {
+            points3D.emplace_back(p.x(), p.y(), 0.05f * std::sin(20 * p.x()) * std::cos(20 * p.y()));
+        }
+
+        timer.start();
+        rm::TriangleMesh3DItem* item = new rm::TriangleMesh3DItem(mesh, points3D);
+        loadTime += getElapsedTime(timer);
+
+        if (_parameters.meshLevelsOfDetail)
+        {
+            timer.start();
+            item->buildLevelsOfDetail();
+            levelsOfDetailTime += getElapsedTime(timer);
+        }
+
+        timer.start();
+        _scene->addItem(item);
+        loadTime += getElapsedTime(timer);
+    }
+    load["meshes3D"] = loadTime;
+    load["levelsOfDetail3D"] = levelsOfDetailTime;
+    load["trianglesPerMesh"] = static_cast<double>(mesh.size() / 3);
+    load["programBuildTime"] = _scene->getProgramRegistry()->getBuildTime();
+
+    return load;
+}
+
+
+
+QJsonObject SceneBenchmark::measureFrames(rm::GraphicsView* view)
+{
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+
+    //The frame time is measured until the GPU finishes. The profiler splits it by item type.
+    view->setProfilingEnabled(true);
+    std::vector<double> frameTimes, gpuTimes;
+    unsigned long long lastFrame = 0;
+    bool hasFrame = false;
+    QElapsedTimer timer;
+    for (unsigned int i = 0; i < _parameters.warmUpFrames + _parameters.frames; i++)
+    {
+        timer.start();
+        view->paintGL();
+        f->glFinish();
+        double frameTime = getElapsedTime(timer);
+
+        if (i >= _parameters.warmUpFrames)
+        {
+            frameTimes.push_back(frameTime);
+        }
+
+        //The GPU times arrive a frame later.
+        const rm::FrameStatistics& statistics = view->getFrameStatistics();
+        if (statistics.gpuTime >= 0 && statistics.frame >= _parameters.warmUpFrames &&
+            (!hasFrame || statistics.frame != lastFrame))
+        {
+            gpuTimes.push_back(statistics.gpuTime);
+            lastFrame = statistics.frame;
+            hasFrame = true;
+        }
+    }
+    view->setProfilingEnabled(false);
+
+    const rm::FrameStatistics& statistics = view->getFrameStatistics();
+    QJsonObject counters;
+    counters["drawCalls"] = static_cast<double>(statistics.counters.drawCalls);
+    counters["programBinds"] = static_cast<double>(statistics.counters.programBinds);
+    counters["vaoCreations"] = static_cast<double>(statistics.counters.vaoCreations);
+    counters["uploadedBytes"] = static_cast<double>(statistics.counters.uploadedBytes);
+    counters["submittedItems"] = static_cast<double>(statistics.counters.submittedItems);
+    counters["culledItems"] = static_cast<double>(statistics.counters.culledItems);
+    counters["reusedItems"] = static_cast<double>(statistics.counters.reusedItems);
+
+    QJsonArray sections;
+    for (const rm::RenderSectionStatistics& section : statistics.sections)
+    {
+        QJsonObject sectionObject;
+        sectionObject["name"] = QString::fromStdString(section.name);
+        sectionObject["cpuTime"] = section.cpuTime;
+        sectionObject["gpuTime"] = section.gpuTime;
+        sectionObject["drawCalls"] = static_cast<double>(section.counters.drawCalls);
+        sections.append(sectionObject);
+    }
+
+    QJsonObject frames;
+    frames["frameTime"] = summarize(frameTimes);
+    frames["gpuTime"] = summarize(gpuTimes);
+    frames["counters"] = counters;
+    frames["sections"] = sections;
+    return frames;
+}
+
+
+
+QJsonObject SceneBenchmark::measurePicks2D()
+{
+    std::mt19937 random(_parameters.seed);
+    std::uniform_real_distribution<float> x(0.0f, static_cast<float>(_parameters.width));
+    std::uniform_real_distribution<float> y(0.0f, static_cast<float>(_parameters.height));
+
+    //The transformation gives the pixel size of the view to the scene.
+    const rm::Point2Df& pixelSize = _view2D->getPixelSize();
+    QTransform transform = QTransform::fromScale(1.0 / pixelSize.x(), 1.0 / pixelSize.y());
+
+    std::vector<double> pickTimes;
+    unsigned int hits = 0;
+    QElapsedTimer timer;
+    for (unsigned int i = 0; i < _parameters.picks; i++)
+    {
+        rm::Point2Df world = _view2D->convertFromScreenToWorld(rm::Point2Df(x(random), y(random)));
+
+        timer.start();
+        const rm::GraphicsItem* item = _scene->itemAt(world.x(), world.y(), transform);
+        pickTimes.push_back(getElapsedTime(timer) * 1000);
+
+        if (item != nullptr)
+        {
+            hits++;
+        }
+    }
+
+    QJsonObject picks;
+    picks["pickTime"] = summarize(pickTimes);
+    picks["hits"] = static_cast<double>(hits);
+    return picks;
+}
+
+
+
+QJsonObject SceneBenchmark::measurePicks3D()
+{
+    std::mt19937 random(_parameters.seed);
+    std::uniform_real_distribution<float> x(0.0f, static_cast<float>(_parameters.width));
+    std::uniform_real_distribution<float> y(0.0f, static_cast<float>(_parameters.height));
+
+    //The first pick builds the scene and item hierarchies.
+    QElapsedTimer timer;
+    timer.start();
+    rm::PickResult first;
+    _view3D->pick(rm::Point2Df(x(random), y(random)), first);
+    double firstPickTime = getElapsedTime(timer);
+
+    std::vector<double> pickTimes;
+    unsigned int hits = 0;
+    for (unsigned int i = 0; i < _parameters.picks; i++)
+    {
+        rm::Point2Df screen(x(random), y(random));
+        rm::PickResult result;
+
+        timer.restart();
+        _view3D->pick(screen, result);
+        pickTimes.push_back(getElapsedTime(timer) * 1000);
+
+        if (result.item != nullptr)
+        {
+            hits++;
+        }
+    }
+
+    QJsonObject picks;
+    picks["firstPickTime"] = firstPickTime;
+    picks["pickTime"] = summarize(pickTimes);
+    picks["hits"] = static_cast<double>(hits);
+    return picks;
+}
+
+
+
+QJsonObject SceneBenchmark::measureReaderOFF(const std::string& filename)
+{
+    std::vector<QVector3D> points;
+    std::vector<unsigned int> triangles;
+    QElapsedTimer timer;
+
+    timer.start();
+    loader::readTriangle3DFileOFF(filename, points, triangles);
+    double readerTime = getElapsedTime(timer);
+    size_t numPoints = points.size(), numTriangles = triangles.size() / 3;
+
+    timer.restart();
+    bool isRead = readTriangle3DFileOFFStream(filename, points, triangles);
+    double streamTime = getElapsedTime(timer);
+
+    QJsonObject reader;
+    reader["file"] = _parameters.offFile.empty() ? QString("synthetic") : QString::fromStdString(filename);
+    reader["points"] = static_cast<double>(numPoints);
+    reader["triangles"] = static_cast<double>(numTriangles);
+    reader["readerTime"] = readerTime;
+    reader["streamTime"] = isRead ? streamTime : -1.0;
+    reader["sameSize"] = isRead && points.size() == numPoints && triangles.size() / 3 == numTriangles;
+    return reader;
+}
+
+
+
+QJsonObject SceneBenchmark::measureMeshCache(const std::string& filename)
+{
+    QJsonObject cache;
+    QTemporaryFile cacheFile(QDir::tempPath() + "/SceneBenchmark-XXXXXX.cache");
+    if (!cacheFile.open())
+    {
+        cache["error"] = "could not create the cache file";
+        return cache;
+    }
+    cacheFile.close();
+    std::string cacheFilename = cacheFile.fileName().toStdString();
+
+    QElapsedTimer timer;
+    timer.start();
+    bool isConverted = loader::convertTriangle3DFileOFF(filename, cacheFilename);
+    double convertTime = getElapsedTime(timer);
+    if (!isConverted)
+    {
+        cache["error"] = "could not convert the OFF file";
+        return cache;
+    }
+
+    //Both paths are timed until the buffers are on the GPU, as when a model is opened on the test application.
+    _scene->makeCurrent();
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+
+    //OFF path: the text is parsed and the item computes the normals and the AABB.
+    timer.restart();
+    std::vector<QVector3D> points;
+    std::vector<unsigned int> triangles;
+    loader::readTriangle3DFileOFF(filename, points, triangles);
+    rm::TriangleMesh3DItem* item = new rm::TriangleMesh3DItem(triangles, points);
+    item->initialize();
+    f->glFinish();
+    double offTime = getElapsedTime(timer);
+    delete item;
+
+    //Cache path: the mapped sections are sent straight to the buffers.
+    timer.restart();
+    loader::MeshCache* meshCache = new loader::MeshCache();
+    bool isOpen = meshCache->open(cacheFilename);
+    double openTime = getElapsedTime(timer);
+    double cacheTime = -1.0;
+    if (isOpen)
+    {
+        item = new rm::TriangleMesh3DItem(meshCache);
+        item->initialize();
+        f->glFinish();
+        cacheTime = getElapsedTime(timer);
+        delete item;
+    }
+    else
+    {
+        delete meshCache;
+    }
+    _scene->doneCurrent();
+
+    cache["triangles"] = static_cast<double>(triangles.size() / 3);
+    cache["bytes"] = static_cast<double>(QFileInfo(cacheFile.fileName()).size());
+    cache["convertTime"] = convertTime;
+    cache["offTime"] = offTime;
+    cache["openTime"] = isOpen ? openTime : -1.0;
+    cache["cacheTime"] = cacheTime;
+    return cache;
+}
+
+
+
+QJsonObject SceneBenchmark::measureTri3ToTri6()
+{
+    std::vector<unsigned int> mesh;
+    std::vector<rm::Point2Df> points;
+    createGrid(getGridCells(_parameters.tri6Triangles), rm::Point2Df(0, 0), 1.0f, mesh, points);
+    size_t numTriangles = mesh.size() / 3;
+    size_t numPoints = points.size();
+
+    QElapsedTimer timer;
+    timer.start();
+    rm::Tri3ToTri6Conversor(mesh, points);
+    double conversionTime = getElapsedTime(timer);
+
+    QJsonObject conversion;
+    conversion["triangles"] = static_cast<double>(numTriangles);
+    conversion["newNodes"] = static_cast<double>(points.size() - numPoints);
+    conversion["time"] = conversionTime;
+    return conversion;
+}
+
+
+
+QJsonObject SceneBenchmark::measureReplay()
+{
+    QJsonObject replay;
+    rm::GraphicsSceneEventRecorder recording;
+    if (!recording.load(_parameters.replayFile))
+    {
+        replay["error"] = "could not read the recording";
+        return replay;
+    }
+
+    rm::GraphicsTool* tool = nullptr;
+    if (_parameters.replayTool == "select")
+    {
+        tool = new rm::Select2DItemTool(_scene);
+    }
+    else if (_parameters.replayTool == "edit-polyline")
+    {
+        for (rm::Graphics2DItem* item : _scene->items2D())
+        {
+            if (rm::Polyline2DItem* polyline = dynamic_cast<rm::Polyline2DItem*>(item))
+            {
+                tool = new rm::EditPolyline2DItemTool(_view2D, polyline);
+                break;
+            }
+        }
+    }
+    else if (_parameters.replayTool == "view-controller")
+    {
+        tool = new rm::ViewControllerTool(_scene);
+    }
+
+    if (tool == nullptr)
+    {
+        replay["error"] = "invalid replay tool";
+        return replay;
+    }
+
+    rm::GraphicsSceneEventReplayer replayer(_scene);
+    replayer.setView(0, _view2D);
+    replayer.setView(1, _view3D);
+
+    //The views are never shown, so the tools run on the scene context.
+    _scene->pushTool(tool);
+    _scene->makeCurrent();
+    rm::ReplayStatistics statistics = replayer.replay(recording.getEvents());
+    _scene->doneCurrent();
+    _scene->popTool();
+    delete tool;
+
+    //Latencies in microseconds, by event type.
+    const std::pair<rm::EventType, const char*> types[] = {
+        {rm::EventType::PressEvent, "press"}, {rm::EventType::MoveEvent, "move"},
+        {rm::EventType::HoverEvent, "hover"}, {rm::EventType::keyEvent, "key"},
+        {rm::EventType::WheelEvent, "wheel"}, {rm::EventType::EnterEvent, "enter"},
+        {rm::EventType::LeaveEvent, "leave"}};
+
+    std::vector<double> allLatencies;
+    for (long long latency : statistics.latencies)
+    {
+        allLatencies.push_back(latency / 1000.0);
+    }
+
+    QJsonObject latencies;
+    latencies["all"] = summarize(allLatencies);
+    for (const auto& type : types)
+    {
+        std::vector<double> typeLatencies;
+        for (size_t i = 0; i < statistics.latencies.size(); i++)
+        {
+            if (statistics.types[i] == type.first)
+            {
+                typeLatencies.push_back(statistics.latencies[i] / 1000.0);
+            }
+        }
+        if (!typeLatencies.empty())
+        {
+            latencies[type.second] = summarize(typeLatencies);
+        }
+    }
+
+    replay["events"] = static_cast<double>(recording.getEvents().size());
+    replay["dispatchedEvents"] = static_cast<double>(statistics.dispatchedEvents);
+    replay["skippedEvents"] = static_cast<double>(statistics.skippedEvents);
+    replay["recordedTime"] = statistics.recordedTime / 1e6;
+    replay["replayTime"] = statistics.replayTime / 1e6;
+    replay["latency"] = latencies;
+    return replay;
+}
+
+
+
+QJsonObject SceneBenchmark::measureSubmission()
+{
+    //A scene of its own, so the items of the other benchmarks do not count.
+    rm::GraphicsScene* scene = new rm::GraphicsScene();
+    rm::Graphics2DView* view2D = scene->create2DView();
+    view2D->resize(_parameters.width, _parameters.height);
+    view2D->setBatchRendering(_parameters.batchRendering);
+    view2D->setCullingEnabled(false);
+    rm::Graphics3DView* view3D = scene->create3DView();
+    view3D->resize(_parameters.width, _parameters.height);
+    view3D->setCullingEnabled(false);
+
+    //The items alternate between 2D and 3D, so they are mixed on the scene list. Each one draws almost nothing, so the
+    //frame time is dominated by the submission.
+    unsigned int numItems = _parameters.submissionItems;
+    unsigned int columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(numItems / 2 + 1))));
+    std::vector<unsigned int> mesh;
+    std::vector<rm::Point2Df> points;
+    std::vector<QVector3D> points3D;
+    createGrid(1, rm::Point2Df(0, 0), 0.8f, mesh, points);
+    for (unsigned int i = 0; i < numItems; i++)
+    {
+        unsigned int cell = i / 2;
+        rm::Point2Df origin(static_cast<float>(cell % columns), static_cast<float>(cell / columns));
+        rm::Point2Df center(origin.x() + 0.5f, origin.y() + 0.5f);
+        if (i % 2 == 1)
+        {
+            points3D.clear();
+            for (const rm::Point2Df& p : points)
+            {
+                points3D.emplace_back(origin.x() + 0.1f + p.x(), origin.y() + 0.1f + p.y(), 0.0f);
+            }
+            scene->addItem(new rm::TriangleMesh3DItem(mesh, points3D));
+        }
+        else if (cell % 2 == 0)
+        {
+            scene->addItem(new rm::PointSet2DItem(std::vector<rm::Point2Df>(1, center)));
+        }
+        else
+        {
+            scene->addItem(new rm::Rectangle2DItem(center, 0.8f, 0.8f));
+        }
+    }
+
+    //The loops of the views before the typed arrays: the 2D view cast each item of the list twice, once for the items
+    //and once for their boxes, and the 3D view once.
+    std::vector<double> castTimes, typedTimes;
+    unsigned long long visitedItems = 0;
+    QElapsedTimer timer;
+    for (unsigned int frame = 0; frame < _parameters.frames; frame++)
+    {
+        timer.start();
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (rm::GraphicsItem* item : scene->items())
+            {
+                rm::Graphics2DItem* item2d = dynamic_cast<rm::Graphics2DItem*>(item);
+                visitedItems += item2d != nullptr && item2d->isVisible() ? 1 : 0;
+            }
+        }
+        for (rm::GraphicsItem* item : scene->items())
+        {
+            rm::Graphics3DItem* item3d = dynamic_cast<rm::Graphics3DItem*>(item);
+            visitedItems += item3d != nullptr && item3d->isVisible() ? 1 : 0;
+        }
+        castTimes.push_back(getElapsedTime(timer));
+
+        timer.restart();
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (rm::Graphics2DItem* item2d : scene->items2D())
+            {
+                visitedItems += item2d->isVisible() ? 1 : 0;
+            }
+        }
+        for (rm::Graphics3DItem* item3d : scene->items3D())
+        {
+            visitedItems += item3d->isVisible() ? 1 : 0;
+        }
+        typedTimes.push_back(getElapsedTime(timer));
+    }
+
+    QJsonObject submission;
+    submission["items2D"] = static_cast<double>(scene->items2D().size());
+    submission["items3D"] = static_cast<double>(scene->items3D().size());
+    submission["visitedItems"] = static_cast<double>(visitedItems);
+    submission["castLoopTime"] = summarize(castTimes);
+    submission["typedLoopTime"] = summarize(typedTimes);
+
+    //Whole frames, with the culling off so all items are submitted.
+    scene->makeCurrent();
+    {
+        QOpenGLFramebufferObject framebuffer(_parameters.width, _parameters.height,
+                                             QOpenGLFramebufferObject::CombinedDepthStencil);
+        framebuffer.bind();
+
+        view2D->initializeGL();
+        view2D->resizeGL(_parameters.width, _parameters.height);
+        view2D->fit();
+        submission["frames2D"] = measureFrames(view2D);
+
+        QVector3D center(columns / 2.0f, columns / 2.0f, 0);
+        view3D->initializeGL();
+        view3D->resizeGL(_parameters.width, _parameters.height);
+        view3D->lookAt(center + QVector3D(0, 0, 1.2f * columns), center, QVector3D(0, 1, 0));
+        submission["frames3D"] = measureFrames(view3D);
+
+        framebuffer.release();
+    }
+
+    scene->deleteView(view2D);
+    scene->makeCurrent();
+    scene->deleteView(view3D);
+    scene->doneCurrent();
+    delete scene;
+    return submission;
+}
+
+
+
+QJsonObject SceneBenchmark::getParameters() const
+{
+    QJsonObject parameters;
+    parameters["pointSets"] = static_cast<double>(_parameters.pointSets);
+    parameters["polylines"] = static_cast<double>(_parameters.polylines);
+    parameters["rectangles"] = static_cast<double>(_parameters.rectangles);
+    parameters["meshes2D"] = static_cast<double>(_parameters.meshes2D);
+    parameters["meshes3D"] = static_cast<double>(_parameters.meshes3D);
+    parameters["pointsPerItem"] = static_cast<double>(_parameters.pointsPerItem);
+    parameters["trianglesPerMesh"] = static_cast<double>(_parameters.trianglesPerMesh);
+    parameters["width"] = _parameters.width;
+    parameters["height"] = _parameters.height;
+    parameters["warmUpFrames"] = static_cast<double>(_parameters.warmUpFrames);
+    parameters["frames"] = static_cast<double>(_parameters.frames);
+    parameters["picks"] = static_cast<double>(_parameters.picks);
+    parameters["batchRendering"] = _parameters.batchRendering;
+    parameters["meshLevelsOfDetail"] = _parameters.meshLevelsOfDetail;
+    parameters["seed"] = static_cast<double>(_parameters.seed);
+    parameters["offFile"] = QString::fromStdString(_parameters.offFile);
+    parameters["offFaces"] = static_cast<double>(_parameters.offFaces);
+    parameters["tri6Triangles"] = static_cast<double>(_parameters.tri6Triangles);
+    parameters["submissionItems"] = static_cast<double>(_parameters.submissionItems);
+    parameters["replayFile"] = QString::fromStdString(_parameters.replayFile);
+    parameters["replayTool"] = QString::fromStdString(_parameters.replayTool);
+    return parameters;
+}
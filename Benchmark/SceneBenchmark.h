@@ -0,0 +1,254 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <QJsonObject>
+
+namespace rm
+{
+class GraphicsScene;
+class GraphicsView;
+class Graphics2DView;
+class Graphics3DView;
+}
+
+/**
+ * This class builds a synthetic scene and measures the library on it without showing any window. The views are never
+ * shown: the scene context is made current on its offscreen surface, a framebuffer object is bound and the view
+ * paintGL is called directly, so the measured frames run the same code as the interactive views.
+ *
+ * All results are returned as a JSON object, with times in milliseconds (microseconds for the picks) and memory in
+ * bytes, so they can be stored and compared between releases.
+ */
+class SceneBenchmark
+{
+public:
+    /**
+     * @brief The Parameters struct - Scene and measurement parameters.
+     */
+    struct Parameters
+    {
+        /**
+         * @brief pointSets - Number of PointSet2DItem.
+         */
+        unsigned int pointSets {100};
+
+        /**
+         * @brief polylines - Number of Polyline2DItem.
+         */
+        unsigned int polylines {100};
+
+        /**
+         * @brief rectangles - Number of Rectangle2DItem.
+         */
+        unsigned int rectangles {100};
+
+        /**
+         * @brief meshes2D - Number of TriangleMesh2DItem.
+         */
+        unsigned int meshes2D {10};
+
+        /**
+         * @brief meshes3D - Number of TriangleMesh3DItem.
+         */
+        unsigned int meshes3D {10};
+
+        /**
+         * @brief pointsPerItem - Number of points of each point set and polyline.
+         */
+        unsigned int pointsPerItem {100};
+
+        /**
+         * @brief trianglesPerMesh - Approximate number of triangles of each mesh.
+         */
+        unsigned int trianglesPerMesh {20000};
+
+        /**
+         * @brief width - Framebuffer width.
+         */
+        int width {1280};
+
+        /**
+         * @brief height - Framebuffer height.
+         */
+        int height {720};
+
+        /**
+         * @brief warmUpFrames - Frames rendered before the measured ones.
+         */
+        unsigned int warmUpFrames {10};
+
+        /**
+         * @brief frames - Number of measured frames of each view.
+         */
+        unsigned int frames {100};
+
+        /**
+         * @brief picks - Number of measured picks on each view.
+         */
+        unsigned int picks {1000};
+
+        /**
+         * @brief batchRendering - True to enable the batched render on the 2D view.
+         */
+        bool batchRendering {false};
+
+        /**
+         * @brief meshLevelsOfDetail - True to build the simplified levels of the 3D meshes.
+         */
+        bool meshLevelsOfDetail {false};
+
+        /**
+         * @brief seed - Seed of the random scene.
+         */
+        unsigned int seed {1};
+
+        /**
+         * @brief offFile - OFF file read by the reader benchmark. If it is empty, a synthetic file is generated.
+         */
+        std::string offFile;
+
+        /**
+         * @brief offFaces - Approximate number of triangles of the synthetic OFF file. The reader benchmark is skipped
+         * if it is 0 and no file is given.
+         */
+        unsigned int offFaces {10000000};
+
+        /**
+         * @brief tri6Triangles - Number of triangles given to Tri3ToTri6Conversor. The benchmark is skipped if it is 0.
+         */
+        unsigned int tri6Triangles {1000000};
+
+        /**
+         * @brief submissionItems - Number of mixed 2D and 3D items of the submission benchmark. The benchmark is
+         * skipped if it is 0.
+         */
+        unsigned int submissionItems {100000};
+
+        /**
+         * @brief replayFile - Event recording replayed on the views. The benchmark is skipped if it is empty.
+         */
+        std::string replayFile;
+
+        /**
+         * @brief replayTool - Tool that receives the replayed events: view-controller, select or edit-polyline.
+         */
+        std::string replayTool {"view-controller"};
+    };
+
+    /**
+     * @brief SceneBenchmark - Constructor.
+     * @param parameters - Benchmark parameters.
+     */
+    explicit SceneBenchmark(const Parameters& parameters);
+
+    /**
+     * @brief ~SceneBenchmark - Destructor. Deletes the views and the scene.
+     */
+    ~SceneBenchmark();
+
+    /**
+     * @brief run - Runs all benchmarks. It needs a QApplication.
+     * @return - Returns the parameters and the results.
+     */
+    QJsonObject run();
+
+private:
+    /**
+     * @brief measurePrograms - Builds all library programs with the program binary disk cache off and then twice with
+     * it on. The first cached build stores the binaries if the cache was empty, the second one loads them. Each build
+     * uses a new context out of the scene share group, since Qt checks the cache attribute once per group.
+     * @return - Returns the cold and warm build times.
+     */
+    QJsonObject measurePrograms();
+
+    /**
+     * @brief load - Creates the items and adds them to the scene.
+     * @return - Returns the load time of each item type.
+     */
+    QJsonObject load();
+
+    /**
+     * @brief measureFrames - Renders a view on the bound framebuffer. The scene context must be current.
+     * @param view - View to be rendered.
+     * @return - Returns the frame times and the counters of the last profiled frame.
+     */
+    QJsonObject measureFrames(rm::GraphicsView* view);
+
+    /**
+     * @brief measurePicks2D - Picks the 2D items under random points of the view.
+     * @return - Returns the pick latencies.
+     */
+    QJsonObject measurePicks2D();
+
+    /**
+     * @brief measurePicks3D - Picks the 3D items under random points of the view.
+     * @return - Returns the pick latencies.
+     */
+    QJsonObject measurePicks3D();
+
+    /**
+     * @brief measureReaderOFF - Compares the library OFF reader with a plain std::ifstream reader, the one the
+     * library used before the memory mapped reader.
+     * @param filename - Triangle OFF file.
+     * @return - Returns the read times.
+     */
+    QJsonObject measureReaderOFF(const std::string& filename);
+
+    /**
+     * @brief measureMeshCache - Converts an OFF file to a binary mesh cache and compares the time to open it on a
+     * TriangleMesh3DItem, until its buffers are uploaded, with the time to do the same from the OFF file. The scene
+     * context is made current.
+     * @param filename - Triangle OFF file.
+     * @return - Returns the conversion, OFF and cache open times.
+     */
+    QJsonObject measureMeshCache(const std::string& filename);
+
+    /**
+     * @brief measureTri3ToTri6 - Converts a linear triangle mesh to a quadratic one.
+     * @return - Returns the conversion time.
+     */
+    QJsonObject measureTri3ToTri6();
+
+    /**
+     * @brief measureReplay - Replays a recorded session on the views, with the replay tool on top of the tool stack.
+     * The recorded events of the first view go to the 2D view and the ones of the second view to the 3D view, as the
+     * views of the test application.
+     * @return - Returns the latency of the tool on each event type.
+     */
+    QJsonObject measureReplay();
+
+    /**
+     * @brief measureSubmission - Builds a scene of tiny items, half 2D and half 3D, added alternately. Times the item
+     * loops of a frame over the scene list with dynamic_cast, as the views did before the typed item arrays, against
+     * the loops over the typed arrays, and the whole frames of both views with the culling off.
+     * @return - Returns the loop and frame times.
+     */
+    QJsonObject measureSubmission();
+
+    /**
+     * @brief getParameters - Gets the parameters as a JSON object.
+     * @return - Returns the parameters.
+     */
+    QJsonObject getParameters() const;
+
+private:
+    /**
+     * @brief _parameters - Benchmark parameters.
+     */
+    Parameters _parameters;
+
+    /**
+     * @brief _scene - Benchmarked scene.
+     */
+    rm::GraphicsScene* _scene {nullptr};
+
+    /**
+     * @brief _view2D - View of the 2D items. It is never shown.
+     */
+    rm::Graphics2DView* _view2D {nullptr};
+
+    /**
+     * @brief _view3D - View of the 3D items. It is never shown.
+     */
+    rm::Graphics3DView* _view3D {nullptr};
+};
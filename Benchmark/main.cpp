@@ -0,0 +1,114 @@
+#include "SceneBenchmark.h"
+#include <cstdio>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSurfaceFormat>
+
+int main(int argc, char *argv[])
+{
+    //Same context setup as the test application.
+    QSurfaceFormat format;
+    format.setDepthBufferSize(24);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    QApplication a(argc, argv);
+
+    SceneBenchmark::Parameters parameters;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders a synthetic Lib_Teste scene off-screen and writes the load time, frame "
+                                     "time, pick latency, tool latency on a recorded session and memory as JSON.");
+    parser.addHelpOption();
+
+    QCommandLineOption pointSets("point-sets", "Number of point sets.", "n", QString::number(parameters.pointSets));
+    QCommandLineOption polylines("polylines", "Number of polylines.", "n", QString::number(parameters.polylines));
+    QCommandLineOption rectangles("rectangles", "Number of rectangles.", "n", QString::number(parameters.rectangles));
+    QCommandLineOption meshes2D("meshes-2d", "Number of 2D triangle meshes.", "n",
+                                QString::number(parameters.meshes2D));
+    QCommandLineOption meshes3D("meshes-3d", "Number of 3D triangle meshes.", "n",
+                                QString::number(parameters.meshes3D));
+    QCommandLineOption pointsPerItem("points-per-item", "Points of each point set and polyline.", "n",
+                                     QString::number(parameters.pointsPerItem));
+    QCommandLineOption trianglesPerMesh("triangles-per-mesh", "Triangles of each mesh.", "n",
+                                        QString::number(parameters.trianglesPerMesh));
+    QCommandLineOption width("width", "Framebuffer width.", "pixels", QString::number(parameters.width));
+    QCommandLineOption height("height", "Framebuffer height.", "pixels", QString::number(parameters.height));
+    QCommandLineOption warmUpFrames("warm-up-frames", "Frames rendered before measuring.", "n",
+                                    QString::number(parameters.warmUpFrames));
+    QCommandLineOption frames("frames", "Measured frames of each view.", "n", QString::number(parameters.frames));
+    QCommandLineOption picks("picks", "Measured picks of each view.", "n", QString::number(parameters.picks));
+    QCommandLineOption batch("batch", "Enable the batched render of the 2D view.");
+    QCommandLineOption meshLod("mesh-lod", "Build the simplified levels of the 3D meshes.");
+    QCommandLineOption seed("seed", "Seed of the random scene.", "n", QString::number(parameters.seed));
+    QCommandLineOption offFile("off-file", "Triangle OFF file for the reader benchmark. A synthetic file is used by "
+                               "default.", "file");
+    QCommandLineOption offFaces("off-faces", "Triangles of the synthetic OFF file. 0 skips the benchmark.", "n",
+                                QString::number(parameters.offFaces));
+    QCommandLineOption tri6Triangles("tri6-triangles", "Triangles converted to TRI6. 0 skips the benchmark.", "n",
+                                     QString::number(parameters.tri6Triangles));
+    QCommandLineOption submissionItems("submission-items", "Mixed 2D and 3D items of the submission benchmark. 0 "
+                                       "skips the benchmark.", "n", QString::number(parameters.submissionItems));
+    QCommandLineOption replay("replay", "Event recording replayed on the views.", "file");
+    QCommandLineOption replayTool("replay-tool", "Tool of the replay: view-controller, select or edit-polyline.",
+                                  "tool", QString::fromStdString(parameters.replayTool));
+    QCommandLineOption output("output", "Output file. The results are written to the standard output by default.",
+                              "file");
+    parser.addOptions({pointSets, polylines, rectangles, meshes2D, meshes3D, pointsPerItem, trianglesPerMesh, width,
+                       height, warmUpFrames, frames, picks, batch, meshLod, seed, offFile, offFaces, tri6Triangles,
+                       submissionItems, replay, replayTool, output});
+    parser.process(a);
+
+    parameters.pointSets = parser.value(pointSets).toUInt();
+    parameters.polylines = parser.value(polylines).toUInt();
+    parameters.rectangles = parser.value(rectangles).toUInt();
+    parameters.meshes2D = parser.value(meshes2D).toUInt();
+    parameters.meshes3D = parser.value(meshes3D).toUInt();
+    parameters.pointsPerItem = parser.value(pointsPerItem).toUInt();
+    parameters.trianglesPerMesh = parser.value(trianglesPerMesh).toUInt();
+    parameters.width = parser.value(width).toInt();
+    parameters.height = parser.value(height).toInt();
+    parameters.warmUpFrames = parser.value(warmUpFrames).toUInt();
+    parameters.frames = parser.value(frames).toUInt();
+    parameters.picks = parser.value(picks).toUInt();
+    parameters.batchRendering = parser.isSet(batch);
+    parameters.meshLevelsOfDetail = parser.isSet(meshLod);
+    parameters.seed = parser.value(seed).toUInt();
+    parameters.offFile = parser.value(offFile).toStdString();
+    parameters.offFaces = parser.value(offFaces).toUInt();
+    parameters.tri6Triangles = parser.value(tri6Triangles).toUInt();
+    parameters.submissionItems = parser.value(submissionItems).toUInt();
+    parameters.replayFile = parser.value(replay).toStdString();
+    parameters.replayTool = parser.value(replayTool).toStdString();
+
+    if (parameters.width <= 0 || parameters.height <= 0)
+    {
+        fprintf(stderr, "Invalid framebuffer size.\n");
+        return 1;
+    }
+
+    QByteArray json;
+    {
+        SceneBenchmark benchmark(parameters);
+        json = QJsonDocument(benchmark.run()).toJson();
+    }
+
+    if (parser.isSet(output))
+    {
+        QFile file(parser.value(output));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text) || file.write(json) != json.size())
+        {
+            fprintf(stderr, "Could not write %s.\n", qPrintable(parser.value(output)));
+            return 1;
+        }
+    }
+    else
+    {
+        fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    }
+
+    return 0;
+}
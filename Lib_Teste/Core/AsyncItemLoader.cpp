@@ -0,0 +1,336 @@
+#include "AsyncItemLoader.h"
+#include "GraphicsItem.h"
+#include "GraphicsScene.h"
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cstdio>
+
+namespace rm
+{
+AsyncItemLoad::AsyncItemLoad(unsigned int id) : _id(id)
+{
+}
+
+
+
+unsigned int AsyncItemLoad::getId() const
+{
+    return _id;
+}
+
+
+
+void AsyncItemLoad::setProgress(float progress)
+{
+    _progress = std::min(std::max(progress, 0.0f), 1.0f);
+}
+
+
+
+float AsyncItemLoad::getProgress() const
+{
+    return _progress;
+}
+
+
+
+void AsyncItemLoad::cancel()
+{
+    _canceled = true;
+}
+
+
+
+bool AsyncItemLoad::isCanceled() const
+{
+    return _canceled;
+}
+
+
+
+AsyncItemLoader::AsyncItemLoader(GraphicsScene* scene, const QSurfaceFormat& format) :
+    _scene(scene),
+    _format(format)
+{
+    //Offscreen surfaces must be created on the GUI thread, but can be used by contexts of other threads.
+    if (QOpenGLContext::supportsThreadedOpenGL())
+    {
+        _surface = new QOffscreenSurface();
+        _surface->setFormat(_format);
+        _surface->create();
+    }
+
+    _progressTimer.setInterval(getProgressInterval());
+    connect(&_progressTimer, &QTimer::timeout, this, &AsyncItemLoader::reportProgress);
+}
+
+
+
+AsyncItemLoader::~AsyncItemLoader()
+{
+    //Stop the thread. The factory that is running can still finish its item.
+    {
+        QMutexLocker locker(&_mutex);
+        _stopping = true;
+        for (auto& load : _loads)
+        {
+            load.second.load->cancel();
+        }
+    }
+    _condition.wakeAll();
+    wait();
+
+    //Delete the items that were not published.
+    _waitingResults.insert(_waitingResults.end(), _results.begin(), _results.end());
+    _results.clear();
+
+    _scene->makeCurrent();
+    QOpenGLExtraFunctions* f = QOpenGLContext::currentContext()->extraFunctions();
+    for (Result& result : _waitingResults)
+    {
+        if (result.fence != nullptr)
+        {
+            f->glDeleteSync(result.fence);
+        }
+        delete result.item;
+    }
+    _scene->doneCurrent();
+    _waitingResults.clear();
+
+    delete _surface;
+}
+
+
+
+unsigned int AsyncItemLoader::load(const ItemFactory& factory, const ItemLoadCallbacks& callbacks)
+{
+    unsigned int id = _nextId++;
+
+    PendingLoad pending;
+    pending.load = std::make_shared<AsyncItemLoad>(id);
+    pending.callbacks = callbacks;
+    _loads[id] = pending;
+
+    Task task;
+    task.load = pending.load;
+    task.factory = factory;
+    {
+        QMutexLocker locker(&_mutex);
+        _tasks.push_back(task);
+    }
+    _condition.wakeOne();
+
+    if (!isRunning())
+    {
+        start();
+    }
+    _progressTimer.start();
+
+    return id;
+}
+
+
+
+bool AsyncItemLoader::cancel(unsigned int id)
+{
+    auto it = _loads.find(id);
+    if (it == _loads.end())
+    {
+        return false;
+    }
+
+    it->second.load->cancel();
+    return true;
+}
+
+
+
+unsigned int AsyncItemLoader::getNumberOfPendingLoads() const
+{
+    return static_cast<unsigned int>(_loads.size());
+}
+
+
+
+void AsyncItemLoader::run()
+{
+    //Create the loader context on this thread.
+    QOpenGLContext* context = nullptr;
+    if (_surface != nullptr)
+    {
+        context = new QOpenGLContext();
+        context->setFormat(_format);
+        context->setShareContext(QOpenGLContext::globalShareContext());
+        if (!context->create() || !context->makeCurrent(_surface))
+        {
+            printf("Loader context was not created, items will be uploaded on the GUI thread.\n");
+            delete context;
+            context = nullptr;
+        }
+    }
+
+    while (true)
+    {
+        Task task;
+        {
+            QMutexLocker locker(&_mutex);
+            while (_tasks.empty() && !_stopping)
+            {
+                _condition.wait(&_mutex);
+            }
+
+            if (_stopping)
+            {
+                break;
+            }
+
+            task = _tasks.front();
+            _tasks.pop_front();
+        }
+
+        Result result;
+        result.load = task.load;
+        if (!task.load->isCanceled())
+        {
+            result.item = task.factory(*task.load);
+        }
+
+        if (result.item != nullptr && context != nullptr && !task.load->isCanceled())
+        {
+            result.item->initialize();
+            result.isInitialized = true;
+
+            //The commands must reach the GPU before the GUI thread waits for the fence.
+            QOpenGLExtraFunctions* f = context->extraFunctions();
+            result.fence = f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            f->glFlush();
+        }
+
+        if (result.item != nullptr && task.load->isCanceled())
+        {
+            delete result.item;
+            result.item = nullptr;
+        }
+
+        {
+            QMutexLocker locker(&_mutex);
+            _results.push_back(result);
+        }
+        QMetaObject::invokeMethod(this, "processResults", Qt::QueuedConnection);
+    }
+
+    if (context != nullptr)
+    {
+        context->doneCurrent();
+        delete context;
+    }
+}
+
+
+
+void AsyncItemLoader::processResults()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _waitingResults.insert(_waitingResults.end(), _results.begin(), _results.end());
+        _results.clear();
+    }
+
+    //Take the results whose upload has finished.
+    std::vector<Result> ready;
+    _scene->makeCurrent();
+    QOpenGLExtraFunctions* f = QOpenGLContext::currentContext()->extraFunctions();
+    for (auto it = _waitingResults.begin(); it != _waitingResults.end();)
+    {
+        if (it->fence != nullptr)
+        {
+            if (f->glClientWaitSync(it->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            {
+                it++;
+                continue;
+            }
+            f->glDeleteSync(it->fence);
+            it->fence = nullptr;
+        }
+
+        //The load could be canceled while its fence was waited.
+        if (it->item != nullptr && it->load->isCanceled())
+        {
+            delete it->item;
+            it->item = nullptr;
+        }
+
+        ready.push_back(*it);
+        it = _waitingResults.erase(it);
+    }
+    _scene->doneCurrent();
+
+    for (Result& result : ready)
+    {
+        if (result.item != nullptr)
+        {
+            if (result.isInitialized)
+            {
+                _scene->publishItem(result.item);
+            }
+            else
+            {
+                _scene->addItem(result.item);
+            }
+            _scene->update();
+        }
+
+        //Callbacks can start new loads, so the load is removed before they are called.
+        ItemLoadCallbacks callbacks = _loads[result.load->getId()].callbacks;
+        _loads.erase(result.load->getId());
+
+        if (result.item != nullptr && callbacks.progress)
+        {
+            callbacks.progress(result.load->getId(), 1.0f);
+        }
+
+        if (callbacks.finished)
+        {
+            callbacks.finished(result.load->getId(), result.item);
+        }
+    }
+
+    if (!_waitingResults.empty())
+    {
+        //Try again on the next iteration of the event loop.
+        QTimer::singleShot(1, this, &AsyncItemLoader::processResults);
+    }
+    else if (_loads.empty())
+    {
+        _progressTimer.stop();
+    }
+}
+
+
+
+void AsyncItemLoader::reportProgress()
+{
+    if (_loads.empty())
+    {
+        _progressTimer.stop();
+        return;
+    }
+
+    //Copy the loads, since the callbacks can start new loads.
+    std::vector<std::pair<unsigned int, PendingLoad>> loads(_loads.begin(), _loads.end());
+    for (auto& load : loads)
+    {
+        float progress = load.second.load->getProgress();
+        auto it = _loads.find(load.first);
+        if (it != _loads.end() && progress != it->second.reportedProgress)
+        {
+            it->second.reportedProgress = progress;
+            if (load.second.callbacks.progress)
+            {
+                load.second.callbacks.progress(load.first, progress);
+            }
+        }
+    }
+}
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include <QMutex>
+#include <QOpenGLExtraFunctions>
+#include <QSurfaceFormat>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+class QOffscreenSurface;
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+class GraphicsItem;
+class GraphicsScene;
+
+/**
+ * @brief The AsyncItemLoad class - State of a background item load, shared by the GUI thread and the loader thread.
+ */
+class AsyncItemLoad
+{
+public:
+    /**
+     * @brief AsyncItemLoad - Constructor.
+     * @param id - Load identifier.
+     */
+    explicit AsyncItemLoad(unsigned int id);
+
+    /**
+     * @brief getId - Gets the load identifier.
+     * @return - Returns the identifier returned by GraphicsScene::addItemAsync().
+     */
+    unsigned int getId() const;
+
+    /**
+     * @brief setProgress - Sets the load progress. It is called by the item factory on the loader thread.
+     * @param progress - Progress between 0 and 1.
+     */
+    void setProgress(float progress);
+
+    /**
+     * @brief getProgress - Gets the load progress.
+     * @return - Returns a value between 0 and 1.
+     */
+    float getProgress() const;
+
+    /**
+     * @brief cancel - Asks the load to stop. Factories should check isCanceled() between their steps.
+     */
+    void cancel();
+
+    /**
+     * @brief isCanceled - Verifies if the load was canceled.
+     * @return - Returns true if the load was canceled.
+     */
+    bool isCanceled() const;
+
+private:
+    /**
+     * @brief _id - Load identifier.
+     */
+    unsigned int _id;
+
+    /**
+     * @brief _progress - Load progress between 0 and 1.
+     */
+    std::atomic<float> _progress {0.0f};
+
+    /**
+     * @brief _canceled - True if the load was canceled.
+     */
+    std::atomic<bool> _canceled {false};
+};
+
+/**
+ * @brief ItemFactory - Function that builds an item on the loader thread: it reads the files and computes the item
+ * data, like normals and AABB. It returns nullptr if the item could not be built or if the load was canceled.
+ */
+using ItemFactory = std::function<GraphicsItem*(AsyncItemLoad& load)>;
+
+/**
+ * @brief The ItemLoadCallbacks struct - Functions called on the GUI thread during a background item load.
+ */
+struct ItemLoadCallbacks
+{
+    /**
+     * @brief progress - Called when the load progress changes.
+     */
+    std::function<void(unsigned int id, float progress)> progress;
+
+    /**
+     * @brief finished - Called after the item was added to the scene, or with nullptr if it failed or was canceled.
+     */
+    std::function<void(unsigned int id, GraphicsItem* item)> finished;
+};
+
+/**
+ * @brief The AsyncItemLoader class - Thread that builds items and uploads their OpenGL resources out of the GUI
+ * thread. The thread has its own context, shared with QOpenGLContext::globalShareContext() like the scene context, so
+ * the buffers created by item->initialize() are visible to all views. A fence is inserted after the upload, and the
+ * item is only added to the scene after the GUI thread sees the fence signaled. If the platform does not support
+ * OpenGL on other threads, only the item factory runs on the loader thread.
+ */
+class AsyncItemLoader : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief AsyncItemLoader - Constructor. It must be called on the GUI thread.
+     * @param scene - Scene that receives the loaded items.
+     * @param format - Format of the scene context.
+     */
+    AsyncItemLoader(GraphicsScene* scene, const QSurfaceFormat& format);
+
+    /**
+     * @brief ~AsyncItemLoader - Destructor. Cancels all loads, waits for the thread and deletes the items that were
+     * not published.
+     */
+    ~AsyncItemLoader() override;
+
+    /**
+     * @brief load - Queues a new item load.
+     * @param factory - Function that builds the item.
+     * @param callbacks - Functions called on the GUI thread.
+     * @return - Returns the load identifier.
+     */
+    unsigned int load(const ItemFactory& factory, const ItemLoadCallbacks& callbacks);
+
+    /**
+     * @brief cancel - Cancels a load. Its finished callback is called with nullptr.
+     * @param id - Load identifier.
+     * @return - Returns true if the load was pending and false otherwise.
+     */
+    bool cancel(unsigned int id);
+
+    /**
+     * @brief getNumberOfPendingLoads - Gets the number of loads not finished yet.
+     * @return - Returns the number of pending loads.
+     */
+    unsigned int getNumberOfPendingLoads() const;
+
+protected:
+    /**
+     * @brief run - Loader thread loop. Runs the queued factories and uploads the items.
+     */
+    void run() override;
+
+private slots:
+    /**
+     * @brief processResults - Publishes the items whose upload fence was signaled.
+     */
+    void processResults();
+
+    /**
+     * @brief reportProgress - Calls the progress callbacks of the loads whose progress has changed.
+     */
+    void reportProgress();
+
+private:
+    /**
+     * @brief The Task struct - Queued load.
+     */
+    struct Task
+    {
+        /**
+         * @brief load - Load state.
+         */
+        std::shared_ptr<AsyncItemLoad> load;
+
+        /**
+         * @brief factory - Function that builds the item.
+         */
+        ItemFactory factory;
+    };
+
+    /**
+     * @brief The Result struct - Item built by the loader thread.
+     */
+    struct Result
+    {
+        /**
+         * @brief load - Load state.
+         */
+        std::shared_ptr<AsyncItemLoad> load;
+
+        /**
+         * @brief item - Built item or nullptr.
+         */
+        GraphicsItem* item {nullptr};
+
+        /**
+         * @brief fence - Fence inserted after the upload, or nullptr if the item was not initialized.
+         */
+        GLsync fence {nullptr};
+
+        /**
+         * @brief isInitialized - True if item->initialize() was called on the loader thread.
+         */
+        bool isInitialized {false};
+    };
+
+    /**
+     * @brief The PendingLoad struct - Load information kept by the GUI thread.
+     */
+    struct PendingLoad
+    {
+        /**
+         * @brief load - Load state.
+         */
+        std::shared_ptr<AsyncItemLoad> load;
+
+        /**
+         * @brief callbacks - Functions called on the GUI thread.
+         */
+        ItemLoadCallbacks callbacks;
+
+        /**
+         * @brief reportedProgress - Last progress given to the progress callback.
+         */
+        float reportedProgress {0.0f};
+    };
+
+    /**
+     * @brief getProgressInterval - Gets the interval between two progress reports.
+     * @return - Returns the interval in milliseconds.
+     */
+    constexpr static int getProgressInterval() { return 100; }
+
+private:
+    /**
+     * @brief _scene - Scene that receives the loaded items.
+     */
+    GraphicsScene* _scene;
+
+    /**
+     * @brief _format - Format of the loader context.
+     */
+    QSurfaceFormat _format;
+
+    /**
+     * @brief _surface - Surface of the loader context. Created on the GUI thread and used by the loader thread.
+     */
+    QOffscreenSurface* _surface {nullptr};
+
+    /**
+     * @brief _mutex - Protects _tasks, _results and _stopping.
+     */
+    mutable QMutex _mutex;
+
+    /**
+     * @brief _condition - Wakes the loader thread when a task is queued or it must stop.
+     */
+    QWaitCondition _condition;
+
+    /**
+     * @brief _tasks - Loads waiting for the loader thread.
+     */
+    std::deque<Task> _tasks;
+
+    /**
+     * @brief _results - Items built by the loader thread and not seen by the GUI thread yet.
+     */
+    std::vector<Result> _results;
+
+    /**
+     * @brief _stopping - True if the loader thread must finish.
+     */
+    bool _stopping {false};
+
+    /**
+     * @brief _waitingResults - Items whose upload fence was not signaled yet. Used only by the GUI thread.
+     */
+    std::vector<Result> _waitingResults;
+
+    /**
+     * @brief _loads - Loads not finished yet. Used only by the GUI thread.
+     */
+    std::map<unsigned int, PendingLoad> _loads;
+
+    /**
+     * @brief _nextId - Identifier of the next load.
+     */
+    unsigned int _nextId {1};
+
+    /**
+     * @brief _progressTimer - Triggers the progress reports while there are pending loads.
+     */
+    QTimer _progressTimer;
+};
+}
@@ -0,0 +1,49 @@
+#include "ItemBatchRenderer.h"
+
+namespace rm
+{
+void ItemBatchRenderer::initialize()
+{
+    _pointSetBatch.initialize();
+    _polylineBatch.initialize();
+}
+
+
+
+void ItemBatchRenderer::release()
+{
+    _pointSetBatch.release();
+    _polylineBatch.release();
+}
+
+
+
+void ItemBatchRenderer::clear()
+{
+    _pointSetBatch.clear();
+    _polylineBatch.clear();
+}
+
+
+
+void ItemBatchRenderer::render(const OpenGLMatrix& projection)
+{
+    //Points are drawn over the segments.
+    _polylineBatch.render(projection);
+    _pointSetBatch.render(projection);
+}
+
+
+
+PointSetBatchRenderer& ItemBatchRenderer::getPointSetBatch()
+{
+    return _pointSetBatch;
+}
+
+
+
+PolylineBatchRenderer& ItemBatchRenderer::getPolylineBatch()
+{
+    return _polylineBatch;
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "PointSetBatchRenderer.h"
+#include "PolylineBatchRenderer.h"
+
+namespace rm
+{
+/**
+ * This class groups the batch renderers of a 2D view. Items add their primitives to the batches while they are
+ * rendered by Graphics2DItem::renderBatched(), and all batches are drawn at the end of the frame: first the polyline
+ * segments and then the points, as a polyline renders itself.
+ */
+class ItemBatchRenderer
+{
+public:
+    /**
+     * @brief initialize - Initializes all batch renderers. Needs a current context.
+     */
+    void initialize();
+
+    /**
+     * @brief release - Deletes the OpenGL objects of all batch renderers. The context of the view must be current.
+     */
+    void release();
+
+    /**
+     * @brief clear - Removes all primitives. It should be called at the beginning of each frame.
+     */
+    void clear();
+
+    /**
+     * @brief render - Renders all batches.
+     * @param projection - Projection matrix of the view.
+     */
+    void render(const OpenGLMatrix& projection);
+
+    /**
+     * @brief getPointSetBatch - Gets the batch of point sets.
+     * @return - Returns the point set batch renderer.
+     */
+    PointSetBatchRenderer& getPointSetBatch();
+
+    /**
+     * @brief getPolylineBatch - Gets the batch of polyline segments.
+     * @return - Returns the polyline batch renderer.
+     */
+    PolylineBatchRenderer& getPolylineBatch();
+
+private:
+    /**
+     * @brief _pointSetBatch - Renders the points with one draw call per layout.
+     */
+    PointSetBatchRenderer _pointSetBatch;
+
+    /**
+     * @brief _polylineBatch - Renders the polyline segments with one draw call.
+     */
+    PolylineBatchRenderer _polylineBatch;
+};
+}
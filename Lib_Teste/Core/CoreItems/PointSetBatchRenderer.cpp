@@ -0,0 +1,292 @@
+#include "PointSetBatchRenderer.h"
+#include "../../Geometry/OpenGLMatrix.h"
+#include "../RenderProfiler.h"
+#include "../../Items/PointSet2DItem.h"
+#include <QOpenGLShaderProgram>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace rm
+{
+void PointSetBatchRenderer::initialize()
+{
+    if (isInitialized())
+    {
+        return;
+    }
+
+    initializeOpenGLFunctions();
+
+    _programRegistry = ShaderProgramRegistry::current();
+
+    //Create a batch for each layout.
+    createBatch(_batches[static_cast<int>(PointSet2DItem::LayoutType::Circle)],
+                ":/shaders/point-batch-quad-geom", ":/shaders/point-batch-circle-frag");
+    createBatch(_batches[static_cast<int>(PointSet2DItem::LayoutType::Square)],
+                ":/shaders/point-batch-quad-geom", ":/shaders/point-batch-square-frag");
+    createBatch(_batches[static_cast<int>(PointSet2DItem::LayoutType::Triangle)],
+                ":/shaders/point-batch-triangle-geom", ":/shaders/point-batch-triangle-frag");
+
+    //Create the model matrices texture. It is allocated on the first render.
+    glGenTextures(1, &_modelTexture);
+    glBindTexture(GL_TEXTURE_2D, _modelTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+
+void PointSetBatchRenderer::release()
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    for (Batch& batch : _batches)
+    {
+        destroyBatch(batch);
+    }
+
+    glDeleteTextures(1, &_modelTexture);
+    _modelTexture = 0;
+    _modelTextureRows = 0;
+    _uploadedModels.clear();
+}
+
+
+
+bool PointSetBatchRenderer::isInitialized() const
+{
+    return _batches[0].program != nullptr;
+}
+
+
+
+void PointSetBatchRenderer::clear()
+{
+    for (Batch& batch : _batches)
+    {
+        batch.vertices.clear();
+    }
+    _models.clear();
+    _numberOfPoints = 0;
+}
+
+
+
+void PointSetBatchRenderer::addPointSet(const PointSet2DItem& pointSet)
+{
+    const std::vector<Point2Df>& points = pointSet.getPointSet();
+    if (points.empty())
+    {
+        return;
+    }
+
+    //Save the model matrix as two rows of the 2D affine transformation.
+    unsigned int modelIndex = static_cast<unsigned int>(_models.size() / 8);
+    const QMatrix4x4& m = pointSet.getModelMatrix().topMatrix();
+    _models.insert(_models.end(), {m(0, 0), m(0, 1), m(0, 3), 0.0f, m(1, 0), m(1, 1), m(1, 3), 0.0f});
+
+    //Compute real radius value and the brush ratio as PointSet2DItem::render() does.
+    const Point2Df& pixelSize = pointSet.getPixelSize();
+    float rx = 0.5f * pixelSize.x() * pointSet.getPointSize();
+    float ry = 0.5f * pixelSize.y() * pointSet.getPointSize();
+    float bx = 1.0f - (pixelSize.x() * pointSet.getBorderSize()) / rx;
+    float by = 1.0f - (pixelSize.y() * pointSet.getBorderSize()) / ry;
+
+    const QVector4D& brushColor = pointSet.getBrushColor();
+    QVector4D penColor = pointSet.isOnFocus() ? QVector4D(0.5f, 0.5f, 0.5f, 1) : pointSet.getPenColor();
+
+    //All points share the style of the point set.
+    PointVertex vertex;
+    vertex.brushColor[0] = brushColor.x();
+    vertex.brushColor[1] = brushColor.y();
+    vertex.brushColor[2] = brushColor.z();
+    vertex.brushColor[3] = brushColor.w();
+    vertex.penColor[0] = penColor.x();
+    vertex.penColor[1] = penColor.y();
+    vertex.penColor[2] = penColor.z();
+    vertex.penColor[3] = penColor.w();
+    vertex.radius[0] = rx;
+    vertex.radius[1] = ry;
+    vertex.brushRatio[0] = bx;
+    vertex.brushRatio[1] = by;
+    vertex.modelIndex = modelIndex;
+
+    //The vector keeps its capacity after clear() and grows geometrically. Reserving the exact size of each point set
+    //would copy the whole batch once per point set.
+    std::vector<PointVertex>& vertices = _batches[static_cast<int>(pointSet.getLayout())].vertices;
+    for (const Point2Df& p : points)
+    {
+        vertex.position[0] = p.x();
+        vertex.position[1] = p.y();
+        vertices.push_back(vertex);
+    }
+
+    _numberOfPoints += static_cast<unsigned int>(points.size());
+}
+
+
+
+void PointSetBatchRenderer::render(const OpenGLMatrix& projection)
+{
+    if (!isInitialized() || _numberOfPoints == 0)
+    {
+        return;
+    }
+
+    updateModelTexture();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _modelTexture);
+
+    glEnable( GL_BLEND );
+    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+
+    //Draw each layout at once.
+    for (Batch& batch : _batches)
+    {
+        if (batch.vertices.empty())
+        {
+            continue;
+        }
+
+        updateVertexBuffer(batch);
+
+        batch.program->bind();
+        RenderProfiler::countProgramBind();
+        batch.vao.bind();
+
+        glUniformMatrix4fv(batch.vpLocation, 1, false, projection.topMatrix().data());
+        glUniform1i(batch.modelsLocation, 0);
+
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(batch.vertices.size()));
+        RenderProfiler::countDrawCall();
+
+        batch.vao.release();
+        batch.program->release();
+    }
+
+    glDisable( GL_BLEND );
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+
+unsigned int PointSetBatchRenderer::size() const
+{
+    return _numberOfPoints;
+}
+
+
+
+void PointSetBatchRenderer::createBatch(Batch& batch, const char* geometrySourceFile, const char* fragmentSourceFile)
+{
+    //Get the shared shader program.
+    batch.program = _programRegistry->acquire({":/shaders/point-batch-vert", "", "", geometrySourceFile,
+                                               fragmentSourceFile});
+    batch.vpLocation = _programRegistry->uniformLocation(batch.program, "vp");
+    batch.modelsLocation = _programRegistry->uniformLocation(batch.program, "models");
+
+    batch.vao.create();
+    RenderProfiler::countVaoCreation();
+    batch.vao.bind();
+
+    //Add points. The buffer is allocated on the first render.
+    glGenBuffers(1, &batch.vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+
+    GLsizei stride = static_cast<GLsizei>(sizeof(PointVertex));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PointVertex, position)));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PointVertex, brushColor)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PointVertex, penColor)));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PointVertex, radius)));
+    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PointVertex, brushRatio)));
+    glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, stride, reinterpret_cast<void*>(offsetof(PointVertex, modelIndex)));
+    for (GLuint i = 0; i <= 5; i++)
+    {
+        glEnableVertexAttribArray(i);
+    }
+
+    batch.vao.release();
+}
+
+
+
+void PointSetBatchRenderer::destroyBatch(Batch& batch)
+{
+    glDeleteBuffers(1, &batch.vertexBuffer);
+    batch.vao.destroy();
+
+    if (_programRegistry != nullptr)
+    {
+        _programRegistry->release(batch.program);
+    }
+    batch.program = nullptr;
+    batch.vertexBuffer = 0;
+    batch.capacity = 0;
+    batch.uploadedVertices.clear();
+}
+
+
+
+void PointSetBatchRenderer::updateVertexBuffer(Batch& batch)
+{
+    size_t numberOfBytes = batch.vertices.size() * sizeof(PointVertex);
+
+    //Nothing has changed since the last frame.
+    if (batch.vertices.size() == batch.uploadedVertices.size() &&
+        std::memcmp(batch.vertices.data(), batch.uploadedVertices.data(), numberOfBytes) == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+    if (batch.vertices.size() > batch.capacity)
+    {
+        //Grow the buffer by doubling, so it is reallocated just a few times.
+        batch.capacity = std::max(static_cast<unsigned int>(batch.vertices.size()), 2 * batch.capacity);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(batch.capacity * sizeof(PointVertex)), nullptr,
+                     GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(numberOfBytes), batch.vertices.data());
+    RenderProfiler::countUploadedBytes(static_cast<long long>(numberOfBytes));
+
+    batch.uploadedVertices = batch.vertices;
+}
+
+
+
+void PointSetBatchRenderer::updateModelTexture()
+{
+    //Complete the last row, so the texture is updated by whole rows.
+    const unsigned int floatsPerRow = 8 * getMatricesPerRow();
+    unsigned int rows = static_cast<unsigned int>((_models.size() + floatsPerRow - 1) / floatsPerRow);
+    _models.resize(rows * floatsPerRow, 0.0f);
+
+    //Nothing has changed since the last frame.
+    if (_models == _uploadedModels)
+    {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, _modelTexture);
+    GLsizei width = static_cast<GLsizei>(2 * getMatricesPerRow());
+    if (rows > _modelTextureRows)
+    {
+        //Grow the texture by doubling, so it is reallocated just a few times.
+        _modelTextureRows = std::max(rows, 2 * _modelTextureRows);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, static_cast<GLsizei>(_modelTextureRows), 0, GL_RGBA,
+                     GL_FLOAT, nullptr);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, static_cast<GLsizei>(rows), GL_RGBA, GL_FLOAT, _models.data());
+
+    _uploadedModels = _models;
+}
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <vector>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLVertexArrayObject>
+#include <QPointer>
+#include "../../Shading/ShaderProgramRegistry.h"
+
+class QOpenGLShaderProgram;
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+class OpenGLMatrix;
+class PointSet2DItem;
+
+/**
+ * This class renders many point sets of a 2D view with one draw call per layout (circle, square and triangle). All
+ * points of the point sets that share a layout are packed in one vertex buffer with their style attributes (brush and
+ * pen colors, radius, brush ratio) and the index of the point set model matrix. The model matrices are stored on a
+ * float texture, so the points stay on model space and moving an item does not change the vertex buffers.
+ * The point sets are added on each frame, between clear() and render(), and the buffers are only updated when their
+ * contents are different from the last uploaded ones.
+ */
+class PointSetBatchRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    /**
+     * @brief Constructor.
+     */
+    PointSetBatchRenderer() = default;
+
+    /**
+     * @brief ~PointSetBatchRenderer - Destructor. The OpenGL objects must have been deleted by release().
+     */
+    ~PointSetBatchRenderer() = default;
+
+    /**
+     * @brief initialize - Gets the shared programs and creates the buffers. Needs a current context.
+     */
+    void initialize();
+
+    /**
+     * @brief release - Deletes the buffers, the vertex array objects and the texture and releases the programs. The
+     * vertex array objects are not shared, so the context of the view must be current.
+     */
+    void release();
+
+    /**
+     * @brief isInitialized - Verifies if the renderer was initialized.
+     * @return - Returns true if the renderer was initialized and false otherwise.
+     */
+    bool isInitialized() const;
+
+    /**
+     * @brief clear - Removes all point sets. It should be called at the beginning of each frame.
+     */
+    void clear();
+
+    /**
+     * @brief addPointSet - Adds the points of a point set to the batch of its layout. The pixel size of the point set
+     * must be already defined.
+     * @param pointSet - Point set to be rendered.
+     */
+    void addPointSet(const PointSet2DItem& pointSet);
+
+    /**
+     * @brief render - Renders all point sets added since the last clear().
+     * @param projection - Projection matrix of the view.
+     */
+    void render(const OpenGLMatrix& projection);
+
+    /**
+     * @brief size - Gets the number of points to be rendered.
+     * @return - Returns the number of points.
+     */
+    unsigned int size() const;
+
+private:
+    /**
+     * @brief The PointVertex struct - Vertex attributes of a point.
+     */
+    struct PointVertex
+    {
+        float position[2];
+        float brushColor[4];
+        float penColor[4];
+        float radius[2];
+        float brushRatio[2];
+        unsigned int modelIndex;
+    };
+
+    /**
+     * @brief The Batch struct - Points of a layout.
+     */
+    struct Batch
+    {
+        /**
+         * @brief program - Shared program of the layout.
+         */
+        QOpenGLShaderProgram* program {nullptr};
+
+        /**
+         * @brief vpLocation - Location of the view projection uniform variable.
+         */
+        int vpLocation {-1};
+
+        /**
+         * @brief modelsLocation - Location of the model matrices sampler.
+         */
+        int modelsLocation {-1};
+
+        /**
+         * @brief vao - Vertex array object of the view.
+         */
+        QOpenGLVertexArrayObject vao;
+
+        /**
+         * @brief vertexBuffer - Buffer with the points.
+         */
+        GLuint vertexBuffer {0};
+
+        /**
+         * @brief capacity - Number of points that fit on the vertex buffer.
+         */
+        unsigned int capacity {0};
+
+        /**
+         * @brief vertices - Points of the current frame.
+         */
+        std::vector<PointVertex> vertices;
+
+        /**
+         * @brief uploadedVertices - Points that are on the vertex buffer.
+         */
+        std::vector<PointVertex> uploadedVertices;
+    };
+
+    /**
+     * @brief createBatch - Gets the program and creates the buffers of a layout.
+     * @param batch - Layout batch.
+     * @param geometrySourceFile - Geometry shader source file.
+     * @param fragmentSourceFile - Fragment shader source file.
+     */
+    void createBatch(Batch& batch, const char* geometrySourceFile, const char* fragmentSourceFile);
+
+    /**
+     * @brief destroyBatch - Releases the program and deletes the buffers of a layout.
+     * @param batch - Layout batch.
+     */
+    void destroyBatch(Batch& batch);
+
+    /**
+     * @brief updateVertexBuffer - Transfers the points of a layout to its buffer if they have changed. The buffer
+     * capacity grows by doubling, so most updates are just a glBufferSubData.
+     * @param batch - Layout batch.
+     */
+    void updateVertexBuffer(Batch& batch);
+
+    /**
+     * @brief updateModelTexture - Transfers the model matrices to the texture if they have changed.
+     */
+    void updateModelTexture();
+
+    /**
+     * @brief getMatricesPerRow - Number of model matrices on each texture row. It must be the same value used by the
+     * vertex shader.
+     * @return - Returns the number of matrices per row.
+     */
+    constexpr static unsigned int getMatricesPerRow() { return 512; }
+
+private:
+    /**
+     * @brief _batches - Batches indexed by PointSet2DItem::LayoutType.
+     */
+    Batch _batches[3];
+
+    /**
+     * @brief _programRegistry - Registry that owns the programs.
+     */
+    QPointer<ShaderProgramRegistry> _programRegistry;
+
+    /**
+     * @brief _models - Model matrices of the current frame. Each matrix uses 8 floats (two RGBA texels).
+     */
+    std::vector<float> _models;
+
+    /**
+     * @brief _uploadedModels - Model matrices that are on the texture.
+     */
+    std::vector<float> _uploadedModels;
+
+    /**
+     * @brief _modelTexture - Texture with the model matrices.
+     */
+    GLuint _modelTexture {0};
+
+    /**
+     * @brief _modelTextureRows - Number of rows allocated on the texture.
+     */
+    unsigned int _modelTextureRows {0};
+
+    /**
+     * @brief _numberOfPoints - Number of points of the current frame.
+     */
+    unsigned int _numberOfPoints {0};
+};
+}
@@ -0,0 +1,282 @@
+#include "PolylineBatchRenderer.h"
+#include "../../Geometry/OpenGLMatrix.h"
+#include "../RenderProfiler.h"
+#include "../../Items/Polyline2DItem.h"
+#include <QOpenGLShaderProgram>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace rm
+{
+void PolylineBatchRenderer::initialize()
+{
+    if (isInitialized())
+    {
+        return;
+    }
+
+    initializeOpenGLFunctions();
+
+    //Get the shared shader program.
+    _programRegistry = ShaderProgramRegistry::current();
+    _program = _programRegistry->acquire({":/shaders/polyline-batch-vert", "", "",
+                                          ":/shaders/polyline-batch-geom",
+                                          ":/shaders/polyline-batch-frag"});
+    _vpLocation = _programRegistry->uniformLocation(_program, "vp");
+    _stylesLocation = _programRegistry->uniformLocation(_program, "styles");
+
+    _vao.create();
+    RenderProfiler::countVaoCreation();
+    _vao.bind();
+
+    //Add vertices. The buffers are allocated on the first render.
+    glGenBuffers(1, &_vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+
+    GLsizei stride = static_cast<GLsizei>(sizeof(PolylineVertex));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void*>(offsetof(PolylineVertex, position)));
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, stride,
+                           reinterpret_cast<void*>(offsetof(PolylineVertex, polylineIndex)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    //The element buffer binding is saved on vao.
+    glGenBuffers(1, &_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+
+    _vao.release();
+
+    //Create the styles texture.
+    glGenTextures(1, &_styleTexture);
+    glBindTexture(GL_TEXTURE_2D, _styleTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+
+void PolylineBatchRenderer::release()
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &_vertexBuffer);
+    glDeleteBuffers(1, &_indexBuffer);
+    glDeleteTextures(1, &_styleTexture);
+    _vao.destroy();
+
+    if (_programRegistry != nullptr)
+    {
+        _programRegistry->release(_program);
+    }
+    _program = nullptr;
+    _vertexBuffer = 0;
+    _indexBuffer = 0;
+    _styleTexture = 0;
+    _vertexCapacity = 0;
+    _indexCapacity = 0;
+    _styleTextureRows = 0;
+    _uploadedVertices.clear();
+    _uploadedIndices.clear();
+    _uploadedStyles.clear();
+}
+
+
+
+bool PolylineBatchRenderer::isInitialized() const
+{
+    return _program != nullptr;
+}
+
+
+
+void PolylineBatchRenderer::clear()
+{
+    _vertices.clear();
+    _indices.clear();
+    _styles.clear();
+}
+
+
+
+void PolylineBatchRenderer::addPolyline(const Polyline2DItem& polyline)
+{
+    const std::vector<Point2Df>& points = polyline.getPointSetItem().getPointSet();
+    if (points.size() < 2)
+    {
+        return;
+    }
+
+    //Save the style as PolylineItem::render() defines its uniform variables.
+    unsigned int polylineIndex = static_cast<unsigned int>(_styles.size() / (4 * getTexelsPerStyle()));
+    const QMatrix4x4& m = polyline.getModelMatrix().topMatrix();
+    const QVector4D& brushColor = polyline.getBrushColor();
+    QVector4D penColor = polyline.isOnFocus() ? QVector4D(0.5f, 0.5f, 0.5f, 1) : polyline.getPenColor();
+
+    const Point2Df& pixelSize = polyline.getPixelSize();
+    float r = 0.5f * polyline.getWorldLineWidth();
+    float b = 1.0f - (std::max(pixelSize.x(), pixelSize.y()) * polyline.getBorderSize() / r);
+
+    _styles.insert(_styles.end(), {m(0, 0), m(0, 1), m(0, 3), 0.0f,
+                                   m(1, 0), m(1, 1), m(1, 3), 0.0f,
+                                   brushColor.x(), brushColor.y(), brushColor.z(), 1.0f,
+                                   penColor.x(), penColor.y(), penColor.z(), 1.0f,
+                                   r, b, static_cast<float>(polyline.getPenCapStyle()), 0.0f});
+
+    //Append the vertices to the arena. A zoomed out polyline gives just the vertices of its simplified line.
+    unsigned int first = static_cast<unsigned int>(_vertices.size());
+    unsigned int count = 0;
+    const unsigned int* lodIndices = polyline.getLevelOfDetailIndices(count);
+    if (lodIndices != nullptr)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const Point2Df& p = points[lodIndices[i]];
+            _vertices.push_back({{p.x(), p.y()}, polylineIndex});
+        }
+    }
+    else
+    {
+        for (const Point2Df& p : points)
+        {
+            _vertices.push_back({{p.x(), p.y()}, polylineIndex});
+        }
+    }
+
+    //Segments of the line strip.
+    unsigned int last = static_cast<unsigned int>(_vertices.size()) - 1;
+    for (unsigned int i = first; i < last; i++)
+    {
+        _indices.push_back(i);
+        _indices.push_back(i + 1);
+    }
+
+    //Closing segment of the line loop.
+    if (polyline.isClosed())
+    {
+        _indices.push_back(last);
+        _indices.push_back(first);
+    }
+}
+
+
+
+void PolylineBatchRenderer::render(const OpenGLMatrix& projection)
+{
+    if (!isInitialized() || _indices.empty())
+    {
+        return;
+    }
+
+    updateStyleTexture();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _styleTexture);
+
+    _program->bind();
+    RenderProfiler::countProgramBind();
+    _vao.bind();
+
+    updateBuffers();
+
+    glUniformMatrix4fv(_vpLocation, 1, false, projection.topMatrix().data());
+    glUniform1i(_stylesLocation, 0);
+
+    glEnable( GL_BLEND );
+    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+
+    //Draw all segments at once.
+    glDrawElements(GL_LINES, static_cast<GLsizei>(_indices.size()), GL_UNSIGNED_INT, nullptr);
+    RenderProfiler::countDrawCall();
+
+    glDisable( GL_BLEND );
+
+    _vao.release();
+    _program->release();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+
+unsigned int PolylineBatchRenderer::size() const
+{
+    return static_cast<unsigned int>(_indices.size() / 2);
+}
+
+
+
+void PolylineBatchRenderer::updateBuffers()
+{
+    //Upload the arena only if some polyline has changed.
+    size_t numberOfBytes = _vertices.size() * sizeof(PolylineVertex);
+    if (_vertices.size() != _uploadedVertices.size() ||
+        std::memcmp(_vertices.data(), _uploadedVertices.data(), numberOfBytes) != 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+        if (_vertices.size() > _vertexCapacity)
+        {
+            //Grow the buffer by doubling, so it is reallocated just a few times.
+            _vertexCapacity = std::max(static_cast<unsigned int>(_vertices.size()), 2 * _vertexCapacity);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_vertexCapacity * sizeof(PolylineVertex)), nullptr,
+                         GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(numberOfBytes), _vertices.data());
+        RenderProfiler::countUploadedBytes(static_cast<long long>(numberOfBytes));
+
+        _uploadedVertices = _vertices;
+    }
+
+    if (_indices != _uploadedIndices)
+    {
+        //The vao is bound, so the element buffer is already the current one.
+        if (_indices.size() > _indexCapacity)
+        {
+            _indexCapacity = std::max(static_cast<unsigned int>(_indices.size()), 2 * _indexCapacity);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(_indexCapacity * sizeof(unsigned int)),
+                         nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(_indices.size() * sizeof(unsigned int)),
+                        _indices.data());
+        RenderProfiler::countUploadedBytes(static_cast<long long>(_indices.size() * sizeof(unsigned int)));
+
+        _uploadedIndices = _indices;
+    }
+}
+
+
+
+void PolylineBatchRenderer::updateStyleTexture()
+{
+    //Complete the last row, so the texture is updated by whole rows.
+    const unsigned int floatsPerRow = 4 * getTexelsPerStyle() * getStylesPerRow();
+    unsigned int rows = static_cast<unsigned int>((_styles.size() + floatsPerRow - 1) / floatsPerRow);
+    _styles.resize(rows * floatsPerRow, 0.0f);
+
+    //Nothing has changed since the last frame.
+    if (_styles == _uploadedStyles)
+    {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, _styleTexture);
+    GLsizei width = static_cast<GLsizei>(getTexelsPerStyle() * getStylesPerRow());
+    if (rows > _styleTextureRows)
+    {
+        //Grow the texture by doubling, so it is reallocated just a few times.
+        _styleTextureRows = std::max(rows, 2 * _styleTextureRows);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, static_cast<GLsizei>(_styleTextureRows), 0, GL_RGBA,
+                     GL_FLOAT, nullptr);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, static_cast<GLsizei>(rows), GL_RGBA, GL_FLOAT, _styles.data());
+
+    _uploadedStyles = _styles;
+}
+}
@@ -0,0 +1,199 @@
+#pragma once
+#include <vector>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLVertexArrayObject>
+#include <QPointer>
+#include "../../Shading/ShaderProgramRegistry.h"
+
+class QOpenGLShaderProgram;
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+class OpenGLMatrix;
+class Polyline2DItem;
+
+/**
+ * This class renders the segments of many polylines of a 2D view with a single draw call. The vertices of all
+ * polylines are concatenated on one arena buffer, each one with the index of its polyline, and the segments are
+ * drawn as indexed GL_LINES. The style of each polyline (model matrix, colors, radius, brush ratio and cap style) is
+ * stored on a float texture, so the vertices stay on model space.
+ * The polylines are added on each frame, between clear() and render(), and the buffers are only updated when their
+ * contents are different from the last uploaded ones.
+ */
+class PolylineBatchRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    /**
+     * @brief Constructor.
+     */
+    PolylineBatchRenderer() = default;
+
+    /**
+     * @brief ~PolylineBatchRenderer - Destructor. The OpenGL objects must have been deleted by release().
+     */
+    ~PolylineBatchRenderer() = default;
+
+    /**
+     * @brief initialize - Gets the shared program and creates the buffers. Needs a current context.
+     */
+    void initialize();
+
+    /**
+     * @brief release - Deletes the buffers, the vertex array object and the texture and releases the program. The
+     * vertex array object is not shared, so the context of the view must be current.
+     */
+    void release();
+
+    /**
+     * @brief isInitialized - Verifies if the renderer was initialized.
+     * @return - Returns true if the renderer was initialized and false otherwise.
+     */
+    bool isInitialized() const;
+
+    /**
+     * @brief clear - Removes all polylines. It should be called at the beginning of each frame.
+     */
+    void clear();
+
+    /**
+     * @brief addPolyline - Adds the segments of a polyline. The pixel size of the polyline must be already defined.
+     * @param polyline - Polyline to be rendered.
+     */
+    void addPolyline(const Polyline2DItem& polyline);
+
+    /**
+     * @brief render - Renders all polylines added since the last clear().
+     * @param projection - Projection matrix of the view.
+     */
+    void render(const OpenGLMatrix& projection);
+
+    /**
+     * @brief size - Gets the number of segments to be rendered.
+     * @return - Returns the number of segments.
+     */
+    unsigned int size() const;
+
+private:
+    /**
+     * @brief The PolylineVertex struct - Vertex attributes of a polyline point.
+     */
+    struct PolylineVertex
+    {
+        float position[2];
+        unsigned int polylineIndex;
+    };
+
+    /**
+     * @brief updateBuffers - Transfers the vertices and the segment indices to their buffers if they have changed.
+     * The buffers capacity grows by doubling, so most updates are just a glBufferSubData.
+     */
+    void updateBuffers();
+
+    /**
+     * @brief updateStyleTexture - Transfers the polyline styles to the texture if they have changed.
+     */
+    void updateStyleTexture();
+
+    /**
+     * @brief getStylesPerRow - Number of styles on each texture row. It must be the same value used by the vertex
+     * shader.
+     * @return - Returns the number of styles per row.
+     */
+    constexpr static unsigned int getStylesPerRow() { return 200; }
+
+    /**
+     * @brief getTexelsPerStyle - Number of RGBA texels used by each style.
+     * @return - Returns the number of texels per style.
+     */
+    constexpr static unsigned int getTexelsPerStyle() { return 5; }
+
+private:
+    /**
+     * @brief _program - Shared program used to render the segments.
+     */
+    QOpenGLShaderProgram* _program {nullptr};
+
+    /**
+     * @brief _programRegistry - Registry that owns the program.
+     */
+    QPointer<ShaderProgramRegistry> _programRegistry;
+
+    /**
+     * @brief _vpLocation - Location of the view projection uniform variable.
+     */
+    int _vpLocation {-1};
+
+    /**
+     * @brief _stylesLocation - Location of the styles sampler.
+     */
+    int _stylesLocation {-1};
+
+    /**
+     * @brief _vao - Vertex array object of the view.
+     */
+    QOpenGLVertexArrayObject _vao;
+
+    /**
+     * @brief _vertexBuffer - Arena buffer with the vertices of all polylines.
+     */
+    GLuint _vertexBuffer {0};
+
+    /**
+     * @brief _indexBuffer - Buffer with the segment indices.
+     */
+    GLuint _indexBuffer {0};
+
+    /**
+     * @brief _vertexCapacity - Number of vertices that fit on the vertex buffer.
+     */
+    unsigned int _vertexCapacity {0};
+
+    /**
+     * @brief _indexCapacity - Number of indices that fit on the index buffer.
+     */
+    unsigned int _indexCapacity {0};
+
+    /**
+     * @brief _vertices - Vertices of the current frame.
+     */
+    std::vector<PolylineVertex> _vertices;
+
+    /**
+     * @brief _uploadedVertices - Vertices that are on the vertex buffer.
+     */
+    std::vector<PolylineVertex> _uploadedVertices;
+
+    /**
+     * @brief _indices - Segment indices of the current frame.
+     */
+    std::vector<unsigned int> _indices;
+
+    /**
+     * @brief _uploadedIndices - Segment indices that are on the index buffer.
+     */
+    std::vector<unsigned int> _uploadedIndices;
+
+    /**
+     * @brief _styles - Polyline styles of the current frame.
+     */
+    std::vector<float> _styles;
+
+    /**
+     * @brief _uploadedStyles - Polyline styles that are on the texture.
+     */
+    std::vector<float> _uploadedStyles;
+
+    /**
+     * @brief _styleTexture - Texture with the polyline styles.
+     */
+    GLuint _styleTexture {0};
+
+    /**
+     * @brief _styleTextureRows - Number of rows allocated on the texture.
+     */
+    unsigned int _styleTextureRows {0};
+};
+}
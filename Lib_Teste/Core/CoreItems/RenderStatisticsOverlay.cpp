@@ -0,0 +1,82 @@
+#include "RenderStatisticsOverlay.h"
+#include "../RenderProfiler.h"
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QStringList>
+#include <algorithm>
+
+namespace rm
+{
+namespace
+{
+/**
+ * @brief formatTime - Formats a time in milliseconds.
+ * @param time - Time, or a negative value if it is unknown.
+ * @return - Returns the formatted time.
+ */
+QString formatTime(double time)
+{
+    return time < 0 ? QString("n/a") : QString::number(time, 'f', 2) + " ms";
+}
+}
+
+
+
+void RenderStatisticsOverlay::visible(bool visible)
+{
+    _visible = visible;
+}
+
+
+
+bool RenderStatisticsOverlay::isVisible() const
+{
+    return _visible;
+}
+
+
+
+void RenderStatisticsOverlay::render(QPainter& painter, const FrameStatistics& statistics) const
+{
+    if (!_visible)
+    {
+        return;
+    }
+
+    const RenderCounters& counters = statistics.counters;
+    QStringList lines;
+    lines << QString("Frame %1  CPU %2  GPU %3").arg(statistics.frame)
+             .arg(formatTime(statistics.cpuTime), formatTime(statistics.gpuTime));
+    lines << QString("Draws %1  Binds %2  VAOs %3  Upload %4 KiB").arg(counters.drawCalls).arg(counters.programBinds)
+             .arg(counters.vaoCreations).arg(counters.uploadedBytes / 1024.0, 0, 'f', 1);
+    lines << QString("Items %1  Culled %2  Reused %3").arg(counters.submittedItems).arg(counters.culledItems)
+             .arg(counters.reusedItems);
+    for (const RenderSectionStatistics& section : statistics.sections)
+    {
+        lines << QString("%1  CPU %2  GPU %3  Draws %4").arg(QString::fromStdString(section.name))
+                 .arg(formatTime(section.cpuTime), formatTime(section.gpuTime)).arg(section.counters.drawCalls);
+    }
+
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    QFontMetrics metrics(font);
+    int width = 0;
+    for (const QString& line : lines)
+    {
+        width = std::max(width, metrics.horizontalAdvance(line));
+    }
+
+    //Text over a translucent box.
+    const int margin = 6;
+    int lineHeight = metrics.lineSpacing();
+    QRect box(margin, margin, width + 2 * margin, lines.size() * lineHeight + 2 * margin);
+    painter.fillRect(box, QColor(0, 0, 0, 160));
+
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    for (int i = 0; i < lines.size(); i++)
+    {
+        painter.drawText(box.left() + margin, box.top() + margin + i * lineHeight + metrics.ascent(), lines[i]);
+    }
+}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+class QPainter;
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+struct FrameStatistics;
+
+/**
+ * This class draws the render statistics of a view as text on its top left corner: the frame times and counters
+ * followed by one line per section. It is drawn with a QPainter after the items, so it is not part of the profiled
+ * frame.
+ */
+class RenderStatisticsOverlay
+{
+public:
+    /**
+     * @brief visible - Shows or hides the overlay.
+     * @param visible - True to show the overlay.
+     */
+    void visible(bool visible);
+
+    /**
+     * @brief isVisible - Verifies if the overlay is visible.
+     * @return - Returns true if the overlay is visible.
+     */
+    bool isVisible() const;
+
+    /**
+     * @brief render - Draws the statistics.
+     * @param painter - Painter active on the view.
+     * @param statistics - Statistics to be drawn.
+     */
+    void render(QPainter& painter, const FrameStatistics& statistics) const;
+
+private:
+    /**
+     * @brief _visible - Visibility attribute.
+     */
+    bool _visible {false};
+};
+}
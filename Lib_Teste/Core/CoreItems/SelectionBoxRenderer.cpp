@@ -0,0 +1,181 @@
+#include "SelectionBoxRenderer.h"
+#include "../../Geometry/OpenGLMatrix.h"
+#include "../RenderProfiler.h"
+#include <QOpenGLShaderProgram>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace rm
+{
+void SelectionBoxRenderer::initialize()
+{
+    if (isInitialized())
+    {
+        return;
+    }
+
+    initializeOpenGLFunctions();
+
+    //Get the shared shader program.
+    _programRegistry = ShaderProgramRegistry::current();
+    _program = _programRegistry->acquire({":/shaders/selection-box-vert", "", "", "",
+                                          ":/shaders/selection-box-frag"});
+    _mvpLocation = _programRegistry->uniformLocation(_program, "mvp");
+
+    //Unit square corners in line loop order.
+    const float corners[] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+
+    _vao.create();
+    RenderProfiler::countVaoCreation();
+    _vao.bind();
+
+    //Add corners.
+    glGenBuffers(1, &_cornerBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _cornerBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(0);
+
+    //Add instances. The buffer is allocated on the first render.
+    glGenBuffers(1, &_instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+
+    GLsizei stride = static_cast<GLsizei>(sizeof(BoxInstance));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(BoxInstance, origin)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(BoxInstance, axisX)));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(BoxInstance, axisY)));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(BoxInstance, color)));
+    for (GLuint i = 1; i <= 4; i++)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+
+    _vao.release();
+}
+
+
+
+void SelectionBoxRenderer::release()
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &_cornerBuffer);
+    glDeleteBuffers(1, &_instanceBuffer);
+    _vao.destroy();
+
+    if (_programRegistry != nullptr)
+    {
+        _programRegistry->release(_program);
+    }
+    _program = nullptr;
+    _cornerBuffer = 0;
+    _instanceBuffer = 0;
+    _capacity = 0;
+    _uploadedInstances.clear();
+}
+
+
+
+bool SelectionBoxRenderer::isInitialized() const
+{
+    return _program != nullptr;
+}
+
+
+
+void SelectionBoxRenderer::clear()
+{
+    _instances.clear();
+}
+
+
+
+void SelectionBoxRenderer::addBox(const AABB2D& aabb, const QMatrix4x4& model, const QVector4D& color)
+{
+    const Point2Df& minCorner = aabb.getMinCornerPoint();
+    const Point2Df& maxCorner = aabb.getMaxCornerPoint();
+
+    //Transform three corners, so rotated items keep a correct box.
+    QVector3D origin = model.map(QVector3D(minCorner.x(), minCorner.y(), 0.0f));
+    QVector3D axisX = model.map(QVector3D(maxCorner.x(), minCorner.y(), 0.0f)) - origin;
+    QVector3D axisY = model.map(QVector3D(minCorner.x(), maxCorner.y(), 0.0f)) - origin;
+
+    BoxInstance box;
+    box.origin[0] = origin.x();
+    box.origin[1] = origin.y();
+    box.axisX[0] = axisX.x();
+    box.axisX[1] = axisX.y();
+    box.axisY[0] = axisY.x();
+    box.axisY[1] = axisY.y();
+    box.color[0] = color.x();
+    box.color[1] = color.y();
+    box.color[2] = color.z();
+    box.color[3] = color.w();
+
+    _instances.push_back(box);
+}
+
+
+
+void SelectionBoxRenderer::render(const OpenGLMatrix& projection)
+{
+    if (!isInitialized() || _instances.empty())
+    {
+        return;
+    }
+
+    updateInstanceBuffer();
+
+    _program->bind();
+    RenderProfiler::countProgramBind();
+    _vao.bind();
+
+    glUniformMatrix4fv(_mvpLocation, 1, false, projection.topMatrix().data());
+
+    //Draw all boxes at once.
+    glDrawArraysInstanced(GL_LINE_LOOP, 0, 4, static_cast<GLsizei>(_instances.size()));
+    RenderProfiler::countDrawCall();
+
+    _vao.release();
+    _program->release();
+}
+
+
+
+unsigned int SelectionBoxRenderer::size() const
+{
+    return static_cast<unsigned int>(_instances.size());
+}
+
+
+
+void SelectionBoxRenderer::updateInstanceBuffer()
+{
+    size_t numberOfBytes = _instances.size() * sizeof(BoxInstance);
+
+    //Nothing has changed since the last frame.
+    if (_instances.size() == _uploadedInstances.size() &&
+        std::memcmp(_instances.data(), _uploadedInstances.data(), numberOfBytes) == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+    if (_instances.size() > _capacity)
+    {
+        //Grow the buffer by doubling, so it is reallocated just a few times.
+        _capacity = std::max(static_cast<unsigned int>(_instances.size()), 2 * _capacity);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_capacity * sizeof(BoxInstance)), nullptr,
+                     GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(numberOfBytes), _instances.data());
+    RenderProfiler::countUploadedBytes(static_cast<long long>(numberOfBytes));
+
+    _uploadedInstances = _instances;
+}
+}
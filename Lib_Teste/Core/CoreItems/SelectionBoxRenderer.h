@@ -0,0 +1,146 @@
+#pragma once
+#include <vector>
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLVertexArrayObject>
+#include <QPointer>
+#include <QVector4D>
+#include "../../Geometry/AxisAligmentBoundingBox.h"
+#include "../../Shading/ShaderProgramRegistry.h"
+
+class QOpenGLShaderProgram;
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+class OpenGLMatrix;
+
+/**
+ * This class renders the selection boxes of all items of a 2D view with a single instanced draw call. Each box is an
+ * instance of a unit square outline, so the GPU data is just the box corner, its two axes and its color.
+ * The boxes are added on each frame, between clear() and render(), but the instance buffer is only updated when the
+ * boxes are different from the last uploaded ones (an item AABB, model matrix or the pixel size has changed).
+ */
+class SelectionBoxRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    /**
+     * @brief Constructor.
+     */
+    SelectionBoxRenderer() = default;
+
+    /**
+     * @brief ~SelectionBoxRenderer - Destructor. The OpenGL objects must have been deleted by release().
+     */
+    ~SelectionBoxRenderer() = default;
+
+    /**
+     * @brief initialize - Gets the shared program and creates the buffers. Needs a current context.
+     */
+    void initialize();
+
+    /**
+     * @brief release - Deletes the buffers and the vertex array object and releases the program. The vertex array
+     * object is not shared, so the context of the view must be current.
+     */
+    void release();
+
+    /**
+     * @brief isInitialized - Verifies if the renderer was initialized.
+     * @return - Returns true if the renderer was initialized and false otherwise.
+     */
+    bool isInitialized() const;
+
+    /**
+     * @brief clear - Removes all boxes. It should be called at the beginning of each frame.
+     */
+    void clear();
+
+    /**
+     * @brief addBox - Adds a box to be rendered.
+     * @param aabb - Box on item model space.
+     * @param model - Item model matrix.
+     * @param color - Box color.
+     */
+    void addBox(const AABB2D& aabb, const QMatrix4x4& model, const QVector4D& color);
+
+    /**
+     * @brief render - Renders all boxes added since the last clear().
+     * @param projection - Projection matrix of the view.
+     */
+    void render(const OpenGLMatrix& projection);
+
+    /**
+     * @brief size - Gets the number of boxes to be rendered.
+     * @return - Returns the number of boxes.
+     */
+    unsigned int size() const;
+
+private:
+    /**
+     * @brief The BoxInstance struct - Instance attributes of a box. The box is the parallelogram
+     * origin + s * axisX + t * axisY, with s and t on [0, 1].
+     */
+    struct BoxInstance
+    {
+        float origin[2];
+        float axisX[2];
+        float axisY[2];
+        float color[4];
+    };
+
+    /**
+     * @brief updateInstanceBuffer - Transfers the boxes to the instance buffer if they have changed. The buffer
+     * capacity grows by doubling, so most updates are just a glBufferSubData.
+     */
+    void updateInstanceBuffer();
+
+private:
+    /**
+     * @brief _program - Shared program used to render the boxes.
+     */
+    QOpenGLShaderProgram* _program {nullptr};
+
+    /**
+     * @brief _programRegistry - Registry that owns the program.
+     */
+    QPointer<ShaderProgramRegistry> _programRegistry;
+
+    /**
+     * @brief _mvpLocation - Location of the mvp uniform variable.
+     */
+    int _mvpLocation {-1};
+
+    /**
+     * @brief _vao - Vertex array object of the view.
+     */
+    QOpenGLVertexArrayObject _vao;
+
+    /**
+     * @brief _cornerBuffer - Buffer with the four corners of the unit square.
+     */
+    GLuint _cornerBuffer {0};
+
+    /**
+     * @brief _instanceBuffer - Buffer with the box instances.
+     */
+    GLuint _instanceBuffer {0};
+
+    /**
+     * @brief _capacity - Number of instances that fit on the instance buffer.
+     */
+    unsigned int _capacity {0};
+
+    /**
+     * @brief _instances - Boxes of the current frame.
+     */
+    std::vector<BoxInstance> _instances;
+
+    /**
+     * @brief _uploadedInstances - Boxes that are on the instance buffer.
+     */
+    std::vector<BoxInstance> _uploadedInstances;
+};
+}
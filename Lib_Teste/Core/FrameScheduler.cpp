@@ -0,0 +1,152 @@
+#include "FrameScheduler.h"
+#include "GraphicsView.h"
+#include <algorithm>
+
+namespace rm
+{
+FrameScheduler::FrameScheduler(QObject* parent) : QObject(parent)
+{
+    _timer.setSingleShot(true);
+    _timer.setTimerType(Qt::PreciseTimer);
+    _timer.setInterval(getDefaultFrameInterval());
+
+    connect(&_timer, &QTimer::timeout, this, &FrameScheduler::flush);
+}
+
+
+
+void FrameScheduler::addView(GraphicsView* view)
+{
+    //A new view has never been painted.
+    _paintedRevision[view] = static_cast<unsigned long long>(-1);
+}
+
+
+
+void FrameScheduler::removeView(GraphicsView* view)
+{
+    _paintedRevision.erase(view);
+    _dirtyViews.erase(view);
+}
+
+
+
+void FrameScheduler::requestUpdate(GraphicsView* view)
+{
+    _dirtyViews.insert(view);
+    scheduleFrame();
+}
+
+
+
+void FrameScheduler::requestUpdate()
+{
+    _allViewsDirty = true;
+    scheduleFrame();
+}
+
+
+
+void FrameScheduler::sceneChanged()
+{
+    _revision++;
+}
+
+
+
+unsigned long long FrameScheduler::getRevision() const
+{
+    return _revision;
+}
+
+
+
+void FrameScheduler::setFrameInterval(int msec)
+{
+    _timer.setInterval(std::max(0, msec));
+}
+
+
+
+int FrameScheduler::getFrameInterval() const
+{
+    return _timer.interval();
+}
+
+
+
+unsigned long long FrameScheduler::getExecutedFrames() const
+{
+    return _executedFrames;
+}
+
+
+
+unsigned long long FrameScheduler::getSkippedFrames() const
+{
+    return _skippedFrames;
+}
+
+
+
+unsigned long long FrameScheduler::getCoalescedRequests() const
+{
+    return _coalescedRequests;
+}
+
+
+
+void FrameScheduler::resetStatistics()
+{
+    _executedFrames = 0;
+    _skippedFrames = 0;
+    _coalescedRequests = 0;
+}
+
+
+
+void FrameScheduler::scheduleFrame()
+{
+    if (_timer.isActive())
+    {
+        //The request will be served by the frame already scheduled.
+        _coalescedRequests++;
+        return;
+    }
+
+    _timer.start();
+}
+
+
+
+void FrameScheduler::flush()
+{
+    //The coalesced mouse events are handled first, so this frame already shows their result.
+    for (auto& view : _paintedRevision)
+    {
+        view.first->flushPendingMoveEvent();
+    }
+
+    //The updates requested by the tools are served by this frame.
+    _timer.stop();
+
+    for (auto& view : _paintedRevision)
+    {
+        bool isDirty = _allViewsDirty || _dirtyViews.count(view.first) > 0 || view.second != _revision;
+        if (isDirty && view.first->isVisible())
+        {
+            //QWidget::update() is also coalesced by Qt until the next paint event.
+            view.first->update();
+            view.second = _revision;
+            _executedFrames++;
+        }
+        else
+        {
+            _skippedFrames++;
+        }
+    }
+
+    _dirtyViews.clear();
+    _allViewsDirty = false;
+}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <QObject>
+#include <QTimer>
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+class GraphicsView;
+
+/**
+ * @brief The FrameScheduler class - Coalesces the repaint requests of all views of a scene. Requests only mark views
+ * as dirty and the repaints are done once per frame interval, so many input events between two frames produce a
+ * single repaint. Each view remembers the scene revision of its last repaint, and views that were not requested and
+ * whose scene content did not change since then are skipped.
+ */
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief FrameScheduler - Constructor.
+     * @param parent - Parent object.
+     */
+    explicit FrameScheduler(QObject* parent = nullptr);
+
+    /**
+     * @brief addView - Adds a view to be managed by the scheduler.
+     * @param view - New view.
+     */
+    void addView(GraphicsView* view);
+
+    /**
+     * @brief removeView - Removes a view from the scheduler. It must be called before the view is deleted.
+     * @param view - View to be removed.
+     */
+    void removeView(GraphicsView* view);
+
+    /**
+     * @brief requestUpdate - Marks a view as dirty and schedules a frame. The other views are repainted on the same
+     * frame only if the scene content has changed.
+     * @param view - View that must be repainted.
+     */
+    void requestUpdate(GraphicsView* view);
+
+    /**
+     * @brief requestUpdate - Marks all views as dirty and schedules a frame.
+     */
+    void requestUpdate();
+
+    /**
+     * @brief sceneChanged - Increments the scene revision. It does not schedule a frame.
+     */
+    void sceneChanged();
+
+    /**
+     * @brief getRevision - Gets the current scene revision.
+     * @return - Returns the scene revision.
+     */
+    unsigned long long getRevision() const;
+
+    /**
+     * @brief setFrameInterval - Sets the minimum interval between two frames.
+     * @param msec - Interval in milliseconds.
+     */
+    void setFrameInterval(int msec);
+
+    /**
+     * @brief getFrameInterval - Gets the minimum interval between two frames.
+     * @return - Returns the interval in milliseconds.
+     */
+    int getFrameInterval() const;
+
+    /**
+     * @brief getExecutedFrames - Gets the number of view repaints requested by the scheduler.
+     * @return - Returns the number of executed frames.
+     */
+    unsigned long long getExecutedFrames() const;
+
+    /**
+     * @brief getSkippedFrames - Gets the number of view repaints avoided because the view was not dirty.
+     * @return - Returns the number of skipped frames.
+     */
+    unsigned long long getSkippedFrames() const;
+
+    /**
+     * @brief getCoalescedRequests - Gets the number of requests merged into an already scheduled frame.
+     * @return - Returns the number of coalesced requests.
+     */
+    unsigned long long getCoalescedRequests() const;
+
+    /**
+     * @brief resetStatistics - Sets the frame counters to zero.
+     */
+    void resetStatistics();
+
+private slots:
+    /**
+     * @brief flush - Dispatches the move events coalesced by the views and repaints the dirty views.
+     */
+    void flush();
+
+private:
+    /**
+     * @brief scheduleFrame - Starts the frame timer if it is not active.
+     */
+    void scheduleFrame();
+
+    /**
+     * @brief getDefaultFrameInterval - Gets the default interval between frames, about 60 frames per second.
+     * @return - Returns the default interval in milliseconds.
+     */
+    constexpr static int getDefaultFrameInterval() { return 16; }
+
+private:
+    /**
+     * @brief _timer - Single shot timer that triggers the next frame.
+     */
+    QTimer _timer;
+
+    /**
+     * @brief _paintedRevision - Scene revision of the last repaint of each view.
+     */
+    std::map<GraphicsView*, unsigned long long> _paintedRevision;
+
+    /**
+     * @brief _dirtyViews - Views requested since the last frame.
+     */
+    std::set<GraphicsView*> _dirtyViews;
+
+    /**
+     * @brief _allViewsDirty - True if all views were requested since the last frame.
+     */
+    bool _allViewsDirty {false};
+
+    /**
+     * @brief _revision - Scene revision. It is incremented on each scene change.
+     */
+    unsigned long long _revision {0};
+
+    /**
+     * @brief _executedFrames - Number of view repaints requested by the scheduler.
+     */
+    unsigned long long _executedFrames {0};
+
+    /**
+     * @brief _skippedFrames - Number of view repaints avoided.
+     */
+    unsigned long long _skippedFrames {0};
+
+    /**
+     * @brief _coalescedRequests - Number of requests merged into a scheduled frame.
+     */
+    unsigned long long _coalescedRequests {0};
+};
+}
@@ -0,0 +1,276 @@
+#include "FrameUniforms.h"
+#include "RenderProfiler.h"
+#include <cstring>
+#include <QOpenGLContext>
+
+//Buffer storage tokens of OpenGL 4.4, missing on older headers.
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace rm
+{
+static_assert(sizeof(ViewUniforms) == 192, "ViewUniforms must match the std140 layout of ViewBlock.");
+static_assert(sizeof(ItemUniforms) == 176, "ItemUniforms must match the std140 layout of ItemBlock.");
+
+constexpr GLuint FrameUniforms::VIEW_BLOCK_BINDING;
+constexpr GLuint FrameUniforms::ITEM_BLOCK_BINDING;
+thread_local FrameUniforms* FrameUniforms::_current = nullptr;
+
+
+
+void ViewUniforms::setProjection(const QMatrix4x4& m)
+{
+    std::memcpy(proj, m.constData(), sizeof(proj));
+}
+
+
+
+void ViewUniforms::setView(const QMatrix4x4& m)
+{
+    std::memcpy(view, m.constData(), sizeof(view));
+}
+
+
+
+void ItemUniforms::setModel(const QMatrix4x4& m)
+{
+    std::memcpy(model, m.constData(), sizeof(model));
+}
+
+
+
+void ItemUniforms::setNormalMatrix(const QMatrix3x3& m)
+{
+    //Each column is padded to a vec4.
+    const float* data = m.constData();
+    for (int column = 0; column < 3; column++)
+    {
+        std::memcpy(normalMatrix + 4 * column, data + 3 * column, 3 * sizeof(float));
+        normalMatrix[4 * column + 3] = 0.0f;
+    }
+}
+
+
+
+void ItemUniforms::setBrushColor(const QVector4D& color)
+{
+    brushColor[0] = color.x();
+    brushColor[1] = color.y();
+    brushColor[2] = color.z();
+    brushColor[3] = color.w();
+}
+
+
+
+void ItemUniforms::setPenColor(const QVector4D& color)
+{
+    penColor[0] = color.x();
+    penColor[1] = color.y();
+    penColor[2] = color.z();
+    penColor[3] = color.w();
+}
+
+
+
+void FrameUniforms::beginFrame(const ViewUniforms& view)
+{
+    if (_viewBuffer == 0)
+    {
+        initialize();
+    }
+
+    //The whole block changes on each frame, so its storage is replaced.
+    glBindBuffer(GL_UNIFORM_BUFFER, _viewBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewUniforms), &view, GL_STREAM_DRAW);
+    RenderProfiler::countUploadedBytes(sizeof(ViewUniforms));
+
+    //The binding points are context state, and views may share a context, so they are set on each frame.
+    glBindBufferBase(GL_UNIFORM_BUFFER, VIEW_BLOCK_BINDING, _viewBuffer);
+    _current = this;
+}
+
+
+
+void FrameUniforms::endFrame()
+{
+    if (_current == this)
+    {
+        _current = nullptr;
+    }
+}
+
+
+
+void FrameUniforms::release()
+{
+    endFrame();
+    if (_viewBuffer != 0)
+    {
+        for (GLsync& fence : _segmentFences)
+        {
+            if (fence != nullptr)
+            {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+
+        //Deleting the buffer also unmaps it.
+        glDeleteBuffers(1, &_viewBuffer);
+        glDeleteBuffers(1, &_itemBuffer);
+        _viewBuffer = 0;
+        _itemBuffer = 0;
+        _nextSlot = 0;
+        _ringMapping = nullptr;
+        _segment = 0;
+    }
+}
+
+
+
+void FrameUniforms::writeItem(const ItemUniforms& item)
+{
+    if (_current != nullptr)
+    {
+        _current->write(item);
+    }
+}
+
+
+
+void FrameUniforms::bindBlocks(GLuint programId)
+{
+    QOpenGLExtraFunctions* f = QOpenGLContext::currentContext()->extraFunctions();
+
+    GLuint index = f->glGetUniformBlockIndex(programId, "ViewBlock");
+    if (index != GL_INVALID_INDEX)
+    {
+        f->glUniformBlockBinding(programId, index, VIEW_BLOCK_BINDING);
+    }
+
+    index = f->glGetUniformBlockIndex(programId, "ItemBlock");
+    if (index != GL_INVALID_INDEX)
+    {
+        f->glUniformBlockBinding(programId, index, ITEM_BLOCK_BINDING);
+    }
+}
+
+
+
+void FrameUniforms::initialize()
+{
+    initializeOpenGLFunctions();
+
+    //Slots passed to glBindBufferRange must start on multiples of the alignment.
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    _slotSize = (static_cast<GLintptr>(sizeof(ItemUniforms)) + alignment - 1) / alignment * alignment;
+    _segmentSize = getRingSize() / getNumberOfSegments() / _slotSize * _slotSize;
+    _nextSlot = 0;
+    _segment = 0;
+
+    glGenBuffers(1, &_viewBuffer);
+    glGenBuffers(1, &_itemBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, _itemBuffer);
+    if (!mapRing())
+    {
+        glBufferData(GL_UNIFORM_BUFFER, getRingSize(), nullptr, GL_STREAM_DRAW);
+    }
+}
+
+
+
+bool FrameUniforms::mapRing()
+{
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    bool hasBufferStorage = !context->isOpenGLES() &&
+                            (context->format().version() >= qMakePair(4, 4) ||
+                             context->hasExtension("GL_ARB_buffer_storage"));
+    if (!hasBufferStorage)
+    {
+        return false;
+    }
+
+    using BufferStorage = void (QOPENGLF_APIENTRYP)(GLenum, GLsizeiptr, const void*, GLbitfield);
+    BufferStorage bufferStorage = reinterpret_cast<BufferStorage>(context->getProcAddress("glBufferStorage"));
+    if (bufferStorage == nullptr)
+    {
+        return false;
+    }
+
+    //Coherent writes are seen by the draws issued after them, without explicit flushes.
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    bufferStorage(GL_UNIFORM_BUFFER, getRingSize(), nullptr, flags);
+    _ringMapping = static_cast<char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, getRingSize(), flags));
+    return _ringMapping != nullptr;
+}
+
+
+
+void FrameUniforms::enterSegment(int segment)
+{
+    if (_segmentFences[_segment] != nullptr)
+    {
+        glDeleteSync(_segmentFences[_segment]);
+    }
+    _segmentFences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    //The ring holds a few frames, so the wait is usually already satisfied.
+    GLsync& fence = _segmentFences[segment];
+    if (fence != nullptr)
+    {
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        while (status == GL_TIMEOUT_EXPIRED)
+        {
+            status = glClientWaitSync(fence, 0, 1000000);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    _segment = segment;
+}
+
+
+
+void FrameUniforms::write(const ItemUniforms& item)
+{
+    if (_ringMapping != nullptr)
+    {
+        //Just a copy on the mapped ring. The draws that still read the next segment are waited for.
+        if (_nextSlot + _slotSize > getNumberOfSegments() * _segmentSize)
+        {
+            _nextSlot = 0;
+        }
+
+        int segment = static_cast<int>(_nextSlot / _segmentSize);
+        if (segment != _segment)
+        {
+            enterSegment(segment);
+        }
+
+        std::memcpy(_ringMapping + _nextSlot, &item, sizeof(ItemUniforms));
+    }
+    else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, _itemBuffer);
+
+        //A new storage is taken when the ring is full. The driver keeps the old one while draws still read it.
+        if (_nextSlot + _slotSize > getRingSize())
+        {
+            glBufferData(GL_UNIFORM_BUFFER, getRingSize(), nullptr, GL_STREAM_DRAW);
+            _nextSlot = 0;
+        }
+
+        //Each slot is written once per storage, so the driver does not need to wait for the GPU.
+        glBufferSubData(GL_UNIFORM_BUFFER, _nextSlot, sizeof(ItemUniforms), &item);
+    }
+    RenderProfiler::countUploadedBytes(sizeof(ItemUniforms));
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, ITEM_BLOCK_BINDING, _itemBuffer, _nextSlot, sizeof(ItemUniforms));
+    _nextSlot += _slotSize;
+}
+}
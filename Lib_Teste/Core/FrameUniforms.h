@@ -0,0 +1,302 @@
+#pragma once
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QVector4D>
+
+namespace rm
+{
+/**
+ * @brief The ViewUniforms struct - Data of the ViewBlock uniform block, with the std140 layout. It has what all items
+ * of a view share on a frame.
+ *
+ * GLSL declaration:
+ *     layout(std140) uniform ViewBlock
+ *     {
+ *         mat4 proj;
+ *         mat4 view;
+ *         vec4 pixelSize;
+ *         vec4 lightAmbient;
+ *         vec4 lightDiffuse;
+ *         vec4 lightPosition;
+ *     };
+ */
+struct ViewUniforms
+{
+    /**
+     * @brief proj - Projection matrix, in column major order.
+     */
+    float proj[16] {};
+
+    /**
+     * @brief view - View matrix, in column major order. It is the identity on 2D views.
+     */
+    float view[16] {};
+
+    /**
+     * @brief pixelSize - Size of a pixel in world coordinates on x and y. Zero on 3D views.
+     */
+    float pixelSize[4] {};
+
+    /**
+     * @brief lightAmbient - Ambient component of the first light of the shading model.
+     */
+    float lightAmbient[4] {};
+
+    /**
+     * @brief lightDiffuse - Diffuse component of the first light of the shading model.
+     */
+    float lightDiffuse[4] {};
+
+    /**
+     * @brief lightPosition - Position of the first light of the shading model. w is 0 for directional lights.
+     */
+    float lightPosition[4] {};
+
+    /**
+     * @brief setProjection - Copies the projection matrix.
+     * @param m - Projection matrix.
+     */
+    void setProjection(const QMatrix4x4& m);
+
+    /**
+     * @brief setView - Copies the view matrix.
+     * @param m - View matrix.
+     */
+    void setView(const QMatrix4x4& m);
+};
+
+/**
+ * @brief The ItemUniforms struct - Data of the ItemBlock uniform block, with the std140 layout. All item shaders
+ * declare the same block and read just the members they need.
+ *
+ * GLSL declaration:
+ *     layout(std140) uniform ItemBlock
+ *     {
+ *         mat4 model;
+ *         mat3 normalMatrix;
+ *         vec4 brushColor;
+ *         vec4 penColor;
+ *         vec4 radius;
+ *         ivec4 style;
+ *     };
+ */
+struct ItemUniforms
+{
+    /**
+     * @brief model - Model matrix, in column major order.
+     */
+    float model[16] {};
+
+    /**
+     * @brief normalMatrix - Normal matrix of the model view transformation. std140 stores each column of a mat3 as a
+     * vec4.
+     */
+    float normalMatrix[12] {};
+
+    /**
+     * @brief brushColor - Fill color.
+     */
+    float brushColor[4] {};
+
+    /**
+     * @brief penColor - Contour color.
+     */
+    float penColor[4] {};
+
+    /**
+     * @brief radius - Item specific sizes. Markers and rectangles use xy for the radius and zw for the brush ratio,
+     * lines use x for the half width and y for the brush ratio.
+     */
+    float radius[4] {};
+
+    /**
+     * @brief style - Item specific enumerations, as the polyline cap style on x.
+     */
+    int style[4] {};
+
+    /**
+     * @brief setModel - Copies the model matrix.
+     * @param m - Model matrix.
+     */
+    void setModel(const QMatrix4x4& m);
+
+    /**
+     * @brief setNormalMatrix - Copies the normal matrix.
+     * @param m - Normal matrix.
+     */
+    void setNormalMatrix(const QMatrix3x3& m);
+
+    /**
+     * @brief setBrushColor - Copies the fill color.
+     * @param color - Fill color.
+     */
+    void setBrushColor(const QVector4D& color);
+
+    /**
+     * @brief setPenColor - Copies the contour color.
+     * @param color - Contour color.
+     */
+    void setPenColor(const QVector4D& color);
+};
+
+/**
+ * @brief The FrameUniforms class - Uniform buffers of a view. The ViewBlock buffer is filled once per frame, at
+ * beginFrame(). The ItemBlock buffer is a ring: each item render writes its block on the next free slot and binds that
+ * slot. This replaces the glUniform calls of each item by one copy and one bind.
+ *
+ * When the context has buffer storage (OpenGL 4.4 or GL_ARB_buffer_storage) the ring is mapped once, persistently, and
+ * an item block is just a memcpy. The ring is split in segments and a fence is placed when the writes leave a
+ * segment, so a segment is only overwritten after the draws that read it have finished. Otherwise each block is
+ * written with glBufferSubData and the storage is orphaned when the ring is full.
+ *
+ * The programs get the block bindings when they are linked by the ShaderProgramRegistry. Items write their blocks
+ * through the static writeItem(), which uses the frame being rendered on the calling thread, in the same way as the
+ * RenderProfiler counters.
+ */
+class FrameUniforms : protected QOpenGLExtraFunctions
+{
+public:
+    /**
+     * @brief VIEW_BLOCK_BINDING - Binding point of the ViewBlock uniform block.
+     */
+    static constexpr GLuint VIEW_BLOCK_BINDING = 0;
+
+    /**
+     * @brief ITEM_BLOCK_BINDING - Binding point of the ItemBlock uniform block.
+     */
+    static constexpr GLuint ITEM_BLOCK_BINDING = 1;
+
+public:
+    /**
+     * @brief Constructor. The buffers are created on the first frame.
+     */
+    FrameUniforms() = default;
+
+    /**
+     * @brief FrameUniforms - Copy is not allowed, since the object owns OpenGL buffers.
+     */
+    FrameUniforms(const FrameUniforms&) = delete;
+
+    /**
+     * @brief operator = - Copy is not allowed, since the object owns OpenGL buffers.
+     */
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    /**
+     * @brief beginFrame - Uploads the view block, binds both buffers and makes this object the target of
+     * writeItem() on the calling thread. Needs a current context.
+     * @param view - View block of the frame.
+     */
+    void beginFrame(const ViewUniforms& view);
+
+    /**
+     * @brief endFrame - Stops receiving the item blocks.
+     */
+    void endFrame();
+
+    /**
+     * @brief release - Deletes the buffers. Needs a current context of the share group where they were created.
+     */
+    void release();
+
+    /**
+     * @brief writeItem - Writes an item block on the ring of the frame being rendered and binds it to
+     * ITEM_BLOCK_BINDING. It does nothing out of a frame.
+     * @param item - Item block.
+     */
+    static void writeItem(const ItemUniforms& item);
+
+    /**
+     * @brief bindBlocks - Assigns the binding points of the ViewBlock and ItemBlock uniform blocks of a linked
+     * program. Blocks that the program does not declare are ignored. Needs a current context.
+     * @param programId - Program object name.
+     */
+    static void bindBlocks(GLuint programId);
+
+private:
+    /**
+     * @brief initialize - Creates the buffers and computes the ring slot size.
+     */
+    void initialize();
+
+    /**
+     * @brief write - Writes an item block on the next slot of the ring and binds it.
+     * @param item - Item block.
+     */
+    void write(const ItemUniforms& item);
+
+    /**
+     * @brief mapRing - Creates an immutable storage for the ring and maps it persistently, if the context supports
+     * buffer storage. The ring buffer must be bound to GL_UNIFORM_BUFFER.
+     * @return - Returns true if the ring was mapped and false otherwise.
+     */
+    bool mapRing();
+
+    /**
+     * @brief enterSegment - Places a fence after the draws that read the segment being left and waits for the draws
+     * that read the segment being entered, from its last use.
+     * @param segment - Segment being entered.
+     */
+    void enterSegment(int segment);
+
+    /**
+     * @brief getRingSize - Gets the size of the ring storage. With 256 bytes slots it holds 4096 item blocks.
+     * @return - Returns the size in bytes.
+     */
+    constexpr static GLsizeiptr getRingSize() { return 1 << 20; }
+
+    /**
+     * @brief getNumberOfSegments - Gets the number of fenced segments of a persistently mapped ring.
+     * @return - Returns the number of segments.
+     */
+    constexpr static int getNumberOfSegments() { return 4; }
+
+private:
+    /**
+     * @brief _viewBuffer - Buffer of the view block.
+     */
+    GLuint _viewBuffer {0};
+
+    /**
+     * @brief _itemBuffer - Ring buffer of the item blocks.
+     */
+    GLuint _itemBuffer {0};
+
+    /**
+     * @brief _slotSize - Size of an item block rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+     */
+    GLintptr _slotSize {0};
+
+    /**
+     * @brief _nextSlot - Offset of the next free slot of the ring.
+     */
+    GLintptr _nextSlot {0};
+
+    /**
+     * @brief _ringMapping - Persistent mapping of the ring, or nullptr if the blocks are written with glBufferSubData.
+     */
+    char* _ringMapping {nullptr};
+
+    /**
+     * @brief _segmentSize - Size of a segment of the mapped ring. It is a multiple of the slot size.
+     */
+    GLintptr _segmentSize {0};
+
+    /**
+     * @brief _segment - Segment of the mapped ring being written.
+     */
+    int _segment {0};
+
+    /**
+     * @brief _segmentFences - Fences placed after the last draws that read each segment.
+     */
+    GLsync _segmentFences[4] {};
+
+    /**
+     * @brief _current - Object that receives the item blocks of the calling thread, or nullptr if no frame is being
+     * rendered.
+     */
+    static thread_local FrameUniforms* _current;
+};
+}
@@ -1,5 +1,7 @@
 #include "Graphics2DItem.h"
 #include "CoreItems/AABB2DItem.h"
+#include "CoreItems/SelectionBoxRenderer.h"
+#include "GraphicsScene.h"
 #include "../Items/Polyline2DItem.h"
 #include <iostream>
 namespace rm
@@ -13,6 +15,12 @@ Graphics2DItem::Graphics2DItem() : GraphicsItem()
 
 Graphics2DItem::~Graphics2DItem()
 {
+    //Do not let the scene index keep a dangling pointer.
+    if (_scene != nullptr)
+    {
+        _scene->itemDestroyed(this);
+    }
+
     delete _aabbItem;
 }
 
@@ -20,6 +28,12 @@ Graphics2DItem::~Graphics2DItem()
 
 void Graphics2DItem::setPixelSize(const Point2Df& p)
 {
+    //The views define the pixel size on each frame, but it changes just on zoom.
+    if (_pixelSize == p)
+    {
+        return;
+    }
+
     _pixelSize = p;
 
     //Set the aabb item to be updated.
@@ -28,6 +42,13 @@ void Graphics2DItem::setPixelSize(const Point2Df& p)
 
 
 
+void Graphics2DItem::renderBatched(int viewId, ItemBatchRenderer&)
+{
+    render(viewId);
+}
+
+
+
 const Point2Df& Graphics2DItem::getPixelSize() const
 {
     return _pixelSize;
@@ -49,6 +70,8 @@ void Graphics2DItem::setAABB(const AABB2D &aabb)
 
     //Set the aabb item to be updated.
     _isAABBItemOutdated = true;
+
+    geometryChanged();
 }
 
 
@@ -88,10 +111,14 @@ AABB2DItem *Graphics2DItem::getAABB2DItem()
         _aabbItem->visible(false);
     }
 
-    if (_isAABBItemOutdated)
+    //The render AABB also depends on the items of a group, so it is compared with the last box transferred.
+    AABB2D aabb = getAABBRender(_pixelSize);
+    if (_isAABBItemOutdated || !(aabb.getMinCornerPoint() == _aabbItemBox.getMinCornerPoint()) ||
+        !(aabb.getMaxCornerPoint() == _aabbItemBox.getMaxCornerPoint()))
     {
         //Update the aabb item with the AABB points.
-        _aabbItem->update(getAABBRender(_pixelSize));
+        _aabbItem->update(aabb);
+        _aabbItemBox = aabb;
 
         _isAABBItemOutdated = false;
     }
@@ -101,6 +128,51 @@ AABB2DItem *Graphics2DItem::getAABB2DItem()
 
 
 
+bool Graphics2DItem::isAABB2DItemVisible() const
+{
+    return _aabbItem != nullptr && _aabbItem->isVisible();
+}
+
+
+
+void Graphics2DItem::showSelectionBox(bool show)
+{
+    _isSelectionBoxVisible = show;
+}
+
+
+
+bool Graphics2DItem::isSelectionBoxVisible() const
+{
+    return _isSelectionBoxVisible;
+}
+
+
+
+void Graphics2DItem::setSelectionBoxColor(const QVector4D& color)
+{
+    _selectionBoxColor = color;
+}
+
+
+
+const QVector4D& Graphics2DItem::getSelectionBoxColor() const
+{
+    return _selectionBoxColor;
+}
+
+
+
+void Graphics2DItem::appendSelectionBoxes(SelectionBoxRenderer& renderer) const
+{
+    if (_isSelectionBoxVisible)
+    {
+        renderer.addBox(getAABBRender(_pixelSize), getModelMatrix().topMatrix(), _selectionBoxColor);
+    }
+}
+
+
+
 bool Graphics2DItem::isInsideToItemAABB(const Point2Df& p, const Point2Df& pixelSize) const
 {
     Point2Df modelPoint = worldSpace2ModelSpace(p);
@@ -113,4 +185,68 @@ Point2Df Graphics2DItem::updatePixelSize(const Point2Df& pixelSize) const
 {
     return Point2Df(pixelSize.x() / getModelMatrix().sX(), pixelSize.y() / getModelMatrix().sY());
 }
+
+
+
+void Graphics2DItem::setLineWidth(float width)
+{
+    GraphicsItem::setLineWidth(width);
+    geometryChanged();
+}
+
+
+
+void Graphics2DItem::setParentItem(Graphics2DItem* parent)
+{
+    _parentItem = parent;
+}
+
+
+
+void Graphics2DItem::modelMatrixChanged()
+{
+    geometryChanged();
+}
+
+
+
+void Graphics2DItem::appearanceChanged()
+{
+    if (_scene != nullptr)
+    {
+        _scene->itemAppearanceChanged(this);
+    }
+    else if (_parentItem != nullptr)
+    {
+        _parentItem->appearanceChanged();
+    }
+}
+
+
+
+void Graphics2DItem::geometryChanged()
+{
+    if (_scene != nullptr)
+    {
+        _scene->itemGeometryChanged(this);
+    }
+    else if (_parentItem != nullptr)
+    {
+        _parentItem->geometryChanged();
+    }
+}
+
+
+
+void Graphics2DItem::requestUpdate()
+{
+    if (_scene != nullptr)
+    {
+        _scene->itemUpdateRequested(this);
+    }
+    else if (_parentItem != nullptr)
+    {
+        _parentItem->requestUpdate();
+    }
+}
 }
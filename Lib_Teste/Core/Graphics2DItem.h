@@ -7,9 +7,18 @@
 namespace rm
 {
 class AABB2DItem;
+class GraphicsScene;
+class ItemBatchRenderer;
+class SelectionBoxRenderer;
 
 class Graphics2DItem: public GraphicsItem
 {
+public:
+    /**
+     * Allow the GraphicsScene to keep the item index information.
+     */
+    friend class GraphicsScene;
+
 public:
     /**
      * @brief Graphics2DItem Empty Constructor
@@ -46,6 +55,14 @@ public:
      */
     void render(int viewId) override = 0;
 
+    /**
+     * @brief renderBatched - Renders the item, but its points and polyline segments are added to the batch renderers
+     * of the view instead of being drawn. The default implementation just calls render().
+     * @param viewId - View's identifier. Where the item will be rendered.
+     * @param batch - Batch renderers of the view.
+     */
+    virtual void renderBatched(int viewId, ItemBatchRenderer& batch);
+
     /**
      * @brief getAABB - Get the current AABB from the object.
      * @return - Current AABB from the object.
@@ -72,6 +89,45 @@ public:
      */
     virtual AABB2DItem* getAABB2DItem();
 
+    /**
+     * @brief isAABB2DItemVisible - Verifies if the item has a visible AABB2DItem. Unlike getAABB2DItem(), it does
+     * not create nor update the AABB2DItem.
+     * @return - Returns true if the AABB2DItem exists and it is visible.
+     */
+    virtual bool isAABB2DItemVisible() const;
+
+    /**
+     * @brief showSelectionBox - Defines the visibility of the item selection box. Selection boxes are rendered by the
+     * view all at once, so they do not need any OpenGL resource on the item.
+     * @param show - True to show the box and false to hide it.
+     */
+    void showSelectionBox(bool show);
+
+    /**
+     * @brief isSelectionBoxVisible - Verifies if the item selection box is visible.
+     * @return - Returns true if the selection box is visible and false otherwise.
+     */
+    bool isSelectionBoxVisible() const;
+
+    /**
+     * @brief setSelectionBoxColor - Sets the color used to render the selection box.
+     * @param color - New selection box color.
+     */
+    void setSelectionBoxColor(const QVector4D& color);
+
+    /**
+     * @brief getSelectionBoxColor - Gets the color used to render the selection box.
+     * @return - The selection box color.
+     */
+    const QVector4D& getSelectionBoxColor() const;
+
+    /**
+     * @brief appendSelectionBoxes - Adds the visible selection boxes to the renderer of a view. The box is the render
+     * AABB of the last pixel size defined.
+     * @param renderer - Selection box renderer of the view.
+     */
+    virtual void appendSelectionBoxes(SelectionBoxRenderer& renderer) const;
+
     /**
      * @brief isIntersecting - Virtual function of graphicsitem so it needs to be implemented by the class' children.
      * The method receives a screen point and answer if intersects the item.
@@ -109,12 +165,63 @@ public:
      */
     Point2Df updatePixelSize(const Point2Df& pixelSize) const;
 
+    /**
+     * @brief setLineWidth - Defines a new line width value and notifies the scene, because the render AABB changes.
+     * @param width - New line width value.
+     */
+    virtual void setLineWidth(float width) override;
+
+    /**
+     * @brief setParentItem - Defines the item that owns this one as a part of it (e.g. the point set of a polyline).
+     * Geometry changes are notified through the parent when the item is not on a scene.
+     * @param parent - Owner item.
+     */
+    void setParentItem(Graphics2DItem* parent);
+
+protected:
+    /**
+     * @brief modelMatrixChanged - Notifies the geometry change.
+     */
+    virtual void modelMatrixChanged() override;
+
+    /**
+     * @brief appearanceChanged - Notifies the scene that the views must be redrawn.
+     */
+    virtual void appearanceChanged() override;
+
+    /**
+     * @brief geometryChanged - Notifies the scene that the item world AABB may have changed, so the scene index can
+     * be updated before the next query.
+     */
+    void geometryChanged();
+
+    /**
+     * @brief requestUpdate - Schedules a frame that redraws the item. Used by items that defer some work to a later
+     * frame, since a frame is not scheduled when nothing else changes.
+     */
+    void requestUpdate();
+
 private:
     /**
      * @brief _aabb - AABB representation object.
      */
     AABB2D _aabb;
 
+    /**
+     * @brief _scene - Scene that contains the item. It is defined by the scene.
+     */
+    GraphicsScene* _scene {nullptr};
+
+    /**
+     * @brief _parentItem - Item that owns this item.
+     */
+    Graphics2DItem* _parentItem {nullptr};
+
+    /**
+     * @brief _isIndexOutdated - Flag to determine if the item is waiting to be updated on the scene index.
+     */
+    bool _isIndexOutdated {false};
+
 protected:
 
     /**
@@ -127,10 +234,25 @@ protected:
      */
     AABB2DItem* _aabbItem{nullptr};
 
+    /**
+     * @brief _isSelectionBoxVisible - Selection box visibility.
+     */
+    bool _isSelectionBoxVisible {false};
+
+    /**
+     * @brief _selectionBoxColor - Selection box color.
+     */
+    QVector4D _selectionBoxColor {61.f / 255, 127.f / 255, 186.f / 255, 1.0f};
+
     /**
      * @brief _isAABBItemOutdated - Flag to determine if its necessary to update the aabb item. This update will
      * be made just at the moment that the aabb item is requested.
      */
     bool _isAABBItemOutdated = {true};
+
+    /**
+     * @brief _aabbItemBox - Box transferred to the aabb item on its last update.
+     */
+    AABB2D _aabbItemBox;
 };
 }
@@ -0,0 +1,541 @@
+#include "Graphics2DItemIndex.h"
+#include "Graphics2DItem.h"
+#include <algorithm>
+
+namespace rm
+{
+namespace
+{
+/**
+ * @brief FAT_FACTOR - Fraction of the AABB size added to each side of the leaves boxes.
+ */
+constexpr float FAT_FACTOR = 0.1f;
+
+
+
+AABB2D unite(const AABB2D& a, const AABB2D& b)
+{
+    AABB2D c = a;
+    c += b;
+    return c;
+}
+
+
+
+float perimeter(const AABB2D& a)
+{
+    Point2Df d = a.getMaxCornerPoint() - a.getMinCornerPoint();
+    return 2.0f * (d.x() + d.y());
+}
+
+
+
+bool containsBox(const AABB2D& a, const AABB2D& b)
+{
+    return a.getMinCornerPoint().x() <= b.getMinCornerPoint().x() &&
+           a.getMinCornerPoint().y() <= b.getMinCornerPoint().y() &&
+           b.getMaxCornerPoint().x() <= a.getMaxCornerPoint().x() &&
+           b.getMaxCornerPoint().y() <= a.getMaxCornerPoint().y();
+}
+
+
+
+Point2Df maxPoint(const Point2Df& a, const Point2Df& b)
+{
+    return Point2Df(std::max(a.x(), b.x()), std::max(a.y(), b.y()));
+}
+
+
+
+AABB2D expand(const AABB2D& a, const Point2Df& d)
+{
+    return AABB2D(a.getMinCornerPoint() - d, a.getMaxCornerPoint() + d);
+}
+
+
+
+bool overlaps(const AABB2D& a, const AABB2D& b)
+{
+    return a.getMinCornerPoint().x() <= b.getMaxCornerPoint().x() &&
+           b.getMinCornerPoint().x() <= a.getMaxCornerPoint().x() &&
+           a.getMinCornerPoint().y() <= b.getMaxCornerPoint().y() &&
+           b.getMinCornerPoint().y() <= a.getMaxCornerPoint().y();
+}
+}
+
+
+
+void Graphics2DItemIndex::insert(Graphics2DItem* item, unsigned int order)
+{
+    if (contains(item))
+    {
+        setOrder(item, order);
+        update(item);
+        return;
+    }
+
+    AABB2D box;
+    Point2Df margin;
+    computeBounds(item, box, margin);
+
+    int leaf = allocateNode();
+    Point2Df fat = (box.getMaxCornerPoint() - box.getMinCornerPoint()) * FAT_FACTOR;
+    _nodes[leaf].box = expand(box, fat);
+    _nodes[leaf].margin = margin;
+    _nodes[leaf].item = item;
+    _nodes[leaf].order = order;
+    _nodes[leaf].height = 0;
+
+    insertLeaf(leaf);
+    _leaves[item] = leaf;
+}
+
+
+
+bool Graphics2DItemIndex::remove(const Graphics2DItem* item)
+{
+    auto it = _leaves.find(item);
+    if (it == _leaves.end())
+    {
+        return false;
+    }
+
+    removeLeaf(it->second);
+    freeNode(it->second);
+    _leaves.erase(it);
+    return true;
+}
+
+
+
+bool Graphics2DItemIndex::update(Graphics2DItem* item)
+{
+    auto it = _leaves.find(item);
+    if (it == _leaves.end())
+    {
+        return false;
+    }
+
+    AABB2D box;
+    Point2Df margin;
+    computeBounds(item, box, margin);
+
+    int leaf = it->second;
+
+    //Small changes are absorbed by the fat AABB.
+    if (containsBox(_nodes[leaf].box, box) && _nodes[leaf].margin == margin)
+    {
+        return false;
+    }
+
+    removeLeaf(leaf);
+
+    Point2Df fat = (box.getMaxCornerPoint() - box.getMinCornerPoint()) * FAT_FACTOR;
+    _nodes[leaf].box = expand(box, fat);
+    _nodes[leaf].margin = margin;
+
+    insertLeaf(leaf);
+    return true;
+}
+
+
+
+void Graphics2DItemIndex::clear()
+{
+    _nodes.clear();
+    _leaves.clear();
+    _root = -1;
+    _freeList = -1;
+}
+
+
+
+bool Graphics2DItemIndex::contains(const Graphics2DItem* item) const
+{
+    return _leaves.find(item) != _leaves.end();
+}
+
+
+
+void Graphics2DItemIndex::setOrder(const Graphics2DItem* item, unsigned int order)
+{
+    auto it = _leaves.find(item);
+    if (it != _leaves.end())
+    {
+        _nodes[it->second].order = order;
+    }
+}
+
+
+
+void Graphics2DItemIndex::query(const Point2Df& p, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const
+{
+    query(AABB2D(p, p), pixelSize, items);
+}
+
+
+
+void Graphics2DItemIndex::query(const AABB2D& box, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const
+{
+    items.clear();
+    if (_root == -1)
+    {
+        return;
+    }
+
+    std::vector<int> leaves;
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(_root);
+
+    while (!stack.empty())
+    {
+        int id = stack.back();
+        stack.pop_back();
+
+        const Node& node = _nodes[id];
+
+        //The node box grows with the render margin of the items below it.
+        Point2Df d(node.margin.x() * pixelSize.x(), node.margin.y() * pixelSize.y());
+        if (!overlaps(expand(node.box, d), box))
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            leaves.push_back(id);
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+
+    sortByOrder(leaves, items);
+}
+
+
+
+unsigned int Graphics2DItemIndex::size() const
+{
+    return static_cast<unsigned int>(_leaves.size());
+}
+
+
+
+int Graphics2DItemIndex::getHeight() const
+{
+    return _root == -1 ? 0 : _nodes[_root].height;
+}
+
+
+
+int Graphics2DItemIndex::allocateNode()
+{
+    if (_freeList == -1)
+    {
+        _nodes.emplace_back();
+        return static_cast<int>(_nodes.size()) - 1;
+    }
+
+    int id = _freeList;
+    _freeList = _nodes[id].parent;
+    _nodes[id] = Node();
+    return id;
+}
+
+
+
+void Graphics2DItemIndex::freeNode(int id)
+{
+    _nodes[id] = Node();
+    _nodes[id].parent = _freeList;
+    _freeList = id;
+}
+
+
+
+void Graphics2DItemIndex::insertLeaf(int leaf)
+{
+    if (_root == -1)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = -1;
+        return;
+    }
+
+    //Find the best sibling using the perimeter as cost.
+    AABB2D leafBox = _nodes[leaf].box;
+    int id = _root;
+    while (!_nodes[id].isLeaf())
+    {
+        int left = _nodes[id].left;
+        int right = _nodes[id].right;
+
+        float area = perimeter(_nodes[id].box);
+        float combinedArea = perimeter(unite(_nodes[id].box, leafBox));
+
+        //Cost of creating a new parent for this node and the new leaf.
+        float cost = 2.0f * combinedArea;
+
+        //Minimum cost of pushing the leaf further down the tree.
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float leftCost = perimeter(unite(leafBox, _nodes[left].box)) + inheritanceCost;
+        if (!_nodes[left].isLeaf())
+        {
+            leftCost -= perimeter(_nodes[left].box);
+        }
+
+        float rightCost = perimeter(unite(leafBox, _nodes[right].box)) + inheritanceCost;
+        if (!_nodes[right].isLeaf())
+        {
+            rightCost -= perimeter(_nodes[right].box);
+        }
+
+        if (cost < leftCost && cost < rightCost)
+        {
+            break;
+        }
+
+        id = leftCost < rightCost ? left : right;
+    }
+
+    int sibling = id;
+
+    //Create a new parent. The node vector can grow here, so no references are kept.
+    int oldParent = _nodes[sibling].parent;
+    int newParent = allocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].left = sibling;
+    _nodes[newParent].right = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+    refitNode(newParent);
+
+    if (oldParent != -1)
+    {
+        if (_nodes[oldParent].left == sibling)
+        {
+            _nodes[oldParent].left = newParent;
+        }
+        else
+        {
+            _nodes[oldParent].right = newParent;
+        }
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    refitAncestors(oldParent);
+}
+
+
+
+void Graphics2DItemIndex::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = -1;
+        return;
+    }
+
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+
+    if (grandParent != -1)
+    {
+        //Connect the sibling to the grand parent and destroy the parent.
+        if (_nodes[grandParent].left == parent)
+        {
+            _nodes[grandParent].left = sibling;
+        }
+        else
+        {
+            _nodes[grandParent].right = sibling;
+        }
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        refitAncestors(grandParent);
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = -1;
+        freeNode(parent);
+    }
+
+    _nodes[leaf].parent = -1;
+}
+
+
+
+int Graphics2DItemIndex::balance(int a)
+{
+    if (_nodes[a].isLeaf() || _nodes[a].height < 2)
+    {
+        return a;
+    }
+
+    int b = _nodes[a].left;
+    int c = _nodes[a].right;
+    int diff = _nodes[c].height - _nodes[b].height;
+
+    //Rotate c up.
+    if (diff > 1)
+    {
+        int f = _nodes[c].left;
+        int g = _nodes[c].right;
+
+        _nodes[c].left = a;
+        _nodes[c].parent = _nodes[a].parent;
+        _nodes[a].parent = c;
+
+        int parent = _nodes[c].parent;
+        if (parent != -1)
+        {
+            if (_nodes[parent].left == a)
+            {
+                _nodes[parent].left = c;
+            }
+            else
+            {
+                _nodes[parent].right = c;
+            }
+        }
+        else
+        {
+            _root = c;
+        }
+
+        //The highest grandchild stays with c.
+        if (_nodes[f].height > _nodes[g].height)
+        {
+            _nodes[c].right = f;
+            _nodes[a].right = g;
+            _nodes[g].parent = a;
+        }
+        else
+        {
+            _nodes[c].right = g;
+            _nodes[a].right = f;
+            _nodes[f].parent = a;
+        }
+
+        refitNode(a);
+        refitNode(c);
+        return c;
+    }
+
+    //Rotate b up.
+    if (diff < -1)
+    {
+        int d = _nodes[b].left;
+        int e = _nodes[b].right;
+
+        _nodes[b].left = a;
+        _nodes[b].parent = _nodes[a].parent;
+        _nodes[a].parent = b;
+
+        int parent = _nodes[b].parent;
+        if (parent != -1)
+        {
+            if (_nodes[parent].left == a)
+            {
+                _nodes[parent].left = b;
+            }
+            else
+            {
+                _nodes[parent].right = b;
+            }
+        }
+        else
+        {
+            _root = b;
+        }
+
+        //The highest grandchild stays with b.
+        if (_nodes[d].height > _nodes[e].height)
+        {
+            _nodes[b].right = d;
+            _nodes[a].left = e;
+            _nodes[e].parent = a;
+        }
+        else
+        {
+            _nodes[b].right = e;
+            _nodes[a].left = d;
+            _nodes[d].parent = a;
+        }
+
+        refitNode(a);
+        refitNode(b);
+        return b;
+    }
+
+    return a;
+}
+
+
+
+void Graphics2DItemIndex::refitNode(int id)
+{
+    Node& node = _nodes[id];
+    const Node& left = _nodes[node.left];
+    const Node& right = _nodes[node.right];
+
+    node.box = unite(left.box, right.box);
+    node.margin = maxPoint(left.margin, right.margin);
+    node.height = 1 + std::max(left.height, right.height);
+}
+
+
+
+void Graphics2DItemIndex::refitAncestors(int id)
+{
+    while (id != -1)
+    {
+        id = balance(id);
+        refitNode(id);
+        id = _nodes[id].parent;
+    }
+}
+
+
+
+void Graphics2DItemIndex::computeBounds(Graphics2DItem* item, AABB2D& box, Point2Df& margin)
+{
+    const QMatrix4x4& m = item->getModelMatrix().topMatrix();
+
+    //The render AABB grows linearly with the pixel size, so the AABB for a unitary pixel gives the margin per pixel.
+    //It is computed before the AABB because groups recompute their AABB lazily.
+    AABB2D render = m * item->getAABBRender(Point2Df(1.0f, 1.0f));
+    box = m * item->getAABB();
+
+    Point2Df lower = box.getMinCornerPoint() - render.getMinCornerPoint();
+    Point2Df upper = render.getMaxCornerPoint() - box.getMaxCornerPoint();
+    margin = maxPoint(maxPoint(lower, upper), Point2Df(0.0f, 0.0f));
+}
+
+
+
+void Graphics2DItemIndex::sortByOrder(std::vector<int>& leaves, std::vector<Graphics2DItem*>& items) const
+{
+    std::sort(leaves.begin(), leaves.end(), [this](int a, int b)
+    {
+        return _nodes[a].order < _nodes[b].order;
+    });
+
+    items.reserve(leaves.size());
+    for (int leaf : leaves)
+    {
+        items.push_back(_nodes[leaf].item);
+    }
+}
+}
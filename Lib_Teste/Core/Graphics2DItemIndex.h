@@ -0,0 +1,225 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "../Geometry/AxisAligmentBoundingBox.h"
+
+namespace rm
+{
+class Graphics2DItem;
+
+/**
+ * @brief The Graphics2DItemIndex class - Dynamic AABB tree over the world AABB of 2D items. Leaves store a fat AABB
+ * (enlarged by a fraction of its size), so small edits do not change the tree. Each node also stores the render
+ * margin per pixel of its subtree (point radius, line thickness...), so queries can take the view pixel size in account
+ * without rebuilding the tree when the zoom changes.
+ */
+class Graphics2DItemIndex
+{
+public:
+    /**
+     * @brief Graphics2DItemIndex - Default constructor. Creates an empty index.
+     */
+    Graphics2DItemIndex() = default;
+
+    /**
+     * @brief insert - Inserts a new item on index.
+     * @param item - Item to be inserted.
+     * @param order - Z order of the item on scene.
+     */
+    void insert(Graphics2DItem* item, unsigned int order);
+
+    /**
+     * @brief remove - Removes an item from index.
+     * @param item - Item to be removed.
+     * @return - Returns true if the item was on index and false otherwise.
+     */
+    bool remove(const Graphics2DItem* item);
+
+    /**
+     * @brief update - Recomputes the item bounds. The tree is changed only if the new bounds are out of the fat AABB.
+     * @param item - Item to be updated.
+     * @return - Returns true if the tree has been changed.
+     */
+    bool update(Graphics2DItem* item);
+
+    /**
+     * @brief clear - Removes all items from index.
+     */
+    void clear();
+
+    /**
+     * @brief contains - Verifies if an item is on index.
+     * @param item - Item to be checked.
+     * @return - Returns true if the item is on index and false otherwise.
+     */
+    bool contains(const Graphics2DItem* item) const;
+
+    /**
+     * @brief setOrder - Defines the z order of an item. Query results are sorted by this value.
+     * @param item - Item on index.
+     * @param order - New z order.
+     */
+    void setOrder(const Graphics2DItem* item, unsigned int order);
+
+    /**
+     * @brief query - Finds all items whose render AABB contains a point.
+     * @param p - Point in world coordinates.
+     * @param pixelSize - Pixel size in world metrics, used to expand the items AABB by their render margins.
+     * @param items - Vector to receive the found items sorted from back to front.
+     */
+    void query(const Point2Df& p, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const;
+
+    /**
+     * @brief query - Finds all items whose render AABB overlaps a box.
+     * @param box - Box in world coordinates.
+     * @param pixelSize - Pixel size in world metrics, used to expand the items AABB by their render margins.
+     * @param items - Vector to receive the found items sorted from back to front.
+     */
+    void query(const AABB2D& box, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const;
+
+    /**
+     * @brief size - Gets the number of items on index.
+     * @return - Returns the number of items on index.
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief getHeight - Gets the tree height. Useful to check the tree balance.
+     * @return - Returns the tree height.
+     */
+    int getHeight() const;
+
+private:
+    /**
+     * @brief The Node struct - Tree node. Leaves have no children and point to an item.
+     */
+    struct Node
+    {
+        /**
+         * @brief box - Fat AABB of a leaf or union of the children boxes.
+         */
+        AABB2D box;
+
+        /**
+         * @brief margin - Render margin per pixel. For inner nodes, it is the maximum margin of the subtree.
+         */
+        Point2Df margin;
+
+        /**
+         * @brief parent - Parent node index, or next free node when the node is not used.
+         */
+        int parent {-1};
+
+        /**
+         * @brief left - Left child index.
+         */
+        int left {-1};
+
+        /**
+         * @brief right - Right child index.
+         */
+        int right {-1};
+
+        /**
+         * @brief height - Leaves have height 0 and free nodes -1.
+         */
+        int height {-1};
+
+        /**
+         * @brief order - Z order of the item.
+         */
+        unsigned int order {0};
+
+        /**
+         * @brief item - Item stored in a leaf.
+         */
+        Graphics2DItem* item {nullptr};
+
+        /**
+         * @brief isLeaf - Verifies if the node is a leaf.
+         * @return - Returns true if the node is a leaf.
+         */
+        bool isLeaf() const { return left == -1; }
+    };
+
+    /**
+     * @brief allocateNode - Gets a node from the free list or creates a new one.
+     * @return - Returns the node index.
+     */
+    int allocateNode();
+
+    /**
+     * @brief freeNode - Gives a node back to the free list.
+     * @param id - Node index.
+     */
+    void freeNode(int id);
+
+    /**
+     * @brief insertLeaf - Links a leaf on tree choosing the sibling with the lowest perimeter cost.
+     * @param leaf - Leaf index.
+     */
+    void insertLeaf(int leaf);
+
+    /**
+     * @brief removeLeaf - Unlinks a leaf from tree.
+     * @param leaf - Leaf index.
+     */
+    void removeLeaf(int leaf);
+
+    /**
+     * @brief balance - Performs a rotation if the node is unbalanced.
+     * @param id - Node index.
+     * @return - Returns the index of the node that took the place of id.
+     */
+    int balance(int id);
+
+    /**
+     * @brief refitNode - Recomputes box, margin and height of an inner node from its children.
+     * @param id - Node index.
+     */
+    void refitNode(int id);
+
+    /**
+     * @brief refitAncestors - Balances and refits all nodes from id up to the root.
+     * @param id - First node index.
+     */
+    void refitAncestors(int id);
+
+    /**
+     * @brief computeBounds - Computes the world AABB and the render margin per pixel of an item.
+     * @param item - Item to compute the bounds.
+     * @param box - Item world AABB.
+     * @param margin - Render margin per pixel.
+     */
+    static void computeBounds(Graphics2DItem* item, AABB2D& box, Point2Df& margin);
+
+    /**
+     * @brief sortByOrder - Sorts the query result by the item z order.
+     * @param leaves - Leaves found.
+     * @param items - Vector to receive the items.
+     */
+    void sortByOrder(std::vector<int>& leaves, std::vector<Graphics2DItem*>& items) const;
+
+private:
+    /**
+     * @brief _nodes - Node pool.
+     */
+    std::vector<Node> _nodes;
+
+    /**
+     * @brief _root - Root node index.
+     */
+    int _root {-1};
+
+    /**
+     * @brief _freeList - First free node index.
+     */
+    int _freeList {-1};
+
+    /**
+     * @brief _leaves - Leaf index by item.
+     */
+    std::unordered_map<const Graphics2DItem*, int> _leaves;
+};
+}
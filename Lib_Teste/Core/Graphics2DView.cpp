@@ -1,4 +1,8 @@
 #include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <algorithm>
+#include <cmath>
 #include "Graphics2DItem.h"
 #include "../Items/SelectionGroup2DItem.h"
 #include "Graphics2DView.h"
@@ -14,6 +18,18 @@ Graphics2DView::Graphics2DView(GraphicsScene* scene, QWidget* parent)
 
 
 
+Graphics2DView::~Graphics2DView()
+{
+    //The framebuffer and the vertex array objects are not shared, so they must be deleted on the view context.
+    makeCurrent();
+    _selectionBoxRenderer.release();
+    _itemBatch.release();
+    delete _frameCache;
+    doneCurrent();
+}
+
+
+
 void Graphics2DView::computeWorldLimits(const Point2Df &c1, const Point2Df &c2)
 {
     //Get the min and max corner.
@@ -92,6 +108,38 @@ void Graphics2DView::newCameraParameters(const Point2Df& center, const Point2Df&
 
     //Recompute the pixel size.
     computePixelSize();
+
+    //The scene has not changed, so the view must ask for its own repaint.
+    _scene->update(this);
+}
+
+
+
+void Graphics2DView::setBatchRendering(bool enable)
+{
+    _isBatchRenderingEnabled = enable;
+}
+
+
+
+bool Graphics2DView::isBatchRenderingEnabled() const
+{
+    return _isBatchRenderingEnabled;
+}
+
+
+
+void Graphics2DView::setPartialRedraw(bool enable)
+{
+    _isPartialRedrawEnabled = enable;
+    invalidateFrameCache();
+}
+
+
+
+bool Graphics2DView::isPartialRedrawEnabled() const
+{
+    return _isPartialRedrawEnabled;
 }
 
 
@@ -127,37 +175,131 @@ Point2Df Graphics2DView::convertFromScreenToWorld(const Point2Df& screen)
 
 void Graphics2DView::paintGL()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
+    _profiler.beginFrame();
+    _submittedItems = 0;
+    _culledItems = 0;
+    _reusedItems = 0;
     glDisable(GL_DEPTH_TEST);
 
-    //Render 2d items
-    const std::list<GraphicsItem *>& itemsList = _scene->items();
-    for(auto item : itemsList)
+    //The items read the projection and the pixel size from the view block.
+    ViewUniforms viewUniforms;
+    viewUniforms.setProjection(_proj.topMatrix());
+    viewUniforms.setView(QMatrix4x4());
+    viewUniforms.pixelSize[0] = _pixelSize.x();
+    viewUniforms.pixelSize[1] = _pixelSize.y();
+    _frameUniforms.beginFrame(viewUniforms);
+
+    const std::vector<Graphics2DItem*>& items2D = _scene->items2D();
+    if (_isPartialRedrawEnabled)
+    {
+        //Redraw just the damaged regions and copy the cached frame to the view.
+        updateFrameCache();
+
+        _profiler.beginSection("Frame cache copy");
+        QOpenGLExtraFunctions* f = context()->extraFunctions();
+        f->glBindFramebuffer(GL_READ_FRAMEBUFFER, _frameCache->handle());
+        f->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebufferObject());
+        f->glBlitFramebuffer(0, 0, _frameCache->width(), _frameCache->height(),
+                             0, 0, _frameCache->width(), _frameCache->height(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        f->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+        _profiler.endSection();
+    }
+    else
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        std::vector<Graphics2DItem*> items;
+        itemsInView(items);
+        unsigned int rendered = renderItems(items);
+        countItems(rendered, static_cast<unsigned int>(items2D.size() - items.size()), 0);
+    }
+
+    renderOverlays(items2D);
+    _frameUniforms.endFrame();
+    _profiler.endFrame();
+
+    renderStatisticsOverlay();
+}
+
+
+
+void Graphics2DView::itemsInView(std::vector<Graphics2DItem*>& items) const
+{
+    if (_isCullingEnabled)
+    {
+        _scene->items2DIn(AABB2D(_min, _max), _pixelSize, items);
+    }
+    else
     {
-        Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+        const std::vector<Graphics2DItem*>& items2D = _scene->items2D();
+        items.assign(items2D.begin(), items2D.end());
+    }
+}
+
+
 
-        if (item2d && item2d->isVisible())
+unsigned int Graphics2DView::renderItems(const std::vector<Graphics2DItem*>& items)
+{
+    unsigned int rendered = 0;
+    if (_isBatchRenderingEnabled)
+    {
+        //Points and segments are collected while the items are rendered and drawn at once.
+        _itemBatch.clear();
+        for(auto item2d : items)
         {
-            item2d->setProjectionMatrix(_proj);
-            item2d->setPixelSize(_pixelSize);
-            item2d->render(id());
+            if (item2d->isVisible())
+            {
+                item2d->setProjectionMatrix(_proj);
+                item2d->setPixelSize(_pixelSize);
+                _profiler.beginItem(item2d);
+                item2d->renderBatched(id(), _itemBatch);
+                rendered++;
+            }
         }
 
+        _profiler.beginSection("ItemBatchRenderer");
+        _itemBatch.render(_proj);
+        _profiler.endSection();
     }
-    //Render item's bounding boxes
-    for(auto item : itemsList)
+    else
     {
-        Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
-        if(item2d)
+        for(auto item2d : items)
         {
-            //@TODO: quando mudar o render dos objetos, mudar o itemBox para const.
-            AABB2DItem* itemBox = item2d->getAABB2DItem();
-            if(itemBox->isVisible())
+            if (item2d->isVisible())
             {
-                //Render item box
-                itemBox->render(id(), _proj, item2d->getModelMatrix(), _pixelSize);
+                item2d->setProjectionMatrix(_proj);
+                item2d->setPixelSize(_pixelSize);
+                _profiler.beginItem(item2d);
+                item2d->render(id());
+                rendered++;
             }
         }
+        _profiler.endSection();
+    }
+    return rendered;
+}
+
+
+
+void Graphics2DView::renderOverlays(const std::vector<Graphics2DItem*>& items)
+{
+    //Render item's selection boxes at once. The instances are uploaded just if some box has changed.
+    _profiler.beginSection("Overlays");
+    _selectionBoxRenderer.clear();
+    for(auto item2d : items)
+    {
+        item2d->appendSelectionBoxes(_selectionBoxRenderer);
+    }
+    _selectionBoxRenderer.render(_proj);
+
+    //Render item's bounding boxes with editing handles. They are not created for items without visible boxes.
+    for(auto item2d : items)
+    {
+        if(item2d->isAABB2DItemVisible())
+        {
+            //Render item box
+            item2d->getAABB2DItem()->render(id(), _proj, item2d->getModelMatrix(), _pixelSize);
+        }
     }
 
     if (_rectangleZoom.isVisible())
@@ -165,6 +307,197 @@ void Graphics2DView::paintGL()
          glDisable(GL_DEPTH_TEST);
         _rectangleZoom.render(id());
     }
+    _profiler.endSection();
+}
+
+
+
+void Graphics2DView::updateFrameCache()
+{
+    //The cached frame has the size of the view framebuffer.
+    QSize size = this->size() * devicePixelRatioF();
+    if (_frameCache == nullptr || _frameCache->size() != size)
+    {
+        delete _frameCache;
+        _frameCache = new QOpenGLFramebufferObject(size);
+        _isFrameCacheValid = false;
+    }
+
+    //Any camera change moves all items on screen.
+    if (_cachedMin != _min || _cachedMax != _max)
+    {
+        _isFrameCacheValid = false;
+    }
+
+    //Items can notify changes while their AABB is computed, so the damaged items are swapped before the update.
+    std::set<Graphics2DItem*> damagedItems;
+    damagedItems.swap(_damagedItems);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    _frameCache->bind();
+    glViewport(0, 0, size.width(), size.height());
+
+    if (!_isFrameCacheValid)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        //Items outside the view are not drawn. Any camera change redraws the whole cache, so they are drawn when seen.
+        std::vector<Graphics2DItem*> items;
+        itemsInView(items);
+        unsigned int rendered = renderItems(items);
+        countItems(rendered, static_cast<unsigned int>(_scene->items2D().size() - items.size()), 0);
+
+        //Save the regions where the items were drawn.
+        _drawnRegions.clear();
+        for (auto item2d : items)
+        {
+            if (item2d->isVisible())
+            {
+                _drawnRegions[item2d] = computeWorldRenderAABB(item2d);
+            }
+        }
+
+        _cachedMin = _min;
+        _cachedMax = _max;
+        _isFrameCacheValid = true;
+    }
+    else
+    {
+        //The damage is the old and the new region of each changed item.
+        for (auto item2d : damagedItems)
+        {
+            auto it = _drawnRegions.find(item2d);
+            if (it != _drawnRegions.end())
+            {
+                damageRegion(it->second);
+                _drawnRegions.erase(it);
+            }
+
+            if (item2d->isVisible())
+            {
+                damageRegion(computeWorldRenderAABB(item2d));
+            }
+        }
+
+        //Items redrawn over the damaged region.
+        std::vector<Graphics2DItem*> items;
+        unsigned int rendered = 0;
+        if (_hasDamagedRegion)
+        {
+            //Convert the damaged region to pixels. A pixel is added on each side for antialiasing.
+            const Point2Df& minCorner = _damagedRegion.getMinCornerPoint();
+            const Point2Df& maxCorner = _damagedRegion.getMaxCornerPoint();
+            float sx = size.width() / (_max.x() - _min.x());
+            float sy = size.height() / (_max.y() - _min.y());
+            int x0 = std::max(0, static_cast<int>(std::floor((minCorner.x() - _min.x()) * sx)) - 1);
+            int y0 = std::max(0, static_cast<int>(std::floor((minCorner.y() - _min.y()) * sy)) - 1);
+            int x1 = std::min(size.width(), static_cast<int>(std::ceil((maxCorner.x() - _min.x()) * sx)) + 1);
+            int y1 = std::min(size.height(), static_cast<int>(std::ceil((maxCorner.y() - _min.y()) * sy)) + 1);
+
+            //Regions outside the view do not need to be redrawn.
+            if (x0 < x1 && y0 < y1)
+            {
+                glEnable(GL_SCISSOR_TEST);
+                glScissor(x0, y0, x1 - x0, y1 - y0);
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                //Redraw just the items that overlap the damaged region.
+                _scene->items2DIn(_damagedRegion, _pixelSize, items);
+                rendered = renderItems(items);
+
+                glDisable(GL_SCISSOR_TEST);
+
+                for (auto item2d : items)
+                {
+                    if (item2d->isVisible())
+                    {
+                        _drawnRegions[item2d] = computeWorldRenderAABB(item2d);
+                    }
+                }
+            }
+        }
+
+        //Only the items outside the view are culled. The visible ones inside it that were not redrawn are kept from the
+        //cached frame.
+        std::vector<Graphics2DItem*> itemsInWindow;
+        itemsInView(itemsInWindow);
+        std::sort(items.begin(), items.end());
+        unsigned int reused = 0;
+        for (auto item2d : itemsInWindow)
+        {
+            if (item2d->isVisible() && !std::binary_search(items.begin(), items.end(), item2d))
+            {
+                reused++;
+            }
+        }
+        countItems(rendered, static_cast<unsigned int>(_scene->items2D().size() - itemsInWindow.size()), reused);
+    }
+
+    _hasDamagedRegion = false;
+
+    _frameCache->release();
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+
+
+AABB2D Graphics2DView::computeWorldRenderAABB(Graphics2DItem* item) const
+{
+    return item->getModelMatrix().topMatrix() * item->getAABBRender(_pixelSize);
+}
+
+
+
+void Graphics2DView::invalidateFrameCache()
+{
+    _isFrameCacheValid = false;
+    _damagedItems.clear();
+    _hasDamagedRegion = false;
+}
+
+
+
+void Graphics2DView::damageItem(Graphics2DItem* item)
+{
+    if (_isPartialRedrawEnabled && _isFrameCacheValid)
+    {
+        _damagedItems.insert(item);
+    }
+}
+
+
+
+void Graphics2DView::damageRemovedItem(const Graphics2DItem* item)
+{
+    auto it = _drawnRegions.find(item);
+    if (it != _drawnRegions.end())
+    {
+        damageRegion(it->second);
+        _drawnRegions.erase(it);
+    }
+    _damagedItems.erase(const_cast<Graphics2DItem*>(item));
+}
+
+
+
+void Graphics2DView::damageRegion(const AABB2D& region)
+{
+    if (!_isPartialRedrawEnabled || !_isFrameCacheValid)
+    {
+        return;
+    }
+
+    if (_hasDamagedRegion)
+    {
+        _damagedRegion += region;
+    }
+    else
+    {
+        _damagedRegion = region;
+        _hasDamagedRegion = true;
+    }
 }
 
 
@@ -212,6 +545,8 @@ void Graphics2DView::initializeGL()
     glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
     glViewport(0, 0, 100, 100);
     _rectangleZoom.initialize();
+    _selectionBoxRenderer.initialize();
+    _itemBatch.initialize();
 }
 
 
@@ -1,10 +1,16 @@
 #pragma once
 #include <QMatrix4x4>
+#include <map>
+#include <set>
 #include <vector>
 
 #include "GraphicsView.h"
+#include "CoreItems/ItemBatchRenderer.h"
+#include "CoreItems/SelectionBoxRenderer.h"
 #include "../Events/EventConstants.h"
 
+class QOpenGLFramebufferObject;
+
 namespace rm
 {
 class Graphics2DView : public GraphicsView
@@ -78,6 +84,37 @@ public:
      */
     const Point2Df& getPixelSize() const;
 
+    /**
+     * @brief setBatchRendering - Enables the batched render of point sets and polylines. When it is enabled, the
+     * polyline segments and the points of all items are drawn after the other items, with one draw call for the
+     * segments and one per point layout, so they are always on top of the other items.
+     * It is recommended for scenes with many point sets or polylines.
+     * @param enable - True to enable the batched render and false to render each item by itself.
+     */
+    void setBatchRendering(bool enable);
+
+    /**
+     * @brief isBatchRenderingEnabled - Verifies if the point sets and polylines are rendered in batches.
+     * @return - Returns true if the batched render is enabled and false otherwise.
+     */
+    bool isBatchRenderingEnabled() const;
+
+    /**
+     * @brief setPartialRedraw - Enables the partial redraw of the view. When it is enabled, the items are drawn on a
+     * cached frame and only the regions changed since the last frame are redrawn, scissored, with the items that
+     * overlap them. Selection boxes, editing handles and the zoom rectangle are drawn over the cached frame on each
+     * frame. Items must notify their changes (geometry, colors, visibility or focus), or GraphicsScene::update() must
+     * be called, for the cached frame to be updated.
+     * @param enable - True to enable the partial redraw and false to redraw all items on each frame.
+     */
+    void setPartialRedraw(bool enable);
+
+    /**
+     * @brief isPartialRedrawEnabled - Verifies if only the changed regions are redrawn.
+     * @return - Returns true if the partial redraw is enabled and false otherwise.
+     */
+    bool isPartialRedrawEnabled() const;
+
     /**
      * @brief synchronizeWith - Synchronize the current view with that view passed by parameter.
      * @param view - view to be synchronized with the current view.
@@ -135,9 +172,64 @@ private:
     void setWorldLimits(const Point2Df& c1, const Point2Df& c2);
 
     /**
-     * @brief Default destructor
+     * @brief itemsInView - Finds the items that may be inside the world window of the view. All scene items are
+     * returned if the culling is disabled.
+     * @param items - Vector to receive the items, sorted from back to front.
+     */
+    void itemsInView(std::vector<Graphics2DItem*>& items) const;
+
+    /**
+     * @brief renderItems - Renders a set of items with the current projection.
+     * @param items - Items sorted from back to front.
+     * @return - Returns the number of visible items rendered.
+     */
+    unsigned int renderItems(const std::vector<Graphics2DItem*>& items);
+
+    /**
+     * @brief renderOverlays - Renders selection boxes, editing handles and zoom rectangle over the items.
+     * @param items - Scene items.
+     */
+    void renderOverlays(const std::vector<Graphics2DItem*>& items);
+
+    /**
+     * @brief updateFrameCache - Redraws the damaged regions of the cached frame, or all of it if it is invalid.
+     */
+    void updateFrameCache();
+
+    /**
+     * @brief computeWorldRenderAABB - Computes the world AABB of an item, including its render margins.
+     * @param item - Item on scene.
+     * @return - Returns the world AABB of the item on this view.
+     */
+    AABB2D computeWorldRenderAABB(Graphics2DItem* item) const;
+
+    /**
+     * @brief invalidateFrameCache - Makes the next frame redraw all items.
+     */
+    void invalidateFrameCache();
+
+    /**
+     * @brief damageItem - Marks an item to have its last drawn and its current regions redrawn on the next frame.
+     * @param item - Changed item.
+     */
+    void damageItem(Graphics2DItem* item);
+
+    /**
+     * @brief damageRemovedItem - Marks the last drawn region of an item removed from scene to be redrawn.
+     * @param item - Removed item.
+     */
+    void damageRemovedItem(const Graphics2DItem* item);
+
+    /**
+     * @brief damageRegion - Marks a world region to be redrawn on the next frame.
+     * @param region - Region in world coordinates.
+     */
+    void damageRegion(const AABB2D& region);
+
+    /**
+     * @brief Destructor.
      */
-    ~Graphics2DView() override = default;
+    ~Graphics2DView() override;
 
     
 private:    
@@ -170,5 +262,65 @@ private:
      * @brief _pixelSize - Current pixel size.
      */
     Point2Df _pixelSize;
+
+    /**
+     * @brief _selectionBoxRenderer - Renders the selection boxes of all items with a single draw call.
+     */
+    SelectionBoxRenderer _selectionBoxRenderer;
+
+    /**
+     * @brief _itemBatch - Renders the points and polyline segments of all items with a few draw calls.
+     */
+    ItemBatchRenderer _itemBatch;
+
+    /**
+     * @brief _isBatchRenderingEnabled - Defines if the point sets and polylines are rendered in batches.
+     */
+    bool _isBatchRenderingEnabled {false};
+
+    /**
+     * @brief _isPartialRedrawEnabled - Defines if only the damaged regions are redrawn.
+     */
+    bool _isPartialRedrawEnabled {false};
+
+    /**
+     * @brief _frameCache - Framebuffer with the items drawn on the last frame. It belongs to the view context.
+     */
+    QOpenGLFramebufferObject* _frameCache {nullptr};
+
+    /**
+     * @brief _isFrameCacheValid - False if all items must be redrawn on the cached frame.
+     */
+    bool _isFrameCacheValid {false};
+
+    /**
+     * @brief _cachedMin - Min world corner of the cached frame.
+     */
+    Point2Df _cachedMin;
+
+    /**
+     * @brief _cachedMax - Max world corner of the cached frame.
+     */
+    Point2Df _cachedMax;
+
+    /**
+     * @brief _damagedItems - Items changed since the last frame.
+     */
+    std::set<Graphics2DItem*> _damagedItems;
+
+    /**
+     * @brief _damagedRegion - World region to be redrawn besides the damaged items regions.
+     */
+    AABB2D _damagedRegion;
+
+    /**
+     * @brief _hasDamagedRegion - True if _damagedRegion must be redrawn.
+     */
+    bool _hasDamagedRegion {false};
+
+    /**
+     * @brief _drawnRegions - World render AABB of each item when it was drawn on the cached frame.
+     */
+    std::map<const Graphics2DItem*, AABB2D> _drawnRegions;
 };
 }
@@ -1,4 +1,5 @@
 #include "Graphics3DItem.h"
+#include <algorithm>
 
 namespace rm
 {
@@ -21,6 +22,26 @@ void Graphics3DItem::setShadingModel(ShadingModel m)
 
 
 
+void Graphics3DItem::setProjectedSize(float size)
+{
+    _projectedSize = size;
+}
+
+
+
+float Graphics3DItem::getPixelsPerUnit() const
+{
+    QVector3D extent = _aabb.getMaxCornerPoint() - _aabb.getMinCornerPoint();
+    float size = std::max(extent.x(), std::max(extent.y(), extent.z()));
+    if (size <= 0.0f)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+    return _projectedSize / size;
+}
+
+
+
 const AABB3D& Graphics3DItem::getAABB() const
 {
     return _aabb;
@@ -33,4 +54,86 @@ AABB3D& Graphics3DItem::getAABB()
     return _aabb;
 }
 
+
+
+
+bool Graphics3DItem::intersectRay(const QVector3D&, const QVector3D&, PickResult&)
+{
+    return false;
+}
+
+
+
+bool Graphics3DItem::intersectTriangles(const QVector3D& origin, const QVector3D& direction, const QVector3D* points,
+                                        const unsigned int* triangles, size_t numTriangles,
+                                        BoundingVolumeHierarchy& bvh, PickResult& result)
+{
+    if (bvh.isEmpty())
+    {
+        std::vector<BoundingVolumeHierarchy::Box> boxes;
+        computeTriangleBoxes(points, triangles, numTriangles, boxes);
+        bvh.build(boxes);
+    }
+
+    //Take the ray to model coordinates. The direction is not normalized, so the ray parameter is the same.
+    bool isInvertible = false;
+    QMatrix4x4 inverse = _modelMatrix.topMatrix().inverted(&isInvertible);
+    if (!isInvertible)
+    {
+        return false;
+    }
+
+    QVector3D localOrigin = inverse.map(origin);
+    QVector3D localDirection = inverse.mapVector(direction);
+
+    float tMax = result.distance;
+    unsigned int cell = 0;
+    float u = 0.0f, v = 0.0f;
+    bool isHit = bvh.intersect(localOrigin, localDirection, tMax, [&](unsigned int triangle, float& t)
+    {
+        const unsigned int* vertices = triangles + 3 * static_cast<size_t>(triangle);
+        float tHit, uHit, vHit;
+        if (BoundingVolumeHierarchy::intersectTriangle(localOrigin, localDirection, points[vertices[0]],
+                                                       points[vertices[1]], points[vertices[2]], tHit, uHit, vHit)
+            && tHit < t)
+        {
+            t = tHit;
+            cell = triangle;
+            u = uHit;
+            v = vHit;
+            return true;
+        }
+        return false;
+    });
+
+    if (isHit)
+    {
+        result.item = this;
+        result.cell = cell;
+        result.u = u;
+        result.v = v;
+        result.distance = tMax;
+        result.point = origin + tMax * direction;
+    }
+    return isHit;
+}
+
+
+
+void Graphics3DItem::computeTriangleBoxes(const QVector3D* points, const unsigned int* triangles, size_t numTriangles,
+                                          std::vector<BoundingVolumeHierarchy::Box>& boxes)
+{
+    boxes.resize(numTriangles);
+    for (size_t i = 0; i < numTriangles; i++)
+    {
+        const QVector3D& p0 = points[triangles[3 * i]];
+        const QVector3D& p1 = points[triangles[3 * i + 1]];
+        const QVector3D& p2 = points[triangles[3 * i + 2]];
+        for (int k = 0; k < 3; k++)
+        {
+            boxes[i].min[k] = std::min(p0[k], std::min(p1[k], p2[k]));
+            boxes[i].max[k] = std::max(p0[k], std::max(p1[k], p2[k]));
+        }
+    }
+}
 };
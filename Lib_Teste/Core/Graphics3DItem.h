@@ -1,11 +1,51 @@
 #pragma once
 
+#include <limits>
 #include "GraphicsItem.h"
 #include "../Geometry/AxisAligmentBoundingBox.h"
+#include "../Geometry/BoundingVolumeHierarchy.h"
 #include "../Shading/ShadingModel.h"
 
 namespace rm
 {
+class Graphics3DItem;
+
+/**
+ * @brief The PickResult struct - Nearest item hit by a ray.
+ */
+struct PickResult
+{
+    /**
+     * @brief item - Item hit, or nullptr if the ray missed all items.
+     */
+    Graphics3DItem* item {nullptr};
+
+    /**
+     * @brief cell - Cell hit: the triangle of a triangle mesh or the quadrilateral of a quad mesh.
+     */
+    unsigned int cell {0};
+
+    /**
+     * @brief u - Barycentric coordinate of the second triangle vertex on the hit point.
+     */
+    float u {0.0f};
+
+    /**
+     * @brief v - Barycentric coordinate of the third triangle vertex on the hit point.
+     */
+    float v {0.0f};
+
+    /**
+     * @brief distance - Ray parameter of the hit. It is the world distance when the ray direction is normalized.
+     */
+    float distance {std::numeric_limits<float>::infinity()};
+
+    /**
+     * @brief point - Hit point in world coordinates.
+     */
+    QVector3D point;
+};
+
 class Graphics3DItem: public GraphicsItem
 {
 public:
@@ -60,6 +100,50 @@ public:
      * @param viewMatrix - matrix to be set
      */
     void setViewMatrix(const OpenGLMatrix &viewMatrix);
+
+    /**
+     * @brief intersectRay - Intersects a ray with the item. The default implementation never hits.
+     * @param origin - Ray origin in world coordinates.
+     * @param direction - Ray direction in world coordinates.
+     * @param result - Nearest hit so far. It is replaced only if the item is hit closer.
+     * @return - Returns true if the item was hit closer than the previous result.
+     */
+    virtual bool intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result);
+
+protected:
+    /**
+     * @brief intersectTriangles - Intersects a ray with a triangle list using a BVH. The BVH is built on the first
+     * call, and must be cleared when the triangles change.
+     * @param origin - Ray origin in world coordinates.
+     * @param direction - Ray direction in world coordinates.
+     * @param points - Points in model coordinates.
+     * @param triangles - Three point indexes per triangle.
+     * @param numTriangles - Number of triangles.
+     * @param bvh - BVH over the triangles.
+     * @param result - Nearest hit so far. Its cell is the triangle index.
+     * @return - Returns true if a triangle was hit closer than the previous result.
+     */
+    bool intersectTriangles(const QVector3D& origin, const QVector3D& direction, const QVector3D* points,
+                            const unsigned int* triangles, size_t numTriangles, BoundingVolumeHierarchy& bvh,
+                            PickResult& result);
+
+    /**
+     * @brief computeTriangleBoxes - Computes the bounds of each triangle of a triangle list.
+     * @param points - Points.
+     * @param triangles - Three point indexes per triangle.
+     * @param numTriangles - Number of triangles.
+     * @param boxes - Receives the bounds.
+     */
+    static void computeTriangleBoxes(const QVector3D* points, const unsigned int* triangles, size_t numTriangles,
+                                     std::vector<BoundingVolumeHierarchy::Box>& boxes);
+
+    /**
+     * @brief getPixelsPerUnit - Estimates the size on screen of a model unit, from the projected size of the AABB
+     * given by the view.
+     * @return - Returns the number of pixels of a model unit, or infinity if the item is not measured.
+     */
+    float getPixelsPerUnit() const;
+
 protected:
      /**
       * @brief _shadingModel - The shading model.
@@ -76,12 +160,23 @@ protected:
       */
      AABB3D _aabb;
 
+     /**
+      * @brief _projectedSize - Size in pixels of the AABB on the view that is rendering the item.
+      */
+     float _projectedSize {std::numeric_limits<float>::infinity()};
+
 private:
     /**
      * @brief setShadingModel - Sets a shading model to the 3D item.
      * @param m - the shading model.
      */
     void setShadingModel(ShadingModel m);
+
+    /**
+     * @brief setProjectedSize - Sets the size of the item AABB on the view that renders it.
+     * @param size - Largest side, in pixels, of the screen box of the projected AABB.
+     */
+    void setProjectedSize(float size);
 };
 };
 
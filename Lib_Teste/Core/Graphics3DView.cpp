@@ -1,6 +1,8 @@
 #include "Graphics3DView.h"
 #include "Graphics3DItem.h"
+#include "../Shading/LightSource.h"
 #include <cmath>
+#include <limits>
 
 namespace rm
 {
@@ -106,6 +108,10 @@ QQuaternion Graphics3DView::screenToArcSphere(const Point2Df& screen)
 
 void Graphics3DView::paintGL()
 {
+    _profiler.beginFrame();
+    _submittedItems = 0;
+    _culledItems = 0;
+    _reusedItems = 0;
     glEnable(GL_DEPTH_TEST);
     glClearColor(0.7f, 0.7f, 0.7f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -114,27 +120,74 @@ void Graphics3DView::paintGL()
     OpenGLMatrix modelview = _view.multMatrix(_sceneModel);
     _view.pop();
 
-    //Render 3d items
-    const std::list<GraphicsItem *>& itemsList = _scene->items();
-    for(auto item : itemsList)
+    _proj.push();
+    OpenGLMatrix mvp = _proj.multMatrix(modelview);
+    _proj.pop();
+
+    //The items read the camera and the first light of the shading model from the view block.
+    LightSource light = _shadingModel.getLightSource(0);
+    const Color& ambient = light.getAmbientComponent();
+    const Color& diffuse = light.getDiffuseComponent();
+    const QVector4D& lightPosition = light.getLightPosition();
+
+    ViewUniforms viewUniforms;
+    viewUniforms.setProjection(_proj.topMatrix());
+    viewUniforms.setView(modelview.topMatrix());
+    viewUniforms.lightAmbient[0] = ambient.redF();
+    viewUniforms.lightAmbient[1] = ambient.greenF();
+    viewUniforms.lightAmbient[2] = ambient.blueF();
+    viewUniforms.lightDiffuse[0] = diffuse.redF();
+    viewUniforms.lightDiffuse[1] = diffuse.greenF();
+    viewUniforms.lightDiffuse[2] = diffuse.blueF();
+    viewUniforms.lightPosition[0] = lightPosition.x();
+    viewUniforms.lightPosition[1] = lightPosition.y();
+    viewUniforms.lightPosition[2] = lightPosition.z();
+    viewUniforms.lightPosition[3] = lightPosition.w();
+    _frameUniforms.beginFrame(viewUniforms);
+
+    //Skip the items whose world AABB is outside the frustum.
+    const std::vector<Graphics3DItem*>& items3D = _scene->items3D();
+    std::vector<Graphics3DItem*> items;
+    if (_isCullingEnabled)
+    {
+        _scene->items3DIn(mvp.topMatrix(), items);
+    }
+    else
     {
-        Graphics3DItem* item3d = dynamic_cast<Graphics3DItem*>(item);
+        items.assign(items3D.begin(), items3D.end());
+    }
 
-        if (item3d && item3d->isVisible())
+    //Render 3d items
+    unsigned int rendered = 0;
+    for(auto item3d : items)
+    {
+        if (item3d->isVisible())
         {
             item3d->setProjectionMatrix(_proj);
             item3d->setViewMatrix(modelview);
             item3d->setShadingModel(_shadingModel);
+            item3d->setProjectedSize(computeProjectedSize(mvp.topMatrix() * item3d->getModelMatrix().topMatrix(),
+                                                          item3d->getAABB()));
+            _profiler.beginItem(item3d);
             item3d->render(id());
+            rendered++;
         }
 
     }
+    _profiler.endSection();
+    countItems(rendered, static_cast<unsigned int>(items3D.size() - items.size()), 0);
 
     if (_rectangleZoom.isVisible())
     {
          glDisable(GL_DEPTH_TEST);
+        _profiler.beginSection("Overlays");
         _rectangleZoom.render(id());
+        _profiler.endSection();
     }
+    _frameUniforms.endFrame();
+    _profiler.endFrame();
+
+    renderStatisticsOverlay();
 }
 
 
@@ -279,23 +332,80 @@ void Graphics3DView::zoomInOut(float zoomFactor, const AABB3D& aabb)
 
 
 
-QVector3D Graphics3DView::computeRayDirection(const Point2Df& )
+QVector3D Graphics3DView::computeRayDirection(const Point2Df& screenPosition)
 {
-//    //Compute angle.
-//    constexpr double PI = 3.14159265358979323846;
-//    const float angle = _camera.fovy / 2;
-//    const double radAngle = static_cast<double>(angle) * PI / 180.0;
+    _proj.push();
+    OpenGLMatrix viewProj = _proj.multMatrix(_view);
+    _proj.pop();
+
+    QVector3D origin, direction;
+    computeRay(screenPosition, viewProj.topMatrix().inverted(), origin, direction);
+    return direction;
+}
 
-//    //Compute auxiliar variables.
-//    float df = _camera.zNear;
-//    float h = 2 * df * static_cast<float>(tan(radAngle));
-//    float w = h * width() / height();
 
-//    //Compute the ray direction.
-//    QVector4D direction = -_camera.zNear * _view.row(2) + h * (screenPosition.y() / height() - 0.5f) * _view.row(1)
-//            + w * (screenPosition.x() / width() - 0.5f) * _view.row(0);
 
-    return QVector3D();
+void Graphics3DView::computeRay(const Point2Df& screenPosition, const QMatrix4x4& inverse, QVector3D& origin,
+                                QVector3D& direction) const
+{
+    //Normalized device coordinates. The screen y axis points down.
+    float x = 2.0f * screenPosition.x() / width() - 1.0f;
+    float y = 1.0f - 2.0f * screenPosition.y() / height();
+
+    QVector4D nearPoint = inverse * QVector4D(x, y, -1.0f, 1.0f);
+    QVector4D farPoint = inverse * QVector4D(x, y, 1.0f, 1.0f);
+
+    origin = nearPoint.toVector3D() / nearPoint.w();
+    direction = (farPoint.toVector3D() / farPoint.w() - origin).normalized();
+}
+
+
+
+void Graphics3DView::pick(const Point2Df& screenPoint, PickResult& result)
+{
+    //The items are rendered with the scene transformations, so the ray is unprojected through them too.
+    _view.push();
+    OpenGLMatrix modelview = _view.multMatrix(_sceneModel);
+    _view.pop();
+
+    _proj.push();
+    OpenGLMatrix mvp = _proj.multMatrix(modelview);
+    _proj.pop();
+
+    QVector3D origin, direction;
+    computeRay(screenPoint, mvp.topMatrix().inverted(), origin, direction);
+    _scene->pick3D(origin, direction, result);
+}
+
+
+
+float Graphics3DView::computeProjectedSize(const QMatrix4x4& mvp, const AABB3D& aabb) const
+{
+    const QVector3D& minCorner = aabb.getMinCornerPoint();
+    const QVector3D& maxCorner = aabb.getMaxCornerPoint();
+
+    QVector2D screenMin(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    QVector2D screenMax(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+    for (int i = 0; i < 8; i++)
+    {
+        QVector4D corner(i & 1 ? maxCorner.x() : minCorner.x(),
+                         i & 2 ? maxCorner.y() : minCorner.y(),
+                         i & 4 ? maxCorner.z() : minCorner.z(), 1.0f);
+        QVector4D clip = mvp * corner;
+        if (clip.w() <= 0.0f)
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+
+        QVector2D ndc(clip.x() / clip.w(), clip.y() / clip.w());
+        screenMin = QVector2D(std::min(screenMin.x(), ndc.x()), std::min(screenMin.y(), ndc.y()));
+        screenMax = QVector2D(std::max(screenMax.x(), ndc.x()), std::max(screenMax.y(), ndc.y()));
+    }
+
+    //The normalized device coordinates span two units across the framebuffer.
+    float pixelRatio = static_cast<float>(devicePixelRatioF());
+    return 0.5f * pixelRatio * std::max((screenMax.x() - screenMin.x()) * width(),
+                                        (screenMax.y() - screenMin.y()) * height());
 }
 
 
@@ -391,5 +501,8 @@ void Graphics3DView::newCameraParameters(const Camera& c, const OpenGLMatrix& sc
 {
     lookAt(c.eye,c.center,c.up);
     _sceneModel = sceneTransformations;
+
+    //The scene has not changed, so the view must ask for its own repaint.
+    _scene->update(this);
 }
 }
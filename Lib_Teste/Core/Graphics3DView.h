@@ -10,6 +10,8 @@
 
 namespace rm
 {
+struct PickResult;
+
 class Graphics3DView : public GraphicsView
 {
     Q_OBJECT
@@ -156,6 +158,13 @@ public:
      */
     void desynchronizeWith(const Graphics3DView* view);
 
+    /**
+     * @brief pick - Finds the nearest visible 3D item under a screen point.
+     * @param screenPoint - Point on canvas coordinate system.
+     * @param result - Receives the nearest hit. Its item is nullptr if no item is under the point.
+     */
+    void pick(const Point2Df& screenPoint, PickResult& result);
+
     struct Camera
     {
            /**
@@ -222,12 +231,32 @@ private:
     virtual ~Graphics3DView() override = default;
 
     /**
-     * @brief computeRayDirection
-     * @param screenPosition
-     * @return
+     * @brief computeRayDirection - Computes the direction of the ray from the eye through a screen point, in the
+     * camera world coordinates (without the scene transformations).
+     * @param screenPosition - Point on canvas coordinate system.
+     * @return - Normalized ray direction.
      */
     QVector3D computeRayDirection(const Point2Df& screenPosition);
 
+    /**
+     * @brief computeRay - Computes the ray through a screen point by unprojecting it on the near and far planes.
+     * @param screenPosition - Point on canvas coordinate system.
+     * @param inverse - Inverse of the matrix from the ray coordinates to the clip coordinates.
+     * @param origin - Receives the ray origin, on the near plane.
+     * @param direction - Receives the normalized ray direction.
+     */
+    void computeRay(const Point2Df& screenPosition, const QMatrix4x4& inverse, QVector3D& origin,
+                    QVector3D& direction) const;
+
+    /**
+     * @brief computeProjectedSize - Computes the size on screen of a box, used to choose the item levels of detail.
+     * @param mvp - Matrix from the box coordinates to the clip coordinates.
+     * @param aabb - Box.
+     * @return - Returns the largest side, in pixels, of the screen box of the projected corners, or infinity if a
+     * corner is behind the camera.
+     */
+    float computeProjectedSize(const QMatrix4x4& mvp, const AABB3D& aabb) const;
+
     /**
      * @brief screenToArcSphere - covert screen coordinates in arc sphere quaternion.
      * @param screen - screen coordinates.
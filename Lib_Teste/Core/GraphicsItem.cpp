@@ -3,6 +3,7 @@
 #include <QOpenGLFunctions>
 
 #include<QOpenGLShaderProgram>
+#include "RenderProfiler.h"
 
 namespace rm
 {
@@ -22,14 +23,22 @@ const QVector4D &GraphicsItem::getBrushColor() const
 
 void GraphicsItem::setBrushColor(const QVector4D& color)
 {
-    _brushColor = color;
+    if (_brushColor != color)
+    {
+        _brushColor = color;
+        appearanceChanged();
+    }
 }
 
 
 
 void GraphicsItem::setBrushColor(const QVector3D& color)
 {
-    _brushColor = QVector4D(color, 1.0f);
+    if (_brushColor != QVector4D(color, 1.0f))
+    {
+        _brushColor = QVector4D(color, 1.0f);
+        appearanceChanged();
+    }
 }
 
 
@@ -43,14 +52,22 @@ const QVector4D &GraphicsItem::getPenColor() const
 
 void GraphicsItem::setPenColor(const QVector4D& color)
 {
-   _penColor = color;
+   if (_penColor != color)
+   {
+       _penColor = color;
+       appearanceChanged();
+   }
 }
 
 
 
 void GraphicsItem::setPenColor(const QVector3D& color)
 {
-   _penColor = QVector4D(color, 1.0f);
+   if (_penColor != QVector4D(color, 1.0f))
+   {
+       _penColor = QVector4D(color, 1.0f);
+       appearanceChanged();
+   }
 }
 
 
@@ -64,7 +81,11 @@ bool GraphicsItem::isVisible() const
 
 void GraphicsItem::visible(bool visible)
 {
-    _visible = visible;
+    if (_visible != visible)
+    {
+        _visible = visible;
+        appearanceChanged();
+    }
 }
 
 
@@ -120,7 +141,11 @@ bool GraphicsItem::isOnFocus() const
 
 void GraphicsItem::onFocus(bool onFocus)
 {
-    _onFocus = onFocus;
+    if (_onFocus != onFocus)
+    {
+        _onFocus = onFocus;
+        appearanceChanged();
+    }
 }
 
 
@@ -142,6 +167,7 @@ const std::string& GraphicsItem::getName() const
 void GraphicsItem::setModelToIdentity()
 {
     _modelMatrix.loadIdentity();
+    modelMatrixChanged();
 }
 
 
@@ -150,6 +176,7 @@ void GraphicsItem::translate(const QVector3D& t)
 {
     //_modelMatrix.translate(t);
     _modelMatrix.translate(t.x(), t.y(), t.z());
+    modelMatrixChanged();
 }
 
 
@@ -158,6 +185,7 @@ void GraphicsItem::scale(const QVector3D& s)
 {
     //_modelMatrix.scale(s);
     _modelMatrix.scale(s.x(), s.y(), s.z());
+    modelMatrixChanged();
 }
 
 
@@ -166,6 +194,7 @@ void GraphicsItem::rotate(const QVector3D& r, const float angle)
 {
     //_modelMatrix.rotate(angle, r);
     _modelMatrix.rotate(angle, r.x(), r.y(), r.z());
+    modelMatrixChanged();
 }
 
 
@@ -173,6 +202,7 @@ void GraphicsItem::rotate(const QVector3D& r, const float angle)
 void GraphicsItem::setModelMatrix(const OpenGLMatrix& m)
 {
     _modelMatrix = m;
+    modelMatrixChanged();
 }
 
 
@@ -194,12 +224,14 @@ void GraphicsItem::pushModelMatrix()
 void GraphicsItem::popModelMatrix()
 {
     _modelMatrix.pop();
+    modelMatrixChanged();
 }
 
 
 void GraphicsItem::multModelMatrix(const OpenGLMatrix &m)
 {
     _modelMatrix.multMatrix(m);
+    modelMatrixChanged();
 }
 
 
@@ -207,5 +239,103 @@ void GraphicsItem::multModelMatrix(const OpenGLMatrix &m)
 void GraphicsItem::multLefModelMatrix(const OpenGLMatrix &m)
 {
     _modelMatrix.multLeftMatrix(m);
+    modelMatrixChanged();
+}
+
+
+
+void GraphicsItem::modelMatrixChanged()
+{
+}
+
+
+
+void GraphicsItem::appearanceChanged()
+{
+}
+
+
+
+QOpenGLShaderProgram* GraphicsItem::acquireProgram(const ShaderProgramKey& key)
+{
+    if (_programRegistry.isNull())
+    {
+        _programRegistry = ShaderProgramRegistry::current();
+    }
+    return _programRegistry->acquire(key);
+}
+
+
+
+void GraphicsItem::releaseProgram(QOpenGLShaderProgram*& program)
+{
+    //If the registry is gone, the program was already deleted with it.
+    if (program != nullptr && !_programRegistry.isNull())
+    {
+        _programRegistry->release(program);
+    }
+    program = nullptr;
+}
+
+
+
+int GraphicsItem::programUniformLocation(QOpenGLShaderProgram* program, const char* name)
+{
+    return _programRegistry->uniformLocation(program, name);
+}
+
+
+
+void GraphicsItem::bindProgram(QOpenGLShaderProgram* program)
+{
+    program->bind();
+    RenderProfiler::countProgramBind();
+}
+
+
+
+QOpenGLVertexArrayObject* GraphicsItem::createVertexArray()
+{
+    QOpenGLVertexArrayObject* vao = new QOpenGLVertexArrayObject();
+    vao->create();
+    RenderProfiler::countVaoCreation();
+    return vao;
+}
+
+
+
+void GraphicsItem::glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    QOpenGLFunctions::glDrawArrays(mode, first, count);
+    RenderProfiler::countDrawCall();
+}
+
+
+
+void GraphicsItem::glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+    QOpenGLFunctions::glDrawElements(mode, count, type, indices);
+    RenderProfiler::countDrawCall();
+}
+
+
+
+void GraphicsItem::glBufferData(GLenum target, qopengl_GLsizeiptr size, const void* data, GLenum usage)
+{
+    QOpenGLFunctions::glBufferData(target, size, data, usage);
+
+    //A null pointer just allocates the buffer.
+    if (data != nullptr)
+    {
+        RenderProfiler::countUploadedBytes(size);
+    }
+}
+
+
+
+void GraphicsItem::glBufferSubData(GLenum target, qopengl_GLintptr offset, qopengl_GLsizeiptr size, const void* data)
+{
+    QOpenGLFunctions::glBufferSubData(target, offset, size, data);
+    RenderProfiler::countUploadedBytes(size);
 }
 }
@@ -3,11 +3,14 @@
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
+#include <QPointer>
 #include <QVector4D>
 #include <algorithm>
 #include "../Geometry/OpenGLMatrix.h"
 
 #include "../Geometry/Vector2D.h"
+#include "../Shading/ShaderProgramRegistry.h"
+#include "FrameUniforms.h"
 
 class Texture;
 class Font;
@@ -244,6 +247,78 @@ public:
     * @param m - Matrix to be multiplied to the current matrix.
     */
    virtual void multLefModelMatrix(const OpenGLMatrix &m);
+protected:
+    /**
+     * @brief modelMatrixChanged - Called after any change on the model matrix. The default implementation does nothing.
+     */
+    virtual void modelMatrixChanged();
+
+    /**
+     * @brief appearanceChanged - Called after a change on colors, visibility or focus. The default implementation does
+     * nothing.
+     */
+    virtual void appearanceChanged();
+
+    /**
+     * @brief acquireProgram - Gets a shared program from the registry of the current context share group. Items that
+     * use the same shader sources share the same compiled program.
+     * @param key - Shader sources.
+     * @return - Returns the shared program.
+     */
+    QOpenGLShaderProgram* acquireProgram(const ShaderProgramKey& key);
+
+    /**
+     * @brief releaseProgram - Gives back a program acquired by acquireProgram and sets the pointer to nullptr.
+     * @param program - Program to be released.
+     */
+    void releaseProgram(QOpenGLShaderProgram*& program);
+
+    /**
+     * @brief programUniformLocation - Gets the cached location of an uniform variable of a shared program.
+     * @param program - Program returned by acquireProgram.
+     * @param name - Uniform variable name.
+     * @return - Returns the uniform location.
+     */
+    int programUniformLocation(QOpenGLShaderProgram* program, const char* name);
+
+    /**
+     * @brief bindProgram - Binds a program and counts the bind on the render profiler.
+     * @param program - Program to be bound.
+     */
+    void bindProgram(QOpenGLShaderProgram* program);
+
+    /**
+     * @brief createVertexArray - Creates a new vertex array object and counts it on the render profiler. Needs a
+     * current context.
+     * @return - Returns the new VAO. The item owns it.
+     */
+    QOpenGLVertexArrayObject* createVertexArray();
+
+    /**
+     * The functions below hide the QOpenGLFunctions ones, so the draw calls and the uploads of all items are counted
+     * on the render profiler.
+     */
+
+    /**
+     * @brief glDrawArrays - Counts the draw call and calls QOpenGLFunctions::glDrawArrays.
+     */
+    void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+
+    /**
+     * @brief glDrawElements - Counts the draw call and calls QOpenGLFunctions::glDrawElements.
+     */
+    void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
+    /**
+     * @brief glBufferData - Counts the uploaded bytes and calls QOpenGLFunctions::glBufferData.
+     */
+    void glBufferData(GLenum target, qopengl_GLsizeiptr size, const void* data, GLenum usage);
+
+    /**
+     * @brief glBufferSubData - Counts the uploaded bytes and calls QOpenGLFunctions::glBufferSubData.
+     */
+    void glBufferSubData(GLenum target, qopengl_GLintptr offset, qopengl_GLsizeiptr size, const void* data);
+
 protected:
 
     /**
@@ -305,5 +380,10 @@ protected:
     * @brief _onFocus - Define if the item has focus or not.
     */
    bool _onFocus {false};
+
+   /**
+    * @brief _programRegistry - Registry where the item programs were acquired.
+    */
+   QPointer<ShaderProgramRegistry> _programRegistry;
 };
 }
@@ -1,5 +1,6 @@
 #include "GraphicsScene.h"
 #include "GraphicsItem.h"
+#include "Graphics2DItem.h"
 #include "Graphics3DItem.h"
 #include "Graphics2DView.h"
 #include "Graphics3DView.h"
@@ -10,9 +11,11 @@
 #include "../Events/GraphicsSceneMoveEvent.h"
 #include "../Events/GraphicsScenePressEvent.h"
 #include "../Events/GraphicsSceneWheelEvent.h"
+#include "../Shading/ShaderProgramRegistry.h"
 #include <iostream>
 #include <algorithm>
 #include <iterator>
+#include <cmath>
 
 namespace rm
 {
@@ -42,6 +45,9 @@ GraphicsScene::GraphicsScene() :
         printf("Scene doesn't share with global\n");
     }
 
+    //Programs are shared by all contexts of the group, so items on all views use the same registry.
+    _programRegistry = ShaderProgramRegistry::fromContext(&_glContext);
+
     //Create default shading model
     createShadingModel();
 }
@@ -50,6 +56,10 @@ GraphicsScene::GraphicsScene() :
 
 GraphicsScene::~GraphicsScene()
 {
+    //Stop the loader thread before the items and the context are destroyed.
+    delete _itemLoader;
+    _itemLoader = nullptr;
+
     makeCurrent();
 
     //Delete all tools in the stack. As tools can contain items, they must be deleted before the items.
@@ -73,6 +83,8 @@ GraphicsScene::~GraphicsScene()
     doneCurrent();
 
     _itemsList.clear();
+    _items2DList.clear();
+    _items3DList.clear();
 
     deleteAllViews();
 
@@ -91,6 +103,9 @@ GraphicsScene::~GraphicsScene()
 
 bool GraphicsScene::removeView(GraphicsView* view)
 {
+    //Views are removed by their destructor, so the scheduler forgets them even if the scene deleted them.
+    _frameScheduler.removeView(view);
+
     //Remove view from conteiner.
     return _views.erase( view->id()) > 0;
 }
@@ -126,8 +141,16 @@ std::vector<ShadingModel>& GraphicsScene::getShadingModels()
 
 
 
+ShaderProgramRegistry* GraphicsScene::getProgramRegistry() const
+{
+    return _programRegistry;
+}
+
+
+
 void GraphicsScene::popTool()
 {
+    flushPendingMoveEvents();
 
     topTool()->finalize();
     _toolStack.pop();
@@ -143,6 +166,8 @@ void GraphicsScene::popTool()
 
 void GraphicsScene::pushTool(GraphicsTool* tool)
 {
+    flushPendingMoveEvents();
+
     makeCurrent();
     if( !isToolStackEmpty())
     {
@@ -165,6 +190,43 @@ GraphicsTool* GraphicsScene::topTool()
 
 
 
+void GraphicsScene::updatePickIndex()
+{
+    _pickBoxes.resize(_items3DList.size());
+    for (size_t i = 0; i < _items3DList.size(); i++)
+    {
+        AABB3D aabb = _items3DList[i]->getModelMatrix().topMatrix() * _items3DList[i]->getAABB();
+        for (int k = 0; k < 3; k++)
+        {
+            _pickBoxes[i].min[k] = aabb.getMinCornerPoint()[k];
+            _pickBoxes[i].max[k] = aabb.getMaxCornerPoint()[k];
+        }
+    }
+
+    if (_pickItems != _items3DList)
+    {
+        _pickItems = _items3DList;
+        _pickIndex.build(_pickBoxes);
+    }
+    else
+    {
+        _pickIndex.refit(_pickBoxes);
+    }
+}
+
+
+
+void GraphicsScene::flushPendingMoveEvents()
+{
+    //The coalesced events belong to the tool that was on top when they were received.
+    for (auto& view : _views)
+    {
+        view.second->flushPendingMoveEvent();
+    }
+}
+
+
+
 bool GraphicsScene::isToolStackEmpty() const
 {
     return _toolStack.empty();
@@ -189,6 +251,8 @@ void GraphicsScene::bringForward(const SelectionGroup2DItem *item)
            }
         }
    }
+
+    updatePartitions();
 }
 
 
@@ -211,6 +275,8 @@ void GraphicsScene::sendBackward(const SelectionGroup2DItem* item)
 
        }
    }
+
+    updatePartitions();
 }
 
 
@@ -236,6 +302,8 @@ void GraphicsScene::bringToFront(const SelectionGroup2DItem* items)
             ++it;
         }
     }
+
+    updatePartitions();
 }
 
 
@@ -270,6 +338,8 @@ void GraphicsScene::sendToBack(const SelectionGroup2DItem *items)
             rit++;
         }
     }
+
+    updatePartitions();
 }
 
 
@@ -279,22 +349,15 @@ Graphics2DView* GraphicsScene::create2DView(QWidget* parent)
     //Create a new view.
     Graphics2DView* new2DView = new Graphics2DView(this, parent);
 
-    //Connect signals to slots.
-    for (auto it = _views.begin(); it != _views.end(); it++)
-    {
-        //connect update to all former created views.
-        QObject::connect(new2DView, SIGNAL(signalUpdate()),
-                         it->second, SLOT(onUpdate()));
-        QObject::connect(it->second, SIGNAL(signalUpdate()),
-                         new2DView, SLOT(onUpdate()));
-    }
-
     //Get the view id.
     int id = new2DView->id();
 
     //Add to current views container.
     _views[id] = new2DView;
 
+    //The scheduler decides when the view is repainted.
+    _frameScheduler.addView(new2DView);
+
     return new2DView;
 }
 
@@ -307,22 +370,15 @@ Graphics3DView* GraphicsScene::create3DView(QWidget* parent)
 
     new3DView->setShadingModel(_shadingModels[0]);
 
-    //Connect signals to slots.
-    for (auto it = _views.begin(); it != _views.end(); it++)
-    {
-        //connect update to all former created views.
-        QObject::connect(new3DView, SIGNAL(signalUpdate()),
-                         it->second, SLOT(onUpdate()));
-        QObject::connect(it->second, SIGNAL(signalUpdate()),
-                         new3DView, SLOT(onUpdate()));
-    }
-
     //Get the view id.
     int id = new3DView->id();
 
     //Add to current views container.
     _views[id] = new3DView;
 
+    //The scheduler decides when the view is repainted.
+    _frameScheduler.addView(new3DView);
+
     return new3DView;
 }
 
@@ -352,24 +408,21 @@ const AABB2D GraphicsScene::computeAABB2D() const
 
     //TODO: Currently, this search is necessary to find the first valid 2d aabb.
     //A concept of invalid aabb while doing a += operation could avoid this.
-    for(auto item : _itemsList)
+    auto it = _items2DList.begin();
+    for(; it != _items2DList.end(); ++it)
     {
-        Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
-
-        if(item2d && item2d->isVisible())
+        if((*it)->isVisible())
         {
-            sceneAABB = item2d->getAABBRender(item2d->getPixelSize());
+            sceneAABB = (*it)->getAABBRender((*it)->getPixelSize());
             break;
         }
     }
 
-    for(auto item : _itemsList)
+    for(; it != _items2DList.end(); ++it)
     {
-        Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
-
-        if(item2d && item2d->isVisible())
+        if((*it)->isVisible())
         {
-            sceneAABB += item2d->getAABBRender(item2d->getPixelSize());
+            sceneAABB += (*it)->getAABBRender((*it)->getPixelSize());
         }
     }
 
@@ -384,24 +437,21 @@ const AABB3D GraphicsScene::computeAABB3D() const
 
     //TODO: Currently, this search is necessary to find the first valid 2d aabb.
     //A concept of invalid aabb while doing a += operation could avoid this.
-    for(auto item : _itemsList)
+    auto it = _items3DList.begin();
+    for(; it != _items3DList.end(); ++it)
     {
-        Graphics3DItem* item3d = dynamic_cast<Graphics3DItem*>(item);
-
-        if(item3d && item3d->isVisible())
+        if((*it)->isVisible())
         {
-            sceneAABB = item3d->getModelMatrix().topMatrix() * item3d->getAABB();
+            sceneAABB = (*it)->getModelMatrix().topMatrix() * (*it)->getAABB();
             break;
         }
     }
 
-    for(auto item : _itemsList)
+    for(; it != _items3DList.end(); ++it)
     {
-        Graphics3DItem* item3d = dynamic_cast<Graphics3DItem*>(item);
-
-        if(item3d && item3d->isVisible())
+        if((*it)->isVisible())
         {
-            sceneAABB += item3d->getModelMatrix().topMatrix() * item3d->getAABB();
+            sceneAABB += (*it)->getModelMatrix().topMatrix() * (*it)->getAABB();
         }
     }
 
@@ -519,6 +569,8 @@ void GraphicsScene::addItem(GraphicsItem* item)
     makeCurrent();
     item->initialize();
     doneCurrent();
+
+    insertOnPartition(item);
 }
 
 
@@ -529,6 +581,60 @@ void GraphicsScene::addItem(GraphicsItem* item, std::list<GraphicsItem*>::const_
     makeCurrent();
     item->initialize();
     doneCurrent();
+
+    //The item is not at the end of the list, so the partitions must be rebuilt.
+    insertOnIndex(item);
+    updatePartitions();
+}
+
+
+
+unsigned int GraphicsScene::addItemAsync(const ItemFactory& factory, const ItemLoadCallbacks& callbacks)
+{
+    if (_itemLoader == nullptr)
+    {
+        _itemLoader = new AsyncItemLoader(this, _glContext.format());
+    }
+    return _itemLoader->load(factory, callbacks);
+}
+
+
+
+unsigned int GraphicsScene::warmUpPrograms(const ItemLoadCallbacks& callbacks)
+{
+    ShaderProgramRegistry* registry = _programRegistry;
+    return addItemAsync([registry](AsyncItemLoad& load) -> GraphicsItem*
+    {
+        QOpenGLContext* context = QOpenGLContext::currentContext();
+        if (context == nullptr)
+        {
+            return nullptr;
+        }
+
+        registry->warmUp(ShaderProgramRegistry::getLibraryPrograms(), [&load](float progress)
+        {
+            load.setProgress(progress);
+        });
+
+        //The programs must be linked before other contexts of the group use them.
+        context->functions()->glFinish();
+        return nullptr;
+    }, callbacks);
+}
+
+
+
+bool GraphicsScene::cancelItemLoad(unsigned int id)
+{
+    return _itemLoader != nullptr && _itemLoader->cancel(id);
+}
+
+
+
+void GraphicsScene::publishItem(GraphicsItem* item)
+{
+    _itemsList.push_back(item);
+    insertOnPartition(item);
 }
 
 
@@ -547,6 +653,7 @@ std::list<GraphicsItem*>::const_iterator GraphicsScene::removeItem(GraphicsItem*
     if (it != _itemsList.end())
     {
         it = _itemsList.erase(it);
+        removeFromPartition(item);
     }
     else
     {
@@ -601,23 +708,69 @@ void GraphicsScene::clearFocus()
 
 
 
-/*const std::vector<GraphicsItem*>& GraphicsScene::collidingItens(GraphicsItem* item) const
+std::list<GraphicsItem*> GraphicsScene::collidingItens(GraphicsItem* item) const
 {
-    return nullptr;
-}*/
+    std::list<GraphicsItem*> collidingItems;
+
+    Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    if (item2d == nullptr)
+    {
+        return collidingItems;
+    }
+
+    //Get the item AABB in world space.
+    AABB2D aabb = item2d->getModelMatrix().topMatrix() * item2d->getAABB();
+
+    std::vector<Graphics2DItem*> candidates;
+    if (_itemIndexMethod == ItemIndexMethod::AABBTreeIndex)
+    {
+        updateIndex();
+        _itemIndex.query(aabb, Point2Df(0.0f, 0.0f), candidates);
+    }
+    else
+    {
+        candidates = _items2DList;
+    }
+
+    //Test the real AABBs, since the index stores enlarged ones.
+    for (Graphics2DItem* other2d : candidates)
+    {
+        if (other2d != item2d && collidingWith(item2d, other2d))
+        {
+            collidingItems.push_back(other2d);
+        }
+    }
+
+    return collidingItems;
+}
 
 
 
-bool GraphicsScene::collidingWith(GraphicsItem* , GraphicsItem* )
+bool GraphicsScene::collidingWith(GraphicsItem* item, GraphicsItem* itemColliding) const
 {
-	return false;
+    Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    Graphics2DItem* other2d = dynamic_cast<Graphics2DItem*>(itemColliding);
+
+    if (item2d == nullptr || other2d == nullptr)
+    {
+        return false;
+    }
+
+    //Get the AABBs in world space.
+    AABB2D a = item2d->getModelMatrix().topMatrix() * item2d->getAABB();
+    AABB2D b = other2d->getModelMatrix().topMatrix() * other2d->getAABB();
+
+    return a.getMinCornerPoint().x() <= b.getMaxCornerPoint().x() &&
+           b.getMinCornerPoint().x() <= a.getMaxCornerPoint().x() &&
+           a.getMinCornerPoint().y() <= b.getMaxCornerPoint().y() &&
+           b.getMinCornerPoint().y() <= a.getMaxCornerPoint().y();
 }
 
 
 
-bool GraphicsScene::itemIscolliding(GraphicsItem* )
+bool GraphicsScene::itemIscolliding(GraphicsItem* item) const
 {
-	return false;
+    return !collidingItens(item).empty();
 }
 
 
@@ -692,13 +845,148 @@ bool GraphicsScene::isActive() const
 
 
 
-const GraphicsItem* GraphicsScene::itemAt(double , double , QTransform ) const
+const GraphicsItem* GraphicsScene::itemAt(double x, double y, QTransform transform) const
 {
+    //Get the pixel size from the transformation scale.
+    float sx = static_cast<float>(std::hypot(transform.m11(), transform.m12()));
+    float sy = static_cast<float>(std::hypot(transform.m21(), transform.m22()));
+    Point2Df pixelSize(sx > 0.0f ? 1.0f / sx : 0.0f, sy > 0.0f ? 1.0f / sy : 0.0f);
+
+    Point2Df p(static_cast<float>(x), static_cast<float>(y));
+
+    std::vector<Graphics2DItem*> candidates;
+    items2DAt(p, pixelSize, candidates);
+
+    //The last items are rendered over the first ones.
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+    {
+        Graphics2DItem* item2d = *it;
+        if (item2d->isVisible())
+        {
+            item2d->setPixelSize(pixelSize);
+            if (item2d->isIntersecting(p))
+            {
+                return item2d;
+            }
+        }
+    }
+
     return nullptr;
 }
 
 
 
+void GraphicsScene::items2DAt(const Point2Df& p, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const
+{
+    items.clear();
+
+    if (_itemIndexMethod == ItemIndexMethod::AABBTreeIndex)
+    {
+        updateIndex();
+
+        //The index gives candidates, whose AABB are tested in model space as the linear search does.
+        _itemIndex.query(p, pixelSize, items);
+        items.erase(std::remove_if(items.begin(), items.end(), [&](Graphics2DItem* item2d)
+        {
+            return !item2d->isInsideToItemAABB(p, pixelSize);
+        }), items.end());
+    }
+    else
+    {
+        for (auto item2d : _items2DList)
+        {
+            if (item2d->isInsideToItemAABB(p, pixelSize))
+            {
+                items.push_back(item2d);
+            }
+        }
+    }
+}
+
+
+
+void GraphicsScene::items2DIn(const AABB2D& box, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const
+{
+    items.clear();
+
+    if (_itemIndexMethod == ItemIndexMethod::AABBTreeIndex)
+    {
+        updateIndex();
+        _itemIndex.query(box, pixelSize, items);
+    }
+    else
+    {
+        const Point2Df& minCorner = box.getMinCornerPoint();
+        const Point2Df& maxCorner = box.getMaxCornerPoint();
+        for (auto item2d : _items2DList)
+        {
+            AABB2D aabb = item2d->getModelMatrix().topMatrix() * item2d->getAABBRender(pixelSize);
+            if (aabb.getMinCornerPoint().x() <= maxCorner.x() && minCorner.x() <= aabb.getMaxCornerPoint().x() &&
+                aabb.getMinCornerPoint().y() <= maxCorner.y() && minCorner.y() <= aabb.getMaxCornerPoint().y())
+            {
+                items.push_back(item2d);
+            }
+        }
+    }
+}
+
+
+
+void GraphicsScene::items3DIn(const QMatrix4x4& viewProjection, std::vector<Graphics3DItem*>& items)
+{
+    items.clear();
+    updatePickIndex();
+
+    //Frustum planes in world coordinates, taken from the rows of the clip matrix.
+    QVector4D planes[6];
+    for (int i = 0; i < 3; i++)
+    {
+        planes[2 * i] = viewProjection.row(3) + viewProjection.row(i);
+        planes[2 * i + 1] = viewProjection.row(3) - viewProjection.row(i);
+    }
+
+    std::vector<unsigned int> indexes;
+    _pickIndex.query(planes, 6, [&](unsigned int index)
+    {
+        const BoundingVolumeHierarchy::Box& box = _pickBoxes[index];
+        if (!BoundingVolumeHierarchy::isBoxOutside(box.min, box.max, planes, 6))
+        {
+            indexes.push_back(index);
+        }
+    });
+
+    //The items keep the scene order.
+    std::sort(indexes.begin(), indexes.end());
+    items.reserve(indexes.size());
+    for (unsigned int index : indexes)
+    {
+        items.push_back(_pickItems[index]);
+    }
+}
+
+
+
+void GraphicsScene::pick3D(const QVector3D& origin, const QVector3D& direction, PickResult& result)
+{
+    result = PickResult();
+    updatePickIndex();
+
+    //Each item is tested against the nearest hit so far, so the farther items are culled by their boxes.
+    float tMax = result.distance;
+    _pickIndex.intersect(origin, direction, tMax, [&](unsigned int index, float& t)
+    {
+        Graphics3DItem* item3d = _pickItems[index];
+        if (item3d->isVisible() && item3d->intersectRay(origin, direction, result))
+        {
+            t = result.distance;
+            return true;
+        }
+        return false;
+    });
+}
+
+
+
 const std::list<GraphicsItem *> &GraphicsScene::items() const
 {
     return _itemsList;
@@ -713,6 +1001,20 @@ std::list<GraphicsItem *> &GraphicsScene::items()
 
 
 
+const std::vector<Graphics2DItem*>& GraphicsScene::items2D() const
+{
+    return _items2DList;
+}
+
+
+
+const std::vector<Graphics3DItem*>& GraphicsScene::items3D() const
+{
+    return _items3DList;
+}
+
+
+
 const GraphicsItem* GraphicsScene::mouseGrabberItem() const
 {
     return nullptr;
@@ -746,45 +1048,346 @@ bool GraphicsScene::sendEvent(std::list<GraphicsItem *> & , GraphicsSceneEvent*
 
 
 
-void* GraphicsScene::itemIndexMethod()
+ItemIndexMethod GraphicsScene::itemIndexMethod() const
 {
-    return nullptr;
+    return _itemIndexMethod;
 }
 
 
 
-void GraphicsScene::setItemIndexMethod(void* )
+void GraphicsScene::setItemIndexMethod(ItemIndexMethod indexMethod)
 {
+    if (indexMethod == _itemIndexMethod)
+    {
+        return;
+    }
+
+    //Remove all items from the current index.
+    for (auto item : _itemsList)
+    {
+        removeFromIndex(item);
+    }
+
+    _itemIndexMethod = indexMethod;
+
+    //Build the new index.
+    _nextIndexOrder = 0;
+    for (auto item : _itemsList)
+    {
+        insertOnIndex(item);
+    }
 }
 
 
 
-QRect GraphicsScene::boundingBox() const
+void GraphicsScene::itemGeometryChanged(Graphics2DItem* item)
 {
-    return QRect();
+    //The views must be redrawn on the next frame.
+    _frameScheduler.sceneChanged();
+    damageItem(item);
+
+    if (_itemIndexMethod == ItemIndexMethod::NoIndex || item->_isIndexOutdated)
+    {
+        return;
+    }
+
+    //Just mark the item. Many changes can be done before the next query.
+    item->_isIndexOutdated = true;
+    _outdatedIndexItems.push_back(item);
 }
 
 
 
-void GraphicsScene::setBoudingBox(QRect )
+void GraphicsScene::itemAppearanceChanged(Graphics2DItem* item)
 {
+    _frameScheduler.sceneChanged();
+    damageItem(item);
 }
 
 
 
-void GraphicsScene::update(const QRectF & )
+void GraphicsScene::itemUpdateRequested(Graphics2DItem* item)
 {
+    damageItem(item);
+    _frameScheduler.sceneChanged();
+    _frameScheduler.requestUpdate();
 }
 
 
 
-void GraphicsScene::update()
+void GraphicsScene::damageItem(Graphics2DItem* item)
+{
+    for (auto& view : _views)
+    {
+        Graphics2DView* view2d = dynamic_cast<Graphics2DView*>(view.second);
+        if (view2d != nullptr)
+        {
+            view2d->damageItem(item);
+        }
+    }
+}
+
+
+
+void GraphicsScene::damageRemovedItem(const Graphics2DItem* item)
+{
+    for (auto& view : _views)
+    {
+        Graphics2DView* view2d = dynamic_cast<Graphics2DView*>(view.second);
+        if (view2d != nullptr)
+        {
+            view2d->damageRemovedItem(item);
+        }
+    }
+}
+
+
+
+void GraphicsScene::damageAll()
+{
+    for (auto& view : _views)
+    {
+        Graphics2DView* view2d = dynamic_cast<Graphics2DView*>(view.second);
+        if (view2d != nullptr)
+        {
+            view2d->invalidateFrameCache();
+        }
+    }
+}
+
+
+
+void GraphicsScene::itemDestroyed(Graphics2DItem* item)
+{
+    damageRemovedItem(item);
+    removeFromIndex(item);
+}
+
+
+
+void GraphicsScene::insertOnIndex(GraphicsItem* item)
+{
+    Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    if (item2d == nullptr)
+    {
+        return;
+    }
+
+    item2d->_scene = this;
+    if (_itemIndexMethod == ItemIndexMethod::AABBTreeIndex)
+    {
+        _itemIndex.insert(item2d, _nextIndexOrder++);
+    }
+}
+
+
+
+void GraphicsScene::removeFromIndex(GraphicsItem* item)
+{
+    Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    if (item2d == nullptr || item2d->_scene != this)
+    {
+        return;
+    }
+
+    if (item2d->_isIndexOutdated)
+    {
+        auto it = std::find(_outdatedIndexItems.begin(), _outdatedIndexItems.end(), item2d);
+        if (it != _outdatedIndexItems.end())
+        {
+            _outdatedIndexItems.erase(it);
+        }
+        item2d->_isIndexOutdated = false;
+    }
+
+    _itemIndex.remove(item2d);
+    item2d->_scene = nullptr;
+}
+
+
+
+void GraphicsScene::updateIndex() const
+{
+    //Items can notify new changes while their AABB is computed, so the list is swapped before the update.
+    std::vector<Graphics2DItem*> outdatedItems;
+    outdatedItems.swap(_outdatedIndexItems);
+
+    for (Graphics2DItem* item2d : outdatedItems)
+    {
+        _itemIndex.update(item2d);
+        item2d->_isIndexOutdated = false;
+    }
+}
+
+
+
+void GraphicsScene::updateIndexOrder()
+{
+    if (_itemIndexMethod == ItemIndexMethod::NoIndex)
+    {
+        return;
+    }
+
+    //The 2D items vector has the same order of the items list.
+    _nextIndexOrder = 0;
+    for (auto item2d : _items2DList)
+    {
+        _itemIndex.setOrder(item2d, _nextIndexOrder++);
+    }
+}
+
+
+
+void GraphicsScene::insertOnPartition(GraphicsItem* item)
+{
+    //The items drawn by the views have changed.
+    _frameScheduler.sceneChanged();
+
+    Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    if (item2d != nullptr)
+    {
+        _items2DList.push_back(item2d);
+        insertOnIndex(item2d);
+        damageItem(item2d);
+        return;
+    }
+
+    Graphics3DItem* item3d = dynamic_cast<Graphics3DItem*>(item);
+    if (item3d != nullptr)
+    {
+        _items3DList.push_back(item3d);
+    }
+}
+
+
+
+void GraphicsScene::removeFromPartition(GraphicsItem* item)
+{
+    //The items drawn by the views have changed.
+    _frameScheduler.sceneChanged();
+
+    Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    if (item2d != nullptr)
+    {
+        _items2DList.erase(std::remove(_items2DList.begin(), _items2DList.end(), item2d), _items2DList.end());
+        removeFromIndex(item2d);
+        damageRemovedItem(item2d);
+        return;
+    }
+
+    Graphics3DItem* item3d = dynamic_cast<Graphics3DItem*>(item);
+    if (item3d != nullptr)
+    {
+        _items3DList.erase(std::remove(_items3DList.begin(), _items3DList.end(), item3d), _items3DList.end());
+    }
+}
+
+
+
+void GraphicsScene::updatePartitions()
+{
+    //The drawing order has changed.
+    _frameScheduler.sceneChanged();
+    damageAll();
+
+    _items2DList.clear();
+    _items3DList.clear();
+
+    for (auto item : _itemsList)
+    {
+        Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+        if (item2d != nullptr)
+        {
+            _items2DList.push_back(item2d);
+            continue;
+        }
+
+        Graphics3DItem* item3d = dynamic_cast<Graphics3DItem*>(item);
+        if (item3d != nullptr)
+        {
+            _items3DList.push_back(item3d);
+        }
+    }
+
+    updateIndexOrder();
+}
+
+
+
+QRect GraphicsScene::boundingBox() const
+{
+    return _sceneBoundingBox;
+}
+
+
+
+void GraphicsScene::setBoudingBox(QRect rect)
 {
-    if (_views.size() > 0)
+    if (_sceneBoundingBox != rect)
+    {
+        _sceneBoundingBox = rect;
+        sceneBoundingBoxChanged(rect);
+    }
+}
+
+
+
+void GraphicsScene::update(const QRectF& rect)
+{
+    AABB2D region(Point2Df(static_cast<float>(rect.left()), static_cast<float>(rect.top())),
+                  Point2Df(static_cast<float>(rect.right()), static_cast<float>(rect.bottom())));
+
+    for (auto& view : _views)
     {
-        _views.begin()->second->update();
-        emit _views[0]->signalUpdate();
+        Graphics2DView* view2d = dynamic_cast<Graphics2DView*>(view.second);
+        if (view2d != nullptr)
+        {
+            view2d->damageRegion(region);
+        }
     }
+
+    //Views without damage tracking redraw everything.
+    _frameScheduler.sceneChanged();
+    _frameScheduler.requestUpdate();
+}
+
+
+
+void GraphicsScene::update()
+{
+    damageAll();
+
+    //Explicit updates may follow changes the scene does not track, like item colors.
+    _frameScheduler.sceneChanged();
+    _frameScheduler.requestUpdate();
+}
+
+
+
+void GraphicsScene::update(GraphicsView* view)
+{
+    _frameScheduler.requestUpdate(view);
+}
+
+
+
+FrameScheduler& GraphicsScene::getFrameScheduler()
+{
+    return _frameScheduler;
+}
+
+
+
+void GraphicsScene::setEventRecorder(GraphicsSceneEventRecorder* recorder)
+{
+    _eventRecorder = recorder;
+}
+
+
+
+GraphicsSceneEventRecorder* GraphicsScene::getEventRecorder() const
+{
+    return _eventRecorder;
 }
 
 
@@ -801,8 +1404,12 @@ void GraphicsScene::clearSelection()
 
 
 
-void GraphicsScene::changed(const std::list<QRectF>& )
+void GraphicsScene::changed(const std::list<QRectF>& region)
 {
+    for (const QRectF& rect : region)
+    {
+        update(rect);
+    }
 }
 
 
@@ -821,6 +1428,8 @@ void GraphicsScene::focusItemChanged(GraphicsItem* newFocusItem, GraphicsItem* o
 
 void GraphicsScene::sceneBoundingBoxChanged(const QRect& )
 {
+    //The views may show a different region, so everything is redrawn.
+    update();
 }
 
 
@@ -17,18 +17,43 @@
 #include "../Shading/ShadingModel.h"
 #include "../Events/EventConstants.h"
 #include "../Geometry/AxisAligmentBoundingBox.h"
+#include "../Geometry/BoundingVolumeHierarchy.h"
+#include "Graphics2DItemIndex.h"
+#include "FrameScheduler.h"
+#include "AsyncItemLoader.h"
 
 
 namespace rm
 {
+/**
+ * @brief The ItemIndexMethod enum - Methods used by the scene to find items on a region.
+ */
+enum class ItemIndexMethod : unsigned char
+{
+    /**
+     * Items are searched by a linear scan of the scene items.
+     */
+    NoIndex,
+
+    /**
+     * 2D items are stored in a dynamic AABB tree.
+     */
+    AABBTreeIndex
+};
+
 class Path;
 class Polyline;
 class GraphicsItem;
 class GraphicsSceneEvent;
+class GraphicsSceneEventRecorder;
 class GraphicsView;
+class Graphics2DItem;
+class Graphics3DItem;
 class Graphics2DView;
 class Graphics3DView;
+struct PickResult;
 class SelectionGroup2DItem;
+class ShaderProgramRegistry;
 class GraphicsScene
 {    
 public:
@@ -37,6 +62,21 @@ public:
      */
     friend class GraphicsView;
 
+    /**
+     * Allow the loader to add items already initialized by its thread.
+     */
+    friend class AsyncItemLoader;
+
+    /**
+     * Allow a Graphics2DItem object to notify its geometry changes.
+     */
+    friend class Graphics2DItem;
+
+    /**
+     * Allow the replayer to find the views of the recorded events.
+     */
+    friend class GraphicsSceneEventReplayer;
+
     /**
      * @brief GraphicsScene Creates a new scene, without any items.
      */
@@ -152,6 +192,33 @@ public:
      */
     void addItem(GraphicsItem* item, std::list<GraphicsItem*>::const_iterator pos);
 
+    /**
+     * @brief addItemAsync - Builds an item and uploads its OpenGL resources on a loader thread, so large meshes do not
+     * freeze the GUI. The item is added at the end of the items list when its upload has finished.
+     * @param factory - Function that builds the item on the loader thread. It should report progress and check
+     * cancellation through its AsyncItemLoad argument.
+     * @param callbacks - Progress and finished functions, called on the GUI thread.
+     * @return - Returns the load identifier.
+     */
+    unsigned int addItemAsync(const ItemFactory& factory, const ItemLoadCallbacks& callbacks = ItemLoadCallbacks());
+
+    /**
+     * @brief warmUpPrograms - Builds all library shader programs on the loader thread, so the first items of each type
+     * do not wait for the compilation on the GUI thread. The loader runs it as an item load that adds no item, so its
+     * finished callback is called with nullptr. If the platform does not support OpenGL on other threads, nothing is
+     * built and the items build their programs as before.
+     * @param callbacks - Progress and finished functions, called on the GUI thread.
+     * @return - Returns the load identifier.
+     */
+    unsigned int warmUpPrograms(const ItemLoadCallbacks& callbacks = ItemLoadCallbacks());
+
+    /**
+     * @brief cancelItemLoad - Cancels a load started by addItemAsync. Its finished callback is called with nullptr.
+     * @param id - Load identifier.
+     * @return - Returns true if the load was pending and false otherwise.
+     */
+    bool cancelItemLoad(unsigned int id);
+
     /**
      * @brief isItemOnScene - Verify if the item is on scene.
      * @param item - Item to be checked.
@@ -225,14 +292,11 @@ public:
     void clearFocus();
 
     /**
-     * TODO: Returns the vector of itens that collide with a given item.
-     */
-    /**
-     * @brief collidingItens Returns the vector of itens that collide with a given item.
+     * @brief collidingItens Returns the list of 2D itens whose world AABB overlaps the world AABB of a given item.
      * @param item GraphicsItem to test collision
-     * @return List of collided items
+     * @return List of collided items sorted by the scene order
      */
-    const std::list<GraphicsItem*>& collidingItens(GraphicsItem * item) const;
+    std::list<GraphicsItem*> collidingItens(GraphicsItem * item) const;
 
     /**
      * @brief collidingWith  Receives two itens and returns if the they are colliding or not.
@@ -240,14 +304,14 @@ public:
      * @param itemColliding GraphicsItem2 to test collision
      * @return True or false if collides or not
      */
-    bool collidingWith(GraphicsItem * item, GraphicsItem * itemColliding);
+    bool collidingWith(GraphicsItem * item, GraphicsItem * itemColliding) const;
 
     /**
      * @brief itemIscolliding Returns if the given item is colliding with any other item in the scene or not.
      * @param item GraphicsItem to check collision with any other GraphicsItem on the scene
      * @return True if the given item is colliding with any other item from scene and False does not.
      */
-    bool itemIscolliding(GraphicsItem * item);
+    bool itemIscolliding(GraphicsItem * item) const;
 
     /**
      * @brief Returns the scene's item in focus
@@ -298,9 +362,48 @@ public:
 
     /**
      * @brief Returns the topmost visible item at the specified position, or 0 if there are no items at this position.
+     * @param x - x world coordinate.
+     * @param y - y world coordinate.
+     * @param transform - Transformation from world to screen. Its scale defines the pixel size used to test points
+     * and lines, which have sizes in pixels.
      */
     const GraphicsItem* itemAt(double x, double y, QTransform transform) const;
 
+    /**
+     * @brief items2DAt - Finds the 2D items whose render AABB contains a point. The exact intersection is not tested.
+     * @param p - Point in world coordinates.
+     * @param pixelSize - Pixel size in world metrics.
+     * @param items - Vector to receive the items, sorted from back to front.
+     */
+    void items2DAt(const Point2Df& p, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const;
+
+    /**
+     * @brief items2DIn - Finds the 2D items whose world render AABB may overlap a box. Some items outside the box can
+     * be returned, since just the AABBs are tested.
+     * @param box - Box in world coordinates.
+     * @param pixelSize - Pixel size in world metrics.
+     * @param items - Vector to receive the items, sorted from back to front.
+     */
+    void items2DIn(const AABB2D& box, const Point2Df& pixelSize, std::vector<Graphics2DItem*>& items) const;
+
+    /**
+     * @brief items3DIn - Finds the 3D items whose world AABB may be inside a view frustum. The items are culled by the
+     * BVH used to pick them, so a frame only pays for the items near the view.
+     * @param viewProjection - Matrix from world to clip coordinates.
+     * @param items - Vector to receive the items, in the scene order.
+     */
+    void items3DIn(const QMatrix4x4& viewProjection, std::vector<Graphics3DItem*>& items);
+
+    /**
+     * @brief pick3D - Finds the nearest visible 3D item hit by a ray. The items are first culled by a BVH over their
+     * world AABBs, which is rebuilt when the 3D items change and refitted on each pick, since the item transformations
+     * are not notified to the scene.
+     * @param origin - Ray origin in world coordinates.
+     * @param direction - Ray direction in world coordinates.
+     * @param result - Receives the nearest hit. Its item is nullptr if no item was hit.
+     */
+    void pick3D(const QVector3D& origin, const QVector3D& direction, PickResult& result);
+
     /**
      * @brief itens - Returns an ordered list of all items on the scene. The order is by visibility on the scene.
      * @return - list of all items.
@@ -313,6 +416,18 @@ public:
      */
     std::list<GraphicsItem*>& items();
 
+    /**
+     * @brief items2D - Returns the 2D items on the scene, ordered by visibility as items().
+     * @return - Vector of 2D items.
+     */
+    const std::vector<Graphics2DItem*>& items2D() const;
+
+    /**
+     * @brief items3D - Returns the 3D items on the scene, ordered by visibility as items().
+     * @return - Vector of 3D items.
+     */
+    const std::vector<Graphics3DItem*>& items3D() const;
+
     /**
      * @brief Returns the current item that is grabbed , or null if no item is currently grabbed by the mouse. The mouse
      * grabber item is the item that receives all mouse events sent to the scene.
@@ -348,12 +463,12 @@ public:
     /**
      * @brief This property holds the item indexing method.
      */
-    void* itemIndexMethod();
+    ItemIndexMethod itemIndexMethod() const;
 
     /**
-     * @brief Sets the ItemIndexMethod using a function that is given by parameter.
+     * @brief Sets the method used to find items on scene. The index is rebuilt when the method changes.
      */
-    void setItemIndexMethod(void* indexMethod);
+    void setItemIndexMethod(ItemIndexMethod indexMethod);
 
     /**
      * @brief This function returns the  box that involves scene.
@@ -375,6 +490,32 @@ public:
      */
     void update();
 
+    /**
+     * @brief Schedules a redraw of a single view. Other views are redrawn on the same frame only if the scene has
+     * changed since their last redraw.
+     * @param view - View to be redrawn.
+     */
+    void update(GraphicsView* view);
+
+    /**
+     * @brief getFrameScheduler - Returns the scheduler that coalesces the redraws of the scene views.
+     * @return - Frame scheduler of the scene.
+     */
+    FrameScheduler& getFrameScheduler();
+
+    /**
+     * @brief setEventRecorder - Sets the recorder of the events that the views dispatch to the tools. The scene does
+     * not take its ownership.
+     * @param recorder - Event recorder, or nullptr to detach the current one.
+     */
+    void setEventRecorder(GraphicsSceneEventRecorder* recorder);
+
+    /**
+     * @brief getEventRecorder - Gets the event recorder of the scene.
+     * @return - Returns the recorder, or nullptr if there is none.
+     */
+    GraphicsSceneEventRecorder* getEventRecorder() const;
+
     /**
      * @brief Removes and deletes all items from the scene, but otherwise leaves the state of the scene unchanged.
      */
@@ -436,6 +577,12 @@ public:
      */
     std::vector<ShadingModel>& getShadingModels();
 
+    /**
+     * @brief getProgramRegistry - Returns the registry that shares shader programs among the scene items.
+     * @return - Registry of the scene context share group.
+     */
+    ShaderProgramRegistry* getProgramRegistry() const;
+
     /**
      * @brief popTool - Removes the tool in the top of the stack
      */
@@ -497,17 +644,134 @@ private:
      * @return - return true if this view is on GraphicsScene container and false otherwise.
      */
     bool removeView(GraphicsView* view);
+
+    /**
+     * @brief flushPendingMoveEvents - Dispatches the move events coalesced by the views to the current top tool.
+     */
+    void flushPendingMoveEvents();
+
+    /**
+     * @brief updatePickIndex - Updates the world AABB of the 3D items and rebuilds or refits the BVH over them.
+     */
+    void updatePickIndex();
+
+    /**
+     * @brief publishItem - Adds an item already initialized by the loader thread at the end of the items list.
+     * @param item - Initialized item.
+     */
+    void publishItem(GraphicsItem* item);
+
+    /**
+     * @brief itemGeometryChanged - Marks a 2D item to be updated on index before the next query.
+     * @param item - Changed item.
+     */
+    void itemGeometryChanged(Graphics2DItem* item);
+
+    /**
+     * @brief itemAppearanceChanged - Marks the scene content as changed, so all views are redrawn on the next frame.
+     * @param item - Changed item.
+     */
+    void itemAppearanceChanged(Graphics2DItem* item);
+
+    /**
+     * @brief itemUpdateRequested - Damages a 2D item and schedules a frame to redraw it.
+     * @param item - Item to be redrawn.
+     */
+    void itemUpdateRequested(Graphics2DItem* item);
+
+    /**
+     * @brief damageItem - Marks the region of a 2D item to be redrawn by the 2D views.
+     * @param item - Changed item.
+     */
+    void damageItem(Graphics2DItem* item);
+
+    /**
+     * @brief damageRemovedItem - Marks the last drawn region of a removed 2D item to be redrawn by the 2D views.
+     * @param item - Removed item.
+     */
+    void damageRemovedItem(const Graphics2DItem* item);
+
+    /**
+     * @brief damageAll - Makes the 2D views redraw all items on the next frame.
+     */
+    void damageAll();
+
+    /**
+     * @brief itemDestroyed - Removes a 2D item that is being deleted from the index.
+     * @param item - Deleted item.
+     */
+    void itemDestroyed(Graphics2DItem* item);
+
+    /**
+     * @brief insertOnPartition - Adds an item at the end of the 2D or 3D items vector and inserts it on index.
+     * @param item - New scene item added at the end of the items list.
+     */
+    void insertOnPartition(GraphicsItem* item);
+
+    /**
+     * @brief removeFromPartition - Removes an item from the 2D or 3D items vector and from index.
+     * @param item - Item removed from scene.
+     */
+    void removeFromPartition(GraphicsItem* item);
+
+    /**
+     * @brief updatePartitions - Rebuilds the 2D and 3D items vectors from the items list. Used after the items list
+     * is reordered.
+     */
+    void updatePartitions();
+
+    /**
+     * @brief insertOnIndex - Inserts an item on index if it is a 2D item.
+     * @param item - New scene item.
+     */
+    void insertOnIndex(GraphicsItem* item);
+
+    /**
+     * @brief removeFromIndex - Removes an item from index if it is a 2D item.
+     * @param item - Item removed from scene.
+     */
+    void removeFromIndex(GraphicsItem* item);
+
+    /**
+     * @brief updateIndex - Updates the index with all outdated items.
+     */
+    void updateIndex() const;
+
+    /**
+     * @brief updateIndexOrder - Renumbers the items order on index. Used after the items list is reordered.
+     */
+    void updateIndexOrder();
 private:
     /**
      * @brief _itemsList List of itens in the scene.
      */
     std::list<GraphicsItem*>_itemsList;
 
+    /**
+     * @brief _items2DList 2D items of the scene in the same order of _itemsList. It avoids type checks on each frame.
+     */
+    std::vector<Graphics2DItem*> _items2DList;
+
+    /**
+     * @brief _items3DList 3D items of the scene in the same order of _itemsList. It avoids type checks on each frame.
+     */
+    std::vector<Graphics3DItem*> _items3DList;
+
     /**
      * @brief _views Store all views that render this scene.
      */
     std::map<int, GraphicsView*> _views;
 
+    /**
+     * @brief _frameScheduler Coalesces the redraw requests of the views.
+     */
+    FrameScheduler _frameScheduler;
+
+    /**
+     * @brief _eventRecorder Recorder of the events dispatched to the tools. It is not owned by the scene.
+     */
+    GraphicsSceneEventRecorder* _eventRecorder {nullptr};
+
     /**
      * @brief _shadingModels Store _shadingModels avaliable to the scene.
      */
@@ -519,9 +783,39 @@ private:
     GraphicsItem* _mouseGrabberItem;
 
     /**
-     * @brief _ItemIndexMethod Pointer to the function that indexes itens to the scene.
+     * @brief _itemIndexMethod Method used to find items on scene.
+     */
+    ItemIndexMethod _itemIndexMethod {ItemIndexMethod::AABBTreeIndex};
+
+    /**
+     * @brief _itemIndex Index over the 2D items world AABB.
+     */
+    mutable Graphics2DItemIndex _itemIndex;
+
+    /**
+     * @brief _outdatedIndexItems 2D items changed after the last index update.
      */
-	void* _ItemIndexMethod;
+    mutable std::vector<Graphics2DItem*> _outdatedIndexItems;
+
+    /**
+     * @brief _pickIndex BVH over the world AABB of the 3D items, used to pick and to cull them.
+     */
+    BoundingVolumeHierarchy _pickIndex;
+
+    /**
+     * @brief _pickItems 3D items on _pickIndex, in the order used to build it.
+     */
+    std::vector<Graphics3DItem*> _pickItems;
+
+    /**
+     * @brief _pickBoxes World AABB of the 3D items on _pickIndex, from the last update.
+     */
+    std::vector<BoundingVolumeHierarchy::Box> _pickBoxes;
+
+    /**
+     * @brief _nextIndexOrder Order given to the next item added at the end of the items list.
+     */
+    unsigned int _nextIndexOrder {0};
 
     /**
      * @brief _backGroundColor Background color of the scene
@@ -553,6 +847,11 @@ private:
      */
     GraphicsItem* _itemInFocus;
 
+    /**
+     * @brief _itemLoader Loader thread used by addItemAsync. It is created on the first asynchronous load.
+     */
+    AsyncItemLoader* _itemLoader {nullptr};
+
     /**
      * @brief _glContext OpenGL context to create all OpenGL buffers to scene.
      */
@@ -563,6 +862,11 @@ private:
      */
     QOffscreenSurface _surface;
 
+    /**
+     * @brief _programRegistry Shared shader programs used by the items of the scene.
+     */
+    ShaderProgramRegistry* _programRegistry {nullptr};
+
     /**
      * @brief _enableEvents Store all current enable events.
      */
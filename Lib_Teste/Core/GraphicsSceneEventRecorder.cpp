@@ -0,0 +1,289 @@
+#include "GraphicsSceneEventRecorder.h"
+#include "../Events/GraphicsScenePressEvent.h"
+#include "../Events/GraphicsSceneMoveEvent.h"
+#include "../Events/GraphicsSceneHoverEvent.h"
+#include "../Events/GraphicsSceneKeyEvent.h"
+#include "../Events/GraphicsSceneWheelEvent.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+/**
+ * @brief RECORDING_MAGIC - First word of a recording file.
+ */
+const quint32 RECORDING_MAGIC = 0x524d4556;
+
+/**
+ * @brief RECORDING_VERSION - Version of the recording file. It must be changed with the file layout.
+ */
+const quint32 RECORDING_VERSION = 1;
+
+
+
+/**
+ * @brief writePoint - Writes a point to the stream.
+ */
+void writePoint(QDataStream& stream, const rm::Point2Df& point)
+{
+    stream << point[0] << point[1];
+}
+
+
+
+/**
+ * @brief readPoint - Reads a point from the stream.
+ */
+rm::Point2Df readPoint(QDataStream& stream)
+{
+    float x = 0.0f, y = 0.0f;
+    stream >> x >> y;
+    return rm::Point2Df(x, y);
+}
+}
+
+namespace rm
+{
+void GraphicsSceneEventRecorder::start()
+{
+    _events.clear();
+    _timer.start();
+    _recording = true;
+}
+
+
+
+void GraphicsSceneEventRecorder::stop()
+{
+    _recording = false;
+}
+
+
+
+bool GraphicsSceneEventRecorder::isRecording() const
+{
+    return _recording;
+}
+
+
+
+void GraphicsSceneEventRecorder::clear()
+{
+    _events.clear();
+}
+
+
+
+void GraphicsSceneEventRecorder::record(int viewId, const GraphicsScenePressEvent& event)
+{
+    RecordedEvent& recorded = append(viewId, EventType::PressEvent);
+    recorded.globalPosition = event.getGlobalPosition();
+    recorded.localPosition = event.getLocalPosition();
+    recorded.screenPosition = event.getScreenPosition();
+    recorded.windowPosition = event.getWindowPosition();
+    recorded.worldPosition = event.getWorldPosition();
+    recorded.buttons = static_cast<MouseButtons>(event.getButton());
+    recorded.modifiers = event.getKeyboardModifiers();
+    recorded.buttonAction = event.getMouseButtonAction();
+}
+
+
+
+void GraphicsSceneEventRecorder::record(int viewId, const GraphicsSceneMoveEvent& event)
+{
+    RecordedEvent& recorded = append(viewId, EventType::MoveEvent);
+    recorded.globalPosition = event.getGlobalPosition();
+    recorded.localPosition = event.getLocalPosition();
+    recorded.screenPosition = event.getScreenPosition();
+    recorded.windowPosition = event.getWindowPosition();
+    recorded.worldPosition = event.getWorldPosition();
+    recorded.oldWorldPosition = event.getOldWorldPosition();
+    recorded.firstWorldPosition = event.getFirstWorldPosition();
+    recorded.buttons = event.getButtons();
+    recorded.modifiers = event.getKeyboardModifiers();
+}
+
+
+
+void GraphicsSceneEventRecorder::record(int viewId, const GraphicsSceneHoverEvent& event)
+{
+    RecordedEvent& recorded = append(viewId, EventType::HoverEvent);
+    recorded.globalPosition = event.getGlobalPositon();
+    recorded.localPosition = event.getLocalPosition();
+    recorded.screenPosition = event.getScreenPosition();
+    recorded.windowPosition = event.getWindowPosition();
+    recorded.worldPosition = event.getWorldPosition();
+    recorded.oldWorldPosition = event.getOldWorldPosition();
+    recorded.firstWorldPosition = event.getFirstWorldPosition();
+    recorded.modifiers = event.getKeyboardModifiers();
+}
+
+
+
+void GraphicsSceneEventRecorder::record(int viewId, const GraphicsSceneKeyEvent& event)
+{
+    RecordedEvent& recorded = append(viewId, EventType::keyEvent);
+    recorded.keyAction = event.getKeyEventType();
+    recorded.modifiers = event.getKeyboardModifiers();
+    recorded.key = event.getKey();
+    recorded.count = event.getCount();
+    recorded.autoRepeat = event.isAutoRepeat();
+    recorded.text = event.text();
+}
+
+
+
+void GraphicsSceneEventRecorder::record(int viewId, const GraphicsSceneWheelEvent& event)
+{
+    RecordedEvent& recorded = append(viewId, EventType::WheelEvent);
+    recorded.globalPosition = event.getGlobalPosition();
+    recorded.localPosition = event.getPosition();
+    recorded.buttons = event.getButtons();
+    recorded.modifiers = event.getKeyboardModifiers();
+    recorded.delta = event.getDelta();
+    recorded.orientation = event.getOrientation();
+}
+
+
+
+void GraphicsSceneEventRecorder::record(int viewId, EventType type)
+{
+    append(viewId, type);
+}
+
+
+
+const std::vector<RecordedEvent>& GraphicsSceneEventRecorder::getEvents() const
+{
+    return _events;
+}
+
+
+
+bool GraphicsSceneEventRecorder::save(const std::string& filename) const
+{
+    QSaveFile file(QString::fromStdString(filename));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        std::cout << "Could not write " << filename << std::endl;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << RECORDING_MAGIC << RECORDING_VERSION << static_cast<quint32>(_events.size());
+
+    for (const RecordedEvent& event : _events)
+    {
+        stream << static_cast<qint64>(event.time) << static_cast<qint32>(event.viewId)
+               << static_cast<quint32>(event.type);
+        writePoint(stream, event.globalPosition);
+        writePoint(stream, event.localPosition);
+        writePoint(stream, event.screenPosition);
+        writePoint(stream, event.windowPosition);
+        writePoint(stream, event.worldPosition);
+        writePoint(stream, event.oldWorldPosition);
+        writePoint(stream, event.firstWorldPosition);
+        stream << static_cast<quint8>(event.buttons) << static_cast<quint8>(event.modifiers)
+               << static_cast<quint8>(event.buttonAction) << static_cast<qint32>(event.delta)
+               << static_cast<quint8>(event.orientation) << static_cast<quint8>(event.keyAction)
+               << static_cast<qint32>(event.key) << static_cast<qint32>(event.count) << event.autoRepeat
+               << QString::fromStdString(event.text);
+    }
+
+    if (stream.status() != QDataStream::Ok || !file.commit())
+    {
+        std::cout << "Could not write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+
+bool GraphicsSceneEventRecorder::load(const std::string& filename)
+{
+    _recording = false;
+    _events.clear();
+
+    QFile file(QString::fromStdString(filename));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        std::cout << "Could not open " << filename << std::endl;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0, version = 0, numberOfEvents = 0;
+    stream >> magic >> version >> numberOfEvents;
+    if (magic != RECORDING_MAGIC || version != RECORDING_VERSION)
+    {
+        std::cout << filename << " is not an event recording of the current version" << std::endl;
+        return false;
+    }
+
+    //The count comes from the file, so it only limits the reservation.
+    _events.reserve(std::min<quint32>(numberOfEvents, 1u << 20));
+    for (quint32 i = 0; i < numberOfEvents && stream.status() == QDataStream::Ok; i++)
+    {
+        RecordedEvent event;
+        qint64 time = 0;
+        qint32 viewId = 0, delta = 0, key = 0, count = 0;
+        quint32 type = 0;
+        quint8 buttons = 0, modifiers = 0, buttonAction = 0, orientation = 0, keyAction = 0;
+        QString text;
+
+        stream >> time >> viewId >> type;
+        event.globalPosition = readPoint(stream);
+        event.localPosition = readPoint(stream);
+        event.screenPosition = readPoint(stream);
+        event.windowPosition = readPoint(stream);
+        event.worldPosition = readPoint(stream);
+        event.oldWorldPosition = readPoint(stream);
+        event.firstWorldPosition = readPoint(stream);
+        stream >> buttons >> modifiers >> buttonAction >> delta >> orientation >> keyAction >> key >> count
+               >> event.autoRepeat >> text;
+
+        event.time = time;
+        event.viewId = viewId;
+        event.type = static_cast<EventType>(type);
+        event.buttons = buttons;
+        event.modifiers = modifiers;
+        event.buttonAction = static_cast<MouseButtonAction>(buttonAction);
+        event.delta = delta;
+        event.orientation = static_cast<Orientation>(orientation);
+        event.keyAction = static_cast<KeyAction>(keyAction);
+        event.key = key;
+        event.count = count;
+        event.text = text.toStdString();
+        _events.push_back(event);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        std::cout << filename << " is truncated" << std::endl;
+        _events.clear();
+        return false;
+    }
+    return true;
+}
+
+
+
+RecordedEvent& GraphicsSceneEventRecorder::append(int viewId, EventType type)
+{
+    RecordedEvent event;
+    event.time = _timer.nsecsElapsed();
+    event.viewId = viewId;
+    event.type = type;
+    _events.push_back(event);
+    return _events.back();
+}
+}
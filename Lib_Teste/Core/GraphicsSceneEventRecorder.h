@@ -0,0 +1,200 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <QElapsedTimer>
+#include "../Events/EventConstants.h"
+#include "../Geometry/Vector2D.h"
+
+namespace rm
+{
+class GraphicsScenePressEvent;
+class GraphicsSceneMoveEvent;
+class GraphicsSceneHoverEvent;
+class GraphicsSceneKeyEvent;
+class GraphicsSceneWheelEvent;
+
+/**
+ * @brief The RecordedEvent struct - One converted event, as it was given to the top tool of the scene. Only the
+ * fields of the event type are meaningful.
+ */
+struct RecordedEvent
+{
+    /**
+     * @brief time - Nanoseconds since the recording started.
+     */
+    long long time {0};
+
+    /**
+     * @brief viewId - Identifier of the view that received the event.
+     */
+    int viewId {-1};
+
+    /**
+     * @brief type - Event type. It is one of PressEvent, MoveEvent, HoverEvent, keyEvent, WheelEvent, EnterEvent and
+     * LeaveEvent.
+     */
+    EventType type {EventType::NoEvent};
+
+    /**
+     * Mouse positions. The wheel position is stored on localPosition.
+     */
+    Point2Df globalPosition;
+    Point2Df localPosition;
+    Point2Df screenPosition;
+    Point2Df windowPosition;
+    Point2Df worldPosition;
+    Point2Df oldWorldPosition;
+    Point2Df firstWorldPosition;
+
+    /**
+     * @brief buttons - Pressed buttons. It holds the button of the press events.
+     */
+    MouseButtons buttons {0};
+
+    /**
+     * @brief modifiers - Pressed keyboard modifiers.
+     */
+    KeyboardModifiers modifiers {0};
+
+    /**
+     * @brief buttonAction - Press or release, for the press events.
+     */
+    MouseButtonAction buttonAction {MouseButtonAction::Press};
+
+    /**
+     * Wheel data.
+     */
+    int delta {0};
+    Orientation orientation {Orientation::Foward};
+
+    /**
+     * Key data.
+     */
+    KeyAction keyAction {KeyAction::pressEvent};
+    int key {-1};
+    int count {0};
+    bool autoRepeat {false};
+    std::string text;
+};
+
+/**
+ * @brief The GraphicsSceneEventRecorder class - Records the events that the views dispatch to the scene tools, after
+ * they were converted from the Qt events. The recording can be saved and replayed later by
+ * GraphicsSceneEventReplayer, on a scene with the same items and views of the same size.
+ *
+ * The recorder is attached to a scene with GraphicsScene::setEventRecorder and it only stores events between start
+ * and stop.
+ */
+class GraphicsSceneEventRecorder
+{
+public:
+    /**
+     * @brief start - Clears the previous events and starts recording.
+     */
+    void start();
+
+    /**
+     * @brief stop - Stops recording. The events are kept.
+     */
+    void stop();
+
+    /**
+     * @brief isRecording - Verifies if the recorder is storing events.
+     * @return - Returns true between start and stop.
+     */
+    bool isRecording() const;
+
+    /**
+     * @brief clear - Removes all events.
+     */
+    void clear();
+
+    /**
+     * @brief record - Stores a press or release event.
+     * @param viewId - Identifier of the view that received the event.
+     * @param event - Converted event.
+     */
+    void record(int viewId, const GraphicsScenePressEvent& event);
+
+    /**
+     * @brief record - Stores a move event.
+     * @param viewId - Identifier of the view that received the event.
+     * @param event - Converted event.
+     */
+    void record(int viewId, const GraphicsSceneMoveEvent& event);
+
+    /**
+     * @brief record - Stores a hover event.
+     * @param viewId - Identifier of the view that received the event.
+     * @param event - Converted event.
+     */
+    void record(int viewId, const GraphicsSceneHoverEvent& event);
+
+    /**
+     * @brief record - Stores a key event.
+     * @param viewId - Identifier of the view that received the event.
+     * @param event - Converted event.
+     */
+    void record(int viewId, const GraphicsSceneKeyEvent& event);
+
+    /**
+     * @brief record - Stores a wheel event.
+     * @param viewId - Identifier of the view that received the event.
+     * @param event - Converted event.
+     */
+    void record(int viewId, const GraphicsSceneWheelEvent& event);
+
+    /**
+     * @brief record - Stores an event without data, the enter and leave events.
+     * @param viewId - Identifier of the view that received the event.
+     * @param type - Event type.
+     */
+    void record(int viewId, EventType type);
+
+    /**
+     * @brief getEvents - Gets the recorded events, in the order they were dispatched.
+     * @return - Returns the recorded events.
+     */
+    const std::vector<RecordedEvent>& getEvents() const;
+
+    /**
+     * @brief save - Writes the events to a binary file.
+     * @param filename - Name/Path of the file.
+     * @return - Returns true if the file was written.
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief load - Replaces the events by the ones of a file written by save. The recording is stopped.
+     * @param filename - Name/Path of the file.
+     * @return - Returns true if the file was read. The events are cleared otherwise.
+     */
+    bool load(const std::string& filename);
+
+private:
+    /**
+     * @brief append - Adds an event with the current time.
+     * @param viewId - Identifier of the view that received the event.
+     * @param type - Event type.
+     * @return - Returns the new event, to be filled by the caller.
+     */
+    RecordedEvent& append(int viewId, EventType type);
+
+private:
+    /**
+     * @brief _events - Recorded events.
+     */
+    std::vector<RecordedEvent> _events;
+
+    /**
+     * @brief _timer - Measures the event times since start.
+     */
+    QElapsedTimer _timer;
+
+    /**
+     * @brief _recording - True between start and stop.
+     */
+    bool _recording {false};
+};
+}
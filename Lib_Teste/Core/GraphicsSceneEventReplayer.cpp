@@ -0,0 +1,146 @@
+#include "GraphicsSceneEventReplayer.h"
+#include "GraphicsScene.h"
+#include "GraphicsView.h"
+#include <QElapsedTimer>
+
+namespace rm
+{
+GraphicsSceneEventReplayer::GraphicsSceneEventReplayer(GraphicsScene* scene)
+    : _scene(scene)
+{
+}
+
+
+
+void GraphicsSceneEventReplayer::setView(int recordedViewId, GraphicsView* view)
+{
+    _views[recordedViewId] = view;
+}
+
+
+
+ReplayStatistics GraphicsSceneEventReplayer::replay(const std::vector<RecordedEvent>& events)
+{
+    ReplayStatistics statistics;
+    statistics.latencies.reserve(events.size());
+    statistics.types.reserve(events.size());
+    if (!events.empty())
+    {
+        statistics.recordedTime = events.back().time - events.front().time;
+    }
+
+    QElapsedTimer replayTimer;
+    replayTimer.start();
+
+    QElapsedTimer eventTimer;
+    for (const RecordedEvent& event : events)
+    {
+        GraphicsView* view = getView(event.viewId);
+        if (!view)
+        {
+            statistics.skippedEvents++;
+            continue;
+        }
+
+        eventTimer.start();
+        if (!dispatch(event, view))
+        {
+            statistics.skippedEvents++;
+            continue;
+        }
+        statistics.latencies.push_back(eventTimer.nsecsElapsed());
+        statistics.types.push_back(event.type);
+        statistics.dispatchedEvents++;
+    }
+
+    statistics.replayTime = replayTimer.nsecsElapsed();
+    return statistics;
+}
+
+
+
+GraphicsView* GraphicsSceneEventReplayer::getView(int recordedViewId) const
+{
+    auto it = _views.find(recordedViewId);
+    if (it != _views.end())
+    {
+        return it->second;
+    }
+
+    auto sceneIt = _scene->_views.find(recordedViewId);
+    return sceneIt != _scene->_views.end() ? sceneIt->second : nullptr;
+}
+
+
+
+bool GraphicsSceneEventReplayer::dispatch(const RecordedEvent& event, GraphicsView* view)
+{
+    switch (event.type)
+    {
+    case EventType::PressEvent:
+        _mousePress.setMouseButtonAction(event.buttonAction);
+        _mousePress.setGlobalPosition(event.globalPosition);
+        _mousePress.setLocalPosition(event.localPosition);
+        _mousePress.setScreenPosition(event.screenPosition);
+        _mousePress.setWindowPosition(event.windowPosition);
+        _mousePress.setWorldPosition(event.worldPosition);
+        _mousePress.setButton(static_cast<MouseButton>(event.buttons));
+        _mousePress.setKeyboardModifiers(event.modifiers);
+        view->dispatchEvent(_mousePress);
+        return true;
+
+    case EventType::MoveEvent:
+        _mouseMove.setGlobalPosition(event.globalPosition);
+        _mouseMove.setLocalPosition(event.localPosition);
+        _mouseMove.setScreenPosition(event.screenPosition);
+        _mouseMove.setWindowPosition(event.windowPosition);
+        _mouseMove.setFirstWorldPosition(event.firstWorldPosition);
+        _mouseMove.setOldWorldPosition(event.oldWorldPosition);
+        _mouseMove.setWorldPosition(event.worldPosition);
+        _mouseMove.setButtons(event.buttons);
+        _mouseMove.setKeyboardModifiers(event.modifiers);
+        view->dispatchEvent(_mouseMove);
+        return true;
+
+    case EventType::HoverEvent:
+        _mouseHover.setGlobalPosition(event.globalPosition);
+        _mouseHover.setLocalPosition(event.localPosition);
+        _mouseHover.setScreenPosition(event.screenPosition);
+        _mouseHover.setWindowPosition(event.windowPosition);
+        _mouseHover.setFirstWorldPosition(event.firstWorldPosition);
+        _mouseHover.setOldWorldPosition(event.oldWorldPosition);
+        _mouseHover.setWorldPosition(event.worldPosition);
+        _mouseHover.setKeyboardModifiers(event.modifiers);
+        view->dispatchEvent(_mouseHover);
+        return true;
+
+    case EventType::keyEvent:
+        _keyEvent.setKeyEventType(event.keyAction);
+        _keyEvent.setKeyboardModifiers(event.modifiers);
+        _keyEvent.setText(event.text);
+        _keyEvent.setAutoRep(event.autoRepeat);
+        _keyEvent.setCount(event.count);
+        _keyEvent.setKey(event.key);
+        view->dispatchEvent(_keyEvent);
+        return true;
+
+    case EventType::WheelEvent:
+        _wheelEvent.setPos(event.localPosition);
+        _wheelEvent.setGlobalPos(event.globalPosition);
+        _wheelEvent.setDelta(event.delta);
+        _wheelEvent.setOrientation(event.orientation);
+        _wheelEvent.setButtons(event.buttons);
+        _wheelEvent.setKeyboardModifiers(event.modifiers);
+        view->dispatchEvent(_wheelEvent);
+        return true;
+
+    case EventType::EnterEvent:
+    case EventType::LeaveEvent:
+        view->dispatchEvent(event.type);
+        return true;
+
+    default:
+        return false;
+    }
+}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include "GraphicsSceneEventRecorder.h"
+#include "../Events/GraphicsScenePressEvent.h"
+#include "../Events/GraphicsSceneMoveEvent.h"
+#include "../Events/GraphicsSceneHoverEvent.h"
+#include "../Events/GraphicsSceneKeyEvent.h"
+#include "../Events/GraphicsSceneWheelEvent.h"
+
+namespace rm
+{
+class GraphicsScene;
+class GraphicsView;
+
+/**
+ * @brief The ReplayStatistics struct - Times of a replay. The times are in nanoseconds.
+ */
+struct ReplayStatistics
+{
+    /**
+     * @brief dispatchedEvents - Number of events given to a view.
+     */
+    unsigned int dispatchedEvents {0};
+
+    /**
+     * @brief skippedEvents - Number of events of views that do not exist on the replay.
+     */
+    unsigned int skippedEvents {0};
+
+    /**
+     * @brief recordedTime - Duration of the recorded session.
+     */
+    long long recordedTime {0};
+
+    /**
+     * @brief replayTime - Duration of the replay.
+     */
+    long long replayTime {0};
+
+    /**
+     * @brief latencies - Time spent by the tool on each dispatched event, in the replay order.
+     */
+    std::vector<long long> latencies;
+
+    /**
+     * @brief types - Type of each dispatched event.
+     */
+    std::vector<EventType> types;
+};
+
+/**
+ * @brief The GraphicsSceneEventReplayer class - Gives recorded events to the views of a scene, as if they came from
+ * Qt. The events are dispatched one after another, ignoring the recorded times, so the replay measures how long the
+ * tools take to handle a real session.
+ *
+ * The recorded world positions are used as they are, so the replay is deterministic if the scene has the same items,
+ * the same tools on the stack and views of the same size as the recorded ones. The views are not repainted.
+ */
+class GraphicsSceneEventReplayer
+{
+public:
+    /**
+     * @brief GraphicsSceneEventReplayer - Constructor. Each recorded event is given to the scene view with the same
+     * identifier, unless another view is set with setView.
+     * @param scene - Scene that receives the events.
+     */
+    explicit GraphicsSceneEventReplayer(GraphicsScene* scene);
+
+    /**
+     * @brief setView - Sets the view that receives the events recorded on another view.
+     * @param recordedViewId - Identifier of the view on the recording.
+     * @param view - View of the scene, or nullptr to skip the events of the recorded view.
+     */
+    void setView(int recordedViewId, GraphicsView* view);
+
+    /**
+     * @brief replay - Dispatches the events to the top tool of the scene.
+     * @param events - Recorded events.
+     * @return - Returns the replay times.
+     */
+    ReplayStatistics replay(const std::vector<RecordedEvent>& events);
+
+private:
+    /**
+     * @brief getView - Gets the view that receives the events of a recorded view.
+     * @param recordedViewId - Identifier of the view on the recording.
+     * @return - Returns the view or nullptr.
+     */
+    GraphicsView* getView(int recordedViewId) const;
+
+    /**
+     * @brief dispatch - Rebuilds an event and gives it to a view.
+     * @param event - Recorded event.
+     * @param view - View that receives the event.
+     * @return - Returns true if the event type can be replayed.
+     */
+    bool dispatch(const RecordedEvent& event, GraphicsView* view);
+
+private:
+    /**
+     * @brief _scene - Scene that receives the events.
+     */
+    GraphicsScene* _scene {nullptr};
+
+    /**
+     * @brief _views - Views set by setView, by recorded identifier.
+     */
+    std::map<int, GraphicsView*> _views;
+
+    /**
+     * Event objects, reused by all events as the views do.
+     */
+    GraphicsScenePressEvent _mousePress;
+    GraphicsSceneMoveEvent _mouseMove;
+    GraphicsSceneHoverEvent _mouseHover;
+    GraphicsSceneKeyEvent _keyEvent;
+    GraphicsSceneWheelEvent _wheelEvent;
+};
+}
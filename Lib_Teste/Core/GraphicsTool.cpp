@@ -161,4 +161,11 @@ void GraphicsTool::finalize()
 {
 
 }
+
+
+
+bool GraphicsTool::acceptsCoalescedMoveEvents() const
+{
+    return true;
+}
 }
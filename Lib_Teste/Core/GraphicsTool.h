@@ -214,6 +214,15 @@ public:
      */
     virtual void finalize();
 
+    /**
+     * @brief acceptsCoalescedMoveEvents - Tells the views if the move and hover events received between two frames may
+     * be merged into one event, when the view coalescing is enabled. The merged event keeps the first world position
+     * and has the world position of the last dispatched event as old position. Tools that need every mouse sample,
+     * like free hand drawing, must return false.
+     * @return - Returns true by default.
+     */
+    virtual bool acceptsCoalescedMoveEvents() const;
+
     /**
      * @brief name - Return the tool's name
      * @return - The tool's name
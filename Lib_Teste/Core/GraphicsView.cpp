@@ -1,6 +1,7 @@
 #include <iostream>
 #include "GraphicsView.h"
 #include "GraphicsItem.h"
+#include "GraphicsSceneEventRecorder.h"
 #include "../Items/RectangleZoomItem.h"
 #include "../Geometry/Vector2D.h"
 #include "../Events/GraphicsSceneMoveEvent.h"
@@ -8,6 +9,8 @@
 #include "../Events/GraphicsSceneWheelEvent.h"
 #include <QMenu>
 #include <QMouseEvent>
+#include <QOpenGLFunctions>
+#include <QPainter>
 
 namespace rm
 {
@@ -31,6 +34,12 @@ GraphicsView::GraphicsView(GraphicsScene* scene, QWidget *parent, ViewType type,
 
 GraphicsView::~GraphicsView()
 {
+    //Timer queries are not shared, so they must be deleted on the view context.
+    makeCurrent();
+    _profiler.release();
+    _frameUniforms.release();
+    doneCurrent();
+
     _scene->makeCurrent();
     _scene->removeView(this);
 }
@@ -44,6 +53,12 @@ void GraphicsView::mouseMoveEvent(QMouseEvent* event)
         //Mouse hover.
         if (event->buttons() == Qt::MouseButton::NoButton && _scene->isEventEnabled(EventType::HoverEvent))
         {
+            //A pending move can not be merged with a hover.
+            if (_pendingMoveEvent == EventType::MoveEvent)
+            {
+                flushPendingMoveEvent();
+            }
+
             //Set the global mouse position.
             _mouseHover.setGlobalPosition( Point2Df(static_cast<float>(event->globalPos().x()),
                                                   static_cast<float>(event->globalPos().y())) );
@@ -60,33 +75,31 @@ void GraphicsView::mouseMoveEvent(QMouseEvent* event)
             _mouseHover.setWindowPosition( Point2Df(static_cast<float>(event->windowPos().x()),
                                                  static_cast<float>(event->windowPos().y())) );
 
-            //Set old world coordinate.
-            _mouseHover.setOldWorldPosition(_mouseHover.getWorldPosition());
-
-            //Convert to world coordinate. This is the current world coordinate right now.
-            const Point2Df& localPosition = _mouseHover.getLocalPosition();
-            _mouseHover.setWorldPosition( convertFromScreenToWorld(localPosition) );
-
             //Set key modifiers.
             _mouseHover.setKeyboardModifiers(_mouseHover.convertKeyboardModifiers(static_cast<unsigned int>(event->modifiers())));
 
-            if (!_scene->isToolStackEmpty())
+            if (canCoalesceMoveEvents())
             {
-                makeCurrent();
-                if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-                {
-                    _scene->topTool()->mouseHoverEvent2D(&_mouseHover, this);
-                }
-                else if (_scene->topTool()->hasSupport3D())
+                //The world positions are computed when the frame dispatches the event.
+                if (_pendingMoveEvent == EventType::HoverEvent)
                 {
-                    _scene->topTool()->mouseHoverEvent3D(&_mouseHover, this);
+                    _coalescedMoveEvents++;
                 }
-                doneCurrent();
+                _pendingMoveEvent = EventType::HoverEvent;
+            }
+            else
+            {
+                sendHoverEvent();
             }
         }
         //Mouse move.
         else if ( _scene->isEventEnabled(EventType::MoveEvent))
         {
+            if (_pendingMoveEvent == EventType::HoverEvent)
+            {
+                flushPendingMoveEvent();
+            }
+
             //Set the global mouse position.
             _mouseMove.setGlobalPosition( Point2Df(static_cast<float>(event->globalPos().x()),
                                                   static_cast<float>(event->globalPos().y())) );
@@ -103,36 +116,26 @@ void GraphicsView::mouseMoveEvent(QMouseEvent* event)
             _mouseMove.setWindowPosition( Point2Df(static_cast<float>(event->windowPos().x()),
                                                  static_cast<float>(event->windowPos().y())) );
 
-            //Set old world coordinate.
-            _mouseMove.setOldWorldPosition(_mouseMove.getWorldPosition());
-
-            //Convert to world coordinate. This is the current world coordinate right now.
-            const Point2Df& localPosition = _mouseMove.getLocalPosition();
-            _mouseMove.setWorldPosition( convertFromScreenToWorld(localPosition) );
-
             //Set the pressed buttons.
             _mouseMove.setButtons( _mouseMove.convertMouseButtons(static_cast<unsigned int>(event->buttons())));
 
             //Set key modifiers.
             _mouseMove.setKeyboardModifiers( _mouseMove.convertKeyboardModifiers(static_cast<unsigned int>(event->modifiers())));
 
-
-            if (!_scene->isToolStackEmpty())
+            if (canCoalesceMoveEvents())
             {
-                makeCurrent();
-                if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
+                if (_pendingMoveEvent == EventType::MoveEvent)
                 {
-                    _scene->topTool()->mouseMoveEvent2D(&_mouseMove, this);
+                    _coalescedMoveEvents++;
                 }
-                else if (_scene->topTool()->hasSupport3D())
-                {
-                    _scene->topTool()->mouseMoveEvent3D(&_mouseMove, this);
-                }
-                doneCurrent();
+                _pendingMoveEvent = EventType::MoveEvent;
+            }
+            else
+            {
+                sendMoveEvent();
             }
         }
-        update();
-        emit signalUpdate();
+        _scene->update(this);
     }
 }
 
@@ -142,6 +145,9 @@ void GraphicsView::mousePressEvent(QMouseEvent* event)
 {
     if(!isPreview() && _scene->isEventEnabled(EventType::PressEvent))
     {
+        //The tool must see the last position before the button changes.
+        flushPendingMoveEvent();
+
         //Set mouse button action.
         _mousePress.setMouseButtonAction(MouseButtonAction::Press);
 
@@ -177,22 +183,9 @@ void GraphicsView::mousePressEvent(QMouseEvent* event)
         _mouseMove.setOldWorldPosition( _mouseMove.getFirstWorldPosition() );
         _mouseMove.setWorldPosition( _mouseMove.getFirstWorldPosition() );
 
-        if (!_scene->isToolStackEmpty())
-        {
-            makeCurrent();
-            if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-            {
-                _scene->topTool()->mousePressEvent2D(&_mousePress, this);
-            }
-            else if (_scene->topTool()->hasSupport3D())
-            {
-                _scene->topTool()->mousePressEvent3D(&_mousePress, this);
-            }
-            doneCurrent();
-        }
+        dispatchEvent(_mousePress);
 
-        update();
-        emit signalUpdate();
+        _scene->update(this);
     }
 }
 
@@ -202,6 +195,9 @@ void GraphicsView::mouseReleaseEvent(QMouseEvent* event)
 {
     if(!isPreview() && _scene->isEventEnabled(EventType::PressEvent))
     {
+        //The tool must see the last position before the button changes.
+        flushPendingMoveEvent();
+
         //Set mouse button action.
         _mousePress.setMouseButtonAction(MouseButtonAction::Release);
 
@@ -231,21 +227,8 @@ void GraphicsView::mouseReleaseEvent(QMouseEvent* event)
         //Get key modifiers.
         _mousePress.setKeyboardModifiers( _mousePress.convertKeyboardModifiers(static_cast<unsigned int>(event->modifiers())) );
 
-        if (!_scene->isToolStackEmpty())
-        {
-            makeCurrent();
-            if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-            {
-                _scene->topTool()->mouseReleaseEvent2D(&_mousePress, this);
-            }
-            else if (_scene->topTool()->hasSupport3D())
-            {
-                _scene->topTool()->mouseReleaseEvent3D(&_mousePress, this);
-            }
-            doneCurrent();
-        }
-        update();
-        emit signalUpdate();
+        dispatchEvent(_mousePress);
+        _scene->update(this);
     }
 }
 
@@ -256,6 +239,7 @@ void GraphicsView::keyPressEvent(QKeyEvent* event)
 
     if(!isPreview() && _scene->isEventEnabled(EventType::keyEvent))
     {
+        flushPendingMoveEvent();
 
         //Set key event type
         _keyEvent.setKeyEventType(KeyAction::pressEvent);
@@ -275,21 +259,8 @@ void GraphicsView::keyPressEvent(QKeyEvent* event)
         //Set key
         _keyEvent.setKey(event->key());
 
-        if (!_scene->isToolStackEmpty())
-        {
-            makeCurrent();
-            if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-            {
-                _scene->topTool()->keyPressEvent2D(&_keyEvent, this);
-            }
-            else if (_scene->topTool()->hasSupport3D())
-            {
-                _scene->topTool()->keyPressEvent3D(&_keyEvent, this);
-            }
-            doneCurrent();
-        }
-        update();
-        emit signalUpdate();
+        dispatchEvent(_keyEvent);
+        _scene->update(this);
     }
 }
 
@@ -317,8 +288,7 @@ void GraphicsView::keyReleaseEvent(QKeyEvent* event)
         //Set key
         _keyEvent.setKey(event->key());
 
-        update();
-        emit signalUpdate();
+        _scene->update(this);
     }
 }
 
@@ -415,21 +385,9 @@ void GraphicsView::enterEvent(QEvent* )
 {
     if(!isPreview() && _scene->isEventEnabled(EventType::EnterEvent))
     {
-        if (!_scene->isToolStackEmpty())
-        {
-            makeCurrent();
-            if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-            {
-                _scene->topTool()->enterEvent2D(&_enterEvent, this);
-            }
-            else if (_scene->topTool()->hasSupport3D())
-            {
-                _scene->topTool()->enterEvent3D(&_enterEvent, this);
-            }
-            doneCurrent();
-        }
-        update();
-        emit signalUpdate();
+        flushPendingMoveEvent();
+        dispatchEvent(EventType::EnterEvent);
+        _scene->update(this);
     }
 }
 
@@ -439,22 +397,10 @@ void GraphicsView::leaveEvent(QEvent* )
 {
     if(!isPreview() && _scene->isEventEnabled(EventType::LeaveEvent))
     {
-        if (!_scene->isToolStackEmpty())
-        {
-            makeCurrent();
-            if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-            {
-                _scene->topTool()->leaveEvent2D(&_leaveEvent, this);
-            }
-            else if (_scene->topTool()->hasSupport3D())
-            {
-                _scene->topTool()->leaveEvent3D(&_leaveEvent, this);
-            }
-            doneCurrent();
-        }
+        flushPendingMoveEvent();
+        dispatchEvent(EventType::LeaveEvent);
 
-        update();
-        emit signalUpdate();
+        _scene->update(this);
     }
 }
 
@@ -476,6 +422,8 @@ void GraphicsView::wheelEvent(QWheelEvent* event)
 {
      if(!isPreview() && _scene->isEventEnabled(EventType::WheelEvent))
      {
+         flushPendingMoveEvent();
+
          //Set the mouse position.
          _wheelEvent.setPos(Point2Df(static_cast<float>(event->pos().x()),
                                      static_cast<float>(event->pos().y())));
@@ -502,22 +450,9 @@ void GraphicsView::wheelEvent(QWheelEvent* event)
          //Set key modifiers.
          _wheelEvent.setKeyboardModifiers( _wheelEvent.convertKeyboardModifiers(static_cast<unsigned int>(event->modifiers())) );
 
-         if (!_scene->isToolStackEmpty())
-         {
-             makeCurrent();
-             if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
-             {
-                 _scene->topTool()->wheelEvent2D(&_wheelEvent, this);
-             }
-             else if (_scene->topTool()->hasSupport3D())
-             {
-                 _scene->topTool()->wheelEvent3D(&_wheelEvent, this);
-             }
-             doneCurrent();
-         }
+         dispatchEvent(_wheelEvent);
 
-         update();
-         emit signalUpdate();
+         _scene->update(this);
      }
 }
 
@@ -599,7 +534,7 @@ int GraphicsView::numberOfViews()
 
 void GraphicsView::onUpdate()
 {
-    update();
+    _scene->update(this);
 }
 
 
@@ -608,4 +543,350 @@ void GraphicsView::zoomInOut(float )
 {
 
 }
+
+
+
+void GraphicsView::setProfilingEnabled(bool enable)
+{
+    _profiler.setEnabled(enable);
+}
+
+
+
+bool GraphicsView::isProfilingEnabled() const
+{
+    return _profiler.isEnabled();
+}
+
+
+
+const FrameStatistics& GraphicsView::getFrameStatistics() const
+{
+    return _profiler.getStatistics();
+}
+
+
+
+void GraphicsView::setStatisticsOverlayVisible(bool visible)
+{
+    _statisticsOverlay.visible(visible);
+    if (visible)
+    {
+        _profiler.setEnabled(true);
+    }
+    _scene->update(this);
+}
+
+
+
+bool GraphicsView::isStatisticsOverlayVisible() const
+{
+    return _statisticsOverlay.isVisible();
+}
+
+
+
+void GraphicsView::setCullingEnabled(bool enable)
+{
+    _isCullingEnabled = enable;
+    _scene->update(this);
+}
+
+
+
+bool GraphicsView::isCullingEnabled() const
+{
+    return _isCullingEnabled;
+}
+
+
+
+unsigned int GraphicsView::getSubmittedItems() const
+{
+    return _submittedItems;
+}
+
+
+
+unsigned int GraphicsView::getCulledItems() const
+{
+    return _culledItems;
+}
+
+
+
+unsigned int GraphicsView::getReusedItems() const
+{
+    return _reusedItems;
+}
+
+
+
+void GraphicsView::dispatchEvent(const GraphicsScenePressEvent& event)
+{
+    if (GraphicsSceneEventRecorder* recorder = getActiveRecorder())
+    {
+        recorder->record(_viewId, event);
+    }
+
+    if (!_scene->isToolStackEmpty())
+    {
+        GraphicsTool* tool = _scene->topTool();
+        bool isPress = event.getMouseButtonAction() == MouseButtonAction::Press;
+
+        makeCurrent();
+        if (_type == ViewType::VIEW_2D && tool->hasSupport2D())
+        {
+            isPress ? tool->mousePressEvent2D(&event, this) : tool->mouseReleaseEvent2D(&event, this);
+        }
+        else if (tool->hasSupport3D())
+        {
+            isPress ? tool->mousePressEvent3D(&event, this) : tool->mouseReleaseEvent3D(&event, this);
+        }
+        doneCurrent();
+    }
+}
+
+
+
+void GraphicsView::dispatchEvent(const GraphicsSceneMoveEvent& event)
+{
+    if (GraphicsSceneEventRecorder* recorder = getActiveRecorder())
+    {
+        recorder->record(_viewId, event);
+    }
+
+    if (!_scene->isToolStackEmpty())
+    {
+        makeCurrent();
+        if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
+        {
+            _scene->topTool()->mouseMoveEvent2D(&event, this);
+        }
+        else if (_scene->topTool()->hasSupport3D())
+        {
+            _scene->topTool()->mouseMoveEvent3D(&event, this);
+        }
+        doneCurrent();
+    }
+}
+
+
+
+void GraphicsView::dispatchEvent(const GraphicsSceneHoverEvent& event)
+{
+    if (GraphicsSceneEventRecorder* recorder = getActiveRecorder())
+    {
+        recorder->record(_viewId, event);
+    }
+
+    if (!_scene->isToolStackEmpty())
+    {
+        makeCurrent();
+        if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
+        {
+            _scene->topTool()->mouseHoverEvent2D(&event, this);
+        }
+        else if (_scene->topTool()->hasSupport3D())
+        {
+            _scene->topTool()->mouseHoverEvent3D(&event, this);
+        }
+        doneCurrent();
+    }
+}
+
+
+
+void GraphicsView::dispatchEvent(const GraphicsSceneKeyEvent& event)
+{
+    if (GraphicsSceneEventRecorder* recorder = getActiveRecorder())
+    {
+        recorder->record(_viewId, event);
+    }
+
+    if (!_scene->isToolStackEmpty())
+    {
+        makeCurrent();
+        if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
+        {
+            _scene->topTool()->keyPressEvent2D(&event, this);
+        }
+        else if (_scene->topTool()->hasSupport3D())
+        {
+            _scene->topTool()->keyPressEvent3D(&event, this);
+        }
+        doneCurrent();
+    }
+}
+
+
+
+void GraphicsView::dispatchEvent(const GraphicsSceneWheelEvent& event)
+{
+    if (GraphicsSceneEventRecorder* recorder = getActiveRecorder())
+    {
+        recorder->record(_viewId, event);
+    }
+
+    if (!_scene->isToolStackEmpty())
+    {
+        makeCurrent();
+        if (_type == ViewType::VIEW_2D && _scene->topTool()->hasSupport2D())
+        {
+            _scene->topTool()->wheelEvent2D(&event, this);
+        }
+        else if (_scene->topTool()->hasSupport3D())
+        {
+            _scene->topTool()->wheelEvent3D(&event, this);
+        }
+        doneCurrent();
+    }
+}
+
+
+
+void GraphicsView::dispatchEvent(EventType type)
+{
+    if (type != EventType::EnterEvent && type != EventType::LeaveEvent)
+    {
+        return;
+    }
+
+    if (GraphicsSceneEventRecorder* recorder = getActiveRecorder())
+    {
+        recorder->record(_viewId, type);
+    }
+
+    if (!_scene->isToolStackEmpty())
+    {
+        GraphicsTool* tool = _scene->topTool();
+        bool isEnter = type == EventType::EnterEvent;
+
+        makeCurrent();
+        if (_type == ViewType::VIEW_2D && tool->hasSupport2D())
+        {
+            isEnter ? tool->enterEvent2D(&_enterEvent, this) : tool->leaveEvent2D(&_leaveEvent, this);
+        }
+        else if (tool->hasSupport3D())
+        {
+            isEnter ? tool->enterEvent3D(&_enterEvent, this) : tool->leaveEvent3D(&_leaveEvent, this);
+        }
+        doneCurrent();
+    }
+}
+
+
+
+void GraphicsView::setMoveEventCoalescing(bool enable)
+{
+    if (!enable)
+    {
+        flushPendingMoveEvent();
+    }
+    _moveEventCoalescing = enable;
+}
+
+
+
+bool GraphicsView::isMoveEventCoalescingEnabled() const
+{
+    return _moveEventCoalescing;
+}
+
+
+
+unsigned long long GraphicsView::getCoalescedMoveEvents() const
+{
+    return _coalescedMoveEvents;
+}
+
+
+
+void GraphicsView::flushPendingMoveEvent()
+{
+    EventType pending = _pendingMoveEvent;
+    _pendingMoveEvent = EventType::NoEvent;
+
+    if (pending == EventType::HoverEvent)
+    {
+        sendHoverEvent();
+    }
+    else if (pending == EventType::MoveEvent)
+    {
+        sendMoveEvent();
+    }
+}
+
+
+
+bool GraphicsView::canCoalesceMoveEvents() const
+{
+    return _moveEventCoalescing && !_scene->isToolStackEmpty() && _scene->topTool()->acceptsCoalescedMoveEvents();
+}
+
+
+
+void GraphicsView::sendHoverEvent()
+{
+    //The old position is the one of the last dispatched event, so it spans all merged events.
+    _mouseHover.setOldWorldPosition(_mouseHover.getWorldPosition());
+
+    //Convert to world coordinate. This is the current world coordinate right now.
+    _mouseHover.setWorldPosition( convertFromScreenToWorld(_mouseHover.getLocalPosition()) );
+
+    dispatchEvent(_mouseHover);
+}
+
+
+
+void GraphicsView::sendMoveEvent()
+{
+    //The old position is the one of the last dispatched event, so it spans all merged events.
+    _mouseMove.setOldWorldPosition(_mouseMove.getWorldPosition());
+
+    //Convert to world coordinate. This is the current world coordinate right now.
+    _mouseMove.setWorldPosition( convertFromScreenToWorld(_mouseMove.getLocalPosition()) );
+
+    dispatchEvent(_mouseMove);
+}
+
+
+
+GraphicsSceneEventRecorder* GraphicsView::getActiveRecorder() const
+{
+    GraphicsSceneEventRecorder* recorder = _scene->getEventRecorder();
+    return recorder && recorder->isRecording() ? recorder : nullptr;
+}
+
+
+
+void GraphicsView::countItems(unsigned int submitted, unsigned int culled, unsigned int reused)
+{
+    _submittedItems += submitted;
+    _culledItems += culled;
+    _reusedItems += reused;
+    RenderProfiler::countItems(submitted, culled, reused);
+}
+
+
+
+void GraphicsView::renderStatisticsOverlay()
+{
+    if (!_statisticsOverlay.isVisible())
+    {
+        return;
+    }
+
+    //The painter sets its own viewport, but the views set it just when they are resized.
+    QOpenGLFunctions* f = context()->functions();
+    GLint viewport[4];
+    f->glGetIntegerv(GL_VIEWPORT, viewport);
+
+    {
+        QPainter painter(this);
+        _statisticsOverlay.render(painter, _profiler.getStatistics());
+    }
+
+    f->glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
 }
@@ -6,6 +6,9 @@
 
 #include "../Events/EventConstants.h"
 #include "GraphicsScene.h"
+#include "FrameUniforms.h"
+#include "RenderProfiler.h"
+#include "CoreItems/RenderStatisticsOverlay.h"
 
 #include "../Items/RectangleZoomItem.h"
 #include "../Core/GraphicsSceneEvent.h"
@@ -24,6 +27,7 @@ namespace rm
 class QChangeEvent;
 class Point3D;
 class CloseEvent;
+class GraphicsSceneEventRecorder;
 //class HideEvent;
 
 
@@ -170,13 +174,139 @@ public:
      */
     virtual Point2Df convertFromScreenToWorld(const Point2Df& screen) = 0;
 
-public slots:
+    /**
+     * @brief setProfilingEnabled - Enables or disables the render profiler of the view.
+     * @param enable - True to measure the frame times and counters of the next frames.
+     */
+    void setProfilingEnabled(bool enable);
 
-    void onUpdate();
+    /**
+     * @brief isProfilingEnabled - Verifies if the render profiler is enabled.
+     * @return - Returns true if the frames are being profiled.
+     */
+    bool isProfilingEnabled() const;
+
+    /**
+     * @brief getFrameStatistics - Gets the statistics of the last profiled frame whose GPU times are known. The GPU
+     * times lag a few frames behind, since the timer queries are not waited for.
+     * @return - Returns the frame statistics.
+     */
+    const FrameStatistics& getFrameStatistics() const;
+
+    /**
+     * @brief setStatisticsOverlayVisible - Shows or hides the render statistics over the view. Showing it enables the
+     * profiler.
+     * @param visible - True to show the statistics.
+     */
+    void setStatisticsOverlayVisible(bool visible);
+
+    /**
+     * @brief isStatisticsOverlayVisible - Verifies if the render statistics are shown over the view.
+     * @return - Returns true if the statistics are visible.
+     */
+    bool isStatisticsOverlayVisible() const;
+
+    /**
+     * @brief setCullingEnabled - Enables or disables the culling of the items outside the view. It is enabled by
+     * default.
+     * @param enable - True to render just the items that may be on screen.
+     */
+    void setCullingEnabled(bool enable);
+
+    /**
+     * @brief isCullingEnabled - Verifies if the items outside the view are culled.
+     * @return - Returns true if the culling is enabled.
+     */
+    bool isCullingEnabled() const;
+
+    /**
+     * @brief getSubmittedItems - Gets the number of items rendered on the last frame.
+     * @return - Returns the number of rendered items.
+     */
+    unsigned int getSubmittedItems() const;
+
+    /**
+     * @brief getCulledItems - Gets the number of scene items left out of the last frame by the culling.
+     * @return - Returns the number of culled items.
+     */
+    unsigned int getCulledItems() const;
+
+    /**
+     * @brief getReusedItems - Gets the number of items inside the view that the last frame kept from the cached frame
+     * instead of rendering them. It is 0 without partial redraw.
+     * @return - Returns the number of reused items.
+     */
+    unsigned int getReusedItems() const;
+
+    /**
+     * @brief dispatchEvent - Gives a converted press or release event to the top tool of the scene, as the 2D or 3D
+     * event of the view type. The event is also stored on the scene event recorder, if it is recording.
+     * @param event - Converted event. Its action tells if it is a press or a release.
+     */
+    void dispatchEvent(const GraphicsScenePressEvent& event);
+
+    /**
+     * @brief dispatchEvent - Gives a converted move event to the top tool of the scene.
+     * @param event - Converted event.
+     */
+    void dispatchEvent(const GraphicsSceneMoveEvent& event);
+
+    /**
+     * @brief dispatchEvent - Gives a converted hover event to the top tool of the scene.
+     * @param event - Converted event.
+     */
+    void dispatchEvent(const GraphicsSceneHoverEvent& event);
+
+    /**
+     * @brief dispatchEvent - Gives a converted key event to the top tool of the scene.
+     * @param event - Converted event.
+     */
+    void dispatchEvent(const GraphicsSceneKeyEvent& event);
+
+    /**
+     * @brief dispatchEvent - Gives a converted wheel event to the top tool of the scene.
+     * @param event - Converted event.
+     */
+    void dispatchEvent(const GraphicsSceneWheelEvent& event);
+
+    /**
+     * @brief dispatchEvent - Gives an enter or leave event to the top tool of the scene.
+     * @param type - EnterEvent or LeaveEvent. The other types are ignored.
+     */
+    void dispatchEvent(EventType type);
+
+    /**
+     * @brief setMoveEventCoalescing - Enables or disables the coalescing of mouse move and hover events. When it is
+     * enabled, the events received between two frames are merged and the top tool receives only the last one, right
+     * before the frame is drawn. Other events dispatch the pending one first, so the tool sees them in order. Tools
+     * can opt out with GraphicsTool::acceptsCoalescedMoveEvents.
+     * @param enable - True to merge the move events. Disabling dispatches the pending event.
+     */
+    void setMoveEventCoalescing(bool enable);
+
+    /**
+     * @brief isMoveEventCoalescingEnabled - Verifies if the move and hover events are coalesced.
+     * @return - Returns true if the events are coalesced.
+     */
+    bool isMoveEventCoalescingEnabled() const;
+
+    /**
+     * @brief getCoalescedMoveEvents - Gets the number of move and hover events that were merged into a later one.
+     * @return - Returns the number of events that were not dispatched.
+     */
+    unsigned long long getCoalescedMoveEvents() const;
 
-signals:
+    /**
+     * @brief flushPendingMoveEvent - Dispatches the coalesced move or hover event, if there is one. The frame
+     * scheduler calls it before each frame.
+     */
+    void flushPendingMoveEvent();
 
-    void signalUpdate();
+public slots:
+    /**
+     * @brief onUpdate - Schedules a repaint of this view on the scene frame scheduler.
+     */
+    void onUpdate();
 
 protected:
 
@@ -198,6 +328,41 @@ protected:
      */
     RectangleZoomItem _rectangleZoom;
 
+    /**
+     * @brief _profiler - Measures the frames of the view. The views mark a section around each item they render.
+     */
+    RenderProfiler _profiler;
+
+    /**
+     * @brief _frameUniforms - View and item uniform blocks. The views fill the view block when a frame begins.
+     */
+    FrameUniforms _frameUniforms;
+
+    /**
+     * @brief _statisticsOverlay - Draws the profiler statistics over the view.
+     */
+    RenderStatisticsOverlay _statisticsOverlay;
+
+    /**
+     * @brief _isCullingEnabled - True if the items outside the view are not rendered.
+     */
+    bool _isCullingEnabled {true};
+
+    /**
+     * @brief _submittedItems - Number of items rendered on the current or last frame.
+     */
+    unsigned int _submittedItems {0};
+
+    /**
+     * @brief _culledItems - Number of items culled on the current or last frame.
+     */
+    unsigned int _culledItems {0};
+
+    /**
+     * @brief _reusedItems - Number of items kept from the cached frame on the current or last frame.
+     */
+    unsigned int _reusedItems {0};
+
 protected:
     /**
      * @brief GraphicsView - Graphics view construtor.
@@ -359,12 +524,49 @@ protected:
      */
     GraphicsSceneEvent& translateQEvent(QEvent* event);
 
+    /**
+     * @brief renderStatisticsOverlay - Draws the render statistics over the frame, if the overlay is visible. It must
+     * be called at the end of paintGL.
+     */
+    void renderStatisticsOverlay();
+
+    /**
+     * @brief countItems - Adds to the item counters of the frame and to the profiler.
+     * @param submitted - Number of items rendered.
+     * @param culled - Number of items culled.
+     * @param reused - Number of items kept from a cached frame.
+     */
+    void countItems(unsigned int submitted, unsigned int culled, unsigned int reused);
+
     /**
      * Calls translateQEvent and propagates the GraphicsSceneEvent to the GraphicsScene
      * TODO: is this function an override from QOpenGLWidget?
      */
     //virtual GraphicsSceneEvent& event(QEvent* event);
 
+private:
+    /**
+     * @brief getActiveRecorder - Gets the event recorder of the scene, if it is recording.
+     * @return - Returns the recorder or nullptr.
+     */
+    GraphicsSceneEventRecorder* getActiveRecorder() const;
+
+    /**
+     * @brief canCoalesceMoveEvents - Verifies if the coalescing is enabled and accepted by the top tool.
+     * @return - Returns true if the move events can be merged.
+     */
+    bool canCoalesceMoveEvents() const;
+
+    /**
+     * @brief sendHoverEvent - Computes the world positions of the hover event and dispatches it.
+     */
+    void sendHoverEvent();
+
+    /**
+     * @brief sendMoveEvent - Computes the world positions of the move event and dispatches it.
+     */
+    void sendMoveEvent();
+
 private:
 
     /**
@@ -430,5 +632,20 @@ private:
      * @brief _type - View type.
      */
     ViewType _type;
+
+    /**
+     * @brief _moveEventCoalescing - True if the move and hover events are merged until the next frame.
+     */
+    bool _moveEventCoalescing {false};
+
+    /**
+     * @brief _pendingMoveEvent - MoveEvent or HoverEvent if a merged event waits for the next frame.
+     */
+    EventType _pendingMoveEvent {EventType::NoEvent};
+
+    /**
+     * @brief _coalescedMoveEvents - Number of move and hover events merged into a later one.
+     */
+    unsigned long long _coalescedMoveEvents {0};
 };
 }
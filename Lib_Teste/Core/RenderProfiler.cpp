@@ -0,0 +1,394 @@
+#include "RenderProfiler.h"
+#include "GraphicsItem.h"
+
+#include <cstdlib>
+#include <typeinfo>
+#include <QOpenGLTimerQuery>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace rm
+{
+namespace
+{
+/**
+ * @brief MAX_PENDING_FRAMES - Number of frames that may wait for their timer queries. If the GPU is further behind,
+ * the oldest frame is waited for.
+ */
+constexpr size_t MAX_PENDING_FRAMES = 3;
+}
+
+thread_local RenderCounters* RenderProfiler::_counters = nullptr;
+
+
+
+void RenderCounters::clear()
+{
+    *this = RenderCounters();
+}
+
+
+
+RenderCounters& RenderCounters::operator+=(const RenderCounters& counters)
+{
+    drawCalls += counters.drawCalls;
+    programBinds += counters.programBinds;
+    vaoCreations += counters.vaoCreations;
+    uploadedBytes += counters.uploadedBytes;
+    submittedItems += counters.submittedItems;
+    culledItems += counters.culledItems;
+    reusedItems += counters.reusedItems;
+    return *this;
+}
+
+
+
+RenderProfiler::~RenderProfiler()
+{
+    release();
+}
+
+
+
+void RenderProfiler::setEnabled(bool enable)
+{
+    _isEnabled = enable;
+}
+
+
+
+bool RenderProfiler::isEnabled() const
+{
+    return _isEnabled;
+}
+
+
+
+void RenderProfiler::beginFrame()
+{
+    if (!_isEnabled)
+    {
+        return;
+    }
+
+    _isInsideFrame = true;
+    _currentSection = -1;
+    _currentItemType = nullptr;
+    _sectionIndex.clear();
+    _currentFrame.statistics = FrameStatistics();
+    _currentFrame.statistics.frame = _numberOfFrames++;
+    _counters = &_currentFrame.statistics.counters;
+
+    _frameTimer.start();
+    recordTimestamp(-1);
+}
+
+
+
+void RenderProfiler::beginSection(const std::string& name)
+{
+    if (!_isInsideFrame)
+    {
+        return;
+    }
+
+    //The timestamp of the new section also ends the current one.
+    closeSection();
+
+    std::vector<RenderSectionStatistics>& sections = _currentFrame.statistics.sections;
+    auto it = _sectionIndex.find(name);
+    if (it == _sectionIndex.end())
+    {
+        it = _sectionIndex.emplace(name, static_cast<int>(sections.size())).first;
+        sections.emplace_back();
+        sections.back().name = name;
+    }
+
+    _currentSection = it->second;
+    _counters = &sections[static_cast<size_t>(_currentSection)].counters;
+
+    recordTimestamp(_currentSection);
+    _sectionTimer.start();
+}
+
+
+
+void RenderProfiler::beginItem(const GraphicsItem* item)
+{
+    if (!_isInsideFrame)
+    {
+        return;
+    }
+
+    //Items of the same type share the open section.
+    const std::type_info& type = typeid(*item);
+    if (_currentItemType != nullptr && *_currentItemType == type)
+    {
+        return;
+    }
+
+    beginSection(getTypeName(item));
+    _currentItemType = &type;
+}
+
+
+
+void RenderProfiler::endSection()
+{
+    if (!_isInsideFrame || _currentSection < 0)
+    {
+        return;
+    }
+
+    closeSection();
+    recordTimestamp(-1);
+}
+
+
+
+void RenderProfiler::endFrame()
+{
+    if (!_isInsideFrame)
+    {
+        return;
+    }
+
+    endSection();
+    recordTimestamp(-1);
+
+    //The frame counters have the work done outside the sections up to now.
+    FrameStatistics& statistics = _currentFrame.statistics;
+    for (const RenderSectionStatistics& section : statistics.sections)
+    {
+        statistics.counters += section.counters;
+    }
+    statistics.cpuTime = _frameTimer.nsecsElapsed() * 1e-6;
+
+    _counters = nullptr;
+    _isInsideFrame = false;
+
+    _pendingFrames.push_back(std::move(_currentFrame));
+    _currentFrame = PendingFrame();
+
+    //Resolve the frames whose queries are ready, in order. Wait just if the GPU is too far behind.
+    while (!_pendingFrames.empty() && resolve(_pendingFrames.front(), _pendingFrames.size() > MAX_PENDING_FRAMES))
+    {
+        _pendingFrames.pop_front();
+    }
+}
+
+
+
+const FrameStatistics& RenderProfiler::getStatistics() const
+{
+    return _statistics;
+}
+
+
+
+void RenderProfiler::release()
+{
+    if (_isInsideFrame)
+    {
+        _counters = nullptr;
+        _isInsideFrame = false;
+    }
+
+    recycle(_currentFrame);
+    for (PendingFrame& frame : _pendingFrames)
+    {
+        recycle(frame);
+    }
+    _pendingFrames.clear();
+
+    for (QOpenGLTimerQuery* query : _freeQueries)
+    {
+        delete query;
+    }
+    _freeQueries.clear();
+}
+
+
+
+void RenderProfiler::countDrawCall()
+{
+    if (_counters != nullptr)
+    {
+        _counters->drawCalls++;
+    }
+}
+
+
+
+void RenderProfiler::countProgramBind()
+{
+    if (_counters != nullptr)
+    {
+        _counters->programBinds++;
+    }
+}
+
+
+
+void RenderProfiler::countVaoCreation()
+{
+    if (_counters != nullptr)
+    {
+        _counters->vaoCreations++;
+    }
+}
+
+
+
+void RenderProfiler::countUploadedBytes(long long bytes)
+{
+    if (_counters != nullptr)
+    {
+        _counters->uploadedBytes += bytes;
+    }
+}
+
+
+
+void RenderProfiler::countItems(unsigned int submitted, unsigned int culled, unsigned int reused)
+{
+    if (_counters != nullptr)
+    {
+        _counters->submittedItems += submitted;
+        _counters->culledItems += culled;
+        _counters->reusedItems += reused;
+    }
+}
+
+
+
+void RenderProfiler::closeSection()
+{
+    if (_currentSection < 0)
+    {
+        return;
+    }
+
+    RenderSectionStatistics& section = _currentFrame.statistics.sections[static_cast<size_t>(_currentSection)];
+    section.cpuTime += _sectionTimer.nsecsElapsed() * 1e-6;
+
+    _currentSection = -1;
+    _currentItemType = nullptr;
+    _counters = &_currentFrame.statistics.counters;
+}
+
+
+
+void RenderProfiler::recordTimestamp(int section)
+{
+    if (!_hasTimerQueries)
+    {
+        return;
+    }
+
+    QOpenGLTimerQuery* query = nullptr;
+    if (_freeQueries.empty())
+    {
+        query = new QOpenGLTimerQuery();
+        if (!query->create())
+        {
+            //Timestamps are not supported, so just the CPU times are measured from now on.
+            delete query;
+            _hasTimerQueries = false;
+            recycle(_currentFrame);
+            return;
+        }
+    }
+    else
+    {
+        query = _freeQueries.back();
+        _freeQueries.pop_back();
+    }
+
+    query->recordTimestamp();
+    _currentFrame.timestamps.push_back(query);
+    _currentFrame.intervalSections.push_back(section);
+}
+
+
+
+bool RenderProfiler::resolve(PendingFrame& frame, bool wait)
+{
+    FrameStatistics& statistics = frame.statistics;
+    if (frame.timestamps.empty())
+    {
+        statistics.gpuTime = -1;
+        for (RenderSectionStatistics& section : statistics.sections)
+        {
+            section.gpuTime = -1;
+        }
+    }
+    else
+    {
+        //The last query is the last one to finish.
+        if (!wait && !frame.timestamps.back()->isResultAvailable())
+        {
+            return false;
+        }
+
+        std::vector<GLuint64> times(frame.timestamps.size());
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            times[i] = frame.timestamps[i]->waitForResult();
+        }
+
+        for (size_t i = 0; i + 1 < times.size(); i++)
+        {
+            int section = frame.intervalSections[i];
+            if (section >= 0)
+            {
+                statistics.sections[static_cast<size_t>(section)].gpuTime += (times[i + 1] - times[i]) * 1e-6;
+            }
+        }
+        statistics.gpuTime = (times.back() - times.front()) * 1e-6;
+    }
+
+    recycle(frame);
+    _statistics = std::move(statistics);
+    return true;
+}
+
+
+
+void RenderProfiler::recycle(PendingFrame& frame)
+{
+    _freeQueries.insert(_freeQueries.end(), frame.timestamps.begin(), frame.timestamps.end());
+    frame.timestamps.clear();
+    frame.intervalSections.clear();
+}
+
+
+
+const std::string& RenderProfiler::getTypeName(const GraphicsItem* item)
+{
+    std::type_index type(typeid(*item));
+    auto it = _typeNames.find(type);
+    if (it == _typeNames.end())
+    {
+        std::string name = type.name();
+#ifdef __GNUG__
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+        if (status == 0)
+        {
+            name = demangled;
+        }
+        std::free(demangled);
+#endif
+        //Remove the namespaces and, on MSVC, the "class " prefix.
+        size_t position = name.rfind("::");
+        if (position != std::string::npos)
+        {
+            name = name.substr(position + 2);
+        }
+        it = _typeNames.emplace(type, name).first;
+    }
+    return it->second;
+}
+}
@@ -0,0 +1,378 @@
+#pragma once
+#include <deque>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <vector>
+#include <QElapsedTimer>
+
+class QOpenGLTimerQuery;
+
+namespace rm
+{
+/**
+ * Forward declarations.
+ */
+class GraphicsItem;
+
+/**
+ * @brief The RenderCounters struct - OpenGL work issued while rendering.
+ */
+struct RenderCounters
+{
+    /**
+     * @brief drawCalls - Number of draw calls.
+     */
+    unsigned int drawCalls {0};
+
+    /**
+     * @brief programBinds - Number of shader program binds.
+     */
+    unsigned int programBinds {0};
+
+    /**
+     * @brief vaoCreations - Number of vertex array objects created.
+     */
+    unsigned int vaoCreations {0};
+
+    /**
+     * @brief uploadedBytes - Number of bytes given to glBufferData and glBufferSubData.
+     */
+    long long uploadedBytes {0};
+
+    /**
+     * @brief submittedItems - Number of items rendered.
+     */
+    unsigned int submittedItems {0};
+
+    /**
+     * @brief culledItems - Number of items skipped because they are outside the view.
+     */
+    unsigned int culledItems {0};
+
+    /**
+     * @brief reusedItems - Number of items inside the view kept from a cached frame instead of being rendered.
+     */
+    unsigned int reusedItems {0};
+
+    /**
+     * @brief clear - Sets all counters to zero.
+     */
+    void clear();
+
+    /**
+     * @brief operator += - Adds the counters of another object.
+     * @param counters - Counters to be added.
+     * @return - Returns this object.
+     */
+    RenderCounters& operator+=(const RenderCounters& counters);
+};
+
+/**
+ * @brief The RenderSectionStatistics struct - Statistics of a part of a frame. Items of the same type share a section.
+ */
+struct RenderSectionStatistics
+{
+    /**
+     * @brief name - Section name. Item sections are named after the item class.
+     */
+    std::string name;
+
+    /**
+     * @brief cpuTime - CPU time spent on the section, in milliseconds.
+     */
+    double cpuTime {0};
+
+    /**
+     * @brief gpuTime - GPU time spent on the section, in milliseconds, or -1 if timer queries are not supported.
+     */
+    double gpuTime {0};
+
+    /**
+     * @brief counters - OpenGL work issued by the section.
+     */
+    RenderCounters counters;
+};
+
+/**
+ * @brief The FrameStatistics struct - Statistics of a frame of a view.
+ */
+struct FrameStatistics
+{
+    /**
+     * @brief frame - Frame number, counted from the first profiled frame of the view.
+     */
+    unsigned long long frame {0};
+
+    /**
+     * @brief cpuTime - CPU time spent on the frame, in milliseconds.
+     */
+    double cpuTime {0};
+
+    /**
+     * @brief gpuTime - GPU time spent on the frame, in milliseconds, or -1 if timer queries are not supported.
+     */
+    double gpuTime {-1};
+
+    /**
+     * @brief counters - OpenGL work issued by the whole frame, including the sections.
+     */
+    RenderCounters counters;
+
+    /**
+     * @brief sections - Statistics of each section, in the order they were first rendered.
+     */
+    std::vector<RenderSectionStatistics> sections;
+};
+
+/**
+ * This class measures where the frame time of a view goes. A frame is split on sections, usually one per item type,
+ * and each section gets its CPU time, its GPU time and the OpenGL work it issued (draw calls, program binds, uploaded
+ * bytes and VAO creations). The GPU time comes from timestamp queries that are read only when their results are
+ * available, a few frames later, so the profiler never stalls the pipeline. The statistics returned are the ones of the
+ * last frame whose results are known.
+ *
+ * The profiler is disabled by default and, while disabled, all its functions return without doing anything. The
+ * counting functions are static and are called by the rendering code, so they add to the frame being profiled on the
+ * calling thread, if any. Work done by the background loader is not counted.
+ */
+class RenderProfiler
+{
+public:
+    /**
+     * @brief Constructor.
+     */
+    RenderProfiler() = default;
+
+    /**
+     * @brief ~RenderProfiler - Destructor. The view context should be current if the profiler was ever used.
+     */
+    ~RenderProfiler();
+
+    /**
+     * @brief RenderProfiler - The queries belong to one context, so the profiler can not be copied.
+     */
+    RenderProfiler(const RenderProfiler&) = delete;
+
+    /**
+     * @brief operator = - The queries belong to one context, so the profiler can not be copied.
+     */
+    RenderProfiler& operator=(const RenderProfiler&) = delete;
+
+    /**
+     * @brief setEnabled - Enables or disables the profiler.
+     * @param enable - True to profile the next frames.
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * @brief isEnabled - Verifies if the profiler is enabled.
+     * @return - Returns true if the frames are being profiled.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief beginFrame - Starts profiling a frame. It must be called with the view context current.
+     */
+    void beginFrame();
+
+    /**
+     * @brief beginSection - Starts a section. The current section, if any, is ended. Sections with the same name are
+     * accumulated. A single timestamp marks the boundary between both sections.
+     * @param name - Section name.
+     */
+    void beginSection(const std::string& name);
+
+    /**
+     * @brief beginItem - Starts the section of the type of an item. Consecutive items of the same type stay on the
+     * section already open, so a run of items costs a single timestamp. The section is ended by the next section of
+     * another type or by endSection().
+     * @param item - Item to be rendered.
+     */
+    void beginItem(const GraphicsItem* item);
+
+    /**
+     * @brief endSection - Ends the current section. The work done until the next section is counted just on the frame.
+     */
+    void endSection();
+
+    /**
+     * @brief endFrame - Ends the current frame and reads the timer queries of the previous frames that are ready.
+     */
+    void endFrame();
+
+    /**
+     * @brief getStatistics - Gets the statistics of the last resolved frame.
+     * @return - Returns the frame statistics.
+     */
+    const FrameStatistics& getStatistics() const;
+
+    /**
+     * @brief release - Deletes the timer queries and discards the frames not resolved. The view context must be
+     * current.
+     */
+    void release();
+
+    /**
+     * @brief countDrawCall - Counts a draw call on the frame being profiled.
+     */
+    static void countDrawCall();
+
+    /**
+     * @brief countProgramBind - Counts a shader program bind on the frame being profiled.
+     */
+    static void countProgramBind();
+
+    /**
+     * @brief countVaoCreation - Counts a vertex array object creation on the frame being profiled.
+     */
+    static void countVaoCreation();
+
+    /**
+     * @brief countUploadedBytes - Counts bytes uploaded to a buffer on the frame being profiled.
+     * @param bytes - Number of bytes.
+     */
+    static void countUploadedBytes(long long bytes);
+
+    /**
+     * @brief countItems - Counts the items rendered, culled and reused by a view on the frame being profiled.
+     * @param submitted - Number of items rendered.
+     * @param culled - Number of items skipped because they are outside the view.
+     * @param reused - Number of items inside the view kept from a cached frame.
+     */
+    static void countItems(unsigned int submitted, unsigned int culled, unsigned int reused);
+
+private:
+    /**
+     * @brief The PendingFrame struct - Frame waiting for its timer queries.
+     */
+    struct PendingFrame
+    {
+        /**
+         * @brief statistics - Frame statistics. The GPU times are filled when the frame is resolved.
+         */
+        FrameStatistics statistics;
+
+        /**
+         * @brief timestamps - Timestamp queries recorded at the frame and section boundaries.
+         */
+        std::vector<QOpenGLTimerQuery*> timestamps;
+
+        /**
+         * @brief intervalSections - Section of the interval that starts at each timestamp, or -1 if it is outside
+         * any section.
+         */
+        std::vector<int> intervalSections;
+    };
+
+    /**
+     * @brief closeSection - Adds the CPU time of the current section and moves the counting back to the frame. The
+     * caller records the timestamp that ends the interval.
+     */
+    void closeSection();
+
+    /**
+     * @brief recordTimestamp - Records a timestamp on the current frame.
+     * @param section - Section of the interval that starts at this timestamp, or -1.
+     */
+    void recordTimestamp(int section);
+
+    /**
+     * @brief resolve - Reads the timer queries of a frame and makes it the current statistics.
+     * @param frame - Frame to be resolved.
+     * @param wait - True to wait for the queries, false to give up if they are not ready.
+     * @return - Returns true if the frame was resolved.
+     */
+    bool resolve(PendingFrame& frame, bool wait);
+
+    /**
+     * @brief recycle - Gives the queries of a frame back to the free list.
+     * @param frame - Frame.
+     */
+    void recycle(PendingFrame& frame);
+
+    /**
+     * @brief getTypeName - Gets the class name of an item, without namespaces.
+     * @param item - Item.
+     * @return - Returns the class name.
+     */
+    const std::string& getTypeName(const GraphicsItem* item);
+
+private:
+    /**
+     * @brief _isEnabled - True if the frames are being profiled.
+     */
+    bool _isEnabled {false};
+
+    /**
+     * @brief _isInsideFrame - True between beginFrame and endFrame of a profiled frame.
+     */
+    bool _isInsideFrame {false};
+
+    /**
+     * @brief _hasTimerQueries - False after a timer query could not be created.
+     */
+    bool _hasTimerQueries {true};
+
+    /**
+     * @brief _numberOfFrames - Number of frames profiled.
+     */
+    unsigned long long _numberOfFrames {0};
+
+    /**
+     * @brief _frameTimer - CPU timer of the current frame.
+     */
+    QElapsedTimer _frameTimer;
+
+    /**
+     * @brief _sectionTimer - CPU timer of the current section.
+     */
+    QElapsedTimer _sectionTimer;
+
+    /**
+     * @brief _currentSection - Index of the current section, or -1.
+     */
+    int _currentSection {-1};
+
+    /**
+     * @brief _currentItemType - Item type of the current section, or nullptr if it is not an item section.
+     */
+    const std::type_info* _currentItemType {nullptr};
+
+    /**
+     * @brief _currentFrame - Frame being profiled.
+     */
+    PendingFrame _currentFrame;
+
+    /**
+     * @brief _sectionIndex - Index of each section of the current frame by name.
+     */
+    std::map<std::string, int> _sectionIndex;
+
+    /**
+     * @brief _pendingFrames - Frames waiting for their timer queries, from the oldest.
+     */
+    std::deque<PendingFrame> _pendingFrames;
+
+    /**
+     * @brief _freeQueries - Timer queries that can be reused.
+     */
+    std::vector<QOpenGLTimerQuery*> _freeQueries;
+
+    /**
+     * @brief _typeNames - Cache of the item class names.
+     */
+    std::map<std::type_index, std::string> _typeNames;
+
+    /**
+     * @brief _statistics - Statistics of the last resolved frame.
+     */
+    FrameStatistics _statistics;
+
+    /**
+     * @brief _counters - Counters that receive the work of the calling thread, or nullptr if no frame is being
+     * profiled on it.
+     */
+    static thread_local RenderCounters* _counters;
+};
+}
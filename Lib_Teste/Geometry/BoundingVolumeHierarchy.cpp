@@ -0,0 +1,356 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <cmath>
+
+namespace rm
+{
+namespace
+{
+/**
+ * @brief getArea - Gets half of the surface area of a box, which is enough to compare the SAH costs.
+ * @param min - Minimal corner.
+ * @param max - Maximal corner.
+ * @return - Returns the half area.
+ */
+float getArea(const float* min, const float* max)
+{
+    float dx = max[0] - min[0];
+    float dy = max[1] - min[1];
+    float dz = max[2] - min[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+
+
+/**
+ * @brief setEmpty - Sets a box that contains nothing, so that it can be grown.
+ * @param min - Minimal corner.
+ * @param max - Maximal corner.
+ */
+void setEmpty(float* min, float* max)
+{
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        min[k] = std::numeric_limits<float>::max();
+        max[k] = -std::numeric_limits<float>::max();
+    }
+}
+
+
+
+/**
+ * @brief grow - Grows a box to contain another box.
+ * @param min - Minimal corner of the grown box.
+ * @param max - Maximal corner of the grown box.
+ * @param otherMin - Minimal corner of the contained box.
+ * @param otherMax - Maximal corner of the contained box.
+ */
+void grow(float* min, float* max, const float* otherMin, const float* otherMax)
+{
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        min[k] = std::min(min[k], otherMin[k]);
+        max[k] = std::max(max[k], otherMax[k]);
+    }
+}
+
+
+
+/**
+ * @brief getCentroid - Gets a coordinate of the center of a box, times two.
+ * @param box - Box.
+ * @param axis - Coordinate axis.
+ * @return - Returns the doubled coordinate.
+ */
+float getCentroid(const BoundingVolumeHierarchy::Box& box, unsigned int axis)
+{
+    return box.min[axis] + box.max[axis];
+}
+}
+
+
+
+void BoundingVolumeHierarchy::build(const std::vector<Box>& boxes)
+{
+    clear();
+    if (boxes.empty())
+    {
+        return;
+    }
+
+    _primitives.resize(boxes.size());
+    for (unsigned int i = 0; i < _primitives.size(); i++)
+    {
+        _primitives[i] = i;
+    }
+
+    //A binary tree with leaves of at least one primitive has less than two nodes per primitive.
+    _nodes.reserve(2 * boxes.size());
+    buildNode(boxes, 0, static_cast<unsigned int>(boxes.size()), 0);
+}
+
+
+
+void BoundingVolumeHierarchy::refit(const std::vector<Box>& boxes)
+{
+    //The children are always after their parent, so a reverse walk visits them first.
+    for (size_t i = _nodes.size(); i-- > 0;)
+    {
+        Node& node = _nodes[i];
+        setEmpty(node.min, node.max);
+        if (node.count > 0)
+        {
+            for (unsigned int j = node.index; j < node.index + node.count; j++)
+            {
+                const Box& box = boxes[_primitives[j]];
+                grow(node.min, node.max, box.min, box.max);
+            }
+        }
+        else
+        {
+            const Node& left = _nodes[i + 1];
+            const Node& right = _nodes[node.index];
+            grow(node.min, node.max, left.min, left.max);
+            grow(node.min, node.max, right.min, right.max);
+        }
+    }
+}
+
+
+
+void BoundingVolumeHierarchy::clear()
+{
+    _nodes.clear();
+    _primitives.clear();
+}
+
+
+
+bool BoundingVolumeHierarchy::isEmpty() const
+{
+    return _nodes.empty();
+}
+
+
+
+size_t BoundingVolumeHierarchy::getNumberOfNodes() const
+{
+    return _nodes.size();
+}
+
+
+
+bool BoundingVolumeHierarchy::intersectTriangle(const QVector3D& origin, const QVector3D& direction,
+                                                const QVector3D& p0, const QVector3D& p1, const QVector3D& p2,
+                                                float& t, float& u, float& v)
+{
+    const float epsilon = 1e-12f;
+    QVector3D e1 = p1 - p0;
+    QVector3D e2 = p2 - p0;
+    QVector3D p = QVector3D::crossProduct(direction, e2);
+    float det = QVector3D::dotProduct(e1, p);
+    if (std::abs(det) < epsilon)
+    {
+        //The ray is parallel to the triangle.
+        return false;
+    }
+
+    float inverseDet = 1.0f / det;
+    QVector3D s = origin - p0;
+    u = QVector3D::dotProduct(s, p) * inverseDet;
+    if (u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+
+    QVector3D q = QVector3D::crossProduct(s, e1);
+    v = QVector3D::dotProduct(direction, q) * inverseDet;
+    if (v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+
+    t = QVector3D::dotProduct(e2, q) * inverseDet;
+    return t > 0.0f;
+}
+
+
+
+unsigned int BoundingVolumeHierarchy::buildNode(const std::vector<Box>& boxes, unsigned int begin, unsigned int end,
+                                                unsigned int depth)
+{
+    unsigned int nodeIndex = static_cast<unsigned int>(_nodes.size());
+    _nodes.push_back(Node());
+
+    //Bounds of the primitives and of their centroids.
+    float min[3], max[3], centroidMin[3], centroidMax[3];
+    setEmpty(min, max);
+    setEmpty(centroidMin, centroidMax);
+    for (unsigned int i = begin; i < end; i++)
+    {
+        const Box& box = boxes[_primitives[i]];
+        grow(min, max, box.min, box.max);
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            centroidMin[k] = std::min(centroidMin[k], getCentroid(box, k));
+            centroidMax[k] = std::max(centroidMax[k], getCentroid(box, k));
+        }
+    }
+
+    std::copy(min, min + 3, _nodes[nodeIndex].min);
+    std::copy(max, max + 3, _nodes[nodeIndex].max);
+
+    unsigned int count = end - begin;
+    if (count <= 2 || depth + 1 >= getMaxDepth())
+    {
+        _nodes[nodeIndex].index = begin;
+        _nodes[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    //Evaluate the SAH cost of the planes between the bins of each axis.
+    const unsigned int numBins = getNumberOfBins();
+    float bestCost = std::numeric_limits<float>::max();
+    unsigned int bestAxis = 3, bestPlane = 0;
+    for (unsigned int axis = 0; axis < 3; axis++)
+    {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f)
+        {
+            continue;
+        }
+
+        float binMin[numBins][3], binMax[numBins][3];
+        unsigned int binCount[numBins] = {};
+        for (unsigned int b = 0; b < numBins; b++)
+        {
+            setEmpty(binMin[b], binMax[b]);
+        }
+
+        float scale = numBins / extent;
+        for (unsigned int i = begin; i < end; i++)
+        {
+            const Box& box = boxes[_primitives[i]];
+            unsigned int b = std::min(numBins - 1,
+                                      static_cast<unsigned int>((getCentroid(box, axis) - centroidMin[axis]) * scale));
+            binCount[b]++;
+            grow(binMin[b], binMax[b], box.min, box.max);
+        }
+
+        //Sweep from the right to get the area and count to the right of each plane.
+        float rightArea[numBins];
+        unsigned int rightCount[numBins];
+        float sweepMin[3], sweepMax[3];
+        setEmpty(sweepMin, sweepMax);
+        unsigned int sweepCount = 0;
+        for (unsigned int b = numBins - 1; b > 0; b--)
+        {
+            grow(sweepMin, sweepMax, binMin[b], binMax[b]);
+            sweepCount += binCount[b];
+            rightArea[b] = sweepCount > 0 ? getArea(sweepMin, sweepMax) : 0.0f;
+            rightCount[b] = sweepCount;
+        }
+
+        setEmpty(sweepMin, sweepMax);
+        sweepCount = 0;
+        for (unsigned int b = 0; b < numBins - 1; b++)
+        {
+            grow(sweepMin, sweepMax, binMin[b], binMax[b]);
+            sweepCount += binCount[b];
+            if (sweepCount == 0 || rightCount[b + 1] == 0)
+            {
+                continue;
+            }
+
+            float cost = sweepCount * getArea(sweepMin, sweepMax) + rightCount[b + 1] * rightArea[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestPlane = b;
+            }
+        }
+    }
+
+    unsigned int middle;
+    if (bestAxis == 3)
+    {
+        //All centroids are at the same point, so split the primitives in half.
+        middle = begin + count / 2;
+    }
+    else
+    {
+        //Keep a leaf if no split is cheaper than testing all primitives.
+        float leafCost = count * getArea(min, max);
+        if (count <= getMaxLeafSize() && bestCost >= leafCost)
+        {
+            _nodes[nodeIndex].index = begin;
+            _nodes[nodeIndex].count = count;
+            return nodeIndex;
+        }
+
+        float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+        float scale = numBins / extent;
+        unsigned int* first = _primitives.data() + begin;
+        unsigned int* last = _primitives.data() + end;
+        unsigned int* split = std::partition(first, last, [&](unsigned int primitive)
+        {
+            float offset = (getCentroid(boxes[primitive], bestAxis) - centroidMin[bestAxis]) * scale;
+            return std::min(numBins - 1, static_cast<unsigned int>(offset)) <= bestPlane;
+        });
+        middle = begin + static_cast<unsigned int>(split - first);
+        if (middle == begin || middle == end)
+        {
+            middle = begin + count / 2;
+        }
+    }
+
+    _nodes[nodeIndex].count = 0;
+    buildNode(boxes, begin, middle, depth + 1);
+    _nodes[nodeIndex].index = buildNode(boxes, middle, end, depth + 1);
+    return nodeIndex;
+}
+
+
+
+bool BoundingVolumeHierarchy::isBoxOutside(const float* min, const float* max, const QVector4D* planes,
+                                            unsigned int numberOfPlanes)
+{
+    for (unsigned int i = 0; i < numberOfPlanes; i++)
+    {
+        //The box corner farthest along the plane normal is the last one to leave the inside.
+        const QVector4D& plane = planes[i];
+        float x = plane.x() >= 0.0f ? max[0] : min[0];
+        float y = plane.y() >= 0.0f ? max[1] : min[1];
+        float z = plane.z() >= 0.0f ? max[2] : min[2];
+        if (plane.x() * x + plane.y() * y + plane.z() * z + plane.w() < 0.0f)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
+float BoundingVolumeHierarchy::intersectNode(const Node& node, const float* origin, const float* inverseDirection,
+                                             float tMax)
+{
+    float tMin = 0.0f;
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        float t0 = (node.min[k] - origin[k]) * inverseDirection[k];
+        float t1 = (node.max[k] - origin[k]) * inverseDirection[k];
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+
+        //The comparisons are written so that NaN (origin on a box plane parallel to the ray) does not cull the box.
+        tMin = t0 > tMin ? t0 : tMin;
+        tMax = t1 < tMax ? t1 : tMax;
+    }
+
+    return tMin <= tMax ? tMin : std::numeric_limits<float>::infinity();
+}
+}
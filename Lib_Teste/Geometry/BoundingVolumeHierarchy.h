@@ -0,0 +1,319 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <QVector3D>
+#include <QVector4D>
+
+namespace rm
+{
+/**
+ * @brief The BoundingVolumeHierarchy class - Binary tree of axis aligned boxes over a set of primitives, used to find
+ * the primitives hit by a ray. The tree is built top-down with a binned surface area heuristic (SAH) and stored as a
+ * flat array in depth-first order: the left child of a node is the next node, so a traversal reads the array mostly
+ * forward.
+ */
+class BoundingVolumeHierarchy
+{
+public:
+    /**
+     * @brief The Box struct - Bounds of a primitive.
+     */
+    struct Box
+    {
+        /**
+         * @brief min - Minimal corner.
+         */
+        float min[3];
+
+        /**
+         * @brief max - Maximal corner.
+         */
+        float max[3];
+    };
+
+    /**
+     * @brief build - Builds the tree. Previous nodes are discarded.
+     * @param boxes - Bounds of each primitive. Primitives are identified by their position on this vector.
+     */
+    void build(const std::vector<Box>& boxes);
+
+    /**
+     * @brief refit - Recomputes the node bounds keeping the tree topology. Used when the primitives move a little,
+     * which is much cheaper than a new build.
+     * @param boxes - New bounds of each primitive. It must have the same size used to build the tree.
+     */
+    void refit(const std::vector<Box>& boxes);
+
+    /**
+     * @brief clear - Removes all nodes.
+     */
+    void clear();
+
+    /**
+     * @brief isEmpty - Verifies if the tree has no nodes.
+     * @return - Returns true if the tree was not built or has no primitives.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief getNumberOfNodes - Gets the number of nodes.
+     * @return - Returns the number of nodes.
+     */
+    size_t getNumberOfNodes() const;
+
+    /**
+     * @brief intersect - Finds the nearest primitive hit by a ray.
+     * @param origin - Ray origin.
+     * @param direction - Ray direction. It does not need to be normalized.
+     * @param tMax - Largest ray parameter accepted. It is reduced to the parameter of the nearest hit.
+     * @param intersectPrimitive - Function called as intersectPrimitive(primitive, tMax) for the primitives whose
+     * boxes are hit. It returns true and reduces tMax if the primitive is hit before tMax.
+     * @return - Returns true if some primitive was hit.
+     */
+    template<class IntersectFunction>
+    bool intersect(const QVector3D& origin, const QVector3D& direction, float& tMax,
+                   const IntersectFunction& intersectPrimitive) const;
+
+    /**
+     * @brief query - Finds the primitives whose boxes may be inside a convex region, like a view frustum. Boxes that
+     * cross a plane are kept, so some primitives outside the region can be visited.
+     * @param planes - Planes (a, b, c, d) of the region. The inside points satisfy a * x + b * y + c * z + d >= 0.
+     * @param numberOfPlanes - Number of planes.
+     * @param visit - Function called as visit(primitive) for the primitives on the leaves inside the region.
+     */
+    template<class VisitFunction>
+    void query(const QVector4D* planes, unsigned int numberOfPlanes, const VisitFunction& visit) const;
+
+    /**
+     * @brief isBoxOutside - Verifies if a box is completely outside one of the planes of a convex region.
+     * @param min - Minimal corner of the box.
+     * @param max - Maximal corner of the box.
+     * @param planes - Planes of the region, with the inside on their positive side.
+     * @param numberOfPlanes - Number of planes.
+     * @return - Returns true if the box is outside the region.
+     */
+    static bool isBoxOutside(const float* min, const float* max, const QVector4D* planes, unsigned int numberOfPlanes);
+
+    /**
+     * @brief intersectTriangle - Intersects a ray with a triangle (Moller-Trumbore algorithm).
+     * @param origin - Ray origin.
+     * @param direction - Ray direction.
+     * @param p0 - First triangle vertex.
+     * @param p1 - Second triangle vertex.
+     * @param p2 - Third triangle vertex.
+     * @param t - Ray parameter of the hit.
+     * @param u - Barycentric coordinate of p1 on the hit point.
+     * @param v - Barycentric coordinate of p2 on the hit point.
+     * @return - Returns true if the ray hits the triangle with t > 0.
+     */
+    static bool intersectTriangle(const QVector3D& origin, const QVector3D& direction, const QVector3D& p0,
+                                  const QVector3D& p1, const QVector3D& p2, float& t, float& u, float& v);
+
+private:
+    /**
+     * @brief The Node struct - Tree node. It has 32 bytes, so two nodes fit in a cache line.
+     */
+    struct Node
+    {
+        /**
+         * @brief min - Minimal corner of the node box.
+         */
+        float min[3];
+
+        /**
+         * @brief index - Right child of an inner node or first position on _primitives of a leaf.
+         */
+        unsigned int index;
+
+        /**
+         * @brief max - Maximal corner of the node box.
+         */
+        float max[3];
+
+        /**
+         * @brief count - Number of primitives of a leaf. It is zero for inner nodes.
+         */
+        unsigned int count;
+    };
+
+    /**
+     * @brief buildNode - Builds a node and its subtree over the primitives [begin, end) of _primitives.
+     * @param boxes - Primitive bounds.
+     * @param begin - First position of the primitives.
+     * @param end - Position after the last primitive.
+     * @param depth - Node depth.
+     * @return - Returns the node position.
+     */
+    unsigned int buildNode(const std::vector<Box>& boxes, unsigned int begin, unsigned int end, unsigned int depth);
+
+    /**
+     * @brief intersectNode - Intersects a ray with a node box.
+     * @param node - Node.
+     * @param origin - Ray origin.
+     * @param inverseDirection - Inverse of each ray direction component.
+     * @param tMax - Largest ray parameter accepted.
+     * @return - Returns the ray parameter where it enters the box, or infinity if it misses the box.
+     */
+    static float intersectNode(const Node& node, const float* origin, const float* inverseDirection, float tMax);
+
+    /**
+     * @brief getMaxLeafSize - Gets the number of primitives from which a node is always split.
+     * @return - Returns the maximum leaf size.
+     */
+    constexpr static unsigned int getMaxLeafSize() { return 8; }
+
+    /**
+     * @brief getNumberOfBins - Gets the number of bins used to evaluate the SAH on each axis.
+     * @return - Returns the number of bins.
+     */
+    constexpr static unsigned int getNumberOfBins() { return 16; }
+
+    /**
+     * @brief getMaxDepth - Gets the maximum tree depth. It is also the traversal stack size.
+     * @return - Returns the maximum depth.
+     */
+    constexpr static unsigned int getMaxDepth() { return 64; }
+
+private:
+    /**
+     * @brief _nodes - Nodes in depth-first order. The root is the first node.
+     */
+    std::vector<Node> _nodes;
+
+    /**
+     * @brief _primitives - Primitive indexes ordered by leaf.
+     */
+    std::vector<unsigned int> _primitives;
+};
+
+
+
+template<class IntersectFunction>
+bool BoundingVolumeHierarchy::intersect(const QVector3D& origin, const QVector3D& direction, float& tMax,
+                                        const IntersectFunction& intersectPrimitive) const
+{
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    const float o[3] = {origin.x(), origin.y(), origin.z()};
+    const float inverseDirection[3] = {1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z()};
+    if (intersectNode(_nodes[0], o, inverseDirection, tMax) == std::numeric_limits<float>::infinity())
+    {
+        return false;
+    }
+
+    bool isHit = false;
+    unsigned int stack[getMaxDepth()];
+    unsigned int stackSize = 0;
+    unsigned int current = 0;
+    while (true)
+    {
+        const Node& node = _nodes[current];
+        if (node.count > 0)
+        {
+            for (unsigned int i = node.index; i < node.index + node.count; i++)
+            {
+                isHit = intersectPrimitive(_primitives[i], tMax) || isHit;
+            }
+        }
+        else
+        {
+            //Visit the nearest child first, so the farthest is often culled by the new tMax.
+            unsigned int left = current + 1;
+            unsigned int right = node.index;
+            float tLeft = intersectNode(_nodes[left], o, inverseDirection, tMax);
+            float tRight = intersectNode(_nodes[right], o, inverseDirection, tMax);
+            if (tRight < tLeft)
+            {
+                std::swap(tLeft, tRight);
+                std::swap(left, right);
+            }
+
+            if (tLeft != std::numeric_limits<float>::infinity())
+            {
+                if (tRight != std::numeric_limits<float>::infinity())
+                {
+                    stack[stackSize++] = right;
+                }
+                current = left;
+                continue;
+            }
+        }
+
+        //Pop the next node that can still be hit before tMax.
+        current = 0;
+        while (stackSize > 0)
+        {
+            unsigned int next = stack[--stackSize];
+            if (intersectNode(_nodes[next], o, inverseDirection, tMax) != std::numeric_limits<float>::infinity())
+            {
+                current = next;
+                break;
+            }
+        }
+
+        if (current == 0)
+        {
+            return isHit;
+        }
+    }
+}
+
+
+
+template<class VisitFunction>
+void BoundingVolumeHierarchy::query(const QVector4D* planes, unsigned int numberOfPlanes,
+                                    const VisitFunction& visit) const
+{
+    if (_nodes.empty() || isBoxOutside(_nodes[0].min, _nodes[0].max, planes, numberOfPlanes))
+    {
+        return;
+    }
+
+    unsigned int stack[getMaxDepth()];
+    unsigned int stackSize = 0;
+    unsigned int current = 0;
+    while (true)
+    {
+        const Node& node = _nodes[current];
+        if (node.count > 0)
+        {
+            for (unsigned int i = node.index; i < node.index + node.count; i++)
+            {
+                visit(_primitives[i]);
+            }
+        }
+        else
+        {
+            unsigned int left = current + 1;
+            unsigned int right = node.index;
+            bool isLeftInside = !isBoxOutside(_nodes[left].min, _nodes[left].max, planes, numberOfPlanes);
+            bool isRightInside = !isBoxOutside(_nodes[right].min, _nodes[right].max, planes, numberOfPlanes);
+            if (isLeftInside)
+            {
+                if (isRightInside)
+                {
+                    stack[stackSize++] = right;
+                }
+                current = left;
+                continue;
+            }
+            if (isRightInside)
+            {
+                current = right;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+        {
+            return;
+        }
+        current = stack[--stackSize];
+    }
+}
+}
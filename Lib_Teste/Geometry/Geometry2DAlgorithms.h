@@ -2,6 +2,7 @@
 #include "Vector2D.h"
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 template<class T>
 using Polygon2D = std::vector<Point2D<T>>;
@@ -40,6 +41,25 @@ public:
      */
     static Polygon2D<T> convexHull( std::vector<Point2D<T>>& points );
 
+    /**
+     * @brief inTriangle - Check if point is inside a triangle or on its boundary. The triangle can have any orientation
+     * @param p - Point to check
+     * @param a - First triangle vertex
+     * @param b - Second triangle vertex
+     * @param c - Third triangle vertex
+     * @return - True if the point is inside the triangle
+     */
+    static bool inTriangle( const Point2D<T>& p, const Point2D<T>& a, const Point2D<T>& b, const Point2D<T>& c );
+
+    /**
+     * @brief inQuadraticTriangle - Check if point is inside a quadratic (TRI6) triangle. The parametric coordinates of
+     * the point are found by Newton iterations on the quadratic map, so the curved edges are taken in account
+     * @param p - Point to check
+     * @param nodes - Six triangle nodes: the three vertices and then the midpoints of the edges 01, 12 and 20
+     * @return - True if the point is inside the triangle
+     */
+    static bool inQuadraticTriangle( const Point2D<T>& p, const Point2D<T>* nodes );
+
 public:
     static Point2D<T> _pivot;
 };
@@ -107,3 +127,60 @@ Polygon2D<T> Geometry2DAlgorithms<T>::convexHull( std::vector<Point2D<T>>& point
     U.resize( j );
     return U;
 }
+
+
+template<class T>
+bool Geometry2DAlgorithms<T>::inTriangle( const Point2D<T>& p, const Point2D<T>& a, const Point2D<T>& b,
+                                          const Point2D<T>& c )
+{
+    T d0 = ( b - a ) ^ ( p - a );
+    T d1 = ( c - b ) ^ ( p - b );
+    T d2 = ( a - c ) ^ ( p - c );
+
+    //The point is inside when it is on the same side of all edges.
+    bool hasNegative = d0 < 0 || d1 < 0 || d2 < 0;
+    bool hasPositive = d0 > 0 || d1 > 0 || d2 > 0;
+    return !( hasNegative && hasPositive );
+}
+
+
+template<class T>
+bool Geometry2DAlgorithms<T>::inQuadraticTriangle( const Point2D<T>& p, const Point2D<T>* nodes )
+{
+    const T tolerance = static_cast<T>( 1e-5 );
+
+    //Start on the centroid and solve x(r, s) = p, with l0 = 1 - r - s.
+    T r = static_cast<T>( 1.0 / 3.0 ), s = r;
+    for ( int iteration = 0; iteration < 16; iteration++ )
+    {
+        T l0 = 1 - r - s;
+        Point2D<T> x = ( l0 * ( 2 * l0 - 1 ) ) * nodes[0] + ( r * ( 2 * r - 1 ) ) * nodes[1] +
+                       ( s * ( 2 * s - 1 ) ) * nodes[2] + ( 4 * l0 * r ) * nodes[3] + ( 4 * r * s ) * nodes[4] +
+                       ( 4 * s * l0 ) * nodes[5];
+
+        //Derivatives of the map.
+        Point2D<T> dr = ( 1 - 4 * l0 ) * nodes[0] + ( 4 * r - 1 ) * nodes[1] + ( 4 * ( l0 - r ) ) * nodes[3] +
+                        ( 4 * s ) * nodes[4] - ( 4 * s ) * nodes[5];
+        Point2D<T> ds = ( 1 - 4 * l0 ) * nodes[0] + ( 4 * s - 1 ) * nodes[2] - ( 4 * r ) * nodes[3] +
+                        ( 4 * r ) * nodes[4] + ( 4 * ( l0 - s ) ) * nodes[5];
+
+        T det = dr ^ ds;
+        if ( det == 0 )
+        {
+            return false;
+        }
+
+        Point2D<T> e = p - x;
+        T deltaR = ( e ^ ds ) / det;
+        T deltaS = ( dr ^ e ) / det;
+        r += deltaR;
+        s += deltaS;
+        if ( std::abs( deltaR ) + std::abs( deltaS ) < tolerance )
+        {
+            return r >= -tolerance && s >= -tolerance && r + s <= 1 + tolerance;
+        }
+    }
+
+    //No convergence, the point is far from the element.
+    return false;
+}
@@ -0,0 +1,190 @@
+#include "PolylineSimplification.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace
+{
+/**
+ * @brief The Range struct - Polyline range waiting to be split by Douglas-Peucker.
+ */
+struct Range
+{
+    unsigned int first;
+    unsigned int last;
+    float error;
+};
+
+
+
+/**
+ * @brief distanceToChord - Computes the distance from a point to a segment. The segment can be a single point, as the
+ * chord that closes a loop.
+ */
+float distanceToChord(const Point2Df& p, const Point2Df& a, const Point2Df& b)
+{
+    Point2Df ab = b - a;
+    Point2Df ap = p - a;
+    float length2 = ab.x() * ab.x() + ab.y() * ab.y();
+    float t = length2 > 0.0f ? std::max(0.0f, std::min(1.0f, (ap.x() * ab.x() + ap.y() * ab.y()) / length2)) : 0.0f;
+    Point2Df d = ap - t * ab;
+    return std::sqrt(d.x() * d.x() + d.y() * d.y());
+}
+}
+
+namespace rm
+{
+void PolylineSimplification::build(const std::vector<Point2Df>& points, bool isClosed)
+{
+    clear();
+
+    unsigned int n = static_cast<unsigned int>(points.size());
+    if (n < 3)
+    {
+        return;
+    }
+
+    std::vector<float> errors;
+    computeErrors(points, isClosed, errors);
+
+    std::vector<float> sortedErrors(errors);
+    std::sort(sortedErrors.begin(), sortedErrors.end(), std::greater<float>());
+
+    //Each level keeps about half of the vertices of the previous one, so all levels have less than n indices.
+    unsigned int previousCount = n;
+    for (unsigned int target = n / 2; target >= 2; target /= 2)
+    {
+        //The largest error removed bounds the distance to the original polyline.
+        float levelError = sortedErrors[target];
+        if (levelError == std::numeric_limits<float>::max())
+        {
+            break;
+        }
+
+        Level level;
+        level.error = levelError;
+        level.first = static_cast<unsigned int>(_indices.size());
+        for (unsigned int i = 0; i < n; i++)
+        {
+            if (errors[i] > levelError)
+            {
+                _indices.push_back(i);
+            }
+        }
+        level.count = static_cast<unsigned int>(_indices.size()) - level.first;
+
+        //Equal errors can keep the same vertices on two levels.
+        if (level.count == previousCount)
+        {
+            _indices.resize(level.first);
+            continue;
+        }
+
+        _levels.push_back(level);
+        previousCount = level.count;
+    }
+}
+
+
+
+void PolylineSimplification::clear()
+{
+    _levels.clear();
+    _indices.clear();
+}
+
+
+
+int PolylineSimplification::findLevel(float tolerance) const
+{
+    for (int i = static_cast<int>(_levels.size()) - 1; i >= 0; i--)
+    {
+        if (_levels[i].error <= tolerance)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+
+const std::vector<PolylineSimplification::Level>& PolylineSimplification::getLevels() const
+{
+    return _levels;
+}
+
+
+
+const std::vector<unsigned int>& PolylineSimplification::getIndices() const
+{
+    return _indices;
+}
+
+
+
+void PolylineSimplification::computeErrors(const std::vector<Point2Df>& points, bool isClosed,
+                                           std::vector<float>& errors)
+{
+    const float maxError = std::numeric_limits<float>::max();
+    unsigned int n = static_cast<unsigned int>(points.size());
+    errors.assign(n, 0.0f);
+    errors[0] = maxError;
+
+    //The ranges use the index n as the first vertex, which closes the loop.
+    std::vector<Range> stack;
+    if (isClosed)
+    {
+        unsigned int farthest = 1;
+        float farthestDistance = -1.0f;
+        for (unsigned int i = 1; i < n; i++)
+        {
+            float distance = distanceToChord(points[i], points[0], points[0]);
+            if (distance > farthestDistance)
+            {
+                farthest = i;
+                farthestDistance = distance;
+            }
+        }
+        errors[farthest] = maxError;
+        stack.push_back({0, farthest, maxError});
+        stack.push_back({farthest, n, maxError});
+    }
+    else
+    {
+        errors[n - 1] = maxError;
+        stack.push_back({0, n - 1, maxError});
+    }
+
+    while (!stack.empty())
+    {
+        Range range = stack.back();
+        stack.pop_back();
+        if (range.last - range.first < 2)
+        {
+            continue;
+        }
+
+        //Split the range at the vertex farthest from its chord.
+        const Point2Df& a = points[range.first];
+        const Point2Df& b = points[range.last % n];
+        unsigned int split = range.first + 1;
+        float splitDistance = -1.0f;
+        for (unsigned int i = range.first + 1; i < range.last; i++)
+        {
+            float distance = distanceToChord(points[i], a, b);
+            if (distance > splitDistance)
+            {
+                split = i;
+                splitDistance = distance;
+            }
+        }
+
+        float error = std::min(splitDistance, range.error);
+        errors[split] = error;
+        stack.push_back({range.first, split, error});
+        stack.push_back({split, range.last, error});
+    }
+}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include "Vector2D.h"
+
+namespace rm
+{
+/**
+ * @brief The PolylineSimplification class - Multi-resolution representation of a polyline. Each vertex gets the
+ * Douglas-Peucker tolerance below which it is kept, and a few levels are extracted from those errors, each one with
+ * about half of the vertices of the previous level. A level is a list of vertex indices, in the polyline order, whose
+ * line is no farther than the level error from the original polyline.
+ *
+ * The first and the last vertices are always kept. On closed polylines the vertex farthest from the first one is kept
+ * too, so the loop never collapses.
+ */
+class PolylineSimplification
+{
+public:
+    /**
+     * @brief The Level struct - Range of a level on the index vector.
+     */
+    struct Level
+    {
+        /**
+         * @brief error - Maximal distance from the level line to the original polyline, in polyline coordinates.
+         */
+        float error {0.0f};
+
+        /**
+         * @brief first - Position of the first index of the level.
+         */
+        unsigned int first {0};
+
+        /**
+         * @brief count - Number of indices of the level.
+         */
+        unsigned int count {0};
+    };
+
+public:
+    /**
+     * @brief build - Computes the levels of a polyline. Previous data is discarded.
+     * @param points - Polyline vertices.
+     * @param isClosed - True if the last vertex is linked to the first one.
+     */
+    void build(const std::vector<Point2Df>& points, bool isClosed);
+
+    /**
+     * @brief clear - Removes all levels.
+     */
+    void clear();
+
+    /**
+     * @brief findLevel - Finds the coarsest level whose error is not greater than a tolerance.
+     * @param tolerance - Maximal error accepted, in polyline coordinates.
+     * @return - Returns the level position, or -1 if no level is coarse enough and all vertices must be used.
+     */
+    int findLevel(float tolerance) const;
+
+    /**
+     * @brief getLevels - Gets the levels, from the finest to the coarsest.
+     * @return - Returns the levels.
+     */
+    const std::vector<Level>& getLevels() const;
+
+    /**
+     * @brief getIndices - Gets the vertex indices of all levels, one level after another.
+     * @return - Returns the indices.
+     */
+    const std::vector<unsigned int>& getIndices() const;
+
+private:
+    /**
+     * @brief computeErrors - Runs Douglas-Peucker on the whole polyline, saving the tolerance below which each vertex
+     * is kept. The error of a vertex is never greater than the error of the vertex that split its range, so each
+     * tolerance gives the same vertices as a Douglas-Peucker run with it.
+     * @param points - Polyline vertices.
+     * @param isClosed - True if the last vertex is linked to the first one.
+     * @param errors - Vector to receive the error of each vertex.
+     */
+    static void computeErrors(const std::vector<Point2Df>& points, bool isClosed, std::vector<float>& errors);
+
+private:
+    /**
+     * @brief _levels - Levels, from the finest to the coarsest.
+     */
+    std::vector<Level> _levels;
+
+    /**
+     * @brief _indices - Vertex indices of all levels.
+     */
+    std::vector<unsigned int> _indices;
+};
+}
@@ -0,0 +1,98 @@
+#include "UniformGrid2D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rm
+{
+void UniformGrid2D::build(const std::vector<AABB2D>& boxes)
+{
+    clear();
+    if (boxes.empty())
+    {
+        return;
+    }
+
+    //Grid bounds.
+    _min = boxes[0].getMinCornerPoint();
+    _max = boxes[0].getMaxCornerPoint();
+    for (const AABB2D& box : boxes)
+    {
+        _min[0] = std::min(_min.x(), box.getMinCornerPoint().x());
+        _min[1] = std::min(_min.y(), box.getMinCornerPoint().y());
+        _max[0] = std::max(_max.x(), box.getMaxCornerPoint().x());
+        _max[1] = std::max(_max.y(), box.getMaxCornerPoint().y());
+    }
+
+    //About one element per grid cell, with cells as square as possible.
+    float width = std::max(_max.x() - _min.x(), std::numeric_limits<float>::min());
+    float height = std::max(_max.y() - _min.y(), std::numeric_limits<float>::min());
+    float cellSize = std::sqrt(width * height / boxes.size());
+    _resolution[0] = std::max(1, std::min(static_cast<int>(width / cellSize), 4096));
+    _resolution[1] = std::max(1, std::min(static_cast<int>(height / cellSize), 4096));
+    _inverseCellSize = Point2Df(_resolution[0] / width, _resolution[1] / height);
+
+    //Count the elements of each grid cell and turn the counters into offsets.
+    size_t numCells = static_cast<size_t>(_resolution[0]) * static_cast<size_t>(_resolution[1]);
+    _firstElement.assign(numCells + 1, 0);
+    for (const AABB2D& box : boxes)
+    {
+        int x0 = getCell(box.getMinCornerPoint().x(), 0), x1 = getCell(box.getMaxCornerPoint().x(), 0);
+        int y0 = getCell(box.getMinCornerPoint().y(), 1), y1 = getCell(box.getMaxCornerPoint().y(), 1);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                _firstElement[y * _resolution[0] + x + 1]++;
+            }
+        }
+    }
+
+    for (size_t c = 0; c < numCells; c++)
+    {
+        _firstElement[c + 1] += _firstElement[c];
+    }
+
+    //Fill the elements in increasing order.
+    std::vector<unsigned int> next(_firstElement.begin(), _firstElement.end() - 1);
+    _elements.resize(_firstElement[numCells]);
+    for (unsigned int e = 0; e < boxes.size(); e++)
+    {
+        const AABB2D& box = boxes[e];
+        int x0 = getCell(box.getMinCornerPoint().x(), 0), x1 = getCell(box.getMaxCornerPoint().x(), 0);
+        int y0 = getCell(box.getMinCornerPoint().y(), 1), y1 = getCell(box.getMaxCornerPoint().y(), 1);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                _elements[next[y * _resolution[0] + x]++] = e;
+            }
+        }
+    }
+}
+
+
+
+void UniformGrid2D::clear()
+{
+    _resolution[0] = _resolution[1] = 0;
+    _firstElement.clear();
+    _elements.clear();
+}
+
+
+
+bool UniformGrid2D::isEmpty() const
+{
+    return _firstElement.empty();
+}
+
+
+
+int UniformGrid2D::getCell(float x, int axis) const
+{
+    int cell = static_cast<int>((x - _min[axis]) * _inverseCellSize[axis]);
+    return std::max(0, std::min(cell, _resolution[axis] - 1));
+}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include "AxisAligmentBoundingBox.h"
+
+namespace rm
+{
+/**
+ * @brief The UniformGrid2D class - Regular grid over the bounds of a set of 2D elements, used to find the elements
+ * under a point. Each grid cell stores the elements whose boxes overlap it, on a compressed array (CSR). The grid
+ * resolution is chosen so that there is about one element per grid cell.
+ */
+class UniformGrid2D
+{
+public:
+    /**
+     * @brief build - Builds the grid. Previous data is discarded.
+     * @param boxes - Bounds of each element. Elements are identified by their position on this vector.
+     */
+    void build(const std::vector<AABB2D>& boxes);
+
+    /**
+     * @brief clear - Removes all elements.
+     */
+    void clear();
+
+    /**
+     * @brief isEmpty - Verifies if the grid was not built or has no elements.
+     * @return - Returns true if there is no element on the grid.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief find - Finds the first element, in increasing order, that contains a point.
+     * @param p - Point.
+     * @param isInside - Function called as isInside(element) for the elements of the grid cell that contains p. It
+     * returns true if the element contains p.
+     * @return - Returns the element index, or -1 if no element contains p.
+     */
+    template<class InsideFunction>
+    int find(const Point2Df& p, const InsideFunction& isInside) const;
+
+private:
+    /**
+     * @brief getCell - Computes the grid cell coordinate of a position.
+     * @param x - Position on the axis.
+     * @param axis - 0 for x and 1 for y.
+     * @return - Returns the cell coordinate, clamped to the grid.
+     */
+    int getCell(float x, int axis) const;
+
+private:
+    /**
+     * @brief _min - Minimal corner of the grid.
+     */
+    Point2Df _min;
+
+    /**
+     * @brief _max - Maximal corner of the grid.
+     */
+    Point2Df _max;
+
+    /**
+     * @brief _inverseCellSize - Inverse of the grid cell size on each axis.
+     */
+    Point2Df _inverseCellSize;
+
+    /**
+     * @brief _resolution - Number of grid cells on each axis.
+     */
+    int _resolution[2] {0, 0};
+
+    /**
+     * @brief _firstElement - Position on _elements of the first element of each grid cell. It has one more entry than
+     * the grid cells.
+     */
+    std::vector<unsigned int> _firstElement;
+
+    /**
+     * @brief _elements - Elements of each grid cell, in increasing order.
+     */
+    std::vector<unsigned int> _elements;
+};
+
+
+
+template<class InsideFunction>
+int UniformGrid2D::find(const Point2Df& p, const InsideFunction& isInside) const
+{
+    if (_firstElement.empty())
+    {
+        return -1;
+    }
+
+    if (p.x() < _min.x() || p.y() < _min.y() || p.x() > _max.x() || p.y() > _max.y())
+    {
+        return -1;
+    }
+
+    int cell = getCell(p.y(), 1) * _resolution[0] + getCell(p.x(), 0);
+    for (unsigned int i = _firstElement[cell]; i < _firstElement[cell + 1]; i++)
+    {
+        if (isInside(_elements[i]))
+        {
+            return static_cast<int>(_elements[i]);
+        }
+    }
+
+    return -1;
+}
+}
@@ -84,16 +84,16 @@ bool Group2DItem::isIntersecting(const Point2Df &point) const
 
 void Group2DItem::render(int viewId)
 {
-    //As the group item has the items control, the group renders all objetcs and your selection
-    //boxes.
+    //As the group item has the items control, the group renders all objetcs. Their selection boxes are added to the
+    //view renderer by appendSelectionBoxes().
     for(auto item : _items)
     {
         item->setPixelSize(_pixelSize);
         item->setProjectionMatrix(_proj);
         item->render(viewId);
 
-        //Render all aabb items
-        if (item->getAABB2DItem()->isVisible())
+        //Render the aabb items with editing handles.
+        if (item->isAABB2DItemVisible())
         {
             item->getAABB2DItem()->render(viewId, _proj, item->getModelMatrix(), _pixelSize);
         }
@@ -102,6 +102,35 @@ void Group2DItem::render(int viewId)
 
 
 
+void Group2DItem::renderBatched(int viewId, ItemBatchRenderer& batch)
+{
+    for(auto item : _items)
+    {
+        item->setPixelSize(_pixelSize);
+        item->setProjectionMatrix(_proj);
+        item->renderBatched(viewId, batch);
+
+        //Render the aabb items with editing handles.
+        if (item->isAABB2DItemVisible())
+        {
+            item->getAABB2DItem()->render(viewId, _proj, item->getModelMatrix(), _pixelSize);
+        }
+    }
+}
+
+
+
+void Group2DItem::appendSelectionBoxes(SelectionBoxRenderer& renderer) const
+{
+    Graphics2DItem::appendSelectionBoxes(renderer);
+    for(auto item : _items)
+    {
+        item->appendSelectionBoxes(renderer);
+    }
+}
+
+
+
 std::set<Graphics2DItem*> Group2DItem::ungroup()
 {
     setAABB(AABB2D());
@@ -121,6 +150,7 @@ void Group2DItem::scale(const QVector3D& s)
     {
         item->scale(s);
     }
+    modelMatrixChanged();
 }
 
 
@@ -132,6 +162,7 @@ void Group2DItem::translate(const QVector3D& t)
     {
         item->translate(t);
     }
+    modelMatrixChanged();
 }
 
 
@@ -187,6 +218,7 @@ void Group2DItem::rotate(const QVector3D& r, const float angle)
     {
         item->rotate(r, angle);
     }
+    modelMatrixChanged();
 }
 
 
@@ -198,6 +230,7 @@ void Group2DItem::setModelMatrix(const OpenGLMatrix &m)
     {
         item->setModelMatrix(m);
     }
+    modelMatrixChanged();
 }
 
 
@@ -231,6 +264,7 @@ void Group2DItem::popModelMatrix()
     {
         item->popModelMatrix();
     }
+    modelMatrixChanged();
 }
 
 
@@ -242,6 +276,7 @@ void Group2DItem::multModelMatrix(const OpenGLMatrix &m)
     {
         item->multModelMatrix(m);
     }
+    modelMatrixChanged();
 }
 
 
@@ -253,6 +288,7 @@ void Group2DItem::multLefModelMatrix(const OpenGLMatrix &m)
     {
         item->multLefModelMatrix(m);
     }
+    modelMatrixChanged();
 }
 
 
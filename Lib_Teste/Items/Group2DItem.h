@@ -37,6 +37,19 @@ public:
      */
     virtual void render(int viewId) override;
 
+    /**
+     * @brief renderBatched - Renders all items of the group adding their point sets to the batch renderer.
+     * @param viewId - View's identifier. Where the item will be rendered.
+     * @param batch - Batch renderers of the view.
+     */
+    virtual void renderBatched(int viewId, ItemBatchRenderer& batch) override;
+
+    /**
+     * @brief appendSelectionBoxes - Adds the group selection box and the selection boxes of its items.
+     * @param renderer - Selection box renderer of the view.
+     */
+    virtual void appendSelectionBoxes(SelectionBoxRenderer& renderer) const override;
+
     /**
      * @brief isIntersecting - Checks if a given point intersects the item. Should be implemented by all itens.
      * @param clickPoint
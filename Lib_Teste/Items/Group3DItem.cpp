@@ -68,6 +68,24 @@ bool Group3DItem::isIntersecting(const Point2Df& ) const
 
 
 
+bool Group3DItem::intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result)
+{
+    bool isHit = false;
+    for (auto item : _items)
+    {
+        isHit = item->intersectRay(origin, direction, result) || isHit;
+    }
+
+    //The group is the item on the scene, so it is the one picked.
+    if (isHit)
+    {
+        result.item = this;
+    }
+    return isHit;
+}
+
+
+
 std::set<Graphics3DItem*> Group3DItem::ungroup()
 {
     return std::move(_items);
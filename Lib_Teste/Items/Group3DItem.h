@@ -43,6 +43,16 @@ public:
      */
     virtual bool isIntersecting(const Point2Df& point) const override ;
 
+    /**
+     * @brief intersectRay - Intersects a ray with the items of the group.
+     * @param origin - Ray origin in world coordinates.
+     * @param direction - Ray direction in world coordinates.
+     * @param result - Nearest hit so far. If an item of the group is hit closer, the group is set as the item hit and
+     * the cell is the one of the inner item.
+     * @return - Returns true if the group was hit closer than the previous result.
+     */
+    virtual bool intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result) override;
+
     /**
      * @brief ungroup - It only clears the set containter of items and returns ownership of the itens to the scene. It's the
      * tool responsability re-add to the scene each item from group before calling the ungroup function.
@@ -1,5 +1,6 @@
 #include "PointSet2DItem.h"
 #include "Polyline2DItem.h"
+#include "../Core/CoreItems/ItemBatchRenderer.h"
 #include <QOpenGLFunctions>
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLShaderProgram>
@@ -29,17 +30,11 @@ PointSet2DItem::~PointSet2DItem()
     }
 
     _vao.clear();
-    _squareProgram->release();
-    _squareProgram->removeAllShaders();
-    delete _squareProgram;
-
-    _circleProgram->release();
-    _circleProgram->removeAllShaders();
-    delete _circleProgram;
 
-    _triangleProgram->release();
-    _triangleProgram->removeAllShaders();
-    delete _triangleProgram;
+    //Give back the shared programs.
+    releaseProgram(_squareProgram);
+    releaseProgram(_circleProgram);
+    releaseProgram(_triangleProgram);
 }
 
 
@@ -60,6 +55,13 @@ const std::vector<Point2Df>& PointSet2DItem::getPointSet() const
 
 
 
+unsigned long long PointSet2DItem::getRevision() const
+{
+    return _revision;
+}
+
+
+
 unsigned int PointSet2DItem::getVerticesVBOId() const
 {
     return  _vertexBuffer;
@@ -81,31 +83,10 @@ float PointSet2DItem::getWorldRadius() const
 
 
 QOpenGLShaderProgram *PointSet2DItem::createProgram(const char *vertexSourceFile, const char *geometrySourceFile,
-                                                    const char *fragmentSourceFile, LocationVariables &locations)
+                                                    const char *fragmentSourceFile)
 {
-    //Create a new program.
-    QOpenGLShaderProgram* program = new QOpenGLShaderProgram();
-
-    //Add vertex and fragment shaders to program.
-    program->addShaderFromSourceFile(QOpenGLShader::Vertex, vertexSourceFile);
-    program->addShaderFromSourceFile(QOpenGLShader::Geometry, geometrySourceFile);
-    program->addShaderFromSourceFile(QOpenGLShader::Fragment, fragmentSourceFile);
-
-
-    //Try to link the program.
-    program->link();
-
-    //Save location variables.
-    locations.m = program->uniformLocation("m");
-    locations.vp = program->uniformLocation("vp");
-    locations.radius = program->uniformLocation("r");
-    locations.brushColor = program->uniformLocation("brushColor");
-    locations.penColor = program->uniformLocation("penColor");
-    locations.borderSize = program->uniformLocation("borderSize");
-    locations.brushRatio = program->uniformLocation("brushRatio"); //TODO: remover
-
-
-    return program;
+    //Get a shared program. It is compiled just by the first item that uses these shaders.
+    return acquireProgram({vertexSourceFile, "", "", geometrySourceFile, fragmentSourceFile});
 }
 
 
@@ -114,46 +95,61 @@ void PointSet2DItem::createPrograms()
 {
     _squareProgram = createProgram(":/shaders/no-transformation-vert",
                                    ":/shaders/quad-generator-geom",
-                                   ":/shaders/bordered-square-frag",
-                                   _squareLocations);
+                                   ":/shaders/bordered-square-frag");
     _circleProgram = createProgram(":/shaders/no-transformation-vert",
                                    ":/shaders/quad-generator-geom",
-                                   ":/shaders/bordered-circle-frag",
-                                   _circleLocations);
+                                   ":/shaders/bordered-circle-frag");
     _triangleProgram = createProgram(":/shaders/no-transformation-vert",
                                      ":/shaders/triangle-generator-geom",
-                                     ":/shaders/bordered-triangle-frag",
-                                     _triangleLocations);
+                                     ":/shaders/bordered-triangle-frag");
 }
 
 
 
 void PointSet2DItem::createBuffers()
 {
-    //Compute te number of bytes.
-    int size = static_cast<int>(_pointSet.size());
-    int numberOfBytes = size * static_cast<int>(sizeof(Point2Df));
-
     //Create a buffer.
     glGenBuffers(1, &_vertexBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, numberOfBytes, _pointSet.data(), GL_DYNAMIC_DRAW);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
     glEnableVertexAttribArray(0);
+
+    //Allocate the buffer and transfer all points.
+    updateVertexBuffer(0, static_cast<unsigned int>(_pointSet.size()));
 }
 
 
 
-void PointSet2DItem::updateVertexBuffer()
+void PointSet2DItem::updateVertexBuffer(unsigned int first, unsigned int count)
 {
+    //All point changes are transferred here, so the scene is notified here too. Edits that keep the AABB still
+    //have to redraw the item.
+    _revision++;
+    geometryChanged();
+
     if (isInitialized())
     {
-        //Transfer new data to buffer.
-        int size = static_cast<int>(_pointSet.size());
-        int numberOfBytes = size * static_cast<int>(sizeof(Point2Df));
-
         glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER,  numberOfBytes, _pointSet.data(), GL_DYNAMIC_DRAW);
+
+        unsigned int size = static_cast<unsigned int>(_pointSet.size());
+        if (size > _vertexCapacity)
+        {
+            //Grow the buffer by doubling, so it is reallocated just a few times. The old storage is orphaned and all
+            //points are transferred again.
+            _vertexCapacity = std::max(size, 2 * _vertexCapacity);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_vertexCapacity * sizeof(Point2Df)), nullptr,
+                         GL_DYNAMIC_DRAW);
+            first = 0;
+            count = size;
+        }
+
+        //Transfer just the changed points.
+        count = std::min(count, size - std::min(first, size));
+        if (count > 0)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(first * sizeof(Point2Df)),
+                            static_cast<GLsizeiptr>(count * sizeof(Point2Df)), _pointSet.data() + first);
+        }
     }
 }
 
@@ -176,6 +172,9 @@ float PointSet2DItem::getBorderSize() const
 void PointSet2DItem::setPointSize(float size)
 {
     _size = size;
+
+    //The point size changes the render AABB.
+    geometryChanged();
 }
 
 
@@ -183,8 +182,7 @@ void PointSet2DItem::setPointSize(float size)
 void PointSet2DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add vertex.
@@ -212,7 +210,11 @@ void PointSet2DItem::checkVao(int id)
 void PointSet2DItem::computeAABB()
 {
     if (_pointSet.size() == 0)
+    {
+        //An empty set has no extent, so the old AABB must not be kept.
+        setAABB(AABB2D());
         return;
+    }
 
     Point2Df minCorner = getAABB().getMinCornerPoint();
     Point2Df maxCorner = getAABB().getMaxCornerPoint();
@@ -257,33 +259,52 @@ void PointSet2DItem::updateAABB(const Point2Df& p)
 
 
 
+void PointSet2DItem::updateAABB(const Point2Df& oldPoint, const Point2Df& newPoint)
+{
+    if (isOnAABBBorder(oldPoint))
+    {
+        //The AABB may shrink, so all points are needed.
+        computeAABB();
+    }
+    else
+    {
+        updateAABB(newPoint);
+    }
+}
+
+
+
+bool PointSet2DItem::isOnAABBBorder(const Point2Df& p) const
+{
+    const Point2Df& minCorner = getAABB().getMinCornerPoint();
+    const Point2Df& maxCorner = getAABB().getMaxCornerPoint();
+
+    return p.x() <= minCorner.x() || p.y() <= minCorner.y() || p.x() >= maxCorner.x() || p.y() >= maxCorner.y();
+}
+
+
+
 void PointSet2DItem::render(int viewId)
 {
     //Verify if there is a vao. If necessary create a new one.
     checkVao(viewId);
 
-    //Save the right variable locations.
-    LocationVariables *currentLocation = nullptr;
-
     switch (_layoutType)
     {
         case LayoutType::Circle:
         {
-            currentLocation = &_circleLocations;
-            _circleProgram->bind();
+            bindProgram(_circleProgram);
             break;
         }
         case LayoutType::Square:
         {
-            currentLocation = &_squareLocations;
-            _squareProgram->bind();
+            bindProgram(_squareProgram);
             break;
         }
 
         case LayoutType::Triangle:
         {
-            currentLocation = &_triangleLocations;
-            _triangleProgram->bind();
+            bindProgram(_triangleProgram);
             break;
         }
     }
@@ -291,30 +312,22 @@ void PointSet2DItem::render(int viewId)
     //Define the correct vao as current.
     _vao[viewId]->bind();
 
-    glUniform4f(currentLocation->brushColor, _brushColor.x(), _brushColor.y(), _brushColor.z(), _brushColor.w());
-    if (!_onFocus)
-    {
-        glUniform4f(currentLocation->penColor, _penColor.x(), _penColor.y(), _penColor.z(), _penColor.w());
-    }
-    else
-    {
-        glUniform4f(currentLocation->penColor, 0.5f, 0.5f, 0.5f, 1);
-    }
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setBrushColor(_brushColor);
+    uniforms.setPenColor(_onFocus ? QVector4D(0.5f, 0.5f, 0.5f, 1.0f) : _penColor);
 
-    //Compute real radius value
-    float rx = 0.5f * _pixelSize.x() * _size;
-    float ry = 0.5f * _pixelSize.y() * _size;
+    //The radius is given in pixels. The geometry shader scales it by the pixel size of the view block.
+    float radius = 0.5f * _size;
 
     //Compute the brush ratio
-    float bx = 1.0f - (_pixelSize.x() * _borderSize) / rx;
-    float by = 1.0f - (_pixelSize.y() * _borderSize) / ry;
+    float brushRatio = 1.0f - _borderSize / radius;
 
-    glUniform2f(currentLocation->radius, rx, ry);
-    glUniform2f(currentLocation->brushRatio, bx, by);
-
-    //Set transformations
-    glUniformMatrix4fv(currentLocation->vp, 1, false, _proj.topMatrix().data());
-    glUniformMatrix4fv(currentLocation->m, 1, false, _modelMatrix.topMatrix().data());
+    uniforms.radius[0] = radius;
+    uniforms.radius[1] = radius;
+    uniforms.radius[2] = brushRatio;
+    uniforms.radius[3] = brushRatio;
+    FrameUniforms::writeItem(uniforms);
 
     glEnable( GL_BLEND );
     glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
@@ -329,6 +342,13 @@ void PointSet2DItem::render(int viewId)
 
 
 
+void PointSet2DItem::renderBatched(int, ItemBatchRenderer& batch)
+{
+    batch.getPointSetBatch().addPointSet(*this);
+}
+
+
+
 bool PointSet2DItem::isInitialized() const
 {
     return _squareProgram != nullptr;
@@ -351,7 +371,7 @@ unsigned int PointSet2DItem::add(const Point2Df& p)
     _pointSet.push_back(point);
 
     //Update VBO of vertices.
-    updateVertexBuffer();
+    updateVertexBuffer(static_cast<unsigned int>(_pointSet.size()) - 1, 1);
 
     //Update AABB.
     updateAABB(p);
@@ -376,8 +396,8 @@ int PointSet2DItem::insert(unsigned int pos, const Point2Df& p)
     _pointSet.insert(_pointSet.begin() + pos, point);
     int size = static_cast<int>(_pointSet.size());
 
-    //Update VBO of vertices.
-    updateVertexBuffer();
+    //Update VBO of vertices. The points after pos were shifted.
+    updateVertexBuffer(pos, static_cast<unsigned int>(size) - pos);
 
     //Update AABB.
     updateAABB(p);
@@ -391,13 +411,14 @@ void PointSet2DItem::pointMove(unsigned int pointId, const Point2Df& delta)
 {
     if (pointId < _pointSet.size())
     {
+        Point2Df oldPoint = _pointSet[pointId];
         _pointSet[pointId] += delta;
 
         //Update VBO of vertices.
-        updateVertexBuffer();
+        updateVertexBuffer(pointId, 1);
 
-        //Recompute AABB.
-        computeAABB();
+        //Update AABB.
+        updateAABB(oldPoint, _pointSet[pointId]);
     }
 }
 
@@ -409,7 +430,7 @@ void PointSet2DItem::setNewPointSet(const std::vector<Point2Df>& pointSet)
     _pointSet = pointSet;
 
     //Update VBO of vertices.
-    updateVertexBuffer();
+    updateVertexBuffer(0, size());
 
     //Recompute AABB.
     computeAABB();
@@ -430,13 +451,14 @@ void PointSet2DItem::setPoint(unsigned int pointId, const Point2Df &p)
         //Get the transformed point.
         Point2Df point(worldPoint.x(), worldPoint.y());
 
+        Point2Df oldPoint = _pointSet[pointId];
         _pointSet[pointId] = point;
 
         //Update VBO of vertices.
-        updateVertexBuffer();
+        updateVertexBuffer(pointId, 1);
 
         //Update AABB.
-        computeAABB();
+        updateAABB(oldPoint, point);
     }
 }
 
@@ -461,7 +483,7 @@ void PointSet2DItem::hardTranslate(float dx, float dy)
     }
 
     //Update VBO of vertices.
-    updateVertexBuffer();
+    updateVertexBuffer(0, size());
 
     //Translate AABB.
     Point2Df minCorner = getAABB().getMinCornerPoint();
@@ -480,13 +502,17 @@ void PointSet2DItem::remove(unsigned int pointID)
 {
     if (pointID < _pointSet.size())
     {
+        Point2Df oldPoint = _pointSet[pointID];
         _pointSet.erase(_pointSet.begin() + pointID);
 
-        //Update VBO of vertices.
-        updateVertexBuffer();
+        //Update VBO of vertices. The points after pointID were shifted.
+        updateVertexBuffer(pointID, size() - pointID);
 
-        //Recompute AABB.
-        computeAABB();
+        //Recompute AABB only if the removed point was on its border.
+        if (isOnAABBBorder(oldPoint))
+        {
+            computeAABB();
+        }
     }
 }
 
@@ -548,7 +574,7 @@ void PointSet2DItem::initialize()
         createPrograms();
 
         //Define the program as corrente. glUseProgram().
-        _squareProgram->bind();
+        bindProgram(_squareProgram);
 
         createBuffers();
     }
@@ -593,7 +619,7 @@ void PointSet2DItem::setLayout(LayoutType type)
 
 
 
-PointSet2DItem::LayoutType PointSet2DItem::getLayout()
+PointSet2DItem::LayoutType PointSet2DItem::getLayout() const
 {
     return _layoutType;
 }
@@ -55,7 +55,7 @@ public:
      * @brief getLayout - Returns the layout value.
      * @return - Returns the layout value.
      */
-    LayoutType getLayout();
+    LayoutType getLayout() const;
 
     /**
      * @brief getPointSet - Returns the 2D points in form of std vector.
@@ -69,6 +69,13 @@ public:
      */
     float getPointSize() const;
 
+    /**
+     * @brief getRevision - Gets a number that changes with each change of the points, so the objects derived from
+     * them know when they must be recomputed.
+     * @return - Returns the current revision.
+     */
+    unsigned long long getRevision() const;
+
     /**
      * @brief getVerticesVBOId - Gets the index of VBO vertices.
      * @return - Returns the index of VBO vertices.
@@ -138,6 +145,14 @@ public:
      */
     void render(int viewId) override;
 
+    /**
+     * @brief renderBatched - Adds the points to the batch renderer of the view. They are drawn with the points of all
+     * other point sets that share the same layout.
+     * @param viewId - View's identifier. Where the item will be rendered.
+     * @param batch - Batch renderers of the view.
+     */
+    void renderBatched(int viewId, ItemBatchRenderer& batch) override;
+
     /**
      * @brief remove - Removes a point with id equal to pointID.
      * @param pointID - Index to point to be removed.
@@ -188,46 +203,6 @@ public:
      */
     float getBorderSize() const;
 
-private:
-
-    struct LocationVariables
-    {
-        /**
-         * @brief vp - OpenGL identifier for view projection matrix.
-         */
-        int vp {-1};
-
-        /**
-         * @brief m - OpenGL identifier for model.
-         */
-        int m {-1};
-
-        /**
-         * @brief radius - OpengGL identifier for radius variable.
-         */
-        int radius {-1};
-
-        /**
-         * @brief brushColor - OpenGL identifier for brush color variable.
-         */
-        int brushColor {-1};
-
-        /**
-         * @brief penColor - OpenGL identifier for pen color variable.
-         */
-        int penColor {-1};
-
-        /**
-         * @brief borderSize - OpenGL identifier for border size variable.
-         */
-        int borderSize;
-
-        /**
-         * @brief penRatio - OpenGL identifier for pen ratio variable.
-         */
-        int brushRatio {-1}; //TODO: Remover
-    };
-
 private:
     /**
      * @brief _pointSet - A set of points.
@@ -240,34 +215,29 @@ private:
     unsigned int _vertexBuffer = static_cast<unsigned int>(-1);
 
     /**
-     * @brief _layoutType - Stores the layoutType
+     * @brief _vertexCapacity - Number of points that fit on the vertex buffer.
      */
-    LayoutType _layoutType {LayoutType::Circle};
+    unsigned int _vertexCapacity {0};
 
     /**
-     * @brief _borderSize - Size of the border in pixels.
+     * @brief _revision - Points revision. It is incremented on each change of the points.
      */
-    float _borderSize {getDefaultBorderSize()};
+    unsigned long long _revision {0};
 
     /**
-     * @brief _size - Diameter of the point in pixels.
-     */
-    float _size {getDefaultSize()};
-
-    /**
-     * @brief _quadLocations - Stores all necessary locations to quad shader.
+     * @brief _layoutType - Stores the layoutType
      */
-    LocationVariables _squareLocations;
+    LayoutType _layoutType {LayoutType::Circle};
 
     /**
-     * @brief _circleLocations - Stores all necessary locations to circle shader.
+     * @brief _borderSize - Size of the border in pixels.
      */
-    LocationVariables _circleLocations;
+    float _borderSize {getDefaultBorderSize()};
 
     /**
-     * @brief _triangleLocations - Stores all necessary locations to triangle shader.
+     * @brief _size - Diameter of the point in pixels.
      */
-    LocationVariables _triangleLocations;
+    float _size {getDefaultSize()};
 
     /**
      * @brief _squareProgram - Quad shader program.
@@ -303,15 +273,14 @@ private:
     void computeAABB();
 
     /**
-     * @brief createProgram - Creates a new program and saves its locations.
+     * @brief createProgram - Gets a shared program. Its uniforms are given by the item and view uniform blocks.
      * @param vertexSourceFile - Vertex shader source code file.
      * @param geometrySourceFile - Geometry shader source code file.
      * @param fragmentSourceFile - Fragment shader source code file.
-     * @param locations - Structure used to save locations.
-     * @return - Returns new opengl shader program.
+     * @return - Returns the opengl shader program.
      */
     QOpenGLShaderProgram* createProgram(const char* vertexSourceFile, const char* geometrySourceFile,
-                                        const char* fragmentSourceFile, LocationVariables& locations);
+                                        const char* fragmentSourceFile);
 
     /**
      * @brief createProgram - Creates all necessary OpenGL programs.
@@ -337,14 +306,32 @@ private:
     constexpr static float getDefaultBorderSize() { return 2.0f; }
 
     /**
-     * @brief updateVertexBuffer - Updates vertex buffer.
+     * @brief isOnAABBBorder - Verifies if a point lies on the border of the current AABB.
+     * @param p - Point on model coordinates.
+     * @return - Returns true if the point touches the AABB border and false otherwise.
+     */
+    bool isOnAABBBorder(const Point2Df& p) const;
+
+    /**
+     * @brief updateVertexBuffer - Transfers a range of points to the vertex buffer, increments the revision and
+     * notifies the scene. The buffer capacity grows by doubling, so only a growth reallocates it and transfers all
+     * points.
+     * @param first - Index of the first changed point.
+     * @param count - Number of changed points.
      */
-    void updateVertexBuffer();
+    void updateVertexBuffer(unsigned int first, unsigned int count);
 
     /**
      * @brief updateAABB - Updates the AABB with a new point. Be careful, this function cannot be used with a moving point.
      * @param p - New point.
      */
     void updateAABB(const Point2Df& p);
+
+    /**
+     * @brief updateAABB - Updates the AABB with a moved point. It is only recomputed if the old point was on its border.
+     * @param oldPoint - Point before moving.
+     * @param newPoint - Point after moving.
+     */
+    void updateAABB(const Point2Df& oldPoint, const Point2Df& newPoint);
 };
 }
@@ -1,5 +1,7 @@
 #include "Polyline2DItem.h"
+#include "../Core/CoreItems/ItemBatchRenderer.h"
 #include <QOpenGLShaderProgram>
+#include <cmath>
 
 
 namespace rm
@@ -10,6 +12,9 @@ Polyline2DItem::Polyline2DItem():Graphics2DItem()
     _previewPoint.visible(false);
     _previewPoint.setBrushColor(QVector3D(0.5, 0, 0.5));
     _pointSetItem.setBrushColor(QVector3D(0, 0.5, 0));
+
+    //The polyline AABB is the point set AABB.
+    _pointSetItem.setParentItem(this);
 }
 
 
@@ -22,12 +27,20 @@ Polyline2DItem::Polyline2DItem(const std::vector<Point2Df>& p, bool isClosed)
     _previewPoint.visible(false);
     _previewPoint.setBrushColor(QVector3D(0.5, 0, 0.5));
     _pointSetItem.setBrushColor(QVector3D(0, 0.5, 0));
+
+    //The polyline AABB is the point set AABB.
+    _pointSetItem.setParentItem(this);
 }
 
 
 
 Polyline2DItem::~Polyline2DItem()
 {
+    if (isInitialized())
+    {
+        glDeleteBuffers(1, &_lodIndexBuffer);
+    }
+
     for (auto it = _vao.begin(); it != _vao.end(); it++)
     {
         //Destroi vao.
@@ -38,34 +51,17 @@ Polyline2DItem::~Polyline2DItem()
     }
 
     _vao.clear();
-    _program->release();
-    _program->removeAllShaders();
-    delete _program;
+    releaseProgram(_program);
 }
 
 
 
 void Polyline2DItem::createProgram()
 {
-    //Create shader program.
-    _program = new QOpenGLShaderProgram();
-
-    //Add shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/no-transformation-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Geometry, ":/shaders/rectangle-generator-geom");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/bordered-line-frag");
-
-    //Try to link the program.
-    _program->link();
-
-    //Get variable locations.
-    _locations.brushColor = _program->uniformLocation("brushColor");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.brushRatio = _program->uniformLocation("brushRatio"); //TODO: remover
-    _locations.radius = _program->uniformLocation("r");
-    _locations.capStyle = _program->uniformLocation("capStyle");
-    _locations.vp = _program->uniformLocation("vp");
-    _locations.m = _program->uniformLocation("m");
+    //Get the shared shader program.
+    _program = acquireProgram({":/shaders/no-transformation-vert", "", "",
+                               ":/shaders/rectangle-generator-geom",
+                               ":/shaders/bordered-line-frag"});
 }
 
 
@@ -74,6 +70,9 @@ void Polyline2DItem::createBuffers()
 {
     glBindBuffer(GL_ARRAY_BUFFER, _pointSetItem.getVerticesVBOId());
     glEnableVertexAttribArray(0);
+
+    //The simplified levels are filled when they are built.
+    glGenBuffers(1, &_lodIndexBuffer);
 }
 
 
@@ -81,8 +80,7 @@ void Polyline2DItem::createBuffers()
 void Polyline2DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add vertex.
@@ -90,6 +88,9 @@ void Polyline2DItem::createVao(int id)
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
     glEnableVertexAttribArray(0);
 
+    //Add the indices of the simplified levels.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _lodIndexBuffer);
+
     //Add to vao.
     std::pair<int, QOpenGLVertexArrayObject*> newVao(id, vao);
     _vao.insert(std::move(newVao));
@@ -109,30 +110,63 @@ void Polyline2DItem::checkVao(int id)
 
 void Polyline2DItem::render(int viewId)
 {
-    //Verify if there is a vao. If necessary create a new one.
-    checkVao(viewId);
+    updateLevelOfDetail(viewId);
+    renderLines(viewId);
 
-    //Define the program as current.
-    _program->bind();
+    //Render points using PointSetItem render method.
+    _pointSetItem.onFocus(_onFocus);
+    if(_pointSetItem.isVisible())
+    {
+        _pointSetItem.setPixelSize(_pixelSize);
+        _pointSetItem.render(viewId);
+    }
+
+    if(_previewPoint.isVisible())
+    {
+        _previewPoint.setPixelSize(_pixelSize);
+        _previewPoint.render(viewId);
+    }
+}
 
-    //Define the correct vao as current.
-    _vao[viewId]->bind();
 
-    glUniform4f(_locations.brushColor, _brushColor.x(), _brushColor.y(), _brushColor.z(), 1);
 
-    if (!_onFocus)
+void Polyline2DItem::renderBatched(int viewId, ItemBatchRenderer& batch)
+{
+    //The segments and the points are drawn later with those of the other items.
+    updateLevelOfDetail(viewId);
+    batch.getPolylineBatch().addPolyline(*this);
+
+    _pointSetItem.onFocus(_onFocus);
+    if(_pointSetItem.isVisible())
     {
-        glUniform4f(_locations.penColor, _penColor.x(), _penColor.y(), _penColor.z(), 1);
+        _pointSetItem.setPixelSize(_pixelSize);
+        _pointSetItem.renderBatched(viewId, batch);
     }
-    else
+
+    if(_previewPoint.isVisible())
     {
-        glUniform4f(_locations.penColor, 0.5f, 0.5f, 0.5f, 1);
+        _previewPoint.setPixelSize(_pixelSize);
+        _previewPoint.renderBatched(viewId, batch);
     }
+}
+
 
-    //Compute the vp matriz.
-    OpenGLMatrix& vp = _proj;
-    glUniformMatrix4fv(_locations.vp, 1, false, vp.topMatrix().data());
-    glUniformMatrix4fv(_locations.m, 1, false, _modelMatrix.topMatrix().data());
+
+void Polyline2DItem::renderLines(int viewId)
+{
+    //Verify if there is a vao. If necessary create a new one.
+    checkVao(viewId);
+
+    //Define the program as current.
+    bindProgram(_program);
+
+    //Define the correct vao as current.
+    _vao[viewId]->bind();
+
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setBrushColor(QVector4D(_brushColor.toVector3D(), 1.0f));
+    uniforms.setPenColor(_onFocus ? QVector4D(0.5f, 0.5f, 0.5f, 1.0f) : QVector4D(_penColor.toVector3D(), 1.0f));
 
     //Compute real radius value
     float r = 0.5f * getWorldLineWidth();
@@ -140,40 +174,117 @@ void Polyline2DItem::render(int viewId)
     //Compute the brush ratio
     float b = 1.0f - (std::max(_pixelSize.x(),_pixelSize.y()) * _borderSize / r);
 
-    glUniform1f(_locations.radius, r);
-    glUniform1f(_locations.brushRatio, b);
-    glUniform1i(_locations.capStyle, static_cast<int>(_capStyle));
+    uniforms.radius[0] = r;
+    uniforms.radius[1] = b;
+    uniforms.style[0] = static_cast<int>(_capStyle);
+    FrameUniforms::writeItem(uniforms);
 
     glEnable( GL_BLEND );
     glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
-    if (_isClosed)
+    if (_lodLevel >= 0)
+    {
+        //Draw the simplified line.
+        const PolylineSimplification::Level& level = _simplification.getLevels()[_lodLevel];
+        glDrawElements(_isClosed ? GL_LINE_LOOP : GL_LINE_STRIP, static_cast<GLsizei>(level.count), GL_UNSIGNED_INT,
+                       reinterpret_cast<const GLvoid*>(level.first * sizeof(unsigned int)));
+    }
+    else if (_isClosed)
+    {
         glDrawArrays(GL_LINE_LOOP, 0, static_cast<GLsizei>(_pointSetItem.getPointSet().size()));
+    }
     else
+    {
         glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(_pointSetItem.getPointSet().size()));
+    }
 
      glDisable(GL_BLEND);
 
     _vao[viewId]->release();
     _program->release();
+}
 
-    //Render points using PointSetItem render method.
-    _pointSetItem.onFocus(_onFocus);
-    if(_pointSetItem.isVisible())
+
+
+void Polyline2DItem::updateLevelOfDetail(int viewId)
+{
+    _lodLevel = -1;
+    unsigned long long revision = _pointSetItem.getRevision();
+    auto rendered = _renderedRevisions.find(viewId);
+    bool isChanging = rendered == _renderedRevisions.end() || rendered->second != revision;
+    _renderedRevisions[viewId] = revision;
+
+    if (!_isLevelOfDetailEnabled || _pointSetItem.size() < levelOfDetailMinimumPoints())
     {
-        _pointSetItem.setPixelSize(_pixelSize);
-        _pointSetItem.render(viewId);
+        return;
     }
 
-    if(_previewPoint.isVisible())
+    if (!_isLevelOfDetailValid || revision != _lodRevision)
     {
-        _previewPoint.setPixelSize(_pixelSize);
-        _previewPoint.render(viewId);
+        //While the points change between frames, as when EditPolyline2DItemTool drags a point, all vertices are drawn.
+        //The levels are rebuilt on the first frame after the changes stop, so that frame is requested here.
+        if (_isLevelOfDetailValid && isChanging)
+        {
+            requestUpdate();
+            return;
+        }
+
+        _simplification.build(_pointSetItem.getPointSet(), _isClosed);
+        _lodRevision = revision;
+        _isLevelOfDetailValid = true;
+
+        //The buffer is filled through GL_ARRAY_BUFFER, so the element buffer of the bound vao is not changed.
+        if (isInitialized())
+        {
+            const std::vector<unsigned int>& indices = _simplification.getIndices();
+            glBindBuffer(GL_ARRAY_BUFFER, _lodIndexBuffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(unsigned int)),
+                         indices.data(), GL_STATIC_DRAW);
+        }
+    }
+
+    //The level errors are in model coordinates, so the pixel is scaled by the largest model axis.
+    const QMatrix4x4& m = _modelMatrix.topMatrix();
+    float scale = std::max(std::hypot(m(0, 0), m(1, 0)), std::hypot(m(0, 1), m(1, 1)));
+    float pixelSize = std::min(_pixelSize.x(), _pixelSize.y());
+    if (scale > 0.0f)
+    {
+        _lodLevel = _simplification.findLevel(0.5f * pixelSize / scale);
     }
 }
 
 
 
+const unsigned int* Polyline2DItem::getLevelOfDetailIndices(unsigned int& count) const
+{
+    if (_lodLevel < 0)
+    {
+        count = _pointSetItem.size();
+        return nullptr;
+    }
+
+    const PolylineSimplification::Level& level = _simplification.getLevels()[_lodLevel];
+    count = level.count;
+    return _simplification.getIndices().data() + level.first;
+}
+
+
+
+void Polyline2DItem::setLevelOfDetailEnabled(bool enable)
+{
+    _isLevelOfDetailEnabled = enable;
+    appearanceChanged();
+}
+
+
+
+bool Polyline2DItem::isLevelOfDetailEnabled() const
+{
+    return _isLevelOfDetailEnabled;
+}
+
+
+
 const AABB2D& Polyline2DItem::getAABB() const
 {
     return _pointSetItem.getAABB();
@@ -215,6 +326,13 @@ AABB2DItem* Polyline2DItem::getAABB2DItem()
 
 
 
+bool Polyline2DItem::isAABB2DItemVisible() const
+{
+    return _pointSetItem.isAABB2DItemVisible();
+}
+
+
+
  const float& Polyline2DItem::getBorderSize() const
 {
     return _borderSize;
@@ -335,7 +453,7 @@ void Polyline2DItem::initialize()
         createProgram();
 
         //Define the program as corrente. glUseProgram().
-        _program->bind();
+        bindProgram(_program);
 
         createBuffers();
     }
@@ -403,6 +521,9 @@ Polyline2DItem::PenCapStyle Polyline2DItem::getPenCapStyle() const
 void Polyline2DItem::closed(bool c)
 {
     _isClosed = c;
+
+    //The levels depend on the closing segment.
+    _isLevelOfDetailValid = false;
 }
 
 
@@ -1,6 +1,8 @@
 #pragma once
+#include <map>
 #include <utility>
 #include "PointSet2DItem.h"
+#include "../Geometry/PolylineSimplification.h"
 #include "../Core/Graphics2DItem.h"
 #include "../Core/Graphics2DView.h"
 #include "../Events/GraphicsScenePressEvent.h"
@@ -87,6 +89,13 @@ public:
      */
     AABB2D getAABBRender(const Point2Df& pixelSize = {0,0}) const override;
 
+    /**
+     * @brief getLevelOfDetailIndices - Gets the vertices of the simplified line chosen by the last render call.
+     * @param count - Receives the number of indices.
+     * @return - Returns the vertex indices, in the polyline order, or nullptr if all vertices are drawn.
+     */
+    const unsigned int* getLevelOfDetailIndices(unsigned int& count) const;
+
     /**
      * @brief getPenCapStyle - get the current pattern that defines how the end points of lines are drawn.
      * @return - enum value that defines how the end points of lines are drawn.
@@ -134,6 +143,12 @@ public:
      */
     bool isClosed() const;
 
+    /**
+     * @brief isLevelOfDetailEnabled - Verifies if the line is simplified when the view is zoomed out.
+     * @return - Returns true if the level of detail is enabled.
+     */
+    bool isLevelOfDetailEnabled() const;
+
     /**
      * @brief isInitialized - Check if OpenGL resources are initialized or not.
      * @return - True if all OpenGL resources are initialized and false otherwise.
@@ -177,6 +192,13 @@ public:
      */
     void render(int viewId) override;
 
+    /**
+     * @brief renderBatched - Adds the polyline segments and its points to the batch renderers of the view.
+     * @param viewId - Identifier of wich view is requesting to render the object.
+     * @param batch - Batch renderers of the view.
+     */
+    void renderBatched(int viewId, ItemBatchRenderer& batch) override;
+
     /**
      * @brief setModelMatrix - Define a new model matrix stack.
      * @param m - new model matrix stack.
@@ -188,6 +210,14 @@ public:
      */
     void setModelToIdentity() override;
 
+    /**
+     * @brief setLevelOfDetailEnabled - Enables or disables the simplification of the line when the view is zoomed
+     * out. It is enabled by default. Vertices closer than half a pixel to the drawn line are skipped, using levels
+     * precomputed from the points. The points, the picking and the edition always use all vertices.
+     * @param enable - True to simplify the line.
+     */
+    void setLevelOfDetailEnabled(bool enable);
+
     /**
      * @brief setPenCapStyle - set a new pattern to draw the end points of lines.
      * @param c - New pattern to draw the end points of lines.
@@ -235,6 +265,12 @@ public:
      */
     AABB2DItem* getAABB2DItem() override;
 
+    /**
+     * @brief isAABB2DItemVisible - Verifies if the point set AABB2DItem is visible, without creating it.
+     * @return - Returns true if the AABB2DItem exists and it is visible.
+     */
+    bool isAABB2DItemVisible() const override;
+
     /**
      * @brief getBorderSize - Gets the border size in pixels.
      * @return - Returns the border size in pixels.
@@ -255,44 +291,6 @@ public:
     float getLineTol(const Point2Df& pixelSize) const;
 
 private:
-    struct LocationVariables
-    {
-        /**
-         * @brief vp - Opengl identifier for view projection matrix.
-         */
-        int vp{-1};
-
-        /**
-         * @brief m - Opengl identifier for model matrix.
-         */
-        int m{-1};
-
-        /**
-         * @brief radius - Opengl identifier for radius variable.
-         */
-        int radius{-1};
-
-        /**
-         * @brief brushColor - Opengl identifier for brush color variable.
-         */
-        int brushColor{-1};
-
-        /**
-         * @brief penColor - Opengl identifier for pen color variable.
-         */
-        int penColor{-1};
-
-        /**
-         * @brief penRatio - Opengl identifier for pen ratio variable.
-         */
-        int brushRatio{-1}; //TODO: remover
-
-        /**
-         * @brief type - OpenGL identifier for cap style.
-         */
-        int capStyle{-1};
-    };
-
     /**
      * @brief _pointSetItem - A point set instance to control the points that define the polyline.
      */
@@ -324,9 +322,40 @@ private:
     PenCapStyle _capStyle = PenCapStyle::Round;
 
     /**
-     * @brief _locations - Store all necessary locations to polyline shader.
+     * @brief _simplification - Simplified levels of the line, built from the point set.
+     */
+    PolylineSimplification _simplification;
+
+    /**
+     * @brief _lodIndexBuffer - Buffer with the vertex indices of all simplified levels.
      */
-    LocationVariables _locations;
+    unsigned int _lodIndexBuffer = static_cast<unsigned int>(-1);
+
+    /**
+     * @brief _isLevelOfDetailEnabled - True if the line is simplified when the view is zoomed out.
+     */
+    bool _isLevelOfDetailEnabled {true};
+
+    /**
+     * @brief _isLevelOfDetailValid - False if the levels were never built or the polyline was opened or closed.
+     */
+    bool _isLevelOfDetailValid {false};
+
+    /**
+     * @brief _lodRevision - Point set revision used to build the levels.
+     */
+    unsigned long long _lodRevision {0};
+
+    /**
+     * @brief _renderedRevisions - Point set revision on the last frame of each view. Each view renders the item once
+     * per frame, so a revision is compared only with the previous frame of the same view.
+     */
+    std::map<int, unsigned long long> _renderedRevisions;
+
+    /**
+     * @brief _lodLevel - Level chosen by the last render call, or -1 to draw all vertices.
+     */
+    int _lodLevel {-1};
 
 private:
     /**
@@ -352,6 +381,26 @@ private:
      */
     void createBuffers();
 
+    /**
+     * @brief renderLines - Renders the polyline segments, without the points.
+     * @param viewId - Identifier of wich view is requesting to render the object.
+     */
+    void renderLines(int viewId);
+
+    /**
+     * @brief updateLevelOfDetail - Rebuilds the levels if the points changed and chooses the level for the current
+     * pixel size.
+     * @param viewId - Identifier of the view being rendered.
+     */
+    void updateLevelOfDetail(int viewId);
+
+    /**
+     * @brief levelOfDetailMinimumPoints - Gets the number of points below which the line is always drawn with all
+     * vertices.
+     * @return - Minimum number of points to simplify the line.
+     */
+    constexpr static unsigned int levelOfDetailMinimumPoints() { return 256; }
+
     /**
      * @brief borderSizeDefaultValue - Gets the border size default
      * @return - Default border size value.
@@ -1,5 +1,6 @@
 #include "QuadMesh2DItem.h"
 #include "Polyline2DItem.h"
+#include "../Geometry/Geometry2DAlgorithms.h"
 #include "../Utility/WireframeTextureBuilder.h"
 
 namespace rm
@@ -32,8 +33,7 @@ QuadMesh2DItem::~QuadMesh2DItem()
 
     _vao.clear();
 
-    delete _program;
-    _program = nullptr;
+    releaseProgram(_program);
 }
 
 
@@ -41,8 +41,7 @@ QuadMesh2DItem::~QuadMesh2DItem()
 void QuadMesh2DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add VBO
@@ -72,23 +71,10 @@ void QuadMesh2DItem::checkVao(int id)
 
 void QuadMesh2DItem::createProgram()
 {
-    //Create shader program.
-    _program = new QOpenGLShaderProgram();
-
-    //Add vertex and fragment shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/mvp-transformation-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Geometry, ":/shaders/wired-solid-color-uv-geom");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/wired-solid-color-uv-frag");
-
-
-    //Try to link the program.
-    _program->link();
-
-    //Get variable locations.
-    _locations.brushColor = _program->uniformLocation("brushColor");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.mvp = _program->uniformLocation("mvp");
-    _locations.wireframe = _program->uniformLocation("wireframe");
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/item-transformation-vert", "", "",
+                               ":/shaders/wired-solid-color-uv-geom",
+                               ":/shaders/wired-solid-color-uv-frag"});
 }
 
 
@@ -148,15 +134,16 @@ void QuadMesh2DItem::render(int viewId)
     //Verify if there is a vao. If necessary create a new one.
     checkVao(viewId);
 
-    _program->bind();
+    bindProgram(_program);
 
     //Define the correct vao as current.
     _vao[viewId]->bind();
 
-    glUniform4f(_locations.brushColor, _brushColor.x(), _brushColor.y(), _brushColor.z(), 1.0f);
-    glUniform4f(_locations.penColor, _penColor.x(), _penColor.y(), _penColor.z(), 1.0f);
-    glUniformMatrix4fv(_locations.mvp, 1, false, (_proj.topMatrix() * _modelMatrix.topMatrix()).data());
-    glUniform1i( _locations.wireframe, 0 );
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setBrushColor(QVector4D(_brushColor.toVector3D(), 1.0f));
+    uniforms.setPenColor(QVector4D(_penColor.toVector3D(), 1.0f));
+    FrameUniforms::writeItem(uniforms);
 
     //Enable culling.
     glEnable(GL_CULL_FACE);
@@ -226,16 +213,61 @@ void QuadMesh2DItem::setWireframeLineThickNess(float thickness)
 
 
 
-bool QuadMesh2DItem::isIntersecting(const Point2Df&) const
+bool QuadMesh2DItem::isIntersecting(const Point2Df& point) const
+{
+    return findCell(point) >= 0;
+}
+
+
+
+int QuadMesh2DItem::cellSelect(const Point2Df& mousePosition)
+{
+    return findCell(mousePosition);
+}
+
+
+
+void QuadMesh2DItem::buildCellGrid() const
 {
-    return false;
+    //Each quadrilateral is stored as two consecutive triangles.
+    std::vector<AABB2D> boxes(_mesh.size() / 6);
+    for (size_t c = 0; c < boxes.size(); c++)
+    {
+        Point2Df minCorner = _points[_mesh[6 * c]];
+        Point2Df maxCorner = minCorner;
+        for (size_t i = 6 * c + 1; i < 6 * c + 6; i++)
+        {
+            const Point2Df& p = _points[_mesh[i]];
+            minCorner[0] = std::min(minCorner.x(), p.x());
+            minCorner[1] = std::min(minCorner.y(), p.y());
+            maxCorner[0] = std::max(maxCorner.x(), p.x());
+            maxCorner[1] = std::max(maxCorner.y(), p.y());
+        }
+        boxes[c] = AABB2D(minCorner, maxCorner);
+    }
+
+    _cellGrid.build(boxes);
 }
 
 
 
-int QuadMesh2DItem::cellSelect(const Point2Df&)
+int QuadMesh2DItem::findCell(const Point2Df& point) const
 {
-    return 0;
+    if (_cellGrid.isEmpty())
+    {
+        buildCellGrid();
+    }
+
+    //Take the point to model coordinates.
+    QVector4D modelPoint = _modelMatrix.topMatrix().inverted() * QVector4D(point.x(), point.y(), 0, 1);
+    Point2Df p(modelPoint.x(), modelPoint.y());
+
+    return _cellGrid.find(p, [&](unsigned int c)
+    {
+        const unsigned int* v = &_mesh[6 * c];
+        return Geometry2DAlgorithms<float>::inTriangle(p, _points[v[0]], _points[v[1]], _points[v[2]]) ||
+               Geometry2DAlgorithms<float>::inTriangle(p, _points[v[3]], _points[v[4]], _points[v[5]]);
+    });
 }
 
 
@@ -9,6 +9,7 @@
 #include <QMatrix4x4>
 
 #include "../Geometry/Vector2D.h"
+#include "../Geometry/UniformGrid2D.h"
 #include "../Core/Graphics2DItem.h"
 #include "../Events/GraphicsScenePressEvent.h"
 #include "../Events/GraphicsSceneHoverEvent.h"
@@ -115,49 +116,23 @@ private:
     void quadToTriangleMesh();
 
     /**
-     * @brief updateVertexBuffer - Update the verterx buffer if it is initialized.
+     * @brief buildCellGrid - Builds the grid used to find the cells.
      */
-    void updateVertexBuffer();
-
-private:
-    struct LocationVariables
-    {
-        /**
-         * @brief mvp - OpenGL identifier for model view projection matrix.
-         */
-        int mvp {-1};
-
-        /**
-         * @brief radius - OpenGL identifier for radius variable.
-         */
-        int radius {-1};
-
-        /**
-         * @brief brushColor - OpenGL identifier for brush color variable.
-         */
-        int brushColor {-1};
-
-        /**
-         * @brief penColor - OpenGL identifier for pen color variable.
-         */
-        int penColor {-1};
-
-        /**
-         * @brief penRatio - OpenGL identifier for pen ratio variable.
-         */
-        int brushRatio {-1};
+    void buildCellGrid() const;
 
-        /**
-         * @brief wireframe - Wireframe texture location.
-         */
-        int wireframe{-1};
-    };
+    /**
+     * @brief findCell - Finds the quadrilateral that contains a point. The grid is built on the first call.
+     * @param point - Point in world coordinates.
+     * @return - Index of the quadrilateral or -1 if no quadrilateral contains the point.
+     */
+    int findCell(const Point2Df& point) const;
 
     /**
-     * @brief _locations - Store all necessary locations to polyline shader.
+     * @brief updateVertexBuffer - Update the verterx buffer if it is initialized.
      */
-    LocationVariables _locations;
+    void updateVertexBuffer();
 
+private:
     /**
      * @brief _mesh - Triangle mesh topology.
      */
@@ -192,5 +167,10 @@ private:
      * @brief _ebo - The item's elements buffer object
      */
     unsigned int _ebo = static_cast<unsigned int>(-1);
+
+    /**
+     * @brief _cellGrid - Uniform grid over the quadrilaterals, used to pick them.
+     */
+    mutable UniformGrid2D _cellGrid;
 };
 }
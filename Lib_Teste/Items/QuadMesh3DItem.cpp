@@ -4,6 +4,7 @@
 
 #include "QuadMesh3DItem.h"
 #include "../Utility/WireframeTextureBuilder.h"
+#include "../Utility/MeshNormals.h"
 
 namespace rm
 {
@@ -37,8 +38,7 @@ QuadMesh3DItem::~QuadMesh3DItem()
         }
         _vao.clear();
 
-        delete _program;
-        _program = nullptr;
+        releaseProgram(_program);
     }
 }
 
@@ -47,8 +47,7 @@ QuadMesh3DItem::~QuadMesh3DItem()
 void QuadMesh3DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add vertex.
@@ -128,12 +127,31 @@ void QuadMesh3DItem::createBuffers()
     glBufferData(GL_ARRAY_BUFFER, numberOfBytes, _normals.data(), GL_STATIC_DRAW);
 
     //Create element buffer.
-    size = static_cast<int>(_mesh.size());
-    numberOfBytes = size * static_cast<int>(sizeof(unsigned int));
-
     glGenBuffers(1, &_elementBuffer);
+    updateElementBuffer();
+}
+
+
+
+void QuadMesh3DItem::updateElementBuffer()
+{
+    //The indexes of the simplified levels are stored after the triangles of the quadrilaterals.
+    const std::vector<unsigned int>& levelIndexes = _levelOfDetail.getIndexes();
+    GLsizeiptr meshBytes = static_cast<GLsizeiptr>(_mesh.size() * sizeof(unsigned int));
+    GLsizeiptr levelBytes = static_cast<GLsizeiptr>(levelIndexes.size() * sizeof(unsigned int));
+
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _elementBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfBytes, _mesh.data(), GL_STATIC_DRAW);
+    if (levelBytes == 0)
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshBytes, _mesh.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshBytes + levelBytes, nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, meshBytes, _mesh.data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, meshBytes, levelBytes, levelIndexes.data());
+    }
+    _isElementBufferOutdated = false;
 }
 
 
@@ -161,28 +179,10 @@ void QuadMesh3DItem::updateVertexBuffer()
 
 void QuadMesh3DItem::createProgram()
 {
-	//Create shader program.
-	_program = new QOpenGLShaderProgram();
-
-    //Add vertex and fragment shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/phong-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Geometry, ":/shaders/wired-phong-uv-geom");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/wired-phong-uv-frag");
-
-	//Try to link the program.
-	_program->link();
-
-	//Get variable locations.
-    _locations.ambientLight = _program->uniformLocation("ambientLight");
-    _locations.diffuseLight = _program->uniformLocation("diffuseLight");
-    _locations.ambientMaterial = _program->uniformLocation("ambientMaterial");
-    _locations.diffuseMaterial = _program->uniformLocation("diffuseMaterial");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.mv = _program->uniformLocation("mv");
-    _locations.lpos = _program->uniformLocation("lpos");
-	_locations.normalMatrix = _program->uniformLocation("nm");
-	_locations.mvp = _program->uniformLocation("mvp");
-    _locations.wireframe = _program->uniformLocation("wireframe");
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/phong-vert", "", "",
+                               ":/shaders/wired-phong-uv-geom",
+                               ":/shaders/wired-phong-uv-frag"});
 }
 
 
@@ -196,31 +196,9 @@ void QuadMesh3DItem::createWireframeTexture()
 
 void QuadMesh3DItem::computeNormals()
 {
-    _normals.resize(_points.size(), QVector3D(0, 0, 0));
-    for (unsigned int t = 0; t < _mesh.size() / 4; t++)
-    {
-       //Get the triangle vertices
-       unsigned int v0 = _mesh[4 * t + 0];
-       unsigned int v1 = _mesh[4 * t + 1];
-       unsigned int v2 = _mesh[4 * t + 2];
-       unsigned int v3 = _mesh[4 * t + 3];
-       const Point3Df& p0 = _points[v0];
-       const Point3Df& p1 = _points[v1];
-       const Point3Df& p2 = _points[v2];
-       const Point3Df& p3 = _points[v3];
-       Point3Df n1 = Point3Df::crossProduct(p1 - p0, p3 - p0);
-       Point3Df n2 = Point3Df::crossProduct(p3 - p1, p1 - p2);
-       Point3Df n = (n1 + n2)/2;
-       _normals[v0] += n;
-       _normals[v1] += n;
-       _normals[v2] += n;
-       _normals[v3] += n;
-    }
-    //Normalize each normal
-    for (auto& normal : _normals)
-    {
-       normal = normal.normalized();
-    }
+    //The adjacency is not kept, since the quads are replaced by triangles after this.
+    MeshNormals meshNormals(4);
+    meshNormals.compute(_mesh, _points, _normals);
 }
 
 
@@ -256,37 +234,26 @@ void QuadMesh3DItem::render(int viewId)
     //Verify if there is a vao. If necessary create a new one.
     checkVao(viewId);
 
-    _program->bind();
+    bindProgram(_program);
 
     //Define the correct vao as current.
     _vao[viewId]->bind();
 
+    if (_isElementBufferOutdated)
+    {
+        updateElementBuffer();
+    }
+
     _viewMatrix.push();
     OpenGLMatrix mv = _viewMatrix.multMatrix(_modelMatrix);
     _viewMatrix.pop();
 
-    _proj.push();
-    OpenGLMatrix mvp = _proj .multMatrix(mv);
-    _proj.pop();
-
-    //Get the light source.
-    LightSource s = _shadingModel.getLightSource(0);
-    const Color& ambient = s.getAmbientComponent();
-    const Color& diffuse = s.getDiffuseComponent();
-
-    glUniform3f(_locations.ambientMaterial, 0.1f * _brushColor.x(), 0.1f * _brushColor.y(), 0.1f * _brushColor.z());
-    glUniform3f(_locations.diffuseMaterial, 0.9f * _brushColor.x(), 0.9f * _brushColor.y(), 0.9f * _brushColor.z());
-    glUniform3f(_locations.ambientLight, ambient.red() / 255.0f, ambient.green() / 255.0f, ambient.blue() / 255.0f);
-    glUniform3f(_locations.diffuseLight, diffuse.red() / 255.0f, diffuse.green() / 255.0f, diffuse.blue() / 255.0f);
-    glUniform4f(_locations.lpos, s.getLightPosition().x(), s.getLightPosition().y(), s.getLightPosition().z(),
-                s.getLightPosition().w());
-
-    glUniform4f(_locations.penColor, _penColor.x(), _penColor.y(), _penColor.z(), 1.0f);
-
-    glUniformMatrix4fv(_locations.mv, 1, false, mv.topMatrix().data());
-    glUniformMatrix4fv(_locations.mvp, 1, false, mvp.topMatrix().data());
-    glUniformMatrix3fv(_locations.normalMatrix, 1, false, mv.topMatrix().normalMatrix().data());
-    glUniform1i(_locations.wireframe, 0);
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setNormalMatrix(mv.topMatrix().normalMatrix());
+    uniforms.setBrushColor(_brushColor);
+    uniforms.setPenColor(QVector4D(_penColor.toVector3D(), 1.0f));
+    FrameUniforms::writeItem(uniforms);
 
     glDisable(GL_CULL_FACE);
     glEnable(GL_BLEND);
@@ -296,7 +263,19 @@ void QuadMesh3DItem::render(int viewId)
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_1D, _wireframeTexture);
 
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_mesh.size()), GL_UNSIGNED_INT, nullptr);
+    //Draw the level chosen by the size of the mesh on the view.
+    size_t first = 0;
+    size_t count = _mesh.size();
+    const std::vector<MeshLevelOfDetail::Level>& levels = _levelOfDetail.getLevels();
+    if (!levels.empty())
+    {
+        int level = _levelOfDetail.selectLevel(getPixelsPerUnit(), _viewLevels[viewId]);
+        _viewLevels[viewId] = level;
+        first = levels[level].first;
+        count = levels[level].count;
+    }
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(count), GL_UNSIGNED_INT,
+                   reinterpret_cast<const GLvoid*>(first * sizeof(unsigned int)));
 
     glDisable(GL_TEXTURE_1D);
     glDisable(GL_BLEND);
@@ -336,6 +315,37 @@ void QuadMesh3DItem::setWireframeLineThickNess(float thickness)
 
 
 
+bool QuadMesh3DItem::intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result)
+{
+    if (!intersectTriangles(origin, direction, _points.data(), _mesh.data(), _mesh.size() / 3, _bvh, result))
+    {
+        return false;
+    }
+
+    //Each quadrilateral was split into two consecutive triangles.
+    result.cell /= 2;
+    return true;
+}
+
+
+
+void QuadMesh3DItem::buildBVH()
+{
+    std::vector<BoundingVolumeHierarchy::Box> boxes;
+    computeTriangleBoxes(_points.data(), _mesh.data(), _mesh.size() / 3, boxes);
+    _bvh.build(boxes);
+}
+
+
+
+void QuadMesh3DItem::buildLevelsOfDetail()
+{
+    _levelOfDetail.build(_mesh.data(), _mesh.size(), _points.data(), _points.size());
+    _isElementBufferOutdated = true;
+}
+
+
+
 void QuadMesh3DItem::quadToTriangleMesh()
 {
     std::vector<unsigned int> triangleMesh;
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
 #include <iostream>
 #include <assert.h>
 #include <QMatrix4x4>
@@ -11,6 +12,7 @@
 #include "../Core/Graphics3DItem.h"
 #include "../Events/GraphicsScenePressEvent.h"
 #include "../Events/GraphicsSceneHoverEvent.h"
+#include "../Utility/MeshLevelOfDetail.h"
 
 using Vector3Df = QVector3D;
 using Point3Df = QVector3D;
@@ -73,6 +75,29 @@ public:
      */
     void setWireframeLineThickNess(float thickness);
 
+    /**
+     * @brief intersectRay - Intersects a ray with the mesh quadrilaterals.
+     * @param origin - Ray origin in world coordinates.
+     * @param direction - Ray direction in world coordinates.
+     * @param result - Nearest hit so far. Its cell is the quadrilateral index and u, v are the barycentric coordinates
+     * on the triangle of the quadrilateral that was hit.
+     * @return - Returns true if the mesh was hit closer than the previous result.
+     */
+    bool intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result) override;
+
+    /**
+     * @brief buildBVH - Builds the BVH used by intersectRay(). It is built on the first pick anyway, but loaders may
+     * call it on their threads to avoid the delay.
+     */
+    void buildBVH();
+
+    /**
+     * @brief buildLevelsOfDetail - Builds the simplified levels drawn when the mesh is small on the view. It takes a
+     * while on large meshes, so loaders should call it on their threads, before the item is added to the scene.
+     * Meshes without levels are always drawn whole.
+     */
+    void buildLevelsOfDetail();
+
 private:
 
     /**
@@ -102,6 +127,12 @@ private:
      */
     void createBuffers();
 
+    /**
+     * @brief updateElementBuffer - Sends the mesh indexes and the indexes of the simplified levels to the element
+     * buffer.
+     */
+    void updateElementBuffer();
+
     /**
      * @brief updateVertexBuffer - Update vertex buffer
      */
@@ -129,64 +160,6 @@ private:
     void quadToTriangleMesh();
 
 private:
-    struct LocationVariables
-    {
-        /**
-         * @brief mvp - OpenGL identifier for model view projection matrix.
-         */
-        int mvp{-1};
-
-        /**
-         * @brief lpos - Light position.
-         */
-        int lpos{-1};
-
-        /**
-         * @brief penColor - OpenGL identifier for pen color variable.
-         */
-        int penColor{-1};
-
-        /**
-         * @brief diffuseLight - Diffuse light component.
-         */
-        int diffuseLight{-1};
-
-        /**
-         * @brief ambientLight - Ambient light component.
-         */
-        int ambientLight{-1};
-
-        /**
-         * @brief diffuseMaterial - Diffuse material component.
-         */
-        int diffuseMaterial{-1};
-
-        /**
-         * @brief ambientMaterial - Ambient material component.
-         */
-        int ambientMaterial{-1};
-
-           /**
-         * @brief normalMatrix - Matrix to transform normals.
-         */
-        int normalMatrix{-1};
-
-        /**
-         * @brief mv - Model view matrix location.
-         */
-        int mv{-1};
-
-        /**
-         * @brief wireframe - Wireframe texture location.
-         */
-        int wireframe{-1};
-    };
-
-    /**
-     * @brief _locations - Store all necessary locations to polyline shader.
-     */
-    LocationVariables _locations;
-
     /**
      * @brief _mesh - Vector holding mesh element indexes
      */
@@ -231,5 +204,25 @@ private:
      * @brief _normals - Quad mesh normals
      */
     std::vector<Vector3Df> _normals;
+
+    /**
+     * @brief _bvh - BVH over the triangles of the quadrilaterals, used to pick the mesh.
+     */
+    BoundingVolumeHierarchy _bvh;
+
+    /**
+     * @brief _levelOfDetail - Simplified levels of the mesh, stored after the mesh indexes on the element buffer.
+     */
+    MeshLevelOfDetail _levelOfDetail;
+
+    /**
+     * @brief _isElementBufferOutdated - True if the levels were built after the element buffer was filled.
+     */
+    bool _isElementBufferOutdated {false};
+
+    /**
+     * @brief _viewLevels - Level drawn on the last frame of each view.
+     */
+    std::map<int, int> _viewLevels;
 };
 };
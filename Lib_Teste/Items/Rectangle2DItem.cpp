@@ -39,9 +39,7 @@ Rectangle2DItem::~Rectangle2DItem()
     }
 
     _vao.clear();
-    _program->release();
-    _program->removeAllShaders();
-    delete _program;
+    releaseProgram(_program);
 }
 
 
@@ -56,7 +54,7 @@ void Rectangle2DItem::initialize()
         createProgram();
 
         //Define the program as corrente. glUseProgram().
-        _program->bind();
+        bindProgram(_program);
 
         createBuffers();
     }
@@ -92,20 +90,15 @@ void Rectangle2DItem::render(int viewId )
     //Verify if there is a vao. If necessary create a new one.
     checkVao(viewId);
 
-    _program->bind();
+    bindProgram(_program);
 
     //Define the correct vao as current.
     _vao[viewId]->bind();
 
-    glUniform4f(_locations.brushColor, _brushColor.x(), _brushColor.y(), _brushColor.z(), _brushColor.w());
-    if (!_onFocus)
-    {
-        glUniform4f(_locations.penColor, _penColor.x(), _penColor.y(), _penColor.z(), _penColor.w());
-    }
-    else
-    {
-        glUniform4f(_locations.penColor, 0.5f, 0.5f, 0.5f, 1);
-    }
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setBrushColor(_brushColor);
+    uniforms.setPenColor(_onFocus ? QVector4D(0.5f, 0.5f, 0.5f, 1.0f) : _penColor);
 
     //Compute real radius value
     float rx = _width * 0.5f;
@@ -115,10 +108,11 @@ void Rectangle2DItem::render(int viewId )
     float bx = 1.0f - (_pixelSize.x() / _modelMatrix.sX() * _borderSize) / rx;
     float by = 1.0f - (_pixelSize.y() / _modelMatrix.sY() * _borderSize) / ry;
 
-    glUniform2f(_locations.radius, rx, ry);
-    glUniform2f(_locations.brushRatio, bx, by);
-    glUniformMatrix4fv(_locations.vp, 1, false, _proj.topMatrix().data());
-    glUniformMatrix4fv(_locations.m, 1, false, _modelMatrix.topMatrix().data());
+    uniforms.radius[0] = rx;
+    uniforms.radius[1] = ry;
+    uniforms.radius[2] = bx;
+    uniforms.radius[3] = by;
+    FrameUniforms::writeItem(uniforms);
 
     glEnable( GL_BLEND );
     glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
@@ -207,8 +201,7 @@ void Rectangle2DItem::setBorderSize(float size)
 void Rectangle2DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add vertex.
@@ -235,25 +228,11 @@ void Rectangle2DItem::checkVao(int id)
 
 void Rectangle2DItem::createProgram()
 {
-    //Create shader program.
-    _program = new QOpenGLShaderProgram();
-
-    //Add shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/no-transformation-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Geometry, ":/shaders/transformable-quad-generator-geom");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/bordered-square-frag");
-
-    //Try to link the program.
-    _program->link();
-
-    //Save location variables.
-    _locations.m = _program->uniformLocation("m");
-    _locations.vp = _program->uniformLocation("vp");
-    _locations.radius = _program->uniformLocation("r");
-    _locations.brushColor = _program->uniformLocation("brushColor");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.borderSize = _program->uniformLocation("borderSize");
-    _locations.brushRatio = _program->uniformLocation("brushRatio");
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/no-transformation-vert", "", "",
+                               ":/shaders/transformable-quad-generator-geom",
+                               ":/shaders/bordered-square-frag"});
+
 }
 
 
@@ -182,47 +182,5 @@ private:
      * @brief _vertexbuffer - Buffers identifiers.
      */
     unsigned int _vertexBuffer = static_cast<unsigned int>(-1);
-
-    struct LocationVariables
-    {
-        /**
-         * @brief vp - Opengl identifier for view projection matrix.
-         */
-        int vp{-1};
-
-        /**
-         * @brief m - Opengl identifier for model matrix.
-         */
-        int m{-1};
-
-        /**
-         * @brief radius - Opengl identifier for radius variable.
-         */
-        int radius{-1};
-
-        /**
-         * @brief brushColor - Opengl identifier for brush color variable.
-         */
-        int brushColor{-1};
-
-        /**
-         * @brief penColor - Opengl identifier for pen color variable.
-         */
-        int penColor{-1};
-
-        /**
-         * @brief penRatio - Opengl identifier for pen ratio variable.
-         */
-        int borderSize{-1};
-        /**
-         * @brief penRatio - OpenGL identifier for pen ratio variable.
-         */
-        int brushRatio {-1};
-    };
-
-    /**
-     * @brief _locations - Store all necessary locations to polyline shader.
-     */
-    LocationVariables _locations;
 };
 }
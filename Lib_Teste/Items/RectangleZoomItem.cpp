@@ -20,9 +20,7 @@ RectangleZoomItem::~RectangleZoomItem()
     }
 
     _vao.clear();
-    _program->release();
-    _program->removeAllShaders();
-    delete _program;
+    releaseProgram(_program);
 }
 
 
@@ -64,7 +62,7 @@ void RectangleZoomItem::render(int viewId)
 {
     //Verify if there is a vao. If necessary create a new one.
     checkVao(viewId);
-    _program->bind();
+    bindProgram(_program);
 
     //Define the correct vao as current.
     _vao[viewId]->bind();
@@ -117,7 +115,7 @@ void RectangleZoomItem::initialize()
         createProgram();
 
         //Define the program as corrente. glUseProgram().
-        _program->bind();
+        bindProgram(_program);
 
         createBuffers();
     }
@@ -162,19 +160,13 @@ void RectangleZoomItem::setCanvasHeight(int h)
 
 void RectangleZoomItem::createProgram()
 {
-    //Create shader program
-    _program = new QOpenGLShaderProgram();
-
-    //Add vertex and fragment shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/mvp-transformation-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/solid-color-frag");
-
-    //Try to link the program.
-    _program->link();
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/mvp-transformation-vert", "", "", "",
+                               ":/shaders/solid-color-frag"});
 
     //Save location variables.
-    _locations.mvp = _program->uniformLocation("mvp");
-    _locations.brushColor = _program->uniformLocation("brushColor");
+    _locations.mvp = programUniformLocation(_program, "mvp");
+    _locations.brushColor = programUniformLocation(_program, "brushColor");
 }
 
 
@@ -209,8 +201,7 @@ void RectangleZoomItem::updateVertexBuffer()
 void RectangleZoomItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add vertex.
@@ -52,4 +52,18 @@ void SelectionGroup2DItem::render(int)
     //the selection box is an item on scene, its selection box is rendered too, but nothing more is rendered.
 
 }
+
+
+
+void SelectionGroup2DItem::renderBatched(int viewId, ItemBatchRenderer&)
+{
+    render(viewId);
+}
+
+
+
+void SelectionGroup2DItem::appendSelectionBoxes(SelectionBoxRenderer& renderer) const
+{
+    Graphics2DItem::appendSelectionBoxes(renderer);
+}
 }
@@ -45,5 +45,19 @@ public:
      */
     void render(int viewId) override;
 
+    /**
+     * @brief renderBatched - Does nothing, as render(). The selected items are rendered by the view.
+     * @param viewId - View identifier.
+     * @param batch - Batch renderers of the view.
+     */
+    void renderBatched(int viewId, ItemBatchRenderer& batch) override;
+
+    /**
+     * @brief appendSelectionBoxes - Adds just the selection group box. The selected items are on scene, so the view
+     * adds their boxes.
+     * @param renderer - Selection box renderer of the view.
+     */
+    void appendSelectionBoxes(SelectionBoxRenderer& renderer) const override;
+
 };
 }
@@ -1,4 +1,5 @@
 #include "TriangleMesh2DItem.h"
+#include "../Geometry/Geometry2DAlgorithms.h"
 #include "../Utility/WireframeTextureBuilder.h"
 #include "Polyline2DItem.h"
 
@@ -28,7 +29,7 @@ TriangleMesh2DItem::~TriangleMesh2DItem()
         }
     }
 
-    delete _program;
+    releaseProgram(_program);
 
     for (auto it = _vao.begin(); it != _vao.end(); it++)
     {
@@ -47,8 +48,7 @@ TriangleMesh2DItem::~TriangleMesh2DItem()
 void TriangleMesh2DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add VBO
@@ -86,43 +86,20 @@ void TriangleMesh2DItem::checkVao(int id)
 
 void TriangleMesh2DItem::createTri3Program()
 {
-    //Create shader program.
-    _program = new QOpenGLShaderProgram();
-
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/mvp-transformation-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Geometry, ":/shaders/wired-solid-color-uvw-geom");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/wired-solid-color-uvw-frag");
-
-    //Try to link the program.
-    _program->link();
-
-    //Get variable locations.
-    _locations.brushColor = _program->uniformLocation("brushColor");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.mvp = _program->uniformLocation("mvp");
-    _locations.wireframe = _program->uniformLocation("wireframe");
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/item-transformation-vert", "", "",
+                               ":/shaders/wired-solid-color-uvw-geom",
+                               ":/shaders/wired-solid-color-uvw-frag"});
 }
 
 
 void TriangleMesh2DItem::createTri6Program()
 {
-    //Create shader program.
-    _program = new QOpenGLShaderProgram();
-
-    //Add vertex and fragment shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/tri6-400-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::TessellationControl, ":/shaders/tri6-400-tesc");
-    _program->addShaderFromSourceFile(QOpenGLShader::TessellationEvaluation, ":/shaders/tri6-400-tese");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/wired-solid-color-400-frag");
-
-    //Try to link the program.
-    _program->link();
-
-    //Get variable locations.
-    _locations.brushColor = _program->uniformLocation("brushColor");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.mvp = _program->uniformLocation("mvp");
-    _locations.wireframe = _program->uniformLocation("wireframe");
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/tri6-400-vert",
+                               ":/shaders/tri6-400-tesc",
+                               ":/shaders/tri6-400-tese", "",
+                               ":/shaders/wired-solid-color-400-frag"});
 }
 
 
@@ -195,7 +172,25 @@ void TriangleMesh2DItem::createTri6ProgramForDebug()
 
            layout(triangles, equal_spacing, ccw) in;
 
-           uniform mat4 mvp;
+           layout(std140) uniform ViewBlock
+           {
+               mat4 proj;
+               mat4 view;
+               vec4 pixelSize;
+               vec4 lightAmbient;
+               vec4 lightDiffuse;
+               vec4 lightPosition;
+           };
+
+           layout(std140) uniform ItemBlock
+           {
+               mat4 model;
+               mat3 normalMatrix;
+               vec4 brushColor;
+               vec4 penColor;
+               vec4 radius;
+               ivec4 style;
+           };
 
            struct OutputPatch
            {
@@ -233,7 +228,7 @@ void TriangleMesh2DItem::createTri6ProgramForDebug()
                        n3 * outPatch.t[3] + n4 * outPatch.t[4] + n5 * outPatch.t[5];
 
                //projeca as coordendas do vertice calculado
-               gl_Position = mvp * vec4(position, 1.0f);
+               gl_Position = proj * view * model * vec4(position, 1.0f);
            }
            )";
 
@@ -275,10 +270,18 @@ void TriangleMesh2DItem::createTri6ProgramForDebug()
 
     std::string fragmentShaderSource = R"(
             #version 400 core
-            uniform vec4 brushColor;
-            uniform vec4 penColor;
             uniform sampler1D wireframe;
 
+            layout(std140) uniform ItemBlock
+            {
+                mat4 model;
+                mat3 normalMatrix;
+                vec4 brushColor;
+                vec4 penColor;
+                vec4 radius;
+                ivec4 style;
+            };
+
             in vec4 colorG;
             in vec3 uvw;
             in vec3 uvw2;
@@ -327,11 +330,8 @@ void TriangleMesh2DItem::createTri6ProgramForDebug()
     //Try to link the program.
     _program->link();
 
-    //Get variable locations.
-    _locations.brushColor = _program->uniformLocation("brushColor");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.mvp = _program->uniformLocation("mvp");
-    _locations.wireframe = _program->uniformLocation("wireframe");
+    //This program is not linked by the registry, so it assigns its own block bindings.
+    FrameUniforms::bindBlocks(_program->programId());
 }
 
 
@@ -411,19 +411,16 @@ void TriangleMesh2DItem::render(int viewId)
 {
     //Verify if there is a vao. If necessary create a new one.
     checkVao(viewId);
-    _program->bind();
+    bindProgram(_program);
 
     //Define the correct vao as current.
     _vao[viewId]->bind();
 
-    _proj.push();
-    OpenGLMatrix mvp = _proj.multMatrix(_modelMatrix);
-    _proj.pop();
-
-    glUniform4f(_locations.brushColor, _brushColor.x(), _brushColor.y(), _brushColor.z(), 1.0f);
-    glUniform4f(_locations.penColor, _penColor.x(), _penColor.y(), _penColor.z(), 1.0f);
-    glUniformMatrix4fv(_locations.mvp, 1, false, mvp.topMatrix().data());
-    glUniform1i( _locations.wireframe, 0 );
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setBrushColor(QVector4D(_brushColor.toVector3D(), 1.0f));
+    uniforms.setPenColor(QVector4D(_penColor.toVector3D(), 1.0f));
+    FrameUniforms::writeItem(uniforms);
 
     //Enable culling.
     glEnable(GL_CULL_FACE);
@@ -502,16 +499,80 @@ void TriangleMesh2DItem::setWireframeLineThickNess(float thickness)
 
 
 
-bool TriangleMesh2DItem::isIntersecting(const Point2Df& ) const
+bool TriangleMesh2DItem::isIntersecting(const Point2Df& point) const
 {
-	return false;
+    return findCell(point) >= 0;
 }
 
 
 
-int TriangleMesh2DItem::cellSelect(const Point2Df& )
+int TriangleMesh2DItem::cellSelect(const Point2Df& mousePosition)
 {
-	return 0;
+    return findCell(mousePosition);
+}
+
+
+
+void TriangleMesh2DItem::buildCellGrid() const
+{
+    unsigned int verticesPerCell = _type == TriangleType::TRI3 ? 3 : 6;
+    std::vector<AABB2D> boxes(_mesh.size() / verticesPerCell);
+    for (size_t c = 0; c < boxes.size(); c++)
+    {
+        const unsigned int* v = &_mesh[verticesPerCell * c];
+        Point2Df minCorner = _points[v[0]];
+        Point2Df maxCorner = _points[v[0]];
+        for (unsigned int i = 1; i < verticesPerCell; i++)
+        {
+            //The control point of a quadratic edge is 2 * midpoint - (p0 + p1) / 2.
+            Point2Df p = _points[v[i]];
+            if (i >= 3)
+            {
+                p = 2.0f * p - 0.5f * (_points[v[i - 3]] + _points[v[(i - 2) % 3]]);
+            }
+
+            minCorner[0] = std::min(minCorner.x(), p.x());
+            minCorner[1] = std::min(minCorner.y(), p.y());
+            maxCorner[0] = std::max(maxCorner.x(), p.x());
+            maxCorner[1] = std::max(maxCorner.y(), p.y());
+        }
+        boxes[c] = AABB2D(minCorner, maxCorner);
+    }
+
+    _cellGrid.build(boxes);
+}
+
+
+
+int TriangleMesh2DItem::findCell(const Point2Df& point) const
+{
+    if (_cellGrid.isEmpty())
+    {
+        buildCellGrid();
+    }
+
+    //Take the point to model coordinates.
+    QVector4D modelPoint = _modelMatrix.topMatrix().inverted() * QVector4D(point.x(), point.y(), 0, 1);
+    Point2Df p(modelPoint.x(), modelPoint.y());
+
+    if (_type == TriangleType::TRI3)
+    {
+        return _cellGrid.find(p, [&](unsigned int c)
+        {
+            return Geometry2DAlgorithms<float>::inTriangle(p, _points[_mesh[3 * c]], _points[_mesh[3 * c + 1]],
+                                                          _points[_mesh[3 * c + 2]]);
+        });
+    }
+
+    return _cellGrid.find(p, [&](unsigned int c)
+    {
+        Point2Df nodes[6];
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            nodes[i] = _points[_mesh[6 * c + i]];
+        }
+        return Geometry2DAlgorithms<float>::inQuadraticTriangle(p, nodes);
+    });
 }
 
 
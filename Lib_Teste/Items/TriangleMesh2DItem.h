@@ -9,6 +9,7 @@
 #include <QMatrix4x4>
 
 #include "../Geometry/Vector2D.h"
+#include "../Geometry/UniformGrid2D.h"
 #include "../Core/Graphics2DItem.h"
 
 namespace rm
@@ -127,45 +128,20 @@ private:
      */
     void updateVertexBuffer();
 
-private:
-    struct LocationVariables
-    {
-        /**
-         * @brief mvp - OpenGL identifier for model view projection matrix.
-         */
-        int mvp {-1};
-
-        /**
-         * @brief radius - OpenGL identifier for radius variable.
-         */
-        int radius {-1};
-
-        /**
-         * @brief brushColor - OpenGL identifier for brush color variable.
-         */
-        int brushColor {-1};
-
-        /**
-         * @brief penColor - OpenGL identifier for pen color variable.
-         */
-        int penColor {-1};
-
-        /**
-         * @brief penRatio - OpenGL identifier for pen ratio variable.
-         */
-        int brushRatio {-1};
-
-        /**
-         * @brief wireframe - Wireframe texture location.
-         */
-        int wireframe{-1};
-    };
+    /**
+     * @brief buildCellGrid - Builds the grid used to find the cells. TRI6 cells are bounded by the control points of
+     * their curved edges, which contain the whole edges.
+     */
+    void buildCellGrid() const;
 
     /**
-     * @brief _locations - Store all necessary locations to polyline shader.
+     * @brief findCell - Finds the cell that contains a point. The grid is built on the first call.
+     * @param point - Point in world coordinates.
+     * @return - Index of the cell or -1 if no cell contains the point.
      */
-    LocationVariables _locations;
+    int findCell(const Point2Df& point) const;
 
+private:
     /**
      * @brief _mesh - Triangle mesh topology.
      */
@@ -208,5 +184,10 @@ private:
      * @brief _type - triangle type. It determines the number of vertex for each triangle.
      */
     TriangleType _type;
+
+    /**
+     * @brief _cellGrid - Uniform grid over the cells, used to pick them.
+     */
+    mutable UniformGrid2D _cellGrid;
 };
 }
@@ -1,10 +1,10 @@
 #include <QOpenGLShaderProgram>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
 #include "TriangleMesh3DItem.h"
 #include "../Utility/WireframeTextureBuilder.h"
-#include "../Shading/LightSource.h"
 
 namespace rm
 {
@@ -18,6 +18,15 @@ TriangleMesh3DItem::TriangleMesh3DItem(std::vector<unsigned int>& mesh, std::vec
 
 
 
+TriangleMesh3DItem::TriangleMesh3DItem(loader::MeshCache* cache)
+    : _cache(cache)
+{
+    _aabb.setMinCornerPoint(_cache->getMinCornerPoint());
+    _aabb.setMaxCornerPoint(_cache->getMaxCornerPoint());
+}
+
+
+
 
 TriangleMesh3DItem::~TriangleMesh3DItem()
 {
@@ -37,9 +46,10 @@ TriangleMesh3DItem::~TriangleMesh3DItem()
         }
         _vao.clear();
 
-        delete _program;
-        _program = nullptr;
+        releaseProgram(_program);
     }
+
+    delete _cache;
 }
 
 
@@ -47,8 +57,7 @@ TriangleMesh3DItem::~TriangleMesh3DItem()
 void TriangleMesh3DItem::createVao(int id)
 {
     //Create and configure a new vao.
-    QOpenGLVertexArrayObject *vao = new QOpenGLVertexArrayObject();
-    vao->create();
+    QOpenGLVertexArrayObject *vao = createVertexArray();
     vao->bind();
 
     //Add vertex.
@@ -115,37 +124,56 @@ void TriangleMesh3DItem::createPrograms()
 void TriangleMesh3DItem::createBuffers()
 {
     //Compute the number of bytes.
-    int size = static_cast<int>(_points.size());
-    int numberOfBytes = size * static_cast<int>(sizeof(Point3Df));
+    GLsizeiptr numberOfBytes = static_cast<GLsizeiptr>(getNumberOfPoints() * sizeof(Point3Df));
 
     //Create vertex buffer.
     glGenBuffers(1, &_vertexBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, numberOfBytes, _points.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, numberOfBytes, getPointsData(), GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
     glEnableVertexAttribArray(0);
 
     //Create normal buffer.
     glGenBuffers(1, &_normalsBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, _normalsBuffer);
-    glBufferData(GL_ARRAY_BUFFER, numberOfBytes, _normals.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, numberOfBytes, getNormalsData(), GL_STATIC_DRAW);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
     glEnableVertexAttribArray(1);
 
     //Create element buffer.
-    size = static_cast<int>(_mesh.size());
-    numberOfBytes = size * static_cast<int>(sizeof(unsigned int));
-
     glGenBuffers(1, &_elementBuffer);
+    updateElementBuffer();
+}
+
+
+
+void TriangleMesh3DItem::updateElementBuffer()
+{
+    //The indexes of the simplified levels are stored after the mesh indexes.
+    const std::vector<unsigned int>& levelIndexes = _levelOfDetail.getIndexes();
+    GLsizeiptr meshBytes = static_cast<GLsizeiptr>(getNumberOfIndexes() * sizeof(unsigned int));
+    GLsizeiptr levelBytes = static_cast<GLsizeiptr>(levelIndexes.size() * sizeof(unsigned int));
+
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _elementBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfBytes, _mesh.data(), GL_STATIC_DRAW);
+    if (levelBytes == 0)
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshBytes, getMeshData(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshBytes + levelBytes, nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, meshBytes, getMeshData());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, meshBytes, levelBytes, levelIndexes.data());
+    }
+    _isElementBufferOutdated = false;
 }
 
 
 
 void TriangleMesh3DItem::updateVertexBuffer()
 {
-    if (isInitialized())
+    //Cached meshes are read only.
+    if (isInitialized() && _cache == nullptr)
     {
         //recompute normals
         computeNormals();
@@ -164,30 +192,39 @@ void TriangleMesh3DItem::updateVertexBuffer()
 
 
 
+void TriangleMesh3DItem::updateVertexBuffer(const std::vector<unsigned int>& changedPoints)
+{
+    std::vector<unsigned int> changedNormals;
+    _meshNormals.update(_mesh, _points, _normals, changedPoints, changedNormals);
+
+    if (isInitialized() && !changedPoints.empty())
+    {
+        //Send the smallest ranges that contain the changes.
+        auto points = std::minmax_element(changedPoints.begin(), changedPoints.end());
+        GLintptr offset = static_cast<GLintptr>(*points.first * sizeof(Point3Df));
+        GLsizeiptr numberOfBytes = static_cast<GLsizeiptr>((*points.second - *points.first + 1) * sizeof(Point3Df));
+        glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, numberOfBytes, &_points[*points.first]);
+
+        if (!changedNormals.empty())
+        {
+            auto normals = std::minmax_element(changedNormals.begin(), changedNormals.end());
+            offset = static_cast<GLintptr>(*normals.first * sizeof(Vector3Df));
+            numberOfBytes = static_cast<GLsizeiptr>((*normals.second - *normals.first + 1) * sizeof(Vector3Df));
+            glBindBuffer(GL_ARRAY_BUFFER, _normalsBuffer);
+            glBufferSubData(GL_ARRAY_BUFFER, offset, numberOfBytes, &_normals[*normals.first]);
+        }
+    }
+}
+
+
+
 void TriangleMesh3DItem::createProgram()
 {
-    //Create shader program.
-    _program = new QOpenGLShaderProgram();
-
-    //Add vertex and fragment shaders to program.
-    _program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/phong-vert");
-    _program->addShaderFromSourceFile(QOpenGLShader::Geometry, ":/shaders/wired-phong-uvw-geom");
-    _program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/wired-phong-uvw-frag");
-
-    //Try to link the program.
-    _program->link();
-
-    //Get variable locations.
-    _locations.ambientLight = _program->uniformLocation("ambientLight");
-    _locations.diffuseLight = _program->uniformLocation("diffuseLight");
-    _locations.ambientMaterial = _program->uniformLocation("ambientMaterial");
-    _locations.diffuseMaterial = _program->uniformLocation("diffuseMaterial");
-    _locations.penColor = _program->uniformLocation("penColor");
-    _locations.mv = _program->uniformLocation("mv");
-    _locations.lpos = _program->uniformLocation("lpos");
-    _locations.normalMatrix = _program->uniformLocation("nm");
-    _locations.mvp = _program->uniformLocation("mvp");
-    _locations.wireframe = _program->uniformLocation("wireframe");
+    //Get the shared shader program. It is compiled just by the first item that uses these shaders.
+    _program = acquireProgram({":/shaders/phong-vert", "", "",
+                               ":/shaders/wired-phong-uvw-geom",
+                               ":/shaders/wired-phong-uvw-frag"});
 }
 
 
@@ -203,26 +240,7 @@ void TriangleMesh3DItem::createWireframeTexture()
 
 void TriangleMesh3DItem::computeNormals()
 {
-    _normals.resize(_points.size(), QVector3D(0, 0, 0));
-    for (unsigned int t = 0; t < _mesh.size() / 3; t++)
-    {
-       //get the triangle vertices
-       unsigned int v0 = _mesh[3 * t + 0];
-       unsigned int v1 = _mesh[3 * t + 1];
-       unsigned int v2 = _mesh[3 * t + 2];
-       const Point3Df& p0 = _points[v0];
-       const Point3Df& p1 = _points[v1];
-       const Point3Df& p2 = _points[v2];
-       Point3Df n = Point3Df::crossProduct(p1 - p0, p2 - p0);
-       _normals[v0] += n;
-       _normals[v1] += n;
-       _normals[v2] += n;
-    }
-    //Normalize each normal
-    for (auto& normal : _normals)
-    {
-       normal = normal.normalized();
-    }
+    _meshNormals.compute(_mesh, _points, _normals);
 }
 
 
@@ -258,38 +276,28 @@ void TriangleMesh3DItem::render(int id)
     //Verify if there is a vao. If necessary create a new one.
     checkVao(id);
 
-    _program->bind();
+    bindProgram(_program);
 
     //Define the correct vao as current.
     _vao[id]->bind();
 
+    if (_isElementBufferOutdated)
+    {
+        updateElementBuffer();
+    }
+
     //QMatrix4x4 mv = _viewMatrix.topMatrix() * _modelMatrix.topMatrix();
 
     _viewMatrix.push();
     OpenGLMatrix mv = _viewMatrix.multMatrix(_modelMatrix);
     _viewMatrix.pop();
 
-    _proj.push();
-    OpenGLMatrix mvp = _proj .multMatrix(mv);
-    _proj.pop();
-
-    //Get the light source.
-    LightSource s = _shadingModel.getLightSource(0);
-    const Color& ambient = s.getAmbientComponent();
-    const Color& diffuse = s.getDiffuseComponent();
-    const QVector4D& lightPos = s.getLightPosition();
-
-    glUniform3f(_locations.ambientMaterial, 0.1f * _brushColor.x(), 0.1f * _brushColor.y(), 0.1f * _brushColor.z());
-    glUniform3f(_locations.diffuseMaterial, 0.9f * _brushColor.x(), 0.9f * _brushColor.y(), 0.9f * _brushColor.z());
-    glUniform3f(_locations.ambientLight, ambient.red() / 255.0f, ambient.green() / 255.0f, ambient.blue() / 255.0f);
-    glUniform3f(_locations.diffuseLight, diffuse.red() / 255.0f, diffuse.green() / 255.0f, diffuse.blue() / 255.0f);
-
-    glUniform4f(_locations.penColor, _penColor.x(), _penColor.y(), _penColor.z(), 1.0f);
-    glUniformMatrix4fv(_locations.mv, 1, false, _viewMatrix.topMatrix().data());
-    glUniform4f(_locations.lpos, lightPos.x(), lightPos.y(), lightPos.z(), lightPos.w());
-    glUniformMatrix4fv(_locations.mvp, 1, false, mvp.topMatrix().data());
-    glUniformMatrix3fv(_locations.normalMatrix, 1, false, mv.topMatrix().normalMatrix().data());
-    glUniform1i( _locations.wireframe, 0 );
+    ItemUniforms uniforms;
+    uniforms.setModel(_modelMatrix.topMatrix());
+    uniforms.setNormalMatrix(mv.topMatrix().normalMatrix());
+    uniforms.setBrushColor(_brushColor);
+    uniforms.setPenColor(QVector4D(_penColor.toVector3D(), 1.0f));
+    FrameUniforms::writeItem(uniforms);
 
     glDisable(GL_CULL_FACE);
     glEnable( GL_BLEND );
@@ -299,7 +307,19 @@ void TriangleMesh3DItem::render(int id)
     glActiveTexture( GL_TEXTURE0 );
     glBindTexture( GL_TEXTURE_1D, _wireframeTexture );
 
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_mesh.size()), GL_UNSIGNED_INT, nullptr);
+    //Draw the level chosen by the size of the mesh on the view.
+    size_t first = 0;
+    size_t count = getNumberOfIndexes();
+    const std::vector<MeshLevelOfDetail::Level>& levels = _levelOfDetail.getLevels();
+    if (!levels.empty())
+    {
+        int level = _levelOfDetail.selectLevel(getPixelsPerUnit(), _viewLevels[id]);
+        _viewLevels[id] = level;
+        first = levels[level].first;
+        count = levels[level].count;
+    }
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(count), GL_UNSIGNED_INT,
+                   reinterpret_cast<const GLvoid*>(first * sizeof(unsigned int)));
 
     glDisable(GL_TEXTURE_1D);
     glDisable( GL_BLEND );
@@ -337,4 +357,98 @@ void TriangleMesh3DItem::setWireframeLineThickNess(float thickness)
 {
     _wireframeLineThickness = thickness;
 }
+
+
+
+void TriangleMesh3DItem::setPoint(unsigned int index, const Point3Df& p)
+{
+    setPoints(std::vector<unsigned int>(1, index), std::vector<Point3Df>(1, p));
+}
+
+
+
+void TriangleMesh3DItem::setPoints(const std::vector<unsigned int>& indexes, const std::vector<Point3Df>& points)
+{
+    if (_cache != nullptr)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        _points[indexes[i]] = points[i];
+    }
+
+    //The levels use the mesh points, so they follow the moved points.
+    computeAABB();
+    updateVertexBuffer(indexes);
+
+    //The topology is the same, so the BVH is just refitted.
+    if (!_bvh.isEmpty())
+    {
+        std::vector<BoundingVolumeHierarchy::Box> boxes;
+        computeTriangleBoxes(_points.data(), _mesh.data(), _mesh.size() / 3, boxes);
+        _bvh.refit(boxes);
+    }
+}
+
+
+
+bool TriangleMesh3DItem::intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result)
+{
+    return intersectTriangles(origin, direction, getPointsData(), getMeshData(), getNumberOfIndexes() / 3, _bvh,
+                              result);
+}
+
+
+
+void TriangleMesh3DItem::buildBVH()
+{
+    std::vector<BoundingVolumeHierarchy::Box> boxes;
+    computeTriangleBoxes(getPointsData(), getMeshData(), getNumberOfIndexes() / 3, boxes);
+    _bvh.build(boxes);
+}
+
+
+
+void TriangleMesh3DItem::buildLevelsOfDetail()
+{
+    _levelOfDetail.build(getMeshData(), getNumberOfIndexes(), getPointsData(), getNumberOfPoints());
+    _isElementBufferOutdated = true;
+}
+
+
+
+size_t TriangleMesh3DItem::getNumberOfPoints() const
+{
+    return _cache != nullptr ? _cache->getNumberOfPoints() : _points.size();
+}
+
+
+
+size_t TriangleMesh3DItem::getNumberOfIndexes() const
+{
+    return _cache != nullptr ? 3 * static_cast<size_t>(_cache->getNumberOfTriangles()) : _mesh.size();
+}
+
+
+
+const Point3Df* TriangleMesh3DItem::getPointsData() const
+{
+    return _cache != nullptr ? _cache->getPoints() : _points.data();
+}
+
+
+
+const Vector3Df* TriangleMesh3DItem::getNormalsData() const
+{
+    return _cache != nullptr ? _cache->getNormals() : _normals.data();
+}
+
+
+
+const unsigned int* TriangleMesh3DItem::getMeshData() const
+{
+    return _cache != nullptr ? _cache->getTriangles() : _mesh.data();
+}
 };
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
 #include <iostream>
 #include <assert.h>
 #include <QMatrix4x4>
@@ -11,6 +12,9 @@
 #include "../Core/Graphics3DItem.h"
 #include "../Events/GraphicsScenePressEvent.h"
 #include "../Events/GraphicsSceneHoverEvent.h"
+#include "../Utility/MeshCache.h"
+#include "../Utility/MeshLevelOfDetail.h"
+#include "../Utility/MeshNormals.h"
 
 using Vector3Df = QVector3D;
 using Point3Df = QVector3D;
@@ -25,6 +29,13 @@ public:
 	 */
     TriangleMesh3DItem(std::vector<unsigned int>& mesh, std::vector<Point3Df>& points);
 
+    /**
+     * @brief TriangleMesh3DItem - Constructor that uses a mesh cache. The normals and the AABB are read from the cache
+     * and its mapped sections are sent straight to the OpenGL buffers.
+     * @param cache - Open mesh cache. The item takes its ownership.
+     */
+    explicit TriangleMesh3DItem(loader::MeshCache* cache);
+
 	/**
      * @brief TriangleMesh3DItem  - Deconstructor
 	 */
@@ -72,6 +83,43 @@ public:
      */
     void setWireframeLineThickNess(float thickness);
 
+    /**
+     * @brief setPoint - Moves a mesh point. Only the normals of the vertices around it are recomputed.
+     * @param index - Point index.
+     * @param p - New point position.
+     */
+    void setPoint(unsigned int index, const Point3Df& p);
+
+    /**
+     * @brief setPoints - Moves some mesh points. Only the normals of the vertices around them are recomputed. Items
+     * built from a mesh cache are read only and are not changed.
+     * @param indexes - Point indexes.
+     * @param points - New point positions, one for each index.
+     */
+    void setPoints(const std::vector<unsigned int>& indexes, const std::vector<Point3Df>& points);
+
+    /**
+     * @brief intersectRay - Intersects a ray with the mesh triangles.
+     * @param origin - Ray origin in world coordinates.
+     * @param direction - Ray direction in world coordinates.
+     * @param result - Nearest hit so far. Its cell is the triangle index.
+     * @return - Returns true if the mesh was hit closer than the previous result.
+     */
+    bool intersectRay(const QVector3D& origin, const QVector3D& direction, PickResult& result) override;
+
+    /**
+     * @brief buildBVH - Builds the BVH used by intersectRay(). It is built on the first pick anyway, but loaders may
+     * call it on their threads to avoid the delay.
+     */
+    void buildBVH();
+
+    /**
+     * @brief buildLevelsOfDetail - Builds the simplified levels drawn when the mesh is small on the view. It takes a
+     * while on large meshes, so loaders should call it on their threads, before the item is added to the scene.
+     * Meshes without levels are always drawn whole.
+     */
+    void buildLevelsOfDetail();
+
 private:
 
     /**
@@ -101,11 +149,24 @@ private:
      */
     void createBuffers();
 
+    /**
+     * @brief updateElementBuffer - Sends the mesh indexes and the indexes of the simplified levels to the element
+     * buffer.
+     */
+    void updateElementBuffer();
+
     /**
      * @brief updateVertexBuffer - update vertex buffer
      */
     void updateVertexBuffer();
 
+    /**
+     * @brief updateVertexBuffer - Updates the normals around the changed points and sends to the buffers only the
+     * range of points and normals that changed.
+     * @param changedPoints - Indexes of the changed points.
+     */
+    void updateVertexBuffer(const std::vector<unsigned int>& changedPoints);
+
     /**
      * @brief createProgram - create an OpenGL program.
      */
@@ -121,65 +182,37 @@ private:
      */
     void computeNormals();
 
-private:
-    struct LocationVariables
-    {
-        /**
-         * @brief mvp - opengl identifier for model view projection matrix.
-         */
-        int mvp{-1};
-
-        /**
-         * @brief lpos - light position.
-         */
-        int lpos{-1};
-
-        /**
-         * @brief penColor - opengl identifier for pen color variable.
-         */
-        int penColor{-1};
-
-        /**
-         * @brief diffuseLight - diffuse light component.
-         */
-        int diffuseLight{-1};
-
-        /**
-         * @brief ambientLight - ambiet light component.
-         */
-        int ambientLight{-1};
-
-        /**
-         * @brief diffuseMaterial - diffuse material component.
-         */
-        int diffuseMaterial{-1};
-
-        /**
-         * @brief ambientMaterial - ambiet material component.
-         */
-        int ambientMaterial{-1};
+    /**
+     * @brief getNumberOfPoints - Gets the number of points, from the cache if there is one.
+     * @return - Returns the number of points.
+     */
+    size_t getNumberOfPoints() const;
 
-        /**
-         * @brief normalMatrix - matriz to transform normals.
-         */
-        int normalMatrix{-1};
+    /**
+     * @brief getNumberOfIndexes - Gets the number of triangle indexes, from the cache if there is one.
+     * @return - Returns the number of indexes.
+     */
+    size_t getNumberOfIndexes() const;
 
-        /**
-         * @brief mv - view matriz location.
-         */
-        int mv{-1};
+    /**
+     * @brief getPointsData - Gets the points, from the cache if there is one.
+     * @return - Returns a pointer to the first point.
+     */
+    const Point3Df* getPointsData() const;
 
-        /**
-         * @brief wireframe - wireframe texture location.
-         */
-        int wireframe{-1};
-    };
+    /**
+     * @brief getNormalsData - Gets the normals, from the cache if there is one.
+     * @return - Returns a pointer to the first normal.
+     */
+    const Vector3Df* getNormalsData() const;
 
     /**
-     * @brief _locations - store all necessary locations to polyline shader.
+     * @brief getMeshData - Gets the triangle indexes, from the cache if there is one.
+     * @return - Returns a pointer to the first index.
      */
-    LocationVariables _locations;
+    const unsigned int* getMeshData() const;
 
+private:
     /**
      * @brief _mesh Vector holding mesh element indexes
      */
@@ -224,5 +257,35 @@ private:
      * @brief _normals triangle mesh normals
      */
     std::vector<Vector3Df> _normals;
+
+    /**
+     * @brief _meshNormals computes the normals and keeps the vertex adjacency for the incremental updates.
+     */
+    MeshNormals _meshNormals {3};
+
+    /**
+     * @brief _bvh BVH over the triangles, used to pick the mesh.
+     */
+    BoundingVolumeHierarchy _bvh;
+
+    /**
+     * @brief _levelOfDetail - Simplified levels of the mesh, stored after the mesh indexes on the element buffer.
+     */
+    MeshLevelOfDetail _levelOfDetail;
+
+    /**
+     * @brief _isElementBufferOutdated - True if the levels were built after the element buffer was filled.
+     */
+    bool _isElementBufferOutdated {false};
+
+    /**
+     * @brief _viewLevels - Level drawn on the last frame of each view.
+     */
+    std::map<int, int> _viewLevels;
+
+    /**
+     * @brief _cache mesh cache used instead of _points, _normals and _mesh. It is nullptr if the item owns its data.
+     */
+    loader::MeshCache* _cache {nullptr};
 };
 };
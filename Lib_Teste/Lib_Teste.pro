@@ -22,22 +22,37 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+        Core/AsyncItemLoader.cpp \
         Core/CoreItems/AABB2DItem.cpp \
+        Core/CoreItems/ItemBatchRenderer.cpp \
+        Core/CoreItems/PointSetBatchRenderer.cpp \
+        Core/CoreItems/PolylineBatchRenderer.cpp \
+        Core/CoreItems/RenderStatisticsOverlay.cpp \
+        Core/CoreItems/SelectionBoxRenderer.cpp \
+        Core/FrameScheduler.cpp \
+        Core/FrameUniforms.cpp \
         Core/Graphics2DItem.cpp \
+        Core/Graphics2DItemIndex.cpp \
         Core/Graphics2DView.cpp \
         Core/Graphics3DItem.cpp \
         Core/Graphics3DView.cpp \
         Core/GraphicsItem.cpp \
         Core/GraphicsScene.cpp \
         Core/GraphicsSceneEvent.cpp \
+        Core/GraphicsSceneEventRecorder.cpp \
+        Core/GraphicsSceneEventReplayer.cpp \
         Core/GraphicsTool.cpp \
         Core/GraphicsView.cpp \
+        Core/RenderProfiler.cpp \
         Events/GraphicsSceneHoverEvent.cpp \
         Events/GraphicsSceneKeyEvent.cpp \
         Events/GraphicsSceneMoveEvent.cpp \
         Events/GraphicsScenePressEvent.cpp \
         Events/GraphicsSceneWheelEvent.cpp \
+        Geometry/BoundingVolumeHierarchy.cpp \
         Geometry/OpenGLMatrix.cpp \
+        Geometry/PolylineSimplification.cpp \
+        Geometry/UniformGrid2D.cpp \
         Items/Group2DItem.cpp \
         Items/Group3DItem.cpp \
         Items/PointSet2DItem.cpp \
@@ -52,6 +67,7 @@ SOURCES += \
         Items/TriangleMesh3DItem.cpp \
         Shading/LightSource.cpp \
         Shading/LightSourceRepresentation.cpp \
+        Shading/ShaderProgramRegistry.cpp \
         Shading/ShadingModel.cpp \
         Shading/ShadingModelRepresentation.cpp \
         Tools/CreatePointSet2DItemTool.cpp \
@@ -61,21 +77,37 @@ SOURCES += \
         Tools/EditPolyline2DItemTool.cpp \
         Tools/Select2DItemTool.cpp \
         Tools/ViewControllerTool.cpp \
+        Utility/MeshCache.cpp \
+        Utility/MeshLevelOfDetail.cpp \
+        Utility/MeshNormals.cpp \
         Utility/ReaderOFF.cpp \
+        Utility/Tri3ToTri6Conversor.cpp \
         Utility/WireframeTextureBuilder.cpp \
         lib_teste.cpp
 
 HEADERS += \
+        Core/AsyncItemLoader.h \
         Core/CoreItems/AABB2DItem.h \
+        Core/CoreItems/ItemBatchRenderer.h \
+        Core/CoreItems/PointSetBatchRenderer.h \
+        Core/CoreItems/PolylineBatchRenderer.h \
+        Core/CoreItems/RenderStatisticsOverlay.h \
+        Core/CoreItems/SelectionBoxRenderer.h \
+        Core/FrameScheduler.h \
+        Core/FrameUniforms.h \
         Core/Graphics2DItem.h \
+        Core/Graphics2DItemIndex.h \
         Core/Graphics2DView.h \
         Core/Graphics3DItem.h \
         Core/Graphics3DView.h \
         Core/GraphicsItem.h \
         Core/GraphicsScene.h \
         Core/GraphicsSceneEvent.h \
+        Core/GraphicsSceneEventRecorder.h \
+        Core/GraphicsSceneEventReplayer.h \
         Core/GraphicsTool.h \
         Core/GraphicsView.h \
+        Core/RenderProfiler.h \
         Events/EventConstants.h \
         Events/GraphicsSceneHoverEvent.h \
         Events/GraphicsSceneKeyEvent.h \
@@ -83,8 +115,11 @@ HEADERS += \
         Events/GraphicsScenePressEvent.h \
         Events/GraphicsSceneWheelEvent.h \
         Geometry/AxisAligmentBoundingBox.h \
+        Geometry/BoundingVolumeHierarchy.h \
         Geometry/Geometry2DAlgorithms.h \
         Geometry/OpenGLMatrix.h \
+        Geometry/PolylineSimplification.h \
+        Geometry/UniformGrid2D.h \
         Geometry/Vector2D.h \
         Items/Group2DItem.h \
         Items/Group3DItem.h \
@@ -102,6 +137,7 @@ HEADERS += \
         Shading/LightSource.h \
         Shading/LightSourceRepresentation.h \
         Shading/LightType.h \
+        Shading/ShaderProgramRegistry.h \
         Shading/ShadingModel.h \
         Shading/ShadingModelRepresentation.h \
         Tools/CreatePointSet2DItemTool.h \
@@ -111,6 +147,10 @@ HEADERS += \
         Tools/EditPolyline2DItemTool.h \
         Tools/Select2DItemTool.h \
         Tools/ViewControllerTool.h \
+        Utility/MeshCache.h \
+        Utility/MeshLevelOfDetail.h \
+        Utility/MeshNormals.h \
+        Utility/ParallelFor.h \
         Utility/ReaderOFF.h \
         Utility/Tri3ToTri6Conversor.h \
         Utility/WireframeTextureBuilder.h \
@@ -0,0 +1,257 @@
+#include "ShaderProgramRegistry.h"
+#include "../Core/FrameUniforms.h"
+#include <QElapsedTimer>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <cstdio>
+
+namespace rm
+{
+ShaderProgramRegistry::ShaderProgramRegistry(QObject* parent) : QObject(parent)
+{
+}
+
+
+
+ShaderProgramRegistry::~ShaderProgramRegistry()
+{
+    for (auto it = _programs.begin(); it != _programs.end(); it++)
+    {
+        it->second.program->removeAllShaders();
+        delete it->second.program;
+    }
+
+    _programs.clear();
+    _keys.clear();
+}
+
+
+
+ShaderProgramRegistry* ShaderProgramRegistry::current()
+{
+    return fromContext(QOpenGLContext::currentContext());
+}
+
+
+
+ShaderProgramRegistry* ShaderProgramRegistry::fromContext(QOpenGLContext* context)
+{
+    if (context == nullptr || context->shareGroup() == nullptr)
+    {
+        return nullptr;
+    }
+
+    //The registry lives as long as the share group.
+    QOpenGLContextGroup* group = context->shareGroup();
+    ShaderProgramRegistry* registry = group->findChild<ShaderProgramRegistry*>(QString(),
+                                                                               Qt::FindDirectChildrenOnly);
+    if (registry == nullptr)
+    {
+        registry = new ShaderProgramRegistry(group);
+    }
+    return registry;
+}
+
+
+
+QOpenGLShaderProgram* ShaderProgramRegistry::acquire(const ShaderProgramKey& key)
+{
+    QMutexLocker locker(&_mutex);
+    auto it = _programs.find(key);
+    if (it == _programs.end())
+    {
+        it = insertProgram(key);
+    }
+
+    it->second.references++;
+    return it->second.program;
+}
+
+
+
+unsigned int ShaderProgramRegistry::warmUp(const std::vector<ShaderProgramKey>& keys,
+                                           const std::function<void(float)>& progress)
+{
+    unsigned int built = 0;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (isSupported(keys[i]))
+        {
+            //The lock is taken per program, so the items of other threads are not blocked by the whole warm-up.
+            QMutexLocker locker(&_mutex);
+            auto it = _programs.find(keys[i]);
+            if (it == _programs.end())
+            {
+                it = insertProgram(keys[i]);
+                built++;
+            }
+
+            if (!it->second.isWarmedUp)
+            {
+                it->second.isWarmedUp = true;
+                it->second.references++;
+            }
+        }
+
+        if (progress)
+        {
+            progress(static_cast<float>(i + 1) / keys.size());
+        }
+    }
+    return built;
+}
+
+
+
+void ShaderProgramRegistry::release(QOpenGLShaderProgram* program)
+{
+    QMutexLocker locker(&_mutex);
+    auto keyIt = _keys.find(program);
+    if (keyIt == _keys.end())
+    {
+        return;
+    }
+
+    auto it = _programs.find(keyIt->second);
+    if (--it->second.references == 0)
+    {
+        //Nobody else uses the program.
+        program->release();
+        program->removeAllShaders();
+        delete program;
+
+        _programs.erase(it);
+        _keys.erase(keyIt);
+    }
+}
+
+
+
+int ShaderProgramRegistry::uniformLocation(QOpenGLShaderProgram* program, const char* name)
+{
+    QMutexLocker locker(&_mutex);
+    auto keyIt = _keys.find(program);
+    if (keyIt == _keys.end())
+    {
+        return program->uniformLocation(name);
+    }
+
+    std::map<std::string, int>& locations = _programs[keyIt->second].locations;
+    auto it = locations.find(name);
+    if (it == locations.end())
+    {
+        it = locations.insert(std::make_pair(std::string(name), program->uniformLocation(name))).first;
+    }
+    return it->second;
+}
+
+
+
+unsigned int ShaderProgramRegistry::size() const
+{
+    QMutexLocker locker(&_mutex);
+    return static_cast<unsigned int>(_programs.size());
+}
+
+
+
+double ShaderProgramRegistry::getBuildTime() const
+{
+    QMutexLocker locker(&_mutex);
+    return _buildTime;
+}
+
+
+
+const std::vector<ShaderProgramKey>& ShaderProgramRegistry::getLibraryPrograms()
+{
+    static const std::vector<ShaderProgramKey> programs =
+    {
+        {":/shaders/no-transformation-vert", "", "", ":/shaders/quad-generator-geom", ":/shaders/bordered-square-frag"},
+        {":/shaders/no-transformation-vert", "", "", ":/shaders/quad-generator-geom", ":/shaders/bordered-circle-frag"},
+        {":/shaders/no-transformation-vert", "", "", ":/shaders/triangle-generator-geom",
+         ":/shaders/bordered-triangle-frag"},
+        {":/shaders/no-transformation-vert", "", "", ":/shaders/rectangle-generator-geom",
+         ":/shaders/bordered-line-frag"},
+        {":/shaders/no-transformation-vert", "", "", ":/shaders/transformable-quad-generator-geom",
+         ":/shaders/bordered-square-frag"},
+        {":/shaders/mvp-transformation-vert", "", "", "", ":/shaders/solid-color-frag"},
+        {":/shaders/item-transformation-vert", "", "", ":/shaders/wired-solid-color-uvw-geom",
+         ":/shaders/wired-solid-color-uvw-frag"},
+        {":/shaders/item-transformation-vert", "", "", ":/shaders/wired-solid-color-uv-geom",
+         ":/shaders/wired-solid-color-uv-frag"},
+        {":/shaders/tri6-400-vert", ":/shaders/tri6-400-tesc", ":/shaders/tri6-400-tese", "",
+         ":/shaders/wired-solid-color-400-frag"},
+        {":/shaders/phong-vert", "", "", ":/shaders/wired-phong-uvw-geom", ":/shaders/wired-phong-uvw-frag"},
+        {":/shaders/phong-vert", "", "", ":/shaders/wired-phong-uv-geom", ":/shaders/wired-phong-uv-frag"},
+        {":/shaders/point-batch-vert", "", "", ":/shaders/point-batch-quad-geom", ":/shaders/point-batch-circle-frag"},
+        {":/shaders/point-batch-vert", "", "", ":/shaders/point-batch-quad-geom", ":/shaders/point-batch-square-frag"},
+        {":/shaders/point-batch-vert", "", "", ":/shaders/point-batch-triangle-geom",
+         ":/shaders/point-batch-triangle-frag"},
+        {":/shaders/polyline-batch-vert", "", "", ":/shaders/polyline-batch-geom", ":/shaders/polyline-batch-frag"},
+        {":/shaders/selection-box-vert", "", "", "", ":/shaders/selection-box-frag"},
+    };
+    return programs;
+}
+
+
+
+std::map<ShaderProgramKey, ShaderProgramRegistry::Entry>::iterator
+ShaderProgramRegistry::insertProgram(const ShaderProgramKey& key)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    //Create a new program.
+    QOpenGLShaderProgram* program = new QOpenGLShaderProgram();
+
+    //Add the shaders that were defined. Cacheable shaders are only compiled on link, if the binary is not on disk.
+    if (!key.vertex.empty())
+    {
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, key.vertex.c_str());
+    }
+    if (!key.tessControl.empty())
+    {
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::TessellationControl, key.tessControl.c_str());
+    }
+    if (!key.tessEvaluation.empty())
+    {
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::TessellationEvaluation, key.tessEvaluation.c_str());
+    }
+    if (!key.geometry.empty())
+    {
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Geometry, key.geometry.c_str());
+    }
+    if (!key.fragment.empty())
+    {
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, key.fragment.c_str());
+    }
+
+    //Try to link the program.
+    if (!program->link())
+    {
+        printf("Program link error: %s\n", program->log().toStdString().c_str());
+    }
+    else
+    {
+        //Block bindings are not kept on the cached binaries, so they are assigned after each link.
+        FrameUniforms::bindBlocks(program->programId());
+    }
+    _buildTime += timer.nsecsElapsed() * 1e-6;
+
+    Entry entry;
+    entry.program = program;
+
+    _keys.insert(std::make_pair(program, key));
+    return _programs.insert(std::make_pair(key, std::move(entry))).first;
+}
+
+
+
+bool ShaderProgramRegistry::isSupported(const ShaderProgramKey& key)
+{
+    return (key.tessControl.empty() || QOpenGLShader::hasOpenGLShaders(QOpenGLShader::TessellationControl)) &&
+           (key.tessEvaluation.empty() || QOpenGLShader::hasOpenGLShaders(QOpenGLShader::TessellationEvaluation)) &&
+           (key.geometry.empty() || QOpenGLShader::hasOpenGLShaders(QOpenGLShader::Geometry));
+}
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <QMutex>
+#include <QObject>
+
+class QOpenGLContext;
+class QOpenGLShaderProgram;
+
+namespace rm
+{
+/**
+ * @brief The ShaderProgramKey struct - Identifies a shader program by the tuple of its source files. Empty stages are
+ * not attached to the program.
+ */
+struct ShaderProgramKey
+{
+    /**
+     * @brief vertex - Vertex shader source file.
+     */
+    std::string vertex;
+
+    /**
+     * @brief tessControl - Tessellation control shader source file.
+     */
+    std::string tessControl;
+
+    /**
+     * @brief tessEvaluation - Tessellation evaluation shader source file.
+     */
+    std::string tessEvaluation;
+
+    /**
+     * @brief geometry - Geometry shader source file.
+     */
+    std::string geometry;
+
+    /**
+     * @brief fragment - Fragment shader source file.
+     */
+    std::string fragment;
+
+    /**
+     * @brief operator< - Strict weak ordering used by the registry map.
+     * @param k - Key to be compared.
+     * @return - Returns true if this key comes before k.
+     */
+    bool operator<(const ShaderProgramKey& k) const
+    {
+        return std::tie(vertex, tessControl, tessEvaluation, geometry, fragment) <
+               std::tie(k.vertex, k.tessControl, k.tessEvaluation, k.geometry, k.fragment);
+    }
+};
+
+
+
+/**
+ * @brief The ShaderProgramRegistry class - Stores shared and reference counted shader programs. Programs are valid in
+ * every context of a share group, so there is one registry per group. The GraphicsScene creates it for the group of
+ * its context and the items acquire their programs from it on initialize(). Items can be initialized by the loader
+ * thread of the scene, so the registry methods are thread safe.
+ *
+ * The shaders are added as cacheable, so Qt keeps the linked program binaries on disk, on the generic cache location.
+ * A cached binary is only used if the source hash and the driver vendor, renderer and version match, otherwise the
+ * program is compiled again and the cache is replaced. The cache is off if the Qt::AA_DisableShaderDiskCache
+ * attribute or the QT_DISABLE_SHADER_DISK_CACHE variable is set.
+ */
+class ShaderProgramRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Destructor. Programs still alive are deleted, so a context of the group should be current.
+     */
+    ~ShaderProgramRegistry() override;
+
+    /**
+     * @brief current - Gets the registry of the share group of the current OpenGL context. The registry is created
+     * if it does not exist yet.
+     * @return - Returns the registry or nullptr if there is no current context.
+     */
+    static ShaderProgramRegistry* current();
+
+    /**
+     * @brief fromContext - Gets the registry of the share group of a given context. The registry is created if it
+     * does not exist yet.
+     * @param context - OpenGL context.
+     * @return - Returns the registry or nullptr if the context is not valid.
+     */
+    static ShaderProgramRegistry* fromContext(QOpenGLContext* context);
+
+    /**
+     * @brief acquire - Gets a program built from the given sources. The program is compiled and linked just on the
+     * first request, the next ones only increase its reference counter. Needs a current context.
+     * @param key - Shader sources.
+     * @return - Returns the shared program.
+     */
+    QOpenGLShaderProgram* acquire(const ShaderProgramKey& key);
+
+    /**
+     * @brief warmUp - Builds programs before the items ask for them. The registry keeps one reference of each program
+     * it builds here, so they are not built again when the last item using them is removed. Programs with stages that
+     * the current context does not support are skipped. Needs a current context, usually the one of the scene loader
+     * thread.
+     * @param keys - Shader sources of the programs.
+     * @param progress - Function called with the fraction of the keys already processed. It can be empty.
+     * @return - Returns the number of programs built, not counting the ones that already existed.
+     */
+    unsigned int warmUp(const std::vector<ShaderProgramKey>& keys,
+                        const std::function<void(float)>& progress = std::function<void(float)>());
+
+    /**
+     * @brief release - Decreases the reference counter of a program. The program is deleted when it is not used
+     * anymore. Needs a current context.
+     * @param program - Program returned by acquire.
+     */
+    void release(QOpenGLShaderProgram* program);
+
+    /**
+     * @brief uniformLocation - Gets the location of an uniform variable. Locations are resolved once per program
+     * and cached, so items sharing a program do not query the driver again.
+     * @param program - Program returned by acquire.
+     * @param name - Uniform variable name.
+     * @return - Returns the uniform location or -1 if it is not active.
+     */
+    int uniformLocation(QOpenGLShaderProgram* program, const char* name);
+
+    /**
+     * @brief size - Gets the number of programs alive in the registry.
+     * @return - Returns the number of programs.
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief getBuildTime - Gets the time spent building programs, from the disk cache or from the sources.
+     * @return - Returns the time in milliseconds.
+     */
+    double getBuildTime() const;
+
+    /**
+     * @brief getLibraryPrograms - Gets the shader sources of all programs used by the library items and renderers.
+     * @return - Returns the program keys.
+     */
+    static const std::vector<ShaderProgramKey>& getLibraryPrograms();
+
+private:
+    /**
+     * @brief ShaderProgramRegistry - Private constructor. Registries are created by fromContext().
+     * @param parent - Share group that owns the registry.
+     */
+    explicit ShaderProgramRegistry(QObject* parent);
+
+    /**
+     * @brief The Entry struct - Shared program information.
+     */
+    struct Entry
+    {
+        /**
+         * @brief program - Linked program.
+         */
+        QOpenGLShaderProgram* program {nullptr};
+
+        /**
+         * @brief references - Number of items using the program.
+         */
+        unsigned int references {0};
+
+        /**
+         * @brief locations - Cached uniform locations.
+         */
+        std::map<std::string, int> locations;
+
+        /**
+         * @brief isWarmedUp - True if the registry holds a reference since warmUp().
+         */
+        bool isWarmedUp {false};
+    };
+
+    /**
+     * @brief insertProgram - Builds a program and inserts it without references. The mutex must be locked.
+     * @param key - Shader sources.
+     * @return - Returns the new entry.
+     */
+    std::map<ShaderProgramKey, Entry>::iterator insertProgram(const ShaderProgramKey& key);
+
+    /**
+     * @brief isSupported - Verifies if the current context supports all stages of a program.
+     * @param key - Shader sources.
+     * @return - Returns true if the program can be built.
+     */
+    static bool isSupported(const ShaderProgramKey& key);
+
+    /**
+     * @brief _mutex - Protects the maps, since programs can be acquired by the GUI and loader threads.
+     */
+    mutable QMutex _mutex;
+
+    /**
+     * @brief _programs - Programs by shader sources.
+     */
+    std::map<ShaderProgramKey, Entry> _programs;
+
+    /**
+     * @brief _keys - Reverse map used to release programs.
+     */
+    std::map<QOpenGLShaderProgram*, ShaderProgramKey> _keys;
+
+    /**
+     * @brief _buildTime - Time spent building programs, in milliseconds.
+     */
+    double _buildTime {0.0};
+};
+}
@@ -1,14 +1,23 @@
 #version 330 core
 
-uniform vec4 brushColor;
-uniform vec4 penColor;
-uniform vec2 brushRatio;
+//Colors, and brush ratio on radius.zw.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
 
 in vec2 uv;
 out vec4 fragColor;
 
 void main()
 {
+   vec2 brushRatio = radius.zw;
+
    //Get absolute value.
    float r = length(uv);
 
@@ -1,8 +1,15 @@
 #version 330 core
-uniform vec4 brushColor;
-uniform vec4 penColor;
-uniform float brushRatio;
-uniform int capStyle;
+
+//Colors, brush ratio on radius.y and cap style on style.x.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
 
 in float p;
 in vec2 uv;
@@ -11,6 +18,9 @@ out vec4 colorFragment;
 
 void main()
 {
+    float brushRatio = radius.y;
+    int capStyle = style.x;
+
     //Compute color for corner fragments.
     float u = abs(uv.x);
     float dx = (u - 1) / (p - 1);
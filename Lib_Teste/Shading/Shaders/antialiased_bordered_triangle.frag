@@ -1,14 +1,23 @@
 #version 330 core
 
-uniform vec4 brushColor;
-uniform vec4 penColor;
-uniform vec2 brushRatio;
+//Colors, and brush ratio on radius.zw.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
 
 in vec3 uvw;
 out vec4 fragColor;
 
 void main()
 {
+    vec2 brushRatio = radius.zw;
+
     //Adjust brush ratio once the coordinate textures space is the half of that used for circle and square.
     vec2 newBrushRatio = vec2(1.0f - (1.0f - brushRatio.x) * 0.5f,
                               1.0f - (1.0f - brushRatio.y) * 0.5f);
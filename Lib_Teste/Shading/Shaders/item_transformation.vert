@@ -0,0 +1,30 @@
+#version 330 core
+
+layout(location = 0) in vec4 pos;
+
+//Camera of the view.
+layout(std140) uniform ViewBlock
+{
+    mat4 proj;
+    mat4 view;
+    vec4 pixelSize;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightPosition;
+};
+
+//Model matrix.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
+
+void main()
+{
+   gl_Position = proj * view * model * pos;
+}
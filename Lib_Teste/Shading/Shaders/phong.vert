@@ -5,23 +5,41 @@ layout(location = 1) in vec3 n;
 out vec3 vNormal;
 out vec3 vLightDir;
 
-uniform vec4 lpos;
-uniform mat4 mvp;
-uniform mat4 mv;
-uniform mat3 nm;
+//Camera and light of the view.
+layout(std140) uniform ViewBlock
+{
+    mat4 proj;
+    mat4 view;
+    vec4 pixelSize;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightPosition;
+};
+
+//Model and normal matrices.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
 
 void main()
 {
+    mat4 mv = view * model;
     vec3 peye = vec3(mv * pos);
-    if (lpos.w == 0)
+    if (lightPosition.w == 0)
     {
-        vLightDir = normalize(lpos.xyz);
+        vLightDir = normalize(lightPosition.xyz);
     }
     else
     {
-        vLightDir = normalize(lpos.xyz - peye.xyz);
+        vLightDir = normalize(lightPosition.xyz - peye.xyz);
     }
 
-    vNormal = normalize(nm * n);
-    gl_Position = mvp * pos;
+    vNormal = normalize(normalMatrix * n);
+    gl_Position = proj * mv * pos;
 }
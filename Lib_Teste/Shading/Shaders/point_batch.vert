@@ -0,0 +1,38 @@
+#version 330 core
+
+layout(location = 0) in vec2 pos;
+layout(location = 1) in vec4 brushColor;
+layout(location = 2) in vec4 penColor;
+layout(location = 3) in vec2 radius;
+layout(location = 4) in vec2 brushRatio;
+layout(location = 5) in uint modelIndex;
+
+//Model matrices of the point sets. Each matrix uses two texels: (m00, m01, m03, 0) and (m10, m11, m13, 0).
+uniform sampler2D models;
+
+//Number of model matrices on each texture row.
+const uint matricesPerRow = 512u;
+
+out VertexData
+{
+   vec4 brushColor;
+   vec4 penColor;
+   vec2 radius;
+   vec2 brushRatio;
+} vertexOut;
+
+void main()
+{
+   ivec2 texel = ivec2(2u * (modelIndex % matricesPerRow), modelIndex / matricesPerRow);
+   vec4 row0 = texelFetch(models, texel, 0);
+   vec4 row1 = texelFetch(models, texel + ivec2(1, 0), 0);
+
+   //Transform the point to world space.
+   vec3 p = vec3(pos, 1.0);
+   gl_Position = vec4(dot(row0.xyz, p), dot(row1.xyz, p), 0.0, 1.0);
+
+   vertexOut.brushColor = brushColor;
+   vertexOut.penColor = penColor;
+   vertexOut.radius = radius;
+   vertexOut.brushRatio = brushRatio;
+}
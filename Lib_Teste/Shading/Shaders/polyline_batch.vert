@@ -0,0 +1,38 @@
+#version 330 core
+
+layout(location = 0) in vec2 pos;
+layout(location = 1) in uint polylineIndex;
+
+//Styles of the polylines. Each style uses five texels: the two rows of the 2D model matrix (m00, m01, m03, 0) and
+//(m10, m11, m13, 0), the brush color, the pen color and (radius, brush ratio, cap style, 0).
+uniform sampler2D styles;
+
+//Number of styles on each texture row.
+const uint stylesPerRow = 200u;
+
+out VertexData
+{
+   vec4 brushColor;
+   vec4 penColor;
+   float radius;
+   float brushRatio;
+   float capStyle;
+} vertexOut;
+
+void main()
+{
+   ivec2 texel = ivec2(5u * (polylineIndex % stylesPerRow), polylineIndex / stylesPerRow);
+   vec4 row0 = texelFetch(styles, texel, 0);
+   vec4 row1 = texelFetch(styles, texel + ivec2(1, 0), 0);
+   vec4 parameters = texelFetch(styles, texel + ivec2(4, 0), 0);
+
+   //Transform the point to world space.
+   vec3 p = vec3(pos, 1.0);
+   gl_Position = vec4(dot(row0.xyz, p), dot(row1.xyz, p), 0.0, 1.0);
+
+   vertexOut.brushColor = texelFetch(styles, texel + ivec2(2, 0), 0);
+   vertexOut.penColor = texelFetch(styles, texel + ivec2(3, 0), 0);
+   vertexOut.radius = parameters.x;
+   vertexOut.brushRatio = parameters.y;
+   vertexOut.capStyle = parameters.z;
+}
@@ -0,0 +1,9 @@
+#version 330 core
+
+in vec4 boxColor;
+out vec4 fragColor;
+
+void main()
+{
+   fragColor = boxColor;
+}
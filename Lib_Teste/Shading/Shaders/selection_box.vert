@@ -0,0 +1,18 @@
+#version 330 core
+
+layout(location = 0) in vec2 corner;
+layout(location = 1) in vec2 origin;
+layout(location = 2) in vec2 axisX;
+layout(location = 3) in vec2 axisY;
+layout(location = 4) in vec4 color;
+
+uniform mat4 mvp;
+
+out vec4 boxColor;
+
+void main()
+{
+   vec2 p = origin + corner.x * axisX + corner.y * axisY;
+   boxColor = color;
+   gl_Position = mvp * vec4(p, 0.0, 1.0);
+}
@@ -1,11 +1,27 @@
 #version 330 core
-uniform vec4 brushColor;
-uniform vec4 penColor;
 uniform sampler1D wireframe;
-uniform vec3 diffuseLight;
-uniform vec3 ambientLight;
-uniform vec3 diffuseMaterial;
-uniform vec3 ambientMaterial;
+
+//Light of the view.
+layout(std140) uniform ViewBlock
+{
+    mat4 proj;
+    mat4 view;
+    vec4 pixelSize;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightPosition;
+};
+
+//Colors. The material is derived from the brush color.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
 
 in vec3 gNormal;
 in vec3 gLightDir;
@@ -14,6 +30,11 @@ out vec4 fragmentColor;
 
 void main()
 {
+    vec3 diffuseLight = lightDiffuse.rgb;
+    vec3 ambientLight = lightAmbient.rgb;
+    vec3 diffuseMaterial = 0.9 * brushColor.rgb;
+    vec3 ambientMaterial = 0.1 * brushColor.rgb;
+
     vec3 n = normalize(gNormal);
     vec3 color = vec3(0, 0, 0);
     vec3 l = normalize(gLightDir);
@@ -1,8 +1,17 @@
 #version 330 core
-uniform vec4 brushColor;
-uniform vec4 penColor;
 uniform sampler1D wireframe;
 
+//Colors.
+layout(std140) uniform ItemBlock
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 brushColor;
+    vec4 penColor;
+    vec4 radius;
+    ivec4 style;
+};
+
 in vec2 uv;
 out vec4 fragmentColor;
 
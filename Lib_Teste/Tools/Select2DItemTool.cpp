@@ -34,7 +34,7 @@ void Select2DItemTool::showBoxItems(bool show)
     _groupItem->getAABB2DItem()->visible(show);
     for (auto gi : _groupItem->getItems())
     {
-        gi->getAABB2DItem()->visible(show);
+        gi->showSelectionBox(show);
     }
 }
 
@@ -43,7 +43,8 @@ void Select2DItemTool::setupGroupBoxLayout()
     QVector4D blue(61.f / 255, 127.f / 255, 186.f / 255, 1.0f);
     AABB2DItem* groupItemSelectionBox = _groupItem->getAABB2DItem();
 
-    setupBoxLayout(_groupItem);
+    groupItemSelectionBox->visible(false);
+    groupItemSelectionBox->setLineWidth(1);
     PointSet2DItem& boxPointSetItem = groupItemSelectionBox->getPointSetItem();
     PointSet2DItem& previewPointSetItem = groupItemSelectionBox->getPreviewPointSetItem();
     groupItemSelectionBox->setBrushColor(blue);
@@ -59,6 +60,8 @@ void Select2DItemTool::setupGroupBoxLayout()
     previewPointSetItem.setBrushColor(blue);
     previewPointSetItem.setPenColor(blue);
     previewPointSetItem.setPointSize(10);
+    previewPointSetItem.setLayout(PointSet2DItem::LayoutType::Square);
+    previewPointSetItem.visible(false);
 
 }
 
@@ -66,23 +69,10 @@ void Select2DItemTool::setupGroupBoxLayout()
 
 void Select2DItemTool::setupBoxLayout(Graphics2DItem *item)
 {
-    AABB2DItem* aabbItem = item->getAABB2DItem();
+    //Items boxes have no handles, so they are drawn by the view selection box renderer.
     QVector4D color(61.f / 255, 127.f / 255, 186.f / 255, 1.0f);
-    aabbItem->visible(false);
-    aabbItem->setLineWidth(1);
-    aabbItem->showHandles(false);
-    aabbItem->setBrushColor(color);
-    aabbItem->setPenColor(color);
-
-    aabbItem->getPointSetItem().setBrushColor(QVector4D(1, 1, 1, 1));
-    aabbItem->getPointSetItem().setPenColor(color);
-    aabbItem->getPointSetItem().setBorderSize(1.0f);
-
-    aabbItem->getPreviewPointSetItem().setBrushColor(color);
-    aabbItem->getPreviewPointSetItem().setPenColor(color);
-    aabbItem->getPreviewPointSetItem().setPointSize(10);
-    aabbItem->getPreviewPointSetItem().visible(false);
-    aabbItem->getPreviewPointSetItem().setLayout(PointSet2DItem::LayoutType::Square);
+    item->showSelectionBox(false);
+    item->setSelectionBoxColor(color);
 }
 
 
@@ -196,19 +186,19 @@ void Select2DItemTool::applyScale(const Point2Df& p, bool uniformScale, bool)
 
 Graphics2DItem *Select2DItemTool::checkItemIntersection(const Point2Df& p, const Point2Df& pixelSize)
 {
-    //Render 2d items
-    const std::list<GraphicsItem *>& itemsList = _scene->items();
-    for(auto item : itemsList)
-    {
-        Graphics2DItem* item2d = dynamic_cast<Graphics2DItem*>(item);
+    //Get the items whose AABB contains the point. The scene uses its index to avoid testing all items.
+    std::vector<Graphics2DItem*> candidates;
+    _scene->items2DAt(p, pixelSize, candidates);
 
-        if (item2d != nullptr && item2d != _groupItem)
+    for(auto item2d : candidates)
+    {
+        if (item2d != _groupItem)
         {
             //Define the pixel size information.
             item2d->setPixelSize(pixelSize);
 
             //Check of intersect with the item.
-            if (item2d->isInsideToItemAABB(p, pixelSize) && item2d->isIntersecting(p))
+            if (item2d->isIntersecting(p))
             {
                 return item2d;
             }
@@ -459,7 +449,7 @@ void Select2DItemTool::keyPressEvent2D(const GraphicsSceneKeyEvent *event, Graph
             //Add the new item as selected.
             for (auto gi : items)
             {
-                gi->getAABB2DItem()->visible(false);
+                gi->showSelectionBox(false);
             }
 
             Group2DItem* newGroup = new Group2DItem(items);
@@ -478,7 +468,7 @@ void Select2DItemTool::keyPressEvent2D(const GraphicsSceneKeyEvent *event, Graph
 
             for(auto item : items)
             {
-                item->getAABB2DItem()->visible(true);
+                item->showSelectionBox(true);
 
                 //If item is group, it has to be treated.
                 Group2DItem* group = dynamic_cast<Group2DItem*> (item);
@@ -500,7 +490,7 @@ void Select2DItemTool::keyPressEvent2D(const GraphicsSceneKeyEvent *event, Graph
                         _groupItem->addItem(sub);
                         setupBoxLayout(sub);
 
-                        sub->getAABB2DItem()->visible(true);
+                        sub->showSelectionBox(true);
                     }
                 }
                 else
@@ -630,7 +620,7 @@ void Select2DItemTool::finalize()
     //set groupItems with their selection box visible
     for (auto i : _groupItem->getItems())
     {
-        i->getAABB2DItem()->visible(false);
+        i->showSelectionBox(false);
     }
     _groupItem->getAABB2DItem()->getPreviewPointSetItem().visible(false);
     _scene->removeItem(_groupItem);
@@ -145,11 +145,8 @@ private:
 
     /**
      * @brief setupBoxLayout - Configures the appearence properties of the items
-     * bounding boxes.
-     * The color of brush and pen of the lines is: (61,127,186)
-     * The point size is 10;
-     * The brush ratio of the points is 0.9;
-     * The points of the external box are squared and white with the border in blue.
+     * selection boxes. They have no handles and are hidden by default.
+     * The color of the lines is: (61,127,186)
      */
     void setupBoxLayout(Graphics2DItem* item);
 
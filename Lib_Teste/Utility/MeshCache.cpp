@@ -0,0 +1,465 @@
+#include "MeshCache.h"
+#include "ReaderOFF.h"
+#include "MeshNormals.h"
+#include <QSaveFile>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace loader
+{
+namespace
+{
+/**
+ * @brief The MeshCacheHeader struct - Header at the beginning of a mesh cache file.
+ */
+struct MeshCacheHeader
+{
+    /**
+     * @brief magic - File signature.
+     */
+    char magic[8];
+
+    /**
+     * @brief byteOrder - Written as getByteOrderMark(). It is read differently on machines of other byte order.
+     */
+    uint32_t byteOrder;
+
+    /**
+     * @brief version - Cache format version.
+     */
+    uint32_t version;
+
+    /**
+     * @brief numPoints - Number of points and normals.
+     */
+    uint32_t numPoints;
+
+    /**
+     * @brief numTriangles - Number of triangles.
+     */
+    uint32_t numTriangles;
+
+    /**
+     * @brief numQuads - Number of source quads.
+     */
+    uint32_t numQuads;
+
+    /**
+     * @brief reserved - Keeps the offsets aligned.
+     */
+    uint32_t reserved;
+
+    /**
+     * @brief minCorner - Minimal corner of the mesh AABB.
+     */
+    float minCorner[3];
+
+    /**
+     * @brief maxCorner - Maximal corner of the mesh AABB.
+     */
+    float maxCorner[3];
+
+    /**
+     * @brief pointsOffset - Offset in bytes of the points section.
+     */
+    uint64_t pointsOffset;
+
+    /**
+     * @brief normalsOffset - Offset in bytes of the normals section.
+     */
+    uint64_t normalsOffset;
+
+    /**
+     * @brief trianglesOffset - Offset in bytes of the triangles section.
+     */
+    uint64_t trianglesOffset;
+
+    /**
+     * @brief quadsOffset - Offset in bytes of the quads section. It is zero if there are no quads.
+     */
+    uint64_t quadsOffset;
+};
+
+static_assert(sizeof(Point3Df) == 3 * sizeof(float), "Point3Df must be three packed floats to be mapped.");
+
+/**
+ * @brief getMagic - Gets the cache file signature.
+ * @return - Returns the eight bytes signature.
+ */
+const char* getMagic() { return "RMMESH\0\0"; }
+
+/**
+ * @brief getByteOrderMark - Gets the value used to detect files written with another byte order.
+ * @return - Returns the byte order mark.
+ */
+constexpr uint32_t getByteOrderMark() { return 0x01020304; }
+
+/**
+ * @brief getSectionAlignment - Gets the alignment in bytes of each section.
+ * @return - Returns the section alignment.
+ */
+constexpr uint64_t getSectionAlignment() { return 16; }
+
+
+
+/**
+ * @brief align - Rounds an offset up to the section alignment.
+ * @param offset - Offset in bytes.
+ * @return - Returns the aligned offset.
+ */
+uint64_t align(uint64_t offset)
+{
+    return (offset + getSectionAlignment() - 1) / getSectionAlignment() * getSectionAlignment();
+}
+
+
+
+/**
+ * @brief isValidSection - Verifies if a section is aligned and inside the file.
+ * @param offset - Section offset in bytes.
+ * @param numberOfBytes - Section size in bytes.
+ * @param fileSize - File size in bytes.
+ * @return - Returns true if the section is valid.
+ */
+bool isValidSection(uint64_t offset, uint64_t numberOfBytes, uint64_t fileSize)
+{
+    return offset >= sizeof(MeshCacheHeader) && offset % getSectionAlignment() == 0 &&
+           offset <= fileSize && numberOfBytes <= fileSize - offset;
+}
+
+
+
+/**
+ * @brief writeSection - Writes a section, preceded by the padding needed to reach its offset.
+ * @param file - File being written.
+ * @param offset - Section offset in bytes.
+ * @param data - Section data.
+ * @param numberOfBytes - Section size in bytes.
+ * @return - Returns true if all bytes were written.
+ */
+bool writeSection(QSaveFile& file, uint64_t offset, const void* data, uint64_t numberOfBytes)
+{
+    static const char padding[getSectionAlignment()] = {};
+    qint64 paddingSize = static_cast<qint64>(offset) - file.pos();
+    if (paddingSize < 0 || file.write(padding, paddingSize) != paddingSize)
+    {
+        return false;
+    }
+
+    return file.write(static_cast<const char*>(data), static_cast<qint64>(numberOfBytes)) ==
+           static_cast<qint64>(numberOfBytes);
+}
+
+
+
+/**
+ * @brief isValidMesh - Verifies if all indexes refer to existing points.
+ * @param indexes - Element indexes.
+ * @param numPoints - Number of points.
+ * @return - Returns true if the indexes are valid.
+ */
+bool isValidMesh(const std::vector<unsigned int>& indexes, size_t numPoints)
+{
+    return std::all_of(indexes.begin(), indexes.end(), [numPoints](unsigned int i) { return i < numPoints; });
+}
+
+
+
+/**
+ * @brief isValidMesh - Verifies if all mapped indexes refer to existing points.
+ * @param indexes - First element index.
+ * @param numIndexes - Number of indexes.
+ * @param numPoints - Number of points.
+ * @return - Returns true if the indexes are valid.
+ */
+bool isValidMesh(const unsigned int* indexes, uint64_t numIndexes, size_t numPoints)
+{
+    return std::all_of(indexes, indexes + numIndexes, [numPoints](unsigned int i) { return i < numPoints; });
+}
+}
+
+
+
+MeshCache::~MeshCache()
+{
+    close();
+}
+
+
+
+bool MeshCache::open(const std::string& filename)
+{
+    close();
+
+    _file.setFileName(QString::fromStdString(filename));
+    if (!_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    uint64_t fileSize = static_cast<uint64_t>(_file.size());
+    if (fileSize < sizeof(MeshCacheHeader))
+    {
+        close();
+        return false;
+    }
+
+    _data = _file.map(0, _file.size());
+    if (_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memcpy(&header, _data, sizeof(MeshCacheHeader));
+
+    //Reject other formats, byte orders and versions. They must be converted again.
+    uint64_t pointBytes = static_cast<uint64_t>(header.numPoints) * sizeof(Point3Df);
+    uint64_t triangleBytes = static_cast<uint64_t>(header.numTriangles) * 3 * sizeof(unsigned int);
+    uint64_t quadBytes = static_cast<uint64_t>(header.numQuads) * 4 * sizeof(unsigned int);
+    if (memcmp(header.magic, getMagic(), sizeof(header.magic)) != 0 || header.byteOrder != getByteOrderMark() ||
+        header.version != getVersion() ||
+        !isValidSection(header.pointsOffset, pointBytes, fileSize) ||
+        !isValidSection(header.normalsOffset, pointBytes, fileSize) ||
+        !isValidSection(header.trianglesOffset, triangleBytes, fileSize) ||
+        (header.numQuads > 0 && !isValidSection(header.quadsOffset, quadBytes, fileSize)))
+    {
+        close();
+        return false;
+    }
+
+    //The items index the points with the mapped triangles and quads, so an index out of range would read outside
+    //the points on the CPU. The scan is cheap next to the upload of the mesh.
+    const unsigned int* triangles = reinterpret_cast<const unsigned int*>(_data + header.trianglesOffset);
+    const unsigned int* quads = header.numQuads > 0 ?
+                reinterpret_cast<const unsigned int*>(_data + header.quadsOffset) : nullptr;
+    if (!isValidMesh(triangles, static_cast<uint64_t>(header.numTriangles) * 3, header.numPoints) ||
+        (quads != nullptr && !isValidMesh(quads, static_cast<uint64_t>(header.numQuads) * 4, header.numPoints)))
+    {
+        close();
+        return false;
+    }
+
+    _numPoints = header.numPoints;
+    _numTriangles = header.numTriangles;
+    _numQuads = header.numQuads;
+    _points = reinterpret_cast<const Point3Df*>(_data + header.pointsOffset);
+    _normals = reinterpret_cast<const Point3Df*>(_data + header.normalsOffset);
+    _triangles = triangles;
+    _quads = quads;
+    _minCornerPoint = Point3Df(header.minCorner[0], header.minCorner[1], header.minCorner[2]);
+    _maxCornerPoint = Point3Df(header.maxCorner[0], header.maxCorner[1], header.maxCorner[2]);
+    return true;
+}
+
+
+
+void MeshCache::close()
+{
+    if (_data != nullptr)
+    {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+
+    _numPoints = 0;
+    _numTriangles = 0;
+    _numQuads = 0;
+    _points = nullptr;
+    _normals = nullptr;
+    _triangles = nullptr;
+    _quads = nullptr;
+}
+
+
+
+bool MeshCache::isOpen() const
+{
+    return _data != nullptr;
+}
+
+
+
+unsigned int MeshCache::getNumberOfPoints() const
+{
+    return _numPoints;
+}
+
+
+
+unsigned int MeshCache::getNumberOfTriangles() const
+{
+    return _numTriangles;
+}
+
+
+
+unsigned int MeshCache::getNumberOfQuads() const
+{
+    return _numQuads;
+}
+
+
+
+const Point3Df* MeshCache::getPoints() const
+{
+    return _points;
+}
+
+
+
+const Point3Df* MeshCache::getNormals() const
+{
+    return _normals;
+}
+
+
+
+const unsigned int* MeshCache::getTriangles() const
+{
+    return _triangles;
+}
+
+
+
+const unsigned int* MeshCache::getQuads() const
+{
+    return _quads;
+}
+
+
+
+const Point3Df& MeshCache::getMinCornerPoint() const
+{
+    return _minCornerPoint;
+}
+
+
+
+const Point3Df& MeshCache::getMaxCornerPoint() const
+{
+    return _maxCornerPoint;
+}
+
+
+
+bool writeMeshCache(const std::string& filename, const std::vector<Point3Df>& points,
+                    const std::vector<Point3Df>& normals, const std::vector<unsigned int>& triangles,
+                    const std::vector<unsigned int>& quads)
+{
+    if (normals.size() != points.size() || triangles.size() % 3 != 0 || quads.size() % 4 != 0)
+    {
+        std::cout << "Invalid mesh for cache " << filename << std::endl;
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(MeshCacheHeader));
+    memcpy(header.magic, getMagic(), sizeof(header.magic));
+    header.byteOrder = getByteOrderMark();
+    header.version = MeshCache::getVersion();
+    header.numPoints = static_cast<uint32_t>(points.size());
+    header.numTriangles = static_cast<uint32_t>(triangles.size() / 3);
+    header.numQuads = static_cast<uint32_t>(quads.size() / 4);
+
+    //Compute the AABB.
+    Point3Df minCorner = points.empty() ? Point3Df() : points[0];
+    Point3Df maxCorner = minCorner;
+    for (const Point3Df& p : points)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            minCorner[c] = std::min(minCorner[c], p[c]);
+            maxCorner[c] = std::max(maxCorner[c], p[c]);
+        }
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        header.minCorner[c] = minCorner[c];
+        header.maxCorner[c] = maxCorner[c];
+    }
+
+    uint64_t pointBytes = points.size() * sizeof(Point3Df);
+    uint64_t triangleBytes = triangles.size() * sizeof(unsigned int);
+    uint64_t quadBytes = quads.size() * sizeof(unsigned int);
+    header.pointsOffset = align(sizeof(MeshCacheHeader));
+    header.normalsOffset = align(header.pointsOffset + pointBytes);
+    header.trianglesOffset = align(header.normalsOffset + pointBytes);
+    header.quadsOffset = quads.empty() ? 0 : align(header.trianglesOffset + triangleBytes);
+
+    //The cache is written to a temporary file that replaces the old one on commit.
+    QSaveFile file(QString::fromStdString(filename));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        std::cout << "Could not write " << filename << std::endl;
+        return false;
+    }
+
+    bool isWritten = file.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader)) ==
+                     static_cast<qint64>(sizeof(MeshCacheHeader)) &&
+                     writeSection(file, header.pointsOffset, points.data(), pointBytes) &&
+                     writeSection(file, header.normalsOffset, normals.data(), pointBytes) &&
+                     writeSection(file, header.trianglesOffset, triangles.data(), triangleBytes) &&
+                     (quads.empty() || writeSection(file, header.quadsOffset, quads.data(), quadBytes));
+
+    if (!isWritten || !file.commit())
+    {
+        std::cout << "Could not write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+
+bool convertTriangle3DFileOFF(const std::string& offFilename, const std::string& cacheFilename)
+{
+    std::vector<Point3Df> points;
+    std::vector<unsigned int> triangles;
+    readTriangle3DFileOFF(offFilename, points, triangles);
+    if (points.empty() || !isValidMesh(triangles, points.size()))
+    {
+        return false;
+    }
+
+    std::vector<Point3Df> normals;
+    rm::MeshNormals(3).compute(triangles, points, normals);
+    return writeMeshCache(cacheFilename, points, normals, triangles);
+}
+
+
+
+bool convertQuad3DFileOFF(const std::string& offFilename, const std::string& cacheFilename)
+{
+    std::vector<Point3Df> points;
+    std::vector<unsigned int> quads;
+    readQuad3DFileOFF(offFilename, points, quads);
+    if (points.empty() || !isValidMesh(quads, points.size()))
+    {
+        return false;
+    }
+
+    std::vector<Point3Df> normals;
+    rm::MeshNormals(4).compute(quads, points, normals);
+
+    //Split each quad into two triangles, like QuadMesh3DItem does.
+    std::vector<unsigned int> triangles(quads.size() / 4 * 6);
+    for (size_t q = 0; q < quads.size() / 4; q++)
+    {
+        const unsigned int* v = &quads[4 * q];
+        unsigned int* t = &triangles[6 * q];
+        t[0] = v[0];
+        t[1] = v[1];
+        t[2] = v[3];
+        t[3] = v[2];
+        t[4] = v[3];
+        t[5] = v[1];
+    }
+
+    return writeMeshCache(cacheFilename, points, normals, triangles, quads);
+}
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <QFile>
+#include <QVector3D>
+using Point3Df = QVector3D;
+
+namespace loader
+{
+/**
+ * @brief The MeshCache class - Read only view of a binary mesh cache file. The file is memory mapped and its sections
+ * (points, normals, triangles and the optional source quads) are used directly, so they can be sent to OpenGL buffers
+ * without intermediate copies. The data is valid while the cache is open.
+ *
+ * File layout, in little endian: a fixed size header with the format version, the element counts, the mesh AABB and
+ * the offset of each section, followed by the sections aligned to 16 bytes.
+ */
+class MeshCache
+{
+public:
+    /**
+     * @brief MeshCache - Constructor. The cache starts closed.
+     */
+    MeshCache() = default;
+
+    /**
+     * @brief MeshCache - Copy is not allowed, since the cache owns the mapped file.
+     */
+    MeshCache(const MeshCache&) = delete;
+
+    /**
+     * @brief operator = - Copy is not allowed, since the cache owns the mapped file.
+     */
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    /**
+     * @brief ~MeshCache - Destructor. Unmaps the file.
+     */
+    ~MeshCache();
+
+    /**
+     * @brief open - Maps a cache file and validates its header and its indexes.
+     * @param filename - Name/Path of the cache file.
+     * @return - Returns true if the file is a valid cache of the current version and false otherwise.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief close - Unmaps the file. The pointers returned before become invalid.
+     */
+    void close();
+
+    /**
+     * @brief isOpen - Verifies if there is a valid cache mapped.
+     * @return - Returns true if the cache is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief getNumberOfPoints - Gets the number of points.
+     * @return - Returns the number of points.
+     */
+    unsigned int getNumberOfPoints() const;
+
+    /**
+     * @brief getNumberOfTriangles - Gets the number of triangles.
+     * @return - Returns the number of triangles.
+     */
+    unsigned int getNumberOfTriangles() const;
+
+    /**
+     * @brief getNumberOfQuads - Gets the number of source quads. It is zero if the mesh was not built from quads.
+     * @return - Returns the number of quads.
+     */
+    unsigned int getNumberOfQuads() const;
+
+    /**
+     * @brief getPoints - Gets the mesh points.
+     * @return - Returns a pointer to the mapped points.
+     */
+    const Point3Df* getPoints() const;
+
+    /**
+     * @brief getNormals - Gets the vertex normals.
+     * @return - Returns a pointer to the mapped normals.
+     */
+    const Point3Df* getNormals() const;
+
+    /**
+     * @brief getTriangles - Gets the triangle indexes, three per triangle.
+     * @return - Returns a pointer to the mapped indexes.
+     */
+    const unsigned int* getTriangles() const;
+
+    /**
+     * @brief getQuads - Gets the source quad indexes, four per quad. The quad q was split into the triangles 2q and
+     * 2q + 1.
+     * @return - Returns a pointer to the mapped indexes or nullptr if the mesh was not built from quads.
+     */
+    const unsigned int* getQuads() const;
+
+    /**
+     * @brief getMinCornerPoint - Gets the minimal corner of the mesh AABB.
+     * @return - Returns the minimal corner point.
+     */
+    const Point3Df& getMinCornerPoint() const;
+
+    /**
+     * @brief getMaxCornerPoint - Gets the maximal corner of the mesh AABB.
+     * @return - Returns the maximal corner point.
+     */
+    const Point3Df& getMaxCornerPoint() const;
+
+    /**
+     * @brief getVersion - Gets the cache format version written and accepted by this code.
+     * @return - Returns the format version.
+     */
+    constexpr static unsigned int getVersion() { return 1; }
+
+private:
+    /**
+     * @brief _file - Mapped cache file.
+     */
+    QFile _file;
+
+    /**
+     * @brief _data - First byte of the mapped file.
+     */
+    const uchar* _data {nullptr};
+
+    /**
+     * @brief _numPoints - Number of points.
+     */
+    unsigned int _numPoints {0};
+
+    /**
+     * @brief _numTriangles - Number of triangles.
+     */
+    unsigned int _numTriangles {0};
+
+    /**
+     * @brief _numQuads - Number of source quads.
+     */
+    unsigned int _numQuads {0};
+
+    /**
+     * @brief _points - Mapped points.
+     */
+    const Point3Df* _points {nullptr};
+
+    /**
+     * @brief _normals - Mapped normals.
+     */
+    const Point3Df* _normals {nullptr};
+
+    /**
+     * @brief _triangles - Mapped triangle indexes.
+     */
+    const unsigned int* _triangles {nullptr};
+
+    /**
+     * @brief _quads - Mapped quad indexes.
+     */
+    const unsigned int* _quads {nullptr};
+
+    /**
+     * @brief _minCornerPoint - Minimal corner of the mesh AABB.
+     */
+    Point3Df _minCornerPoint;
+
+    /**
+     * @brief _maxCornerPoint - Maximal corner of the mesh AABB.
+     */
+    Point3Df _maxCornerPoint;
+};
+
+/**
+ * @brief writeMeshCache - Writes a binary mesh cache. The file is replaced only if the whole cache was written.
+ * @param filename - Name/Path of the cache file.
+ * @param points - Mesh points.
+ * @param normals - Vertex normals, one per point.
+ * @param triangles - Triangle indexes.
+ * @param quads - Source quad indexes. It can be empty.
+ * @return - Returns true if the cache was written and false otherwise.
+ */
+bool writeMeshCache(const std::string& filename, const std::vector<Point3Df>& points,
+                    const std::vector<Point3Df>& normals, const std::vector<unsigned int>& triangles,
+                    const std::vector<unsigned int>& quads = std::vector<unsigned int>());
+
+/**
+ * @brief convertTriangle3DFileOFF - Reads an OFF 3D triangle mesh, computes its normals and writes a mesh cache.
+ * @param offFilename - Name/Path of the OFF file.
+ * @param cacheFilename - Name/Path of the cache file.
+ * @return - Returns true if the cache was written and false otherwise.
+ */
+bool convertTriangle3DFileOFF(const std::string& offFilename, const std::string& cacheFilename);
+
+/**
+ * @brief convertQuad3DFileOFF - Reads an OFF 3D quadrilateral mesh, computes its normals, splits each quad into two
+ * triangles and writes a mesh cache that keeps the source quads.
+ * @param offFilename - Name/Path of the OFF file.
+ * @param cacheFilename - Name/Path of the cache file.
+ * @return - Returns true if the cache was written and false otherwise.
+ */
+bool convertQuad3DFileOFF(const std::string& offFilename, const std::string& cacheFilename);
+}
@@ -0,0 +1,472 @@
+#include "MeshLevelOfDetail.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+/**
+ * @brief MINIMUM_TRIANGLES - Number of triangles below which no coarser level is built.
+ */
+const size_t MINIMUM_TRIANGLES = 64;
+
+/**
+ * @brief MAXIMUM_LEVELS - Maximal number of levels, counting the mesh itself.
+ */
+const unsigned int MAXIMUM_LEVELS = 8;
+
+/**
+ * @brief BORDER_WEIGHT - Weight of the planes that keep the border vertices on the border.
+ */
+const double BORDER_WEIGHT = 10.0;
+
+
+
+/**
+ * @brief The Quadric struct - Sum of squared distances to a set of weighted planes.
+ */
+struct Quadric
+{
+    double a2 {0}, ab {0}, ac {0}, ad {0}, b2 {0}, bc {0}, bd {0}, c2 {0}, cd {0}, d2 {0};
+    double weight {0};
+
+    void addPlane(const QVector3D& n, double d, double w)
+    {
+        a2 += w * n.x() * n.x(); ab += w * n.x() * n.y(); ac += w * n.x() * n.z(); ad += w * n.x() * d;
+        b2 += w * n.y() * n.y(); bc += w * n.y() * n.z(); bd += w * n.y() * d;
+        c2 += w * n.z() * n.z(); cd += w * n.z() * d;
+        d2 += w * d * d;
+        weight += w;
+    }
+
+    Quadric& operator+=(const Quadric& q)
+    {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd; d2 += q.d2;
+        weight += q.weight;
+        return *this;
+    }
+
+    double evaluate(const QVector3D& p) const
+    {
+        double x = p.x(), y = p.y(), z = p.z();
+        return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+             + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+             + c2 * z * z + 2 * cd * z
+             + d2;
+    }
+};
+
+
+
+/**
+ * @brief The Collapse struct - Move of a vertex onto a neighbour.
+ */
+struct Collapse
+{
+    float error;
+    unsigned int from;
+    unsigned int to;
+};
+
+
+
+/**
+ * @brief The Simplifier class - Collapses the edges of a triangle mesh, keeping the quadrics between calls, so each
+ * level is simplified from the previous one and its error is measured against the original mesh.
+ */
+class Simplifier
+{
+public:
+    Simplifier(const unsigned int* triangles, size_t numberOfIndexes, const QVector3D* points, size_t numberOfPoints)
+        : _points(points)
+        , _triangles(triangles, triangles + numberOfIndexes)
+        , _quadrics(numberOfPoints)
+    {
+        computeQuadrics();
+    }
+
+    /**
+     * @brief simplify - Collapses edges until the mesh has at most a number of triangles or no edge can be collapsed.
+     * Each pass collapses the cheapest edges whose neighbourhoods do not overlap, then rewrites the triangles.
+     */
+    void simplify(size_t targetTriangles)
+    {
+        size_t numberOfTriangles = _triangles.size() / 3;
+        while (numberOfTriangles > targetTriangles)
+        {
+            std::vector<Collapse> collapses;
+            findCollapses(collapses);
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+            {
+                return a.error < b.error;
+            });
+
+            buildAdjacency();
+
+            std::vector<unsigned int> remap(_quadrics.size());
+            std::iota(remap.begin(), remap.end(), 0u);
+            std::vector<char> isLocked(_quadrics.size(), 0);
+            size_t removed = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (numberOfTriangles - removed <= targetTriangles)
+                {
+                    break;
+                }
+
+                unsigned int sharedTriangles = 0;
+                if (isLocked[collapse.from] || isLocked[collapse.to] || !canCollapse(collapse, sharedTriangles))
+                {
+                    continue;
+                }
+
+                remap[collapse.from] = collapse.to;
+                _quadrics[collapse.to] += _quadrics[collapse.from];
+                _error = std::max(_error, collapse.error);
+                removed += sharedTriangles;
+
+                //The triangles around the collapsed vertex changed, so its neighbourhood waits for the next pass.
+                for (unsigned int i = _firstTriangle[collapse.from]; i < _firstTriangle[collapse.from + 1]; i++)
+                {
+                    const unsigned int* t = &_triangles[3 * _vertexTriangles[i]];
+                    isLocked[t[0]] = isLocked[t[1]] = isLocked[t[2]] = 1;
+                }
+            }
+
+            if (removed == 0)
+            {
+                return;
+            }
+
+            //Rewrite the triangles, removing the ones that lost an edge.
+            size_t last = 0;
+            for (size_t i = 0; i < _triangles.size(); i += 3)
+            {
+                unsigned int a = remap[_triangles[i]];
+                unsigned int b = remap[_triangles[i + 1]];
+                unsigned int c = remap[_triangles[i + 2]];
+                if (a != b && b != c && c != a)
+                {
+                    _triangles[last++] = a;
+                    _triangles[last++] = b;
+                    _triangles[last++] = c;
+                }
+            }
+            _triangles.resize(last);
+            numberOfTriangles = _triangles.size() / 3;
+        }
+    }
+
+    const std::vector<unsigned int>& getTriangles() const
+    {
+        return _triangles;
+    }
+
+    float getError() const
+    {
+        return _error;
+    }
+
+private:
+    /**
+     * @brief computeQuadrics - Adds the triangle planes, weighted by area, to their vertices, and the planes
+     * perpendicular to the border edges to the border vertices.
+     */
+    void computeQuadrics()
+    {
+        for (size_t i = 0; i < _triangles.size(); i += 3)
+        {
+            QVector3D n = triangleNormal(&_triangles[i]);
+            float length = n.length();
+            if (length > 0.0f)
+            {
+                n /= length;
+                double d = -QVector3D::dotProduct(n, _points[_triangles[i]]);
+                for (int k = 0; k < 3; k++)
+                {
+                    _quadrics[_triangles[i + k]].addPlane(n, d, 0.5 * length);
+                }
+            }
+        }
+
+        std::vector<Edge> edges;
+        collectEdges(edges);
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b)
+            {
+                j++;
+            }
+
+            if (j - i == 1)
+            {
+                const QVector3D& a = _points[edges[i].a];
+                const QVector3D& b = _points[edges[i].b];
+                QVector3D n = QVector3D::crossProduct(b - a, triangleNormal(&_triangles[3 * edges[i].triangle]));
+                float length = n.length();
+                if (length > 0.0f)
+                {
+                    n /= length;
+                    double d = -QVector3D::dotProduct(n, a);
+                    double w = BORDER_WEIGHT * (b - a).lengthSquared();
+                    _quadrics[edges[i].a].addPlane(n, d, w);
+                    _quadrics[edges[i].b].addPlane(n, d, w);
+                }
+            }
+            i = j;
+        }
+    }
+
+    /**
+     * @brief findCollapses - Finds the cheapest direction of each edge. Edges used by other than two triangles are
+     * borders, and a vertex on a border can only move along a border edge.
+     */
+    void findCollapses(std::vector<Collapse>& collapses) const
+    {
+        std::vector<Edge> edges;
+        collectEdges(edges);
+
+        std::vector<std::pair<Edge, bool>> uniqueEdges;
+        std::vector<char> isBorderVertex(_quadrics.size(), 0);
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b)
+            {
+                j++;
+            }
+
+            bool isBorder = j - i != 2;
+            if (isBorder)
+            {
+                isBorderVertex[edges[i].a] = isBorderVertex[edges[i].b] = 1;
+            }
+            uniqueEdges.push_back(std::make_pair(edges[i], isBorder));
+            i = j;
+        }
+
+        collapses.reserve(uniqueEdges.size());
+        for (const auto& edge : uniqueEdges)
+        {
+            unsigned int a = edge.first.a, b = edge.first.b;
+            bool canMoveA = !isBorderVertex[a] || edge.second;
+            bool canMoveB = !isBorderVertex[b] || edge.second;
+            if (!canMoveA && !canMoveB)
+            {
+                continue;
+            }
+
+            Quadric q = _quadrics[a];
+            q += _quadrics[b];
+            float errorA = canMoveA ? computeError(q, _points[b]) : std::numeric_limits<float>::max();
+            float errorB = canMoveB ? computeError(q, _points[a]) : std::numeric_limits<float>::max();
+            if (errorA <= errorB)
+            {
+                collapses.push_back({errorA, a, b});
+            }
+            else
+            {
+                collapses.push_back({errorB, b, a});
+            }
+        }
+    }
+
+    /**
+     * @brief canCollapse - Verifies that no triangle around the moved vertex is flipped by the collapse.
+     */
+    bool canCollapse(const Collapse& collapse, unsigned int& sharedTriangles) const
+    {
+        const QVector3D& target = _points[collapse.to];
+        for (unsigned int i = _firstTriangle[collapse.from]; i < _firstTriangle[collapse.from + 1]; i++)
+        {
+            const unsigned int* t = &_triangles[3 * _vertexTriangles[i]];
+            if (t[0] == collapse.to || t[1] == collapse.to || t[2] == collapse.to)
+            {
+                sharedTriangles++;
+                continue;
+            }
+
+            QVector3D p[3];
+            for (int k = 0; k < 3; k++)
+            {
+                p[k] = t[k] == collapse.from ? target : _points[t[k]];
+            }
+            QVector3D before = triangleNormal(t);
+            QVector3D after = QVector3D::crossProduct(p[1] - p[0], p[2] - p[0]);
+            if (QVector3D::dotProduct(before, after) <= 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief buildAdjacency - Builds the triangles of each vertex on a compressed array (CSR).
+     */
+    void buildAdjacency()
+    {
+        _firstTriangle.assign(_quadrics.size() + 1, 0);
+        for (unsigned int v : _triangles)
+        {
+            _firstTriangle[v + 1]++;
+        }
+        std::partial_sum(_firstTriangle.begin(), _firstTriangle.end(), _firstTriangle.begin());
+
+        std::vector<unsigned int> position(_firstTriangle.begin(), _firstTriangle.end() - 1);
+        _vertexTriangles.resize(_triangles.size());
+        for (size_t i = 0; i < _triangles.size(); i++)
+        {
+            _vertexTriangles[position[_triangles[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+    }
+
+    struct Edge
+    {
+        unsigned int a;
+        unsigned int b;
+        unsigned int triangle;
+    };
+
+    /**
+     * @brief collectEdges - Lists the edges of all triangles with the smaller vertex first, sorted by vertices.
+     */
+    void collectEdges(std::vector<Edge>& edges) const
+    {
+        edges.reserve(_triangles.size());
+        for (size_t i = 0; i < _triangles.size(); i += 3)
+        {
+            unsigned int triangle = static_cast<unsigned int>(i / 3);
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int a = _triangles[i + k];
+                unsigned int b = _triangles[i + (k + 1) % 3];
+                edges.push_back({std::min(a, b), std::max(a, b), triangle});
+            }
+        }
+        std::sort(edges.begin(), edges.end(), [](const Edge& e, const Edge& f)
+        {
+            return e.a < f.a || (e.a == f.a && e.b < f.b);
+        });
+    }
+
+    QVector3D triangleNormal(const unsigned int* t) const
+    {
+        return QVector3D::crossProduct(_points[t[1]] - _points[t[0]], _points[t[2]] - _points[t[0]]);
+    }
+
+    /**
+     * @brief computeError - Gives the root mean square distance to the planes of a quadric.
+     */
+    static float computeError(const Quadric& q, const QVector3D& p)
+    {
+        if (q.weight <= 0.0)
+        {
+            return 0.0f;
+        }
+        return static_cast<float>(std::sqrt(std::max(0.0, q.evaluate(p) / q.weight)));
+    }
+
+private:
+    const QVector3D* _points;
+    std::vector<unsigned int> _triangles;
+    std::vector<Quadric> _quadrics;
+    std::vector<unsigned int> _firstTriangle;
+    std::vector<unsigned int> _vertexTriangles;
+    float _error {0.0f};
+};
+}
+
+namespace rm
+{
+void MeshLevelOfDetail::build(const unsigned int* triangles, size_t numberOfIndexes, const QVector3D* points,
+                              size_t numberOfPoints)
+{
+    clear();
+
+    size_t previousTriangles = numberOfIndexes / 3;
+    if (previousTriangles < 2 * MINIMUM_TRIANGLES)
+    {
+        return;
+    }
+
+    Simplifier simplifier(triangles, 3 * previousTriangles, points, numberOfPoints);
+
+    Level mesh;
+    mesh.count = static_cast<unsigned int>(3 * previousTriangles);
+    _levels.push_back(mesh);
+
+    while (_levels.size() < MAXIMUM_LEVELS && previousTriangles / 2 >= MINIMUM_TRIANGLES)
+    {
+        simplifier.simplify(previousTriangles / 2);
+
+        //Stop when the collapses are blocked and the level would be almost the previous one.
+        const std::vector<unsigned int>& simplified = simplifier.getTriangles();
+        size_t numberOfTriangles = simplified.size() / 3;
+        if (4 * numberOfTriangles > 3 * previousTriangles)
+        {
+            break;
+        }
+
+        Level level;
+        level.error = simplifier.getError();
+        level.first = static_cast<unsigned int>(numberOfIndexes + _indexes.size());
+        level.count = static_cast<unsigned int>(simplified.size());
+        _indexes.insert(_indexes.end(), simplified.begin(), simplified.end());
+        _levels.push_back(level);
+        previousTriangles = numberOfTriangles;
+    }
+
+    if (_levels.size() == 1)
+    {
+        _levels.clear();
+    }
+}
+
+
+
+void MeshLevelOfDetail::clear()
+{
+    _levels.clear();
+    _indexes.clear();
+}
+
+
+
+const std::vector<MeshLevelOfDetail::Level>& MeshLevelOfDetail::getLevels() const
+{
+    return _levels;
+}
+
+
+
+const std::vector<unsigned int>& MeshLevelOfDetail::getIndexes() const
+{
+    return _indexes;
+}
+
+
+
+int MeshLevelOfDetail::selectLevel(float pixelsPerUnit, int currentLevel) const
+{
+    if (_levels.empty())
+    {
+        return 0;
+    }
+
+    int numberOfLevels = static_cast<int>(_levels.size());
+    int level = std::max(0, std::min(currentLevel, numberOfLevels - 1));
+    while (level > 0 && _levels[level].error * pixelsPerUnit > 1.0f)
+    {
+        level--;
+    }
+    while (level + 1 < numberOfLevels && _levels[level + 1].error * pixelsPerUnit < 0.5f)
+    {
+        level++;
+    }
+    return level;
+}
+}
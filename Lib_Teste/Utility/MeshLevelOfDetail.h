@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <QVector3D>
+
+namespace rm
+{
+/**
+ * @brief The MeshLevelOfDetail class - Chain of simplified versions of a triangle mesh. The triangles are simplified
+ * by quadric error edge collapses, where a vertex is always collapsed onto one of its neighbours, so all levels use
+ * the mesh points and just need other triangle indexes. The indexes of the coarse levels are meant to be stored after
+ * the mesh indexes on the same element buffer.
+ *
+ * Each level has about half of the triangles of the previous one. Vertices on the mesh borders only collapse along
+ * the borders, so open meshes keep their outline.
+ */
+class MeshLevelOfDetail
+{
+public:
+    /**
+     * @brief The Level struct - Range of a level on the element buffer.
+     */
+    struct Level
+    {
+        /**
+         * @brief error - Estimated distance from the level surface to the mesh, in model coordinates.
+         */
+        float error {0.0f};
+
+        /**
+         * @brief first - Position of the first index of the level, counting the mesh indexes.
+         */
+        unsigned int first {0};
+
+        /**
+         * @brief count - Number of indexes of the level.
+         */
+        unsigned int count {0};
+    };
+
+public:
+    /**
+     * @brief build - Simplifies a triangle mesh. Previous levels are discarded.
+     * @param triangles - Three point indexes per triangle.
+     * @param numberOfIndexes - Number of triangle indexes.
+     * @param points - Mesh points.
+     * @param numberOfPoints - Number of points.
+     */
+    void build(const unsigned int* triangles, size_t numberOfIndexes, const QVector3D* points, size_t numberOfPoints);
+
+    /**
+     * @brief clear - Removes all levels.
+     */
+    void clear();
+
+    /**
+     * @brief getLevels - Gets the levels, from the mesh itself to the coarsest one. It is empty if build was not
+     * called or the mesh could not be simplified.
+     * @return - Returns the levels.
+     */
+    const std::vector<Level>& getLevels() const;
+
+    /**
+     * @brief getIndexes - Gets the triangle indexes of the simplified levels, one level after another.
+     * @return - Returns the indexes.
+     */
+    const std::vector<unsigned int>& getIndexes() const;
+
+    /**
+     * @brief selectLevel - Chooses the coarsest level whose error is below a pixel. The level is made coarser only
+     * when the error of the next level is below half a pixel, so a mesh near the limit does not change its level on
+     * each frame.
+     * @param pixelsPerUnit - Size on screen, in pixels, of a model unit.
+     * @param currentLevel - Level used on the previous frame.
+     * @return - Returns the level to be drawn.
+     */
+    int selectLevel(float pixelsPerUnit, int currentLevel) const;
+
+private:
+    /**
+     * @brief _levels - Levels, from the mesh itself to the coarsest one.
+     */
+    std::vector<Level> _levels;
+
+    /**
+     * @brief _indexes - Triangle indexes of the simplified levels.
+     */
+    std::vector<unsigned int> _indexes;
+};
+}
@@ -0,0 +1,196 @@
+#include "MeshNormals.h"
+#include "ParallelFor.h"
+
+namespace rm
+{
+MeshNormals::MeshNormals(unsigned int verticesPerFace) :
+    _verticesPerFace(verticesPerFace)
+{
+}
+
+
+
+void MeshNormals::compute(const std::vector<unsigned int>& elements, const std::vector<QVector3D>& points,
+                          std::vector<QVector3D>& normals)
+{
+    if (!isValid(elements.size(), points.size()))
+    {
+        buildAdjacency(elements, points.size());
+    }
+
+    //Compute the face normals and then gather them on the vertices.
+    size_t numFaces = elements.size() / _verticesPerFace;
+    parallelFor(numFaces, getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        computeFaceNormals(elements.data(), points.data(), nullptr, begin, end);
+    });
+
+    normals.resize(points.size());
+    parallelFor(points.size(), getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        gatherVertexNormals(normals.data(), nullptr, begin, end);
+    });
+}
+
+
+
+void MeshNormals::update(const std::vector<unsigned int>& elements, const std::vector<QVector3D>& points,
+                         std::vector<QVector3D>& normals, const std::vector<unsigned int>& changedPoints,
+                         std::vector<unsigned int>& changedNormals)
+{
+    changedNormals.clear();
+    if (!isValid(elements.size(), points.size()) || normals.size() != points.size())
+    {
+        //There is nothing to update, so compute everything.
+        compute(elements, points, normals);
+        changedNormals.resize(points.size());
+        for (unsigned int i = 0; i < changedNormals.size(); i++)
+        {
+            changedNormals[i] = i;
+        }
+        return;
+    }
+
+    //Collect the faces of the changed points.
+    std::vector<unsigned int> faces;
+    for (unsigned int v : changedPoints)
+    {
+        for (unsigned int i = _firstFace[v]; i < _firstFace[v + 1]; i++)
+        {
+            if (!_faceMarks[_faces[i]])
+            {
+                _faceMarks[_faces[i]] = true;
+                faces.push_back(_faces[i]);
+            }
+        }
+    }
+
+    //Collect the vertices of these faces.
+    for (unsigned int f : faces)
+    {
+        _faceMarks[f] = false;
+        for (unsigned int c = 0; c < _verticesPerFace; c++)
+        {
+            unsigned int v = elements[_verticesPerFace * f + c];
+            if (!_vertexMarks[v])
+            {
+                _vertexMarks[v] = true;
+                changedNormals.push_back(v);
+            }
+        }
+    }
+
+    for (unsigned int v : changedNormals)
+    {
+        _vertexMarks[v] = false;
+    }
+
+    parallelFor(faces.size(), getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        computeFaceNormals(elements.data(), points.data(), faces.data(), begin, end);
+    });
+
+    parallelFor(changedNormals.size(), getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        gatherVertexNormals(normals.data(), changedNormals.data(), begin, end);
+    });
+}
+
+
+
+void MeshNormals::invalidate()
+{
+    _numElements = 0;
+    _firstFace.clear();
+    _faces.clear();
+    _faceNormals.clear();
+    _faceMarks.clear();
+    _vertexMarks.clear();
+}
+
+
+
+bool MeshNormals::isValid(size_t numElements, size_t numPoints) const
+{
+    return !_firstFace.empty() && _numElements == numElements && _firstFace.size() == numPoints + 1;
+}
+
+
+
+void MeshNormals::buildAdjacency(const std::vector<unsigned int>& elements, size_t numPoints)
+{
+    size_t numFaces = elements.size() / _verticesPerFace;
+    _numElements = elements.size();
+
+    //Count the faces of each vertex and turn the counters into offsets.
+    _firstFace.assign(numPoints + 1, 0);
+    for (size_t i = 0; i < _verticesPerFace * numFaces; i++)
+    {
+        _firstFace[elements[i] + 1]++;
+    }
+
+    for (size_t v = 0; v < numPoints; v++)
+    {
+        _firstFace[v + 1] += _firstFace[v];
+    }
+
+    //Fill the faces in increasing order, so the sums are done in the same order of a sequential scatter.
+    std::vector<unsigned int> next(_firstFace.begin(), _firstFace.end() - 1);
+    _faces.resize(_firstFace[numPoints]);
+    for (size_t f = 0; f < numFaces; f++)
+    {
+        for (unsigned int c = 0; c < _verticesPerFace; c++)
+        {
+            _faces[next[elements[_verticesPerFace * f + c]]++] = static_cast<unsigned int>(f);
+        }
+    }
+
+    _faceNormals.resize(numFaces);
+    _faceMarks.assign(numFaces, false);
+    _vertexMarks.assign(numPoints, false);
+}
+
+
+
+void MeshNormals::computeFaceNormals(const unsigned int* elements, const QVector3D* points, const unsigned int* faces,
+                                     size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        size_t f = faces != nullptr ? faces[i] : i;
+        const unsigned int* v = elements + _verticesPerFace * f;
+        const QVector3D& p0 = points[v[0]];
+        const QVector3D& p1 = points[v[1]];
+        const QVector3D& p2 = points[v[2]];
+
+        if (_verticesPerFace == 3)
+        {
+            _faceNormals[f] = QVector3D::crossProduct(p1 - p0, p2 - p0);
+        }
+        else
+        {
+            //Average of the normals of the two triangles of the quadrilateral.
+            const QVector3D& p3 = points[v[3]];
+            QVector3D n1 = QVector3D::crossProduct(p1 - p0, p3 - p0);
+            QVector3D n2 = QVector3D::crossProduct(p3 - p1, p1 - p2);
+            _faceNormals[f] = (n1 + n2) / 2;
+        }
+    }
+}
+
+
+
+void MeshNormals::gatherVertexNormals(QVector3D* normals, const unsigned int* vertices, size_t begin, size_t end) const
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        size_t v = vertices != nullptr ? vertices[i] : i;
+        QVector3D n(0, 0, 0);
+        for (unsigned int j = _firstFace[v]; j < _firstFace[v + 1]; j++)
+        {
+            n += _faceNormals[_faces[j]];
+        }
+        normals[v] = n.normalized();
+    }
+}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+#include <QVector3D>
+
+namespace rm
+{
+/**
+ * @brief The MeshNormals class - Computes the vertex normals of triangle or quadrilateral meshes. Each vertex normal
+ * is the normalized sum of the normals of its faces. The faces of each vertex are stored on a compressed adjacency
+ * (CSR), so the vertex normals are gathered in parallel without write conflicts. The faces are summed in increasing
+ * order, which gives the same result as the sequential scatter loop.
+ *
+ * The adjacency is built on the first computation and kept for the incremental updates. It is rebuilt when the number
+ * of points or elements changes; other topology changes must call invalidate().
+ */
+class MeshNormals
+{
+public:
+    /**
+     * @brief MeshNormals - Constructor.
+     * @param verticesPerFace - Number of vertices of each face: 3 for triangles and 4 for quadrilaterals.
+     */
+    explicit MeshNormals(unsigned int verticesPerFace);
+
+    /**
+     * @brief compute - Computes the normals of all vertices.
+     * @param elements - Face indexes.
+     * @param points - Mesh points.
+     * @param normals - Computed normals, one per point.
+     */
+    void compute(const std::vector<unsigned int>& elements, const std::vector<QVector3D>& points,
+                 std::vector<QVector3D>& normals);
+
+    /**
+     * @brief update - Recomputes only the normals of the vertices that share a face with a changed point.
+     * @param elements - Face indexes.
+     * @param points - Mesh points, already changed.
+     * @param normals - Normals computed by compute(). The affected normals are replaced.
+     * @param changedPoints - Indexes of the changed points.
+     * @param changedNormals - Receives the indexes of the normals that were recomputed.
+     */
+    void update(const std::vector<unsigned int>& elements, const std::vector<QVector3D>& points,
+                std::vector<QVector3D>& normals, const std::vector<unsigned int>& changedPoints,
+                std::vector<unsigned int>& changedNormals);
+
+    /**
+     * @brief invalidate - Discards the adjacency. It must be called when the faces change.
+     */
+    void invalidate();
+
+private:
+    /**
+     * @brief isValid - Verifies if the adjacency was built for a mesh of the given sizes.
+     * @param numElements - Number of face indexes.
+     * @param numPoints - Number of points.
+     * @return - Returns true if the adjacency can be used.
+     */
+    bool isValid(size_t numElements, size_t numPoints) const;
+
+    /**
+     * @brief buildAdjacency - Builds the faces of each vertex.
+     * @param elements - Face indexes.
+     * @param numPoints - Number of points.
+     */
+    void buildAdjacency(const std::vector<unsigned int>& elements, size_t numPoints);
+
+    /**
+     * @brief computeFaceNormals - Computes the normals of a range of faces.
+     * @param elements - Face indexes.
+     * @param points - Mesh points.
+     * @param faces - Faces to be computed, or nullptr to compute the faces [begin, end).
+     * @param begin - First position of the range.
+     * @param end - Position after the last one of the range.
+     */
+    void computeFaceNormals(const unsigned int* elements, const QVector3D* points, const unsigned int* faces,
+                            size_t begin, size_t end);
+
+    /**
+     * @brief gatherVertexNormals - Sums and normalizes the face normals of a range of vertices.
+     * @param normals - Mesh normals.
+     * @param vertices - Vertices to be computed, or nullptr to compute the vertices [begin, end).
+     * @param begin - First position of the range.
+     * @param end - Position after the last one of the range.
+     */
+    void gatherVertexNormals(QVector3D* normals, const unsigned int* vertices, size_t begin, size_t end) const;
+
+    /**
+     * @brief getMinCountPerThread - Gets the minimum number of faces or vertices given to a thread.
+     * @return - Returns the minimum count.
+     */
+    constexpr static size_t getMinCountPerThread() { return 16384; }
+
+private:
+    /**
+     * @brief _verticesPerFace - Number of vertices of each face.
+     */
+    unsigned int _verticesPerFace;
+
+    /**
+     * @brief _numElements - Number of face indexes used to build the adjacency.
+     */
+    size_t _numElements {0};
+
+    /**
+     * @brief _firstFace - Position on _faces of the first face of each vertex. It has one more entry than points.
+     */
+    std::vector<unsigned int> _firstFace;
+
+    /**
+     * @brief _faces - Faces of each vertex, in increasing order.
+     */
+    std::vector<unsigned int> _faces;
+
+    /**
+     * @brief _faceNormals - Not normalized normal of each face.
+     */
+    std::vector<QVector3D> _faceNormals;
+
+    /**
+     * @brief _faceMarks - Marks the faces already collected by update(). Always cleared after use.
+     */
+    std::vector<bool> _faceMarks;
+
+    /**
+     * @brief _vertexMarks - Marks the vertices already collected by update(). Always cleared after use.
+     */
+    std::vector<bool> _vertexMarks;
+};
+}
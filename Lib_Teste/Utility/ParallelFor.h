@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace rm
+{
+/**
+ * @brief parallelFor - Splits the range [0, count) into contiguous blocks and runs a function on each block, one
+ * block per hardware thread. Small ranges are run on the calling thread.
+ * @param count - Number of elements.
+ * @param minCountPerThread - Minimum number of elements given to a thread.
+ * @param function - Function called as function(begin, end) for each block. It must be safe to call it concurrently
+ * on disjoint blocks.
+ */
+template<class Function>
+void parallelFor(size_t count, size_t minCountPerThread, const Function& function)
+{
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::max<size_t>(1, std::min(numThreads, count / std::max<size_t>(1, minCountPerThread)));
+    if (numThreads == 1)
+    {
+        function(static_cast<size_t>(0), count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    size_t blockSize = (count + numThreads - 1) / numThreads;
+    for (size_t begin = blockSize; begin < count; begin += blockSize)
+    {
+        threads.emplace_back(function, begin, std::min(begin + blockSize, count));
+    }
+
+    //The calling thread runs the first block.
+    function(static_cast<size_t>(0), std::min(blockSize, count));
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+}
@@ -1,309 +1,600 @@
 #include "ReaderOFF.h"
+#include <QFile>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <thread>
 
 namespace loader
 {
-void readFileOFF(const std::string& filename, std::vector<Point3Df>& points,
-                 std::vector<std::vector<unsigned int>>& polygons)
+namespace
 {
-    std::ifstream ifile;
-    ifile.open(filename);
-
-    if (!ifile.is_open())
+/**
+ * @brief getMinChunkSize - Minimum number of bytes parsed by a thread. Small files are parsed by a single thread.
+ * @return - Returns the minimum chunk size in bytes.
+ */
+constexpr size_t getMinChunkSize() { return 1 << 20; }
+
+/**
+ * @brief The OFFFile struct - Memory mapped OFF file and its header.
+ */
+struct OFFFile
+{
+    /**
+     * @brief file - Opened file. The mapped memory is valid while it is open.
+     */
+    QFile file;
+
+    /**
+     * @brief contents - Used when the file could not be mapped.
+     */
+    QByteArray contents;
+
+    /**
+     * @brief body - First byte after the header counts.
+     */
+    const char* body {nullptr};
+
+    /**
+     * @brief end - One past the last byte of the file.
+     */
+    const char* end {nullptr};
+
+    /**
+     * @brief numPoints - Number of points on header.
+     */
+    unsigned int numPoints {0};
+
+    /**
+     * @brief numFaces - Number of faces on header.
+     */
+    unsigned int numFaces {0};
+};
+
+
+
+/**
+ * @brief skipSpaces - Skips white spaces and comments.
+ * @param p - Current position. It is moved to the next token or to end.
+ * @param end - End of the parsed range.
+ */
+inline void skipSpaces(const char*& p, const char* end)
+{
+    while (p < end)
     {
-        std::cout << "Could not open " << std::endl;
-        perror(filename.c_str());
-        return;
+        if (*p == '#')
+        {
+            //Comments go to the end of the line.
+            while (p < end && *p != '\n')
+            {
+                p++;
+            }
+        }
+        else if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        {
+            p++;
+        }
+        else
+        {
+            return;
+        }
     }
+}
 
-    char OFF[100];
-    unsigned int numPoints;
-    unsigned int numPolygons;
-    unsigned int numFaces;
 
-    ifile >> OFF; //discarding the first line of the file .off
-    ifile >> numPoints;
-    ifile >> numPolygons;
-    ifile >> numFaces;
 
-    points.resize(numPoints);
-    polygons.resize(numPolygons);
+/**
+ * @brief parseUnsigned - Parses an unsigned integer token.
+ * @param p - Current position. It is moved after the token.
+ * @param end - End of the parsed range.
+ * @param value - Parsed value.
+ * @return - Returns true if a number was parsed and false otherwise.
+ */
+inline bool parseUnsigned(const char*& p, const char* end, unsigned int& value)
+{
+    skipSpaces(p, end);
 
-    //reading the points
-    for (unsigned int i = 0; i < numPoints; i++)
+    const char* first = p;
+    unsigned int v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
     {
-        float x, y, z;
-
-        ifile >> x;
-        ifile >> y;
-        ifile >> z;
-
-        QVector3D point;
-        point.setX(x);
-        point.setY(y);
-        point.setZ(z);
-
-        points[i] = point;
+        v = 10 * v + static_cast<unsigned int>(*p - '0');
+        p++;
     }
 
-    //reading the polygons
-    for (unsigned int i = 0; i < numPolygons; i++)
-    {
-        unsigned int numOfPoints; //how many points the polygon have
+    value = v;
+    return p != first;
+}
 
-        ifile >> numOfPoints;
 
-        std::vector<unsigned int> pointID;
-        pointID.resize(numOfPoints);
 
-        //reading the point IDs
-        for (unsigned int j = 0; j < numOfPoints; j++)
+/**
+ * @brief matchWord - Verifies, ignoring the case, if a word starts at a position.
+ * @param p - Current position. It is moved after the word if it matches.
+ * @param end - End of the parsed range.
+ * @param word - Lower case word.
+ * @return - Returns true if the word matches and false otherwise.
+ */
+inline bool matchWord(const char*& p, const char* end, const char* word)
+{
+    const char* q = p;
+    for (; *word != '\0'; word++, q++)
+    {
+        if (q >= end || (*q | 0x20) != *word)
         {
-            ifile >> pointID[j];
+            return false;
         }
-
-        polygons[i] = pointID;
     }
-
-    ifile.close();
+    p = q;
+    return true;
 }
 
 
 
-void readTriangle3DFileOFF(const std::string& filename, std::vector<Point3Df>& points,
-                           std::vector<unsigned int>& triangles)
+/**
+ * @brief parseFloat - Parses a floating point token, with optional sign, fraction and exponent. The inf, infinity
+ * and nan tokens are also accepted, as the formatted stream reads did.
+ * @param p - Current position. It is moved after the token.
+ * @param end - End of the parsed range.
+ * @param value - Parsed value.
+ * @return - Returns true if a number was parsed and false otherwise.
+ */
+inline bool parseFloat(const char*& p, const char* end, float& value)
 {
-    std::ifstream ifile;
-    ifile.open(filename);
+    //Powers of ten that are exactly represented on a double.
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
 
-    if (!ifile.is_open())
+    skipSpaces(p, end);
+
+    const char* first = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
     {
-        std::cout << "Could not open " << std::endl;
-        perror(filename.c_str());
-        return;
+        negative = *p == '-';
+        p++;
     }
 
-    char OFF[100];
-    unsigned int numPoints;
-    unsigned int numTriangles;
-    unsigned int numFaces;
+    //Non finite values.
+    if (matchWord(p, end, "inf"))
+    {
+        matchWord(p, end, "inity");
+        value = negative ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+        return true;
+    }
+    if (matchWord(p, end, "nan"))
+    {
+        //An optional payload, as nan(0x1), is ignored.
+        if (p < end && *p == '(')
+        {
+            while (p < end && *p != ')' && *p != '\n')
+            {
+                p++;
+            }
+            p += p < end && *p == ')' ? 1 : 0;
+        }
+        value = std::numeric_limits<float>::quiet_NaN();
+        return true;
+    }
 
-    ifile >> OFF; //discarding the first line of the file .off
-    ifile >> numPoints;
-    ifile >> numTriangles;
-    ifile >> numFaces;
+    //Accumulate up to 19 significant digits on an integer, so the value is rounded just once.
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        if (digits < 19)
+        {
+            mantissa = 10 * mantissa + static_cast<uint64_t>(*p - '0');
+            digits += mantissa > 0 ? 1 : 0;
+        }
+        else
+        {
+            exponent++;
+        }
+        hasDigits = true;
+        p++;
+    }
 
-    points.resize(numPoints);
-    triangles.resize(3 * numTriangles);
+    if (p < end && *p == '.')
+    {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            if (digits < 19)
+            {
+                mantissa = 10 * mantissa + static_cast<uint64_t>(*p - '0');
+                digits += mantissa > 0 ? 1 : 0;
+                exponent--;
+            }
+            hasDigits = true;
+            p++;
+        }
+    }
 
-    //reading the points
-    for (unsigned int i = 0; i < numPoints; i++)
+    if (!hasDigits)
     {
-        float x, y, z;
+        p = first;
+        return false;
+    }
 
-        ifile >> x;
-        ifile >> y;
-        ifile >> z;
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = *q == '-';
+            q++;
+        }
 
-        QVector3D point;
-        point.setX(x);
-        point.setY(y);
-        point.setZ(z);
+        int e = 0;
+        bool hasExponent = false;
+        while (q < end && *q >= '0' && *q <= '9')
+        {
+            e = std::min(10 * e + (*q - '0'), 1000);
+            hasExponent = true;
+            q++;
+        }
 
-        points[i] = point;
+        //A lonely 'e' is not part of the number.
+        if (hasExponent)
+        {
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
     }
 
-    //reading the polygons
-    for (unsigned int i = 0; i < numTriangles; i++)
+    double v = static_cast<double>(mantissa);
+    while (exponent > 22)
+    {
+        v *= 1e22;
+        exponent -= 22;
+    }
+    while (exponent < -22)
     {
-        unsigned int numOfPoints; //how many points the polygon have
+        v /= 1e22;
+        exponent += 22;
+    }
+    v = exponent >= 0 ? v * powers[exponent] : v / powers[-exponent];
+
+    value = static_cast<float>(negative ? -v : v);
+    return true;
+}
 
-        ifile >> numOfPoints;
 
-        ifile >> triangles[3 * i + 0];
-        ifile >> triangles[3 * i + 1];
-        ifile >> triangles[3 * i + 2];
-    }
 
-    ifile.close();
+/**
+ * @brief isRecordLine - Verifies if a line has a vertex or a face, that is, it is not empty or a comment.
+ * @param p - Line begin.
+ * @param end - Line end.
+ * @return - Returns true if the line has a record.
+ */
+inline bool isRecordLine(const char* p, const char* end)
+{
+    skipSpaces(p, end);
+    return p < end;
 }
 
 
 
-void readTriangle2DFileOFF(const std::string& filename, std::vector<Point2Df>& points,
-                           std::vector<unsigned int>& triangles)
+/**
+ * @brief nextLine - Finds the begin of the next line.
+ * @param p - Any position of the current line.
+ * @param end - End of file.
+ * @return - Returns the next line begin or end.
+ */
+inline const char* nextLine(const char* p, const char* end)
 {
-    std::ifstream ifile;
-    ifile.open(filename);
+    const char* newLine = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    return newLine != nullptr ? newLine + 1 : end;
+}
+
+
 
-    if (!ifile.is_open())
+/**
+ * @brief openOFF - Maps an OFF file and reads its header.
+ * @param filename - Name/Path of the file.
+ * @param off - Mapped file.
+ * @return - Returns true if the file was opened and false otherwise.
+ */
+bool openOFF(const std::string& filename, OFFFile& off)
+{
+    off.file.setFileName(QString::fromStdString(filename));
+    if (!off.file.open(QIODevice::ReadOnly))
     {
         std::cout << "Could not open " << std::endl;
         perror(filename.c_str());
-        return;
+        return false;
     }
 
-    char OFF[100];
-    unsigned int numPoints;
-    unsigned int numTriangles;
-    unsigned int numFaces;
-
-    ifile >> OFF; //discarding the first line of the file .off
-    ifile >> numPoints;
-    ifile >> numTriangles;
-    ifile >> numFaces;
+    //Empty files can not be mapped.
+    const char* begin = nullptr;
+    qint64 size = off.file.size();
+    uchar* memory = size > 0 ? off.file.map(0, size) : nullptr;
+    if (memory != nullptr)
+    {
+        begin = reinterpret_cast<const char*>(memory);
+    }
+    else
+    {
+        off.contents = off.file.readAll();
+        begin = off.contents.constData();
+        size = off.contents.size();
+    }
+    off.end = begin + size;
 
-    points.resize(numPoints);
-    triangles.resize(3 * numTriangles);
+    //Discard the OFF keyword.
+    const char* p = begin;
+    skipSpaces(p, off.end);
+    while (p < off.end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+    {
+        p++;
+    }
 
-    //reading the points
-    for (unsigned int i = 0; i < numPoints; i++)
+    unsigned int numEdges = 0;
+    if (!parseUnsigned(p, off.end, off.numPoints) || !parseUnsigned(p, off.end, off.numFaces) ||
+        !parseUnsigned(p, off.end, numEdges))
     {
-        float x, y, z;
+        std::cout << "Invalid OFF header on " << filename << std::endl;
+        return false;
+    }
 
-        ifile >> x;
-        ifile >> y;
-        ifile >> z;
+    //The rest of the header line is blank, unless the records follow the counts on the same line.
+    off.body = p;
+    return true;
+}
 
-        Point2Df point;
-        point[0] = x;
-        point[1] = y;
 
-        points[i] = point;
-    }
 
-    //reading the polygons
-    for (unsigned int i = 0; i < numTriangles; i++)
+/**
+ * @brief parseRecord - Parses a vertex or a face record.
+ * @param p - Record begin. It is moved after the record.
+ * @param end - End of the parsed range.
+ * @param record - Record index: vertices come first and faces after them.
+ * @param off - OFF file.
+ * @param onVertex - Function called with the vertex index and its coordinates.
+ * @param onFace - Function called with the face index and its point IDs.
+ * @param ids - Buffer reused by the faces, so they do not allocate memory.
+ */
+template<class VertexFunction, class FaceFunction>
+inline void parseRecord(const char*& p, const char* end, unsigned int record, const OFFFile& off,
+                        VertexFunction& onVertex, FaceFunction& onFace, std::vector<unsigned int>& ids)
+{
+    if (record < off.numPoints)
     {
-        unsigned int numOfPoints; //how many points the polygon have
-
-        ifile >> numOfPoints;
-
-        ifile >> triangles[3 * i + 0];
-        ifile >> triangles[3 * i + 1];
-        ifile >> triangles[3 * i + 2];
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        parseFloat(p, end, x);
+        parseFloat(p, end, y);
+        parseFloat(p, end, z);
+        onVertex(record, x, y, z);
     }
+    else
+    {
+        unsigned int numOfPoints = 0; //how many points the polygon have
+        parseUnsigned(p, end, numOfPoints);
 
-    ifile.close();
+        ids.resize(numOfPoints);
+        for (unsigned int j = 0; j < numOfPoints; j++)
+        {
+            parseUnsigned(p, end, ids[j]);
+        }
+        onFace(record - off.numPoints, ids.data(), numOfPoints);
+    }
 }
 
 
 
-void readQuad3DFileOFF(const std::string& filename, std::vector<Point3Df>& points,
-                              std::vector<unsigned int>& quads)
+/**
+ * @brief parseOFF - Parses the vertices and faces of an OFF file. The body is split into chunks of whole lines that
+ * are parsed by several threads. The lines are counted on a first parallel pass, so each chunk knows the index of its
+ * first record. If the records do not fill one line each, the file is parsed sequentially.
+ * @param off - Opened OFF file.
+ * @param onVertex - Function called with the vertex index and its coordinates. It can be called by many threads.
+ * @param onFace - Function called with the face index and its point IDs. It can be called by many threads.
+ */
+template<class VertexFunction, class FaceFunction>
+void parseOFF(const OFFFile& off, VertexFunction onVertex, FaceFunction onFace)
 {
-    std::ifstream ifile;
-    ifile.open(filename);
+    const unsigned int numRecords = off.numPoints + off.numFaces;
+    const size_t size = static_cast<size_t>(off.end - off.body);
 
-    if (!ifile.is_open())
+    //Split the body on line boundaries.
+    unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, size / getMinChunkSize() + 1));
+
+    std::vector<const char*> chunks(numThreads + 1, off.end);
+    chunks[0] = off.body;
+    for (unsigned int t = 1; t < numThreads; t++)
     {
-        std::cout << "Could not open " << std::endl;
-        perror(filename.c_str());
-        return;
+        chunks[t] = nextLine(std::max(chunks[t - 1], off.body + t * (size / numThreads)), off.end);
     }
 
-    char OFF[100];
-    unsigned int numPoints;
-    unsigned int numQuads;
-    unsigned int numFaces;
+    auto runParallel = [numThreads](const std::function<void(unsigned int)>& task)
+    {
+        std::vector<std::thread> threads;
+        for (unsigned int t = 1; t < numThreads; t++)
+        {
+            threads.emplace_back(task, t);
+        }
+        task(0);
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    };
+
+    //First pass: count the records of each chunk.
+    std::vector<unsigned int> firstRecord(numThreads + 1, 0);
+    runParallel([&](unsigned int t)
+    {
+        unsigned int count = 0;
+        for (const char* line = chunks[t]; line < chunks[t + 1];)
+        {
+            const char* lineEnd = nextLine(line, chunks[t + 1]);
+            count += isRecordLine(line, lineEnd) ? 1 : 0;
+            line = lineEnd;
+        }
+        firstRecord[t + 1] = count;
+    });
 
-    ifile >> OFF; //discarding the first line of the file .off
-    ifile >> numPoints;
-    ifile >> numQuads;
-    ifile >> numFaces;
+    for (unsigned int t = 0; t < numThreads; t++)
+    {
+        firstRecord[t + 1] += firstRecord[t];
+    }
 
-    points.resize(numPoints);
-    quads.resize(4 * numQuads);
+    if (firstRecord[numThreads] < numRecords)
+    {
+        //Records are not one per line, so parse the tokens sequentially.
+        std::vector<unsigned int> ids;
+        const char* p = off.body;
+        for (unsigned int record = 0; record < numRecords; record++)
+        {
+            parseRecord(p, off.end, record, off, onVertex, onFace, ids);
+        }
+        return;
+    }
 
-    //reading the points
-    for (unsigned int i = 0; i < numPoints; i++)
+    //Second pass: parse each chunk knowing the index of its first record.
+    runParallel([&](unsigned int t)
     {
-        float x, y, z;
+        std::vector<unsigned int> ids;
+        unsigned int record = firstRecord[t];
+        for (const char* line = chunks[t]; line < chunks[t + 1] && record < numRecords;)
+        {
+            const char* lineEnd = nextLine(line, chunks[t + 1]);
+            if (isRecordLine(line, lineEnd))
+            {
+                const char* p = line;
+                parseRecord(p, lineEnd, record, off, onVertex, onFace, ids);
+                record++;
+            }
+            line = lineEnd;
+        }
+    });
+}
+}
 
-        ifile >> x;
-        ifile >> y;
-        ifile >> z;
 
-        Point3Df point;
-        point.setX(x);
-        point.setY(y);
-        point.setZ(z);
 
-        points[i] = point;
+void readFileOFF(const std::string& filename, std::vector<Point3Df>& points,
+                 std::vector<std::vector<unsigned int>>& polygons)
+{
+    OFFFile off;
+    if (!openOFF(filename, off))
+    {
+        return;
     }
 
-    //reading the polygons
-    for (unsigned int i = 0; i < numQuads; i++)
+    points.resize(off.numPoints);
+    polygons.resize(off.numFaces);
+
+    parseOFF(off, [&points](unsigned int i, float x, float y, float z)
     {
-        unsigned int numOfPoints; //how many points the polygon have
+        points[i] = QVector3D(x, y, z);
+    },
+    [&polygons](unsigned int i, const unsigned int* ids, unsigned int n)
+    {
+        polygons[i].assign(ids, ids + n);
+    });
+}
+
 
-        ifile >> numOfPoints;
 
-        ifile >> quads[4 * i + 0];
-        ifile >> quads[4 * i + 1];
-        ifile >> quads[4 * i + 2];
-        ifile >> quads[4 * i + 3];
+void readTriangle3DFileOFF(const std::string& filename, std::vector<Point3Df>& points,
+                           std::vector<unsigned int>& triangles)
+{
+    OFFFile off;
+    if (!openOFF(filename, off))
+    {
+        return;
     }
 
-    ifile.close();
+    points.resize(off.numPoints);
+    triangles.resize(3 * static_cast<size_t>(off.numFaces));
+
+    parseOFF(off, [&points](unsigned int i, float x, float y, float z)
+    {
+        points[i] = QVector3D(x, y, z);
+    },
+    [&triangles](unsigned int i, const unsigned int* ids, unsigned int n)
+    {
+        std::copy(ids, ids + std::min(n, 3u), triangles.begin() + 3 * static_cast<size_t>(i));
+    });
 }
 
 
 
-void readQuad2DFileOFF(const std::string& filename, std::vector<Point2Df>& points,
-                              std::vector<unsigned int>& quads)
+void readTriangle2DFileOFF(const std::string& filename, std::vector<Point2Df>& points,
+                           std::vector<unsigned int>& triangles)
 {
-    std::ifstream ifile;
-    ifile.open(filename);
-
-    if (!ifile.is_open())
+    OFFFile off;
+    if (!openOFF(filename, off))
     {
-        std::cout << "Could not open " << std::endl;
-        perror(filename.c_str());
         return;
     }
 
-    char OFF[100];
-    unsigned int numPoints;
-    unsigned int numQuads;
-    unsigned int numFaces;
-
-    ifile >> OFF; //discarding the first line of the file .off
-    ifile >> numPoints;
-    ifile >> numQuads;
-    ifile >> numFaces;
-
-    points.resize(numPoints);
-    quads.resize(4 * numQuads);
+    points.resize(off.numPoints);
+    triangles.resize(3 * static_cast<size_t>(off.numFaces));
 
-    //reading the points
-    for (unsigned int i = 0; i < numPoints; i++)
+    parseOFF(off, [&points](unsigned int i, float x, float y, float)
     {
-        float x, y, z;
+        points[i] = Point2Df(x, y);
+    },
+    [&triangles](unsigned int i, const unsigned int* ids, unsigned int n)
+    {
+        std::copy(ids, ids + std::min(n, 3u), triangles.begin() + 3 * static_cast<size_t>(i));
+    });
+}
 
-        ifile >> x;
-        ifile >> y;
-        ifile >> z;
 
-        Point2Df point;
-        point[0] = x;
-        point[1] = y;
 
-        points[i] = point;
+void readQuad3DFileOFF(const std::string& filename, std::vector<Point3Df>& points,
+                              std::vector<unsigned int>& quads)
+{
+    OFFFile off;
+    if (!openOFF(filename, off))
+    {
+        return;
     }
 
-    //reading the polygons
-    for (unsigned int i = 0; i < numQuads; i++)
+    points.resize(off.numPoints);
+    quads.resize(4 * static_cast<size_t>(off.numFaces));
+
+    parseOFF(off, [&points](unsigned int i, float x, float y, float z)
     {
-        unsigned int numOfPoints; //how many points the polygon have
+        points[i] = QVector3D(x, y, z);
+    },
+    [&quads](unsigned int i, const unsigned int* ids, unsigned int n)
+    {
+        std::copy(ids, ids + std::min(n, 4u), quads.begin() + 4 * static_cast<size_t>(i));
+    });
+}
 
-        ifile >> numOfPoints;
 
-        ifile >> quads[4 * i + 0];
-        ifile >> quads[4 * i + 1];
-        ifile >> quads[4 * i + 2];
-        ifile >> quads[4 * i + 3];
+
+void readQuad2DFileOFF(const std::string& filename, std::vector<Point2Df>& points,
+                              std::vector<unsigned int>& quads)
+{
+    OFFFile off;
+    if (!openOFF(filename, off))
+    {
+        return;
     }
 
-    ifile.close();
+    points.resize(off.numPoints);
+    quads.resize(4 * static_cast<size_t>(off.numFaces));
+
+    parseOFF(off, [&points](unsigned int i, float x, float y, float)
+    {
+        points[i] = Point2Df(x, y);
+    },
+    [&quads](unsigned int i, const unsigned int* ids, unsigned int n)
+    {
+        std::copy(ids, ids + std::min(n, 4u), quads.begin() + 4 * static_cast<size_t>(i));
+    });
 }
 }
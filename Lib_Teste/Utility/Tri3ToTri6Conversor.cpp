@@ -0,0 +1,222 @@
+#include "Tri3ToTri6Conversor.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+
+namespace rm
+{
+namespace
+{
+/**
+ * @brief getMinCountPerThread - Gets the minimum number of vertices or triangles given to a thread.
+ * @return - Returns the minimum count.
+ */
+constexpr size_t getMinCountPerThread()
+{
+    return 16384;
+}
+
+
+
+/**
+ * @brief random - Gets a pseudo random number from a seed and a counter. Each edge draws its own numbers, so the
+ * result does not depend on the thread that handles the edge.
+ * @param seed - Seed.
+ * @param counter - Counter.
+ * @return - Returns a number in [0, 1).
+ */
+float random(uint64_t seed, uint64_t counter)
+{
+    //splitmix64 finalizer.
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull * (counter + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    return static_cast<float>(z >> 40) / static_cast<float>(1ull << 24);
+}
+
+
+
+/**
+ * @brief computeNode - Computes the node of an edge, moved by up to a tenth of the edge length if requested.
+ * @param p0 - First edge vertex.
+ * @param p1 - Second edge vertex.
+ * @param randomMove - True to move the node randomly.
+ * @param seed - Seed of the random move.
+ * @param edge - Edge index.
+ * @return - Returns the new node.
+ */
+Point2Df computeNode(const Point2Df& p0, const Point2Df& p1, bool randomMove, uint64_t seed, uint64_t edge)
+{
+    Point2Df node = 0.5f * (p0 + p1);
+    if (randomMove)
+    {
+        float l = (p0 - p1).norm();
+        Point2Df dirMove(2 * random(seed, 3 * edge) - 1.0f, 2 * random(seed, 3 * edge + 1) - 1.0f);
+        dirMove.normalize();
+        node += (l * dirMove) * (random(seed, 3 * edge + 2) / 10.0f);
+    }
+    return node;
+}
+
+
+
+/**
+ * @brief computeNode - Computes the node of an edge, moved by up to a tenth of the edge length if requested.
+ * @param p0 - First edge vertex.
+ * @param p1 - Second edge vertex.
+ * @param randomMove - True to move the node randomly.
+ * @param seed - Seed of the random move.
+ * @param edge - Edge index.
+ * @return - Returns the new node.
+ */
+QVector3D computeNode(const QVector3D& p0, const QVector3D& p1, bool randomMove, uint64_t seed, uint64_t edge)
+{
+    QVector3D node = 0.5f * (p0 + p1);
+    if (randomMove)
+    {
+        float l = (p0 - p1).length();
+        QVector3D dirMove(2 * random(seed, 4 * edge) - 1.0f, 2 * random(seed, 4 * edge + 1) - 1.0f,
+                          2 * random(seed, 4 * edge + 2) - 1.0f);
+        dirMove.normalize();
+        node += (l * dirMove) * (random(seed, 4 * edge + 3) / 10.0f);
+    }
+    return node;
+}
+
+
+
+/**
+ * @brief convert - Converts a linear triangle mesh to a quadratic one. The edges are grouped by their lower vertex
+ * with a counting sort, so each vertex deduplicates its few edges independently, and all passes except the counting
+ * one run in parallel.
+ * @param mesh - Linear triangle indexes. It receives the quadratic triangle indexes.
+ * @param points - Mesh points. The edge nodes are appended.
+ * @param randomMove - True to move the new nodes randomly.
+ */
+template<class Point>
+void convert(std::vector<unsigned int>& mesh, std::vector<Point>& points, bool randomMove)
+{
+    size_t numTriangles = mesh.size() / 3;
+    size_t numPoints = points.size();
+    uint64_t seed = static_cast<uint64_t>(time(nullptr));
+
+    //Count the edge uses of each lower vertex and turn the counters into offsets.
+    std::vector<unsigned int> firstUse(numPoints + 1, 0);
+    for (size_t c = 0; c < 3 * numTriangles; c++)
+    {
+        size_t t = c / 3;
+        unsigned int i = std::min(mesh[c], mesh[3 * t + (c + 1) % 3]);
+        firstUse[i + 1]++;
+    }
+
+    for (size_t v = 0; v < numPoints; v++)
+    {
+        firstUse[v + 1] += firstUse[v];
+    }
+
+    //Fill the upper vertex and the triangle corner of each use.
+    std::vector<unsigned int> upper(3 * numTriangles), corner(3 * numTriangles);
+    {
+        std::vector<unsigned int> next(firstUse.begin(), firstUse.end() - 1);
+        for (size_t c = 0; c < 3 * numTriangles; c++)
+        {
+            size_t t = c / 3;
+            unsigned int i = std::min(mesh[c], mesh[3 * t + (c + 1) % 3]);
+            unsigned int j = std::max(mesh[c], mesh[3 * t + (c + 1) % 3]);
+            upper[next[i]] = j;
+            corner[next[i]++] = static_cast<unsigned int>(c);
+        }
+    }
+
+    //Sort the uses of each vertex by the upper vertex, so the uses of an edge are together, and count the edges.
+    std::vector<unsigned int> firstEdge(numPoints + 1, 0);
+    parallelFor(numPoints, getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        std::vector<std::pair<unsigned int, unsigned int>> uses;
+        for (size_t v = begin; v < end; v++)
+        {
+            uses.clear();
+            for (unsigned int u = firstUse[v]; u < firstUse[v + 1]; u++)
+            {
+                uses.emplace_back(upper[u], corner[u]);
+            }
+            std::sort(uses.begin(), uses.end());
+
+            unsigned int numEdges = 0;
+            for (size_t u = 0; u < uses.size(); u++)
+            {
+                upper[firstUse[v] + u] = uses[u].first;
+                corner[firstUse[v] + u] = uses[u].second;
+                if (u == 0 || uses[u].first != uses[u - 1].first)
+                {
+                    numEdges++;
+                }
+            }
+            firstEdge[v + 1] = numEdges;
+        }
+    });
+
+    for (size_t v = 0; v < numPoints; v++)
+    {
+        firstEdge[v + 1] += firstEdge[v];
+    }
+
+    //Create the edge nodes and give their indexes to the triangle corners.
+    std::vector<unsigned int> cornerNode(3 * numTriangles);
+    points.resize(numPoints + firstEdge[numPoints]);
+    parallelFor(numPoints, getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; v++)
+        {
+            unsigned int edge = firstEdge[v];
+            for (unsigned int u = firstUse[v]; u < firstUse[v + 1]; u++)
+            {
+                if (u != firstUse[v] && upper[u] != upper[u - 1])
+                {
+                    edge++;
+                }
+
+                if (u == firstUse[v] || upper[u] != upper[u - 1])
+                {
+                    points[numPoints + edge] = computeNode(points[v], points[upper[u]], randomMove, seed, edge);
+                }
+                cornerNode[corner[u]] = static_cast<unsigned int>(numPoints + edge);
+            }
+        }
+    });
+
+    //Build the quadratic triangles: the three vertices and then the nodes of the edges 01, 12 and 20.
+    std::vector<unsigned int> newMesh(6 * numTriangles);
+    parallelFor(numTriangles, getMinCountPerThread(), [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; t++)
+        {
+            for (size_t c = 0; c < 3; c++)
+            {
+                newMesh[6 * t + c] = mesh[3 * t + c];
+                newMesh[6 * t + 3 + c] = cornerNode[3 * t + c];
+            }
+        }
+    });
+
+    mesh.swap(newMesh);
+}
+}
+
+
+
+void Tri3ToTri6Conversor(std::vector<unsigned int>& mesh, std::vector<Point2Df>& points, bool randomMove)
+{
+    convert(mesh, points, randomMove);
+}
+
+
+
+void Tri3ToTri6Conversor(std::vector<unsigned int>& mesh, std::vector<QVector3D>& points, bool randomMove)
+{
+    convert(mesh, points, randomMove);
+}
+}
@@ -1,9 +1,11 @@
 #include "MainWindow.h"
 #include "Vector2D.h"
 #include "GraphicsItemModel.h"
+#include "../../Core/GraphicsSceneEventReplayer.h"
 #include "ui_mainwindow.h"
 
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QStandardItemModel>
 #include <QPushButton>
 #include <QMouseEvent>
@@ -24,10 +26,14 @@ MainWindow::MainWindow(QWidget *parent) :
     _scene->enableMouseEvents();
     _scene->enableEvent(EventType::keyEvent);
 
+    //Build the programs while the window is shown, so the first items are not slowed down by the shader compilation.
+    _scene->warmUpPrograms();
+
     //Creates two GraphicsView2D
     _view2D = _scene->create2DView(this);
     _view2D->preview(false); //define it as preview
     _view2D->installEventFilter(this);
+    _view2D->setMoveEventCoalescing(true);
 
 
     Graphics3DView* view3D = _scene->create3DView(this);
@@ -43,6 +49,8 @@ MainWindow::MainWindow(QWidget *parent) :
     light.setDiffuseComponet(greenColor);
     view3D->setShadingModel(shadeModel);
     view3D->installEventFilter(this);
+    view3D->setMoveEventCoalescing(true);
+    _view3D = view3D;
 
     //Initialize the scene tool stack with default view controler
     pushTool(new ViewControllerTool(_scene), _ui->actionDefault);
@@ -98,6 +106,27 @@ MainWindow::MainWindow(QWidget *parent) :
     _contextMenuEditRectangle.addAction(_removeAction);
     _contextMenuEditRectangle.addAction(_renameAction);
 
+    //Toggles the frame times and counters over both views.
+    _renderStatisticsAction = new QAction("Statistics", this);
+    _renderStatisticsAction->setCheckable(true);
+    _renderStatisticsAction->setToolTip("Show render statistics");
+    connect(_renderStatisticsAction, SIGNAL(toggled(bool)), this, SLOT(showRenderStatistics(bool)));
+    _ui->toolBar->addSeparator();
+    _ui->toolBar->addAction(_renderStatisticsAction);
+
+    //Records the session events, to measure the tools on them later.
+    _scene->setEventRecorder(&_eventRecorder);
+    _recordEventsAction = new QAction("Record", this);
+    _recordEventsAction->setCheckable(true);
+    _recordEventsAction->setToolTip("Record the events given to the tools");
+    connect(_recordEventsAction, SIGNAL(toggled(bool)), this, SLOT(recordEvents(bool)));
+    _ui->toolBar->addAction(_recordEventsAction);
+
+    _replayEventsAction = new QAction("Replay", this);
+    _replayEventsAction->setToolTip("Replay recorded events on the current tool");
+    connect(_replayEventsAction, SIGNAL(triggered()), this, SLOT(replayEvents()));
+    _ui->toolBar->addAction(_replayEventsAction);
+
     //connect(_ui->sceneTreeView,SIGNAL(itemChanged(QStandardItem*)), this, SLOT(renameItem()));
 }
 
@@ -105,6 +134,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    _scene->setEventRecorder(nullptr);
     delete _toolType;
     delete _scene;
     delete _ui;
@@ -955,16 +985,69 @@ void MainWindow::on_actionTriangular3DMesh_triggered()
         list = fileName.split("/");
         QString name = list[list.size() - 1];
         std::string file = fileName.toStdString();
-        std::vector<Point3Df> points;
-        std::vector<unsigned int> triangles;
-        loader::readTriangle3DFileOFF(file, points, triangles);
-        rm::TriangleMesh3DItem* triangleMesh = new rm::TriangleMesh3DItem(triangles, points);
-        Point3Df color(0.1f, 0.5f, 1.0f );
-        triangleMesh->setBrushColor(color);
-        _scene->addItem(triangleMesh);
-        _scene->update();
+        QFileInfo cacheInfo(fileName + ".cache");
+        bool isCacheOutdated = !cacheInfo.exists() || cacheInfo.lastModified() < QFileInfo(fileName).lastModified();
+        std::string cacheFile = cacheInfo.filePath().toStdString();
+
+        //Read the mesh and upload it on the loader thread, so the window keeps responding.
+        ItemFactory factory = [file, cacheFile, isCacheOutdated](AsyncItemLoad& load) -> GraphicsItem*
+        {
+            //Convert the OFF file to a binary cache when there is no cache or it is older than the file.
+            if (isCacheOutdated)
+            {
+                loader::convertTriangle3DFileOFF(file, cacheFile);
+            }
+            load.setProgress(0.5f);
 
-        addTreeItemAndModel(name, _triangleMesh3DTree, triangleMesh);
+            if (load.isCanceled())
+            {
+                return nullptr;
+            }
+
+            rm::TriangleMesh3DItem* triangleMesh = nullptr;
+            loader::MeshCache* cache = new loader::MeshCache();
+            if (cache->open(cacheFile))
+            {
+                triangleMesh = new rm::TriangleMesh3DItem(cache);
+            }
+            else
+            {
+                //The cache could not be written, so read the OFF file.
+                delete cache;
+                std::vector<Point3Df> points;
+                std::vector<unsigned int> triangles;
+                loader::readTriangle3DFileOFF(file, points, triangles);
+                triangleMesh = new rm::TriangleMesh3DItem(triangles, points);
+            }
+            Point3Df color(0.1f, 0.5f, 1.0f );
+            triangleMesh->setBrushColor(color);
+            load.setProgress(0.8f);
+
+            //Build the picking BVH and the simplified levels here, so the window does not stall.
+            triangleMesh->buildBVH();
+            load.setProgress(0.9f);
+            triangleMesh->buildLevelsOfDetail();
+            return triangleMesh;
+        };
+
+        ItemLoadCallbacks callbacks;
+        callbacks.progress = [this, name](unsigned int, float progress)
+        {
+            statusBar()->showMessage(QString("Loading %1: %2%").arg(name).arg(static_cast<int>(100 * progress)));
+        };
+        callbacks.finished = [this, name](unsigned int, GraphicsItem* triangleMesh)
+        {
+            if (triangleMesh != nullptr)
+            {
+                addTreeItemAndModel(name, _triangleMesh3DTree, triangleMesh);
+                statusBar()->showMessage(QString("%1 loaded.").arg(name));
+            }
+            else
+            {
+                statusBar()->showMessage(QString("%1 was not loaded.").arg(name));
+            }
+        };
+        _scene->addItemAsync(factory, callbacks);
     }
 }
 
@@ -1005,17 +1088,37 @@ void MainWindow::on_actionQuad3DMesh_triggered()
         list = fileName.split("/");
         QString name = list[list.size() - 1];
         std::string file = fileName.toStdString();
-        std::vector<Point3Df> points;
-        std::vector<unsigned int> triangles;
-        loader::readQuad3DFileOFF(file, points, triangles);
-        rm::QuadMesh3DItem* quadMesh = new rm::QuadMesh3DItem(triangles, points);
-        Point3Df color(1.0f, 0.5f, 0.2f );
-        quadMesh->setBrushColor(color);
-        _scene->addItem(quadMesh);
 
-        _scene->update();
+        //The normals are computed by the constructor, so the whole item is built on the loader thread.
+        ItemFactory factory = [file](AsyncItemLoad& load) -> GraphicsItem*
+        {
+            std::vector<Point3Df> points;
+            std::vector<unsigned int> triangles;
+            loader::readQuad3DFileOFF(file, points, triangles);
+            load.setProgress(0.5f);
+
+            if (load.isCanceled())
+            {
+                return nullptr;
+            }
 
-        addTreeItemAndModel(name, _quadMesh3DTree, quadMesh);
+            rm::QuadMesh3DItem* quadMesh = new rm::QuadMesh3DItem(triangles, points);
+            Point3Df color(1.0f, 0.5f, 0.2f );
+            quadMesh->setBrushColor(color);
+            quadMesh->buildBVH();
+            quadMesh->buildLevelsOfDetail();
+            return quadMesh;
+        };
+
+        ItemLoadCallbacks callbacks;
+        callbacks.finished = [this, name](unsigned int, GraphicsItem* quadMesh)
+        {
+            if (quadMesh != nullptr)
+            {
+                addTreeItemAndModel(name, _quadMesh3DTree, quadMesh);
+            }
+        };
+        _scene->addItemAsync(factory, callbacks);
     }
 
 }
@@ -1130,6 +1233,70 @@ void MainWindow::on_actionPlaneNegativeZ_triggered()
 
 
 
+void MainWindow::showRenderStatistics(bool checked)
+{
+    _view2D->setStatisticsOverlayVisible(checked);
+    _view2D->setProfilingEnabled(checked);
+    _view3D->setStatisticsOverlayVisible(checked);
+    _view3D->setProfilingEnabled(checked);
+}
+
+
+
+void MainWindow::recordEvents(bool checked)
+{
+    if (checked)
+    {
+        _eventRecorder.start();
+        statusBar()->showMessage("Recording the events.");
+        return;
+    }
+
+    _eventRecorder.stop();
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Event Recording"), "",
+                                                    tr("Event Recordings(*.rec)"));
+    if (fileName.size() && _eventRecorder.save(fileName.toStdString()))
+    {
+        statusBar()->showMessage(QString("%1 events saved.").arg(_eventRecorder.getEvents().size()));
+    }
+    else
+    {
+        statusBar()->clearMessage();
+    }
+}
+
+
+
+void MainWindow::replayEvents()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open Event Recording"), "",
+                                                    tr("Event Recordings(*.rec)"));
+    rm::GraphicsSceneEventRecorder recording;
+    if (!fileName.size() || !recording.load(fileName.toStdString()))
+    {
+        return;
+    }
+
+    //The views are created in the same order on every run, so the recorded view identifiers still match.
+    rm::GraphicsSceneEventReplayer replayer(_scene);
+    rm::ReplayStatistics statistics = replayer.replay(recording.getEvents());
+    _scene->update();
+
+    long long toolTime = 0;
+    for (long long latency : statistics.latencies)
+    {
+        toolTime += latency;
+    }
+    double meanLatency = statistics.dispatchedEvents ? toolTime / 1000.0 / statistics.dispatchedEvents : 0.0;
+    statusBar()->showMessage(QString("%1 events replayed in %2 ms (recorded in %3 ms), %4 us per event.")
+                             .arg(statistics.dispatchedEvents)
+                             .arg(statistics.replayTime / 1e6, 0, 'f', 2)
+                             .arg(statistics.recordedTime / 1e6, 0, 'f', 2)
+                             .arg(meanLatency, 0, 'f', 2));
+}
+
+
+
 void MainWindow::on_actionView3D_triggered(bool checked)
 {
     if(checked)
@@ -8,6 +8,7 @@
 #include "../../Core/Graphics2DView.h"
 #include "../../Core/GraphicsView.h"
 #include "../../Core/Graphics3DView.h"
+#include "../../Core/GraphicsSceneEventRecorder.h"
 #include "../../Tools/ViewControllerTool.h"
 #include "../../Shading/ShadingModel.h"
 #include "../../Shading/LightSource.h"
@@ -18,6 +19,7 @@
 #include "../../Tools/CreatePointSet2DItemTool.h"
 #include "../../Tools/CreateRectangle2DItemTool.h"
 #include "../../Utility/ReaderOFF.h"
+#include "../../Utility/MeshCache.h"
 #include "../../Items/TriangleMesh3DItem.h"
 #include "../../Items/TriangleMesh2DItem.h"
 #include "../../Items/QuadMesh3DItem.h"
@@ -253,6 +255,23 @@ private slots:
      */
     void removeItem();
 
+    /**
+     * @brief showRenderStatistics - Shows or hides the render statistics of the views and enables their profilers.
+     * @param checked - True to show the statistics.
+     */
+    void showRenderStatistics(bool checked);
+
+    /**
+     * @brief recordEvents - Starts recording the events given to the tools, or stops and saves the recording.
+     * @param checked - True to start recording.
+     */
+    void recordEvents(bool checked);
+
+    /**
+     * @brief replayEvents - Replays a saved recording on the views and shows the time spent by the tools.
+     */
+    void replayEvents();
+
     /**
      * @brief showContextMenu - Show a menu of screen with different option depending on the selected item.
      * @param pos - Position of the mouse on the screen.
@@ -304,6 +323,8 @@ private:
 
     rm::Graphics2DView* _view2D;
 
+    rm::Graphics3DView* _view3D;
+
     unsigned int _itemsCounter {0};
 
     QAction* _createPolylineAction;
@@ -315,6 +336,11 @@ private:
     QAction* _createRectangleAction;
     QAction* _createEllipseAction;
     QAction* _editEllipseAction;
+    QAction* _renderStatisticsAction;
+    QAction* _recordEventsAction;
+    QAction* _replayEventsAction;
+
+    rm::GraphicsSceneEventRecorder _eventRecorder;
 
     QMenu _contextMenuCreatePolyline;
 